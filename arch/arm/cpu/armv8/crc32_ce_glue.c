@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * CRC-32 and CRC-32C using the ARMv8 CRC32 and PMULL instructions
+ *
+ * crc32_no_comp() is an EFI runtime service, so this code and its data are
+ * placed in the EFI runtime sections too.
+ */
+
+#include <common.h>
+#include <efi_loader.h>
+#include <asm/armv8/cpu.h>
+#include <asm/armv8/crc32.h>
+
+/* Below this the CRC32 instructions on their own are about as fast */
+#define CRC32_PMULL_MIN		1024
+
+u32 crc32_armv8_update(u32 crc, const u8 *p, size_t len);
+u32 crc32c_armv8_update(u32 crc, const u8 *p, size_t len);
+void crc32_pmull_fold(u32 crc, const u8 *p, size_t len, const u64 k[4],
+		      u8 rem[16]);
+
+/*
+ * Bit-reflected x^575, x^511 mod P to fold 64 bytes ahead, then x^191,
+ * x^127 mod P to fold 16 bytes ahead
+ */
+static const u64 __efi_runtime_data crc32_fold_consts[] = {
+	0x653d982200000000, 0xcad38e8f00000000,
+	0x65673b4600000000, 0x9ba54c6f00000000,
+};
+
+static const u64 __efi_runtime_data crc32c_fold_consts[] = {
+	0x1c19243b00000000, 0x75bba45b00000000,
+	0x3743f7bd00000000, 0x3171d43000000000,
+};
+
+bool __efi_runtime crc32_armv8_supported(void)
+{
+	return id_aa64isar0_field(ID_AA64ISAR0_CRC32_SHIFT) != 0;
+}
+
+static bool __efi_runtime crc32_use_pmull(size_t len)
+{
+	return len >= CRC32_PMULL_MIN &&
+	       id_aa64isar0_field(ID_AA64ISAR0_AES_SHIFT) >=
+	       ID_AA64ISAR0_AES_PMULL;
+}
+
+u32 __efi_runtime crc32_armv8_le(u32 crc, const u8 *p, size_t len)
+{
+	u8 rem[16];
+	size_t n;
+
+	if (crc32_use_pmull(len)) {
+		n = len & ~15;
+		crc32_pmull_fold(crc, p, n, crc32_fold_consts, rem);
+		crc = crc32_armv8_update(0, rem, sizeof(rem));
+		p += n;
+		len -= n;
+	}
+
+	return crc32_armv8_update(crc, p, len);
+}
+
+u32 __efi_runtime crc32c_armv8_le(u32 crc, const u8 *p, size_t len)
+{
+	u8 rem[16];
+	size_t n;
+
+	if (crc32_use_pmull(len)) {
+		n = len & ~15;
+		crc32_pmull_fold(crc, p, n, crc32c_fold_consts, rem);
+		crc = crc32c_armv8_update(0, rem, sizeof(rem));
+		p += n;
+		len -= n;
+	}
+
+	return crc32c_armv8_update(crc, p, len);
+}
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * SHA-1 block function using the ARMv8 Crypto Extensions
+ */
+
+#include <common.h>
+#include <asm/armv8/cpu.h>
+#include <u-boot/sha1.h>
+
+void sha1_armv8_ce_process(u32 state[5], const unsigned char *src,
+			   unsigned int blocks);
+
+void sha1_process(sha1_context *ctx, const unsigned char *data,
+		  unsigned int blocks)
+{
+	u32 state[5];
+	int i;
+
+	if (!blocks)
+		return;
+	if (!id_aa64isar0_field(ID_AA64ISAR0_SHA1_SHIFT)) {
+		sha1_base_process(ctx, data, blocks);
+		return;
+	}
+
+	/* sha1_context holds the state as unsigned long */
+	for (i = 0; i < 5; i++)
+		state[i] = ctx->state[i];
+	sha1_armv8_ce_process(state, data, blocks);
+	for (i = 0; i < 5; i++)
+		ctx->state[i] = state[i];
+}
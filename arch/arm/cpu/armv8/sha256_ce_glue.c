@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * SHA-256 block function using the ARMv8 Crypto Extensions
+ */
+
+#include <common.h>
+#include <asm/armv8/cpu.h>
+#include <u-boot/sha256.h>
+
+void sha256_armv8_ce_process(uint32_t state[8], const uint8_t *src,
+			     unsigned int blocks);
+
+void sha256_process(sha256_context *ctx, const uint8_t *data,
+		    unsigned int blocks)
+{
+	if (!blocks)
+		return;
+	if (id_aa64isar0_field(ID_AA64ISAR0_SHA2_SHIFT) <
+	    ID_AA64ISAR0_SHA2_SHA256) {
+		sha256_base_process(ctx, data, blocks);
+		return;
+	}
+
+	sha256_armv8_ce_process(ctx->state, data, blocks);
+}
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * SHA-512 block function using the ARMv8.2 SHA-512 instructions
+ */
+
+#include <common.h>
+#include <asm/armv8/cpu.h>
+#include <u-boot/sha512.h>
+
+void sha512_armv8_ce_process(uint64_t state[8], const uint8_t *src,
+			     unsigned int blocks);
+
+void sha512_process(sha512_context *ctx, const uint8_t *data,
+		    unsigned int blocks)
+{
+	if (!blocks)
+		return;
+	if (id_aa64isar0_field(ID_AA64ISAR0_SHA2_SHIFT) <
+	    ID_AA64ISAR0_SHA2_SHA512) {
+		sha512_base_process(ctx, data, blocks);
+		return;
+	}
+
+	sha512_armv8_ce_process(ctx->state, data, blocks);
+}
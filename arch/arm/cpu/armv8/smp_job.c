@@ -0,0 +1,318 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Secondary CPUs running jobs on ARMv8
+ *
+ * The CPUs are listed in the /cpus node of the control device tree and are
+ * started with PSCI CPU_ON or released from the spin-table. They run U-Boot
+ * with the boot CPU's translation tables and exception vectors, then are
+ * switched off (PSCI) or sent back to the spin-table, so that the OS finds
+ * them where the firmware left them.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <cpu_func.h>
+#include <log.h>
+#include <malloc.h>
+#include <smp_job.h>
+#include <time.h>
+#include <asm/cache.h>
+#include <asm/global_data.h>
+#include <asm/psci.h>
+#include <asm/ptrace.h>
+#include <asm/spin_table.h>
+#include <asm/system.h>
+#include <dm/ofnode.h>
+#include "smp_job_boot.h"
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Time allowed for a CPU to come up or be parked */
+#define SMP_JOB_TIMEOUT_MS	1000
+
+#define PSCI_AFFINITY_OFF	1
+
+struct smp_job_boot smp_job_boot __aligned(ARCH_DMA_MINALIGN);
+
+/* Written with the MMU off, so keep the array in cache lines of its own */
+static u64 smp_job_parked[ALIGN(CONFIG_SMP_JOB_CPUS * sizeof(u64),
+				ARCH_DMA_MINALIGN) / sizeof(u64)]
+	__aligned(ARCH_DMA_MINALIGN);
+
+static void *smp_job_stacks[CONFIG_SMP_JOB_CPUS];
+static int smp_job_arrived[CONFIG_SMP_JOB_CPUS];
+static void (*smp_job_entry)(int cpu);
+static bool smp_job_psci;
+static int smp_job_started;	/* number of CPUs asked to start */
+static int smp_job_go;		/* set once the CPUs may go ahead */
+static int smp_job_nr;		/* number of CPUs running jobs */
+
+#define read_el_reg(reg) ({						\
+	u64 __val;							\
+									\
+	switch (current_el()) {						\
+	case 3:								\
+		asm volatile("mrs %0, " #reg "_el3" : "=r" (__val));	\
+		break;							\
+	case 2:								\
+		asm volatile("mrs %0, " #reg "_el2" : "=r" (__val));	\
+		break;							\
+	default:							\
+		asm volatile("mrs %0, " #reg "_el1" : "=r" (__val));	\
+		break;							\
+	}								\
+	__val;								\
+})
+
+static inline void smp_job_wfe(void)
+{
+	asm volatile("wfe" : : : "memory");
+}
+
+static inline void smp_job_sev(void)
+{
+	asm volatile("sev" : : : "memory");
+}
+
+static ulong smp_job_psci_call(ulong fn, ulong arg0, ulong arg1, ulong arg2)
+{
+	struct pt_regs regs;
+
+	regs.regs[0] = fn;
+	regs.regs[1] = arg0;
+	regs.regs[2] = arg1;
+	regs.regs[3] = arg2;
+	smc_call(&regs);
+
+	return regs.regs[0];
+}
+
+/* Called by smp_job_secondary_entry() on each secondary CPU */
+static void __noreturn smp_job_main(int cpu)
+{
+	__atomic_store_n(&smp_job_arrived[cpu - 1], 1, __ATOMIC_RELEASE);
+	smp_job_sev();
+	while (!__atomic_load_n(&smp_job_go, __ATOMIC_ACQUIRE))
+		smp_job_wfe();
+
+	if (cpu <= smp_job_nr)
+		smp_job_entry(cpu);
+
+	if (smp_job_psci)
+		smp_job_psci_call(ARM_PSCI_0_2_FN_CPU_OFF, 0, 0, 0);
+#ifdef CONFIG_ARMV8_SPIN_TABLE
+	else
+		smp_job_spin_table_park(&smp_job_parked[cpu - 1]);
+#endif
+
+	while (1)
+		smp_job_wfe();
+}
+
+static u64 smp_job_read_mpidr(ofnode node)
+{
+	const fdt32_t *reg;
+	int len;
+
+	reg = ofnode_read_prop(node, "reg", &len);
+	if (!reg)
+		return ~0ULL;
+	if (len == sizeof(u64))
+		return ((u64)fdt32_to_cpu(reg[0]) << 32) | fdt32_to_cpu(reg[1]);
+
+	return fdt32_to_cpu(reg[0]);
+}
+
+/* Find the CPUs to start and how, returning the number found */
+static int smp_job_find_cpus(int max)
+{
+	u64 self = read_mpidr() & SMP_JOB_MPIDR_MASK;
+	const char *method, *first = NULL;
+	ofnode cpus, node;
+	int nr = 0;
+
+	cpus = ofnode_path("/cpus");
+	if (!ofnode_valid(cpus))
+		return 0;
+
+	ofnode_for_each_subnode(node, cpus) {
+		const char *type = ofnode_read_string(node, "device_type");
+		u64 mpidr;
+
+		if (!type || strcmp(type, "cpu") || !ofnode_is_available(node))
+			continue;
+		mpidr = smp_job_read_mpidr(node) & SMP_JOB_MPIDR_MASK;
+		if (mpidr == self)
+			continue;
+
+		method = ofnode_read_string(node, "enable-method");
+		if (!method || (first && strcmp(method, first)))
+			continue;
+		if (!strcmp(method, "psci")) {
+			/* U-Boot at EL3 has no secure monitor to call */
+			if (current_el() == 3)
+				continue;
+		} else if (strcmp(method, "spin-table") ||
+			   !IS_ENABLED(CONFIG_ARMV8_SPIN_TABLE)) {
+			continue;
+		}
+		first = method;
+		smp_job_boot.mpidr[nr++] = mpidr;
+		if (nr == max)
+			break;
+	}
+	smp_job_psci = first && !strcmp(first, "psci");
+
+	return nr;
+}
+
+int arch_smp_job_start(int max, void (*entry)(int cpu))
+{
+	struct smp_job_boot *boot = &smp_job_boot;
+	ulong start;
+	int i, nr;
+
+	nr = smp_job_find_cpus(max);
+	if (!nr)
+		return -ENODEV;
+
+	for (i = 0; i < nr; i++) {
+		smp_job_stacks[i] = memalign(16, CONFIG_SMP_JOB_STACK_SIZE);
+		if (!smp_job_stacks[i]) {
+			while (i--)
+				free(smp_job_stacks[i]);
+			return -ENOMEM;
+		}
+		boot->sp[i] = (ulong)smp_job_stacks[i] +
+			CONFIG_SMP_JOB_STACK_SIZE;
+		smp_job_arrived[i] = 0;
+		smp_job_parked[i] = 0;
+	}
+	boot->nr = nr;
+	boot->gd = (ulong)gd;
+	boot->ttbr0 = read_el_reg(ttbr0);
+	boot->tcr = read_el_reg(tcr);
+	boot->mair = read_el_reg(mair);
+	boot->sctlr = get_sctlr();
+	boot->vbar = read_el_reg(vbar);
+	boot->main = (ulong)smp_job_main;
+	smp_job_entry = entry;
+	smp_job_go = 0;
+	smp_job_nr = 0;
+
+	/* The CPUs read all of this with their MMU off */
+	flush_dcache_range((ulong)boot, (ulong)(boot + 1));
+	flush_dcache_range((ulong)smp_job_parked,
+			   (ulong)smp_job_parked + sizeof(smp_job_parked));
+
+	smp_job_started = nr;
+	if (smp_job_psci) {
+		for (i = 0; i < nr; i++) {
+			long ret;
+
+			ret = smp_job_psci_call(ARM_PSCI_0_2_FN64_CPU_ON,
+						boot->mpidr[i],
+						(ulong)smp_job_secondary_entry,
+						0);
+			if (ret) {
+				log_debug("CPU %llx: PSCI CPU_ON failed (%ld)\n",
+					  boot->mpidr[i], ret);
+				smp_job_started = i;
+				break;
+			}
+		}
+#ifdef CONFIG_ARMV8_SPIN_TABLE
+	} else {
+		/*
+		 * This releases every spinning CPU; those not in smp_job_boot
+		 * go straight back to spinning
+		 */
+		spin_table_cpu_release_addr = (ulong)smp_job_secondary_entry;
+		flush_dcache_range((ulong)&spin_table_cpu_release_addr,
+				   (ulong)&spin_table_cpu_release_addr +
+				   sizeof(u64));
+		smp_job_sev();
+#endif
+	}
+
+	/* Use the CPUs which came up in time */
+	start = get_timer(0);
+	for (nr = 0; nr < smp_job_started; nr++) {
+		while (!__atomic_load_n(&smp_job_arrived[nr], __ATOMIC_ACQUIRE) &&
+		       get_timer(start) < SMP_JOB_TIMEOUT_MS)
+			;
+		if (!smp_job_arrived[nr]) {
+			log_debug("CPU %llx did not come up\n",
+				  boot->mpidr[nr]);
+			break;
+		}
+	}
+
+#ifdef CONFIG_ARMV8_SPIN_TABLE
+	if (!smp_job_psci) {
+		spin_table_cpu_release_addr = 0;
+		flush_dcache_range((ulong)&spin_table_cpu_release_addr,
+				   (ulong)&spin_table_cpu_release_addr +
+				   sizeof(u64));
+	}
+#endif
+
+	/* Any others park themselves, if they ever turn up */
+	smp_job_nr = nr;
+	__atomic_store_n(&smp_job_go, 1, __ATOMIC_RELEASE);
+	smp_job_sev();
+
+	return nr ? nr : -ETIMEDOUT;
+}
+
+static bool smp_job_is_parked(int i)
+{
+	if (smp_job_psci)
+		return smp_job_psci_call(ARM_PSCI_0_2_FN64_AFFINITY_INFO,
+					 smp_job_boot.mpidr[i], 0, 0) ==
+			PSCI_AFFINITY_OFF;
+
+	invalidate_dcache_range((ulong)smp_job_parked,
+				(ulong)smp_job_parked + sizeof(smp_job_parked));
+
+	return smp_job_parked[i];
+}
+
+void arch_smp_job_stop(void)
+{
+	ulong start = get_timer(0);
+	int i;
+
+	for (i = 0; i < smp_job_started; i++) {
+		bool parked;
+
+		while (!(parked = smp_job_is_parked(i)) &&
+		       get_timer(start) < SMP_JOB_TIMEOUT_MS)
+			;
+		if (!parked) {
+			/* Its stack may still be in use, so leave it */
+			log_err("CPU %llx was not parked\n",
+				smp_job_boot.mpidr[i]);
+			continue;
+		}
+		free(smp_job_stacks[i]);
+	}
+	smp_job_started = 0;
+}
+
+ulong arch_smp_job_cpu_id(void)
+{
+	/* Bit 31 is always set, so this is never zero */
+	return read_mpidr();
+}
+
+void arch_smp_job_wait_event(void)
+{
+	smp_job_wfe();
+}
+
+void arch_smp_job_send_event(void)
+{
+	smp_job_sev();
+}
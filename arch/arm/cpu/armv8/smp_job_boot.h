@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Layout of the data used to bring secondary CPUs into U-Boot for running
+ * jobs, shared between smp_job.c and smp_job_entry.S
+ */
+
+#ifndef __ARMV8_SMP_JOB_BOOT_H
+#define __ARMV8_SMP_JOB_BOOT_H
+
+#define SMP_JOB_BOOT_GD		0
+#define SMP_JOB_BOOT_TTBR0	8
+#define SMP_JOB_BOOT_TCR	16
+#define SMP_JOB_BOOT_MAIR	24
+#define SMP_JOB_BOOT_SCTLR	32
+#define SMP_JOB_BOOT_VBAR	40
+#define SMP_JOB_BOOT_MAIN	48
+#define SMP_JOB_BOOT_NR		56
+#define SMP_JOB_BOOT_MPIDR	64
+#define SMP_JOB_BOOT_SP		(SMP_JOB_BOOT_MPIDR + 8 * CONFIG_SMP_JOB_CPUS)
+
+/* The affinity fields of MPIDR_EL1 */
+#define SMP_JOB_MPIDR_MASK	0xff00ffffff
+
+#ifndef __ASSEMBLY__
+/**
+ * struct smp_job_boot - what a secondary CPU needs to join the boot CPU
+ *
+ * This is read by smp_job_secondary_entry() with the MMU and caches off.
+ *
+ * @gd:		global data pointer
+ * @ttbr0:	translation table base, as on the boot CPU
+ * @tcr:	translation control, as on the boot CPU
+ * @mair:	memory attributes, as on the boot CPU
+ * @sctlr:	system control, as on the boot CPU
+ * @vbar:	exception vectors, as on the boot CPU
+ * @main:	C function to call with the job CPU number
+ * @nr:		number of entries in @mpidr and @sp
+ * @mpidr:	affinity of each CPU to start, see SMP_JOB_MPIDR_MASK
+ * @sp:		initial stack pointer of each CPU
+ */
+struct smp_job_boot {
+	u64 gd;
+	u64 ttbr0;
+	u64 tcr;
+	u64 mair;
+	u64 sctlr;
+	u64 vbar;
+	u64 main;
+	u64 nr;
+	u64 mpidr[CONFIG_SMP_JOB_CPUS];
+	u64 sp[CONFIG_SMP_JOB_CPUS];
+};
+
+extern struct smp_job_boot smp_job_boot;
+
+void smp_job_secondary_entry(void);
+void __noreturn smp_job_spin_table_park(u64 *parked);
+#endif
+
+#endif /* __ARMV8_SMP_JOB_BOOT_H */
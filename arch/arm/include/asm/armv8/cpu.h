@@ -24,3 +24,24 @@ static inline unsigned int read_midr(void)
 			 MIDR_PARTNUM_SHIFT) == MIDR_PARTNUM_CORTEX_A53)
 #define is_cortex_a72() (((read_midr() & MIDR_PARTNUM_MASK) >>\
 			 MIDR_PARTNUM_SHIFT) == MIDR_PARTNUM_CORTEX_A72)
+
+#define ID_AA64ISAR0_AES_SHIFT		4
+#define ID_AA64ISAR0_SHA1_SHIFT		8
+#define ID_AA64ISAR0_SHA2_SHIFT		12
+#define ID_AA64ISAR0_CRC32_SHIFT	16
+
+#define ID_AA64ISAR0_AES_PMULL		2
+#define ID_AA64ISAR0_SHA2_SHA256	1
+#define ID_AA64ISAR0_SHA2_SHA512	2
+
+static inline unsigned long read_id_aa64isar0(void)
+{
+	unsigned long val;
+
+	asm volatile("mrs %0, id_aa64isar0_el1" : "=r" (val));
+
+	return val;
+}
+
+/* Read a 4-bit field of ID_AA64ISAR0_EL1, e.g. ID_AA64ISAR0_SHA2_SHIFT */
+#define id_aa64isar0_field(shift)	((read_id_aa64isar0() >> (shift)) & 0xf)
@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * CRC-32 and CRC-32C using the ARMv8 CRC32 and PMULL instructions
+ */
+
+#ifndef __ASM_ARMV8_CRC32_H
+#define __ASM_ARMV8_CRC32_H
+
+#include <linux/types.h>
+
+/**
+ * crc32_armv8_supported() - Check whether the CPU has the CRC32 instructions
+ *
+ * Return: true if crc32_armv8_le() and crc32c_armv8_le() may be used
+ */
+bool crc32_armv8_supported(void);
+
+/**
+ * crc32_armv8_le() - Update a CRC-32 (IEEE 802.3) over a buffer
+ *
+ * Large buffers are folded with PMULL first, when the CPU has it.
+ *
+ * @crc: CRC so far, without the final inversion
+ * @p: Data to checksum
+ * @len: Length of data in bytes
+ * Return: updated CRC
+ */
+u32 crc32_armv8_le(u32 crc, const u8 *p, size_t len);
+
+/**
+ * crc32c_armv8_le() - Update a CRC-32C (Castagnoli) over a buffer
+ *
+ * @crc: CRC so far, without the final inversion
+ * @p: Data to checksum
+ * @len: Length of data in bytes
+ * Return: updated CRC
+ */
+u32 crc32c_armv8_le(u32 crc, const u8 *p, size_t len);
+
+#endif /* __ASM_ARMV8_CRC32_H */
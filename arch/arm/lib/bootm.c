@@ -18,6 +18,7 @@
 #include <dm.h>
 #include <lmb.h>
 #include <log.h>
+#include <smp_job.h>
 #include <asm/global_data.h>
 #include <dm/root.h>
 #include <env.h>
@@ -110,6 +111,9 @@ static void announce_and_cleanup(int fake)
 	udc_disconnect();
 #endif
 
+	/* The OS expects to find the secondary CPUs parked */
+	smp_job_stop();
+
 	board_quiesce_devices();
 
 	printf("\nStarting kernel ...%s\n\n", fake ?
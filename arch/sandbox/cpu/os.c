@@ -9,6 +9,8 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
 #include <setjmp.h>
 #include <signal.h>
 #include <stdio.h>
@@ -953,3 +955,53 @@ void os_relaunch(char *argv[])
 	execv(argv[0], argv);
 	os_exit(1);
 }
+
+struct os_thread {
+	pthread_t thread;
+	void (*func)(void *arg);
+	void *arg;
+};
+
+static void *os_thread_run(void *data)
+{
+	struct os_thread *thread = data;
+
+	thread->func(thread->arg);
+
+	return NULL;
+}
+
+void *os_thread_create(void (*func)(void *arg), void *arg)
+{
+	struct os_thread *thread;
+
+	thread = os_malloc(sizeof(*thread));
+	if (!thread)
+		return NULL;
+	thread->func = func;
+	thread->arg = arg;
+	if (pthread_create(&thread->thread, NULL, os_thread_run, thread)) {
+		os_free(thread);
+		return NULL;
+	}
+
+	return thread;
+}
+
+void os_thread_join(void *data)
+{
+	struct os_thread *thread = data;
+
+	pthread_join(thread->thread, NULL);
+	os_free(thread);
+}
+
+unsigned long os_thread_self(void)
+{
+	return (unsigned long)pthread_self();
+}
+
+void os_thread_yield(void)
+{
+	sched_yield();
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Secondary CPUs for sandbox, using host threads
+ */
+
+#include <common.h>
+#include <os.h>
+#include <smp_job.h>
+
+struct sandbox_cpu {
+	void *thread;
+	int cpu;
+};
+
+static struct sandbox_cpu sandbox_cpus[CONFIG_SMP_JOB_CPUS];
+static void (*sandbox_cpu_entry)(int cpu);
+static int sandbox_cpu_count;
+
+static void sandbox_cpu_run(void *arg)
+{
+	struct sandbox_cpu *priv = arg;
+
+	sandbox_cpu_entry(priv->cpu);
+}
+
+int arch_smp_job_start(int max, void (*entry)(int cpu))
+{
+	int i;
+
+	sandbox_cpu_entry = entry;
+	for (i = 0; i < max && i < ARRAY_SIZE(sandbox_cpus); i++) {
+		struct sandbox_cpu *priv = &sandbox_cpus[i];
+
+		priv->cpu = i + 1;
+		priv->thread = os_thread_create(sandbox_cpu_run, priv);
+		if (!priv->thread)
+			break;
+	}
+	sandbox_cpu_count = i;
+
+	return i;
+}
+
+void arch_smp_job_stop(void)
+{
+	int i;
+
+	for (i = 0; i < sandbox_cpu_count; i++)
+		os_thread_join(sandbox_cpus[i].thread);
+	sandbox_cpu_count = 0;
+}
+
+ulong arch_smp_job_cpu_id(void)
+{
+	return os_thread_self();
+}
+
+void arch_smp_job_wait_event(void)
+{
+	os_thread_yield();
+}
+
+void arch_smp_job_send_event(void)
+{
+}
@@ -64,6 +64,15 @@ static int do_dm_dump_static_driver_info(struct cmd_tbl *cmdtp, int flag, int ar
 	return 0;
 }
 
+static __maybe_unused int do_dm_dump_probe_times(struct cmd_tbl *cmdtp,
+						  int flag, int argc,
+						  char *const argv[])
+{
+	dm_dump_probe_times(argc ? simple_strtoul(argv[0], NULL, 10) : 0);
+
+	return 0;
+}
+
 static struct cmd_tbl test_commands[] = {
 	U_BOOT_CMD_MKENT(tree, 0, 1, do_dm_dump_all, "", ""),
 	U_BOOT_CMD_MKENT(uclass, 1, 1, do_dm_dump_uclass, "", ""),
@@ -71,6 +80,9 @@ static struct cmd_tbl test_commands[] = {
 	U_BOOT_CMD_MKENT(drivers, 1, 1, do_dm_dump_drivers, "", ""),
 	U_BOOT_CMD_MKENT(compat, 1, 1, do_dm_dump_driver_compat, "", ""),
 	U_BOOT_CMD_MKENT(static, 1, 1, do_dm_dump_static_driver_info, "", ""),
+#if CONFIG_IS_ENABLED(DM_PROBE_TIMES)
+	U_BOOT_CMD_MKENT(probe-times, 1, 1, do_dm_dump_probe_times, "", ""),
+#endif
 };
 
 static __maybe_unused void dm_reloc(void)
@@ -115,4 +127,10 @@ U_BOOT_CMD(
 	"dm drivers       Dump list of drivers with uclass and instances\n"
 	"dm compat        Dump list of drivers with compatibility strings\n"
 	"dm static        Dump list of drivers with static platform data"
+#if CONFIG_IS_ENABLED(DM_PROBE_TIMES)
+	"\n"
+	"dm probe-times [<count>]\n"
+	"                 Dump time taken to bind and probe each device, most\n"
+	"                 costly first"
+#endif
 );
@@ -18,6 +18,7 @@
 #include <fdt_support.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#include <dm/of_index.h>
 
 #define MAX_LEVEL	32		/* how deeply nested we will go */
 #define SCRATCHPAD	1024		/* bytes of scratchpad memory */
@@ -153,10 +154,12 @@ static int do_fdt(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 		blob = map_sysmem(addr, 0);
 		if (!fdt_valid(&blob))
 			return 1;
-		if (control)
+		if (control) {
 			gd->fdt_blob = blob;
-		else
+			of_index_invalidate();
+		} else {
 			set_working_fdt_addr(addr);
+		}
 
 		if (argc >= 2) {
 			int  len;
@@ -192,6 +195,10 @@ static int do_fdt(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 		return CMD_RET_FAILURE;
 	}
 
+	/* Any of the commands below may change the control devicetree */
+	if (working_fdt == gd->fdt_blob)
+		of_index_invalidate();
+
 	/*
 	 * Move the working_fdt
 	 */
@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Load an image from a FIT on storage without reading the whole FIT first
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <bootm.h>
+#include <command.h>
+#include <env.h>
+#include <fit_stream.h>
+#include <fs.h>
+#include <image.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <part.h>
+
+struct fitload_file {
+	const char *ifname;
+	const char *dev_part;
+	const char *fname;
+};
+
+static int fitload_file_read(struct fit_stream_src *src, ulong offset,
+			     ulong size, void *buf)
+{
+	struct fitload_file *file = src->priv;
+	loff_t actread;
+
+	if (fs_set_blk_dev(file->ifname, file->dev_part, FS_TYPE_ANY))
+		return -ENODEV;
+	if (fs_read(file->fname, map_to_sysmem(buf), offset, size, &actread))
+		return -EIO;
+
+	return actread == size ? 0 : -EIO;
+}
+
+static int fitload_verify_conf(const void *fit, int cfg_noffset)
+{
+	if (!FIT_IMAGE_ENABLE_VERIFY)
+		return 0;
+
+	puts("   Verifying Hash Integrity ... ");
+	if (fit_config_verify(fit, cfg_noffset)) {
+		puts("Bad Data Hash\n");
+		return -EACCES;
+	}
+	puts("OK\n");
+
+	return 0;
+}
+
+/* Check whether configuration @cfg_noffset refers to image @name */
+static bool fitload_conf_uses(const void *fit, int cfg_noffset,
+			      const char *name)
+{
+	const char *prop_name;
+	int prop;
+
+	fdt_for_each_property_offset(prop, fit, cfg_noffset) {
+		fdt_getprop_by_offset(fit, prop, &prop_name, NULL);
+		if (prop_name && strcmp(prop_name, FIT_DESC_PROP) &&
+		    fdt_stringlist_search(fit, cfg_noffset, prop_name,
+					  name) >= 0)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * An image named directly is only loaded when required keys are present if
+ * a configuration using it verifies, since the keys may only sign
+ * configurations
+ */
+static int fitload_verify_image(const void *fit, int noffset)
+{
+	const char *name = fit_get_name(fit, noffset, NULL);
+	int confs, cfg_noffset;
+
+	if (!FIT_IMAGE_ENABLE_VERIFY || !fit_stream_key_required(NULL))
+		return 0;
+
+	confs = fdt_path_offset(fit, FIT_CONFS_PATH);
+	if (confs >= 0) {
+		fdt_for_each_subnode(cfg_noffset, fit, confs) {
+			if (!fitload_conf_uses(fit, cfg_noffset, name))
+				continue;
+			printf("   Using '%s' configuration\n",
+			       fdt_get_name(fit, cfg_noffset, NULL));
+			if (!fitload_verify_conf(fit, cfg_noffset))
+				return 0;
+		}
+	}
+	printf("No verified configuration uses image '%s'\n", name);
+
+	return -EACCES;
+}
+
+/*
+ * Find the image to load: either the image named by @spec, the kernel of
+ * configuration '#<name>' or else the kernel of the default configuration
+ */
+static int fitload_find_image(const void *fit, const char *spec)
+{
+	const char *conf_name = NULL;
+	int cfg_noffset, noffset;
+	int ret;
+
+	if (spec && *spec != '#') {
+		noffset = fit_image_get_node(fit, spec);
+		if (noffset < 0)
+			return noffset;
+		ret = fitload_verify_image(fit, noffset);
+
+		return ret ? ret : noffset;
+	}
+	if (spec)
+		conf_name = spec + 1;
+
+	cfg_noffset = fit_conf_get_node(fit, conf_name);
+	if (cfg_noffset < 0) {
+		puts("Could not find configuration node\n");
+		return -ENOENT;
+	}
+	printf("   Using '%s' configuration\n",
+	       fdt_get_name(fit, cfg_noffset, NULL));
+	ret = fitload_verify_conf(fit, cfg_noffset);
+	if (ret)
+		return ret;
+	noffset = fit_conf_get_prop_node(fit, cfg_noffset, FIT_KERNEL_PROP);
+	if (noffset < 0)
+		puts("Could not find kernel subimage\n");
+
+	return noffset;
+}
+
+static int fitload(struct fit_stream_src *src, int argc, char *const argv[])
+{
+	const char *spec = argc > 0 ? argv[0] : NULL;
+	ulong load, len;
+	void *fit;
+	int noffset;
+	int ret;
+
+	ret = fit_stream_read_header(src, &fit);
+	if (ret) {
+		printf("Cannot read FIT (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	noffset = fitload_find_image(fit, spec);
+	if (noffset < 0)
+		goto err;
+
+	if (argc > 1) {
+		load = simple_strtoul(argv[1], NULL, 16);
+	} else if (fit_image_get_load(fit, noffset, &load)) {
+		puts("Can't get subimage load address!\n");
+		goto err;
+	}
+	printf("   Loading '%s' to 0x%08lx\n", fit_get_name(fit, noffset, NULL),
+	       load);
+
+	ret = fit_stream_load_image(src, fit, noffset, load,
+				    CONFIG_SYS_BOOTM_LEN, &len);
+	if (ret) {
+		printf("Failed to load image (err=%d)\n", ret);
+		goto err;
+	}
+	printf("%lu bytes loaded\n", len);
+	free(fit);
+
+	env_set_hex("fileaddr", load);
+	env_set_hex("filesize", len);
+
+	return CMD_RET_SUCCESS;
+
+err:
+	free(fit);
+
+	return CMD_RET_FAILURE;
+}
+
+static int do_fitload_blk(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	struct fit_stream_src src = {};
+	struct disk_partition info;
+	char *endp;
+	ulong blk;
+
+	if (argc < 4)
+		return CMD_RET_USAGE;
+
+	if (blk_get_device_part_str(argv[1], argv[2], &src.desc, &info,
+				    1) < 0)
+		return CMD_RET_FAILURE;
+	blk = simple_strtoul(argv[3], &endp, 16);
+	if (*endp)
+		return CMD_RET_USAGE;
+	src.start = info.start + blk;
+
+	return fitload(&src, argc - 4, argv + 4);
+}
+
+static int do_fitload_file(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	struct fit_stream_src src = {};
+	struct fitload_file file;
+
+	if (argc < 4)
+		return CMD_RET_USAGE;
+
+	file.ifname = argv[1];
+	file.dev_part = argv[2];
+	file.fname = argv[3];
+	src.read = fitload_file_read;
+	src.priv = &file;
+
+	return fitload(&src, argc - 4, argv + 4);
+}
+
+#ifdef CONFIG_SYS_LONGHELP
+static char fitload_help_text[] =
+	"blk <interface> <dev[:part]> <blk> [<image>|#<conf>] [<addr>]\n"
+	"    - load an image from a FIT starting at hex block <blk>\n"
+	"fitload file <interface> <dev[:part]> <filename> [<image>|#<conf>] [<addr>]\n"
+	"    - load an image from a FIT held in a file\n"
+	"\n"
+	"The image is hashed and decompressed as it is read. By default the\n"
+	"kernel of the default configuration is loaded to its load address.\n"
+	"If the control FDT has required keys, an image named directly is\n"
+	"only loaded if a configuration using it verifies.";
+#endif
+
+U_BOOT_CMD_WITH_SUBCMDS(fitload, "Load an image from a FIT on storage",
+	fitload_help_text,
+	U_BOOT_SUBCMD_MKENT(blk, 7, 0, do_fitload_blk),
+	U_BOOT_SUBCMD_MKENT(file, 7, 0, do_fitload_file));
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Measure the throughput of the hash algorithms
+ */
+
+#include <common.h>
+#include <command.h>
+#include <div64.h>
+#include <hash.h>
+#include <mapmem.h>
+#include <time.h>
+
+static const char *const hashbench_algos[] = {
+	"sha1", "sha256", "sha384", "sha512", "crc32",
+};
+
+static int hashbench_one(struct hash_algo *algo, const void *buf, ulong len)
+{
+	u8 digest[HASH_MAX_DIGEST_SIZE];
+	ulong start, us;
+
+	start = timer_get_us();
+	algo->hash_func_ws(buf, len, digest, algo->chunk_size);
+	us = max(timer_get_us() - start, 1UL);
+
+	printf("%-12s %lu bytes in %lu us, %llu KiB/s\n", algo->name, len, us,
+	       lldiv((u64)len * 1000000 / 1024, us));
+
+	return 0;
+}
+
+static int do_hashbench(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	struct hash_algo *algo;
+	ulong addr, len;
+	const void *buf;
+	int i;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+
+	addr = simple_strtoul(argv[1], NULL, 16);
+	len = simple_strtoul(argv[2], NULL, 16);
+	buf = map_sysmem(addr, len);
+
+	if (argc > 3) {
+		if (hash_lookup_algo(argv[3], &algo)) {
+			printf("Unknown hash algorithm '%s'\n", argv[3]);
+			unmap_sysmem(buf);
+			return CMD_RET_FAILURE;
+		}
+		hashbench_one(algo, buf, len);
+	} else {
+		for (i = 0; i < ARRAY_SIZE(hashbench_algos); i++) {
+			if (!hash_lookup_algo(hashbench_algos[i], &algo))
+				hashbench_one(algo, buf, len);
+		}
+	}
+	unmap_sysmem(buf);
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	hashbench,	4,	0,	do_hashbench,
+	"measure hash algorithm throughput",
+	"address count [algorithm]\n"
+	"    - hash 'count' bytes at 'address' with each algorithm (or just\n"
+	"      'algorithm') and show the time taken"
+);
@@ -8,13 +8,19 @@
  * Boot support
  */
 #include <common.h>
+#include <blk.h>
 #include <bootstage.h>
 #include <command.h>
+#include <dm.h>
 #include <env.h>
 #include <image.h>
 #include <net.h>
+#include <part.h>
+#include <net/netperf.h>
+#include <net/store.h>
 #include <net/udp.h>
 #include <net/sntp.h>
+#include <net/tftp.h>
 
 static int netboot_common(enum proto_t, struct cmd_tbl *, int, char * const []);
 
@@ -36,17 +42,37 @@ U_BOOT_CMD(
 int do_tftpb(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 {
 	int ret;
+	int i;
+
+	/* Further loadAddress/filename pairs are fetched alongside the first */
+	if (argc > 3) {
+		if (!(argc & 1))
+			return CMD_RET_USAGE;
+		for (i = 3; i < argc; i += 2) {
+			if (tftp_add_file(simple_strtoul(argv[i], NULL, 16),
+					  argv[i + 1])) {
+				tftp_clear_files();
+				return CMD_RET_USAGE;
+			}
+		}
+		argc = 3;
+	}
 
 	bootstage_mark_name(BOOTSTAGE_KERNELREAD_START, "tftp_start");
 	ret = netboot_common(TFTPGET, cmdtp, argc, argv);
 	bootstage_mark_name(BOOTSTAGE_KERNELREAD_STOP, "tftp_done");
+	tftp_clear_files();
 	return ret;
 }
 
 U_BOOT_CMD(
-	tftpboot,	3,	1,	do_tftpb,
+	tftpboot,	1 + 2 * CONFIG_TFTP_MAX_FILES,	1,	do_tftpb,
 	"boot image via network using TFTP protocol",
-	"[loadAddress] [[hostIPaddr:]bootfilename]"
+	"[loadAddress] [[hostIPaddr:]bootfilename]\n"
+	"tftpboot loadAddress [hostIPaddr:]bootfilename "
+	"loadAddress filename ...\n"
+	"    - also fetch further files from the same server at once;\n"
+	"      filesize is set to the size of the first one"
 );
 #endif
 
@@ -123,6 +149,81 @@ U_BOOT_CMD(
 );
 #endif
 
+#if defined(CONFIG_CMD_NETINSTALL)
+static int do_netinstall(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	struct disk_partition info;
+	struct blk_desc *desc;
+	enum proto_t proto;
+	int size;
+	int ret;
+
+	if (argc < 4 || argc > 5)
+		return CMD_RET_USAGE;
+
+	if (IS_ENABLED(CONFIG_CMD_TFTPBOOT) && !strcmp(argv[1], "tftp"))
+		proto = TFTPGET;
+	else if (IS_ENABLED(CONFIG_CMD_NFS) && !strcmp(argv[1], "nfs"))
+		proto = NFS;
+	else
+		return CMD_RET_USAGE;
+
+	if (blk_get_device_part_str(argv[2], argv[3], &desc, &info, 1) < 0)
+		return CMD_RET_FAILURE;
+
+	if (argc == 5) {
+		net_boot_file_name_explicit = true;
+		copy_filename(net_boot_file_name, argv[4],
+			      sizeof(net_boot_file_name));
+	} else {
+		copy_filename(net_boot_file_name, env_get("bootfile"),
+			      sizeof(net_boot_file_name));
+	}
+
+	image_load_addr = env_get_hex("loadaddr", image_load_addr);
+	if (net_store_start(desc, &info, argv[3]))
+		return CMD_RET_FAILURE;
+	size = net_loop(proto);
+	ret = size < 0 ? size : net_store_finish();
+	net_store_stop();
+	if (ret)
+		return CMD_RET_FAILURE;
+
+	env_set_hex("filesize", net_boot_file_size);
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(
+	netinstall,	5,	0,	do_netinstall,
+	"download a file straight to a block device",
+	"tftp|nfs <interface> <dev[:part]> [[hostIPaddr:]bootfilename]\n"
+	"    - write the file to the partition while it is downloaded,\n"
+	"      using the memory at $loadaddr as a buffer. Android sparse\n"
+	"      images are expanded as they are written."
+);
+#endif
+
+#if defined(CONFIG_CMD_WGET)
+static int do_wget(struct cmd_tbl *cmdtp, int flag, int argc,
+		   char *const argv[])
+{
+	int ret;
+
+	bootstage_mark_name(BOOTSTAGE_KERNELREAD_START, "wget_start");
+	ret = netboot_common(WGET, cmdtp, argc, argv);
+	bootstage_mark_name(BOOTSTAGE_KERNELREAD_STOP, "wget_done");
+	return ret;
+}
+
+U_BOOT_CMD(
+	wget,	3,	1,	do_wget,
+	"boot image via network using HTTP protocol",
+	"[loadAddress] [[hostIPaddr:]path]"
+);
+#endif
+
 static void netboot_update_env(void)
 {
 	char tmp[22];
@@ -404,6 +505,75 @@ U_BOOT_CMD(
 );
 #endif
 
+#if defined(CONFIG_CMD_NETPERF)
+static struct netperf_params netperf_params;
+
+static struct udp_ops netperf_ops = {
+	.prereq = netperf_prereq,
+	.start = netperf_start,
+	.data = &netperf_params,
+};
+
+static int do_netperf(struct cmd_tbl *cmdtp, int flag, int argc,
+		      char *const argv[])
+{
+	struct netperf_params *p = &netperf_params;
+	char *end;
+	int arg;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	memset(p, 0, sizeof(*p));
+	p->port = NETPERF_PORT;
+	if (!strcmp(argv[1], "sink")) {
+		p->mode = NETPERF_SINK;
+		arg = 2;
+	} else if (!strcmp(argv[1], "source") && argc >= 3) {
+		p->mode = NETPERF_SOURCE;
+		p->ip = string_to_ip(argv[2]);
+		if (!p->ip.s_addr)
+			return CMD_RET_USAGE;
+		end = strchr(argv[2], ':');
+		if (end)
+			p->port = simple_strtoul(end + 1, NULL, 10);
+		p->duration = 10000;
+		p->size = NETPERF_MAX_SIZE;
+		arg = 3;
+	} else {
+		return CMD_RET_USAGE;
+	}
+
+	if (argc > arg)
+		p->duration = simple_strtoul(argv[arg], NULL, 10) * 1000;
+	if (argc > arg + 1) {
+		if (p->mode == NETPERF_SINK)
+			p->port = simple_strtoul(argv[arg + 1], NULL, 10);
+		else
+			p->size = simple_strtoul(argv[arg + 1], NULL, 10);
+	}
+	if (p->mode == NETPERF_SOURCE &&
+	    (!p->duration || p->size < sizeof(struct netperf_hdr) ||
+	     p->size > NETPERF_MAX_SIZE))
+		return CMD_RET_USAGE;
+
+	if (udp_loop(&netperf_ops) < 0)
+		return CMD_RET_FAILURE;
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(
+	netperf,	5,	1,	do_netperf,
+	"measure UDP throughput of the network device",
+	"sink [seconds [port]]\n"
+	"    - count the packets a host sends, for some seconds or until\n"
+	"      none come for 3 seconds\n"
+	"netperf source hostIPaddr[:port] [seconds [size]]\n"
+	"    - send packets of size payload bytes to a host, 10 s by default"
+);
+#endif
+
 #if defined(CONFIG_CMD_DNS)
 int do_dns(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 {
@@ -480,3 +650,81 @@ U_BOOT_CMD(
 );
 
 #endif  /* CONFIG_CMD_LINK_LOCAL */
+
+#if defined(CONFIG_CMD_ARP)
+static int do_arp(struct cmd_tbl *cmdtp, int flag, int argc,
+		  char *const argv[])
+{
+	if (argc != 2)
+		return CMD_RET_USAGE;
+
+	if (!strcmp(argv[1], "show"))
+		arp_show();
+	else if (!strcmp(argv[1], "flush"))
+		arp_flush();
+	else
+		return CMD_RET_USAGE;
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(
+	arp,	2,	1,	do_arp,
+	"ARP cache",
+	"show - list the MAC addresses known for IP addresses\n"
+	"arp flush - forget them all"
+);
+#endif	/* CONFIG_CMD_ARP */
+
+#if defined(CONFIG_DM_ETH)
+static int do_net_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	struct eth_stats *stats;
+	struct udevice *dev;
+	struct uclass *uc;
+
+	uclass_id_foreach_dev(UCLASS_ETH, dev, uc) {
+		if (!device_active(dev))
+			continue;
+		stats = eth_get_stats(dev);
+		printf("eth%d: %s\n", dev_seq(dev), dev->name);
+		printf("  rx: %lu packets, %lu bytes, %lu errors, %lu dropped, %lu full polls\n",
+		       stats->rx_packets, stats->rx_bytes, stats->rx_errors,
+		       stats->rx_dropped, stats->rx_full_polls);
+		printf("  tx: %lu packets, %lu bytes, %lu errors\n",
+		       stats->tx_packets, stats->tx_bytes, stats->tx_errors);
+	}
+
+	return CMD_RET_SUCCESS;
+}
+
+static struct cmd_tbl cmd_net_sub[] = {
+	U_BOOT_CMD_MKENT(stats, 1, 1, do_net_stats, "", ""),
+};
+
+static int do_net(struct cmd_tbl *cmdtp, int flag, int argc,
+		  char *const argv[])
+{
+	struct cmd_tbl *cp;
+
+	cp = find_cmd_tbl(argv[1], cmd_net_sub, ARRAY_SIZE(cmd_net_sub));
+
+	/* Strip off leading 'net' command argument */
+	argc--;
+	argv++;
+
+	if (!cp || argc > cp->maxargs)
+		return CMD_RET_USAGE;
+	if (flag == CMD_FLAG_REPEAT && !cmd_is_repeatable(cp))
+		return CMD_RET_SUCCESS;
+
+	return cp->cmd(cmdtp, flag, argc, argv);
+}
+
+U_BOOT_CMD(
+	net,	2,	1,	do_net,
+	"NET sub-system",
+	"stats - show the traffic counters of active Ethernet devices"
+);
+#endif	/* CONFIG_DM_ETH */
@@ -18,6 +18,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <net.h>
+#include <smp_job.h>
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
@@ -33,11 +34,6 @@
 #include <bootm.h>
 #include <image.h>
 
-#ifndef CONFIG_SYS_BOOTM_LEN
-/* use 8MByte as default max gunzip size */
-#define CONFIG_SYS_BOOTM_LEN	0x800000
-#endif
-
 #define MAX_CMDLINE_SIZE	SZ_4K
 
 #define IH_INITRD_ARCH IH_ARCH_DEFAULT
@@ -373,6 +369,118 @@ static int handle_decomp_error(int comp_type, size_t uncomp_size, int ret)
 #endif
 
 #ifndef USE_HOSTCC
+/**
+ * struct bootm_decomp - decompression of the OS image
+ *
+ * @job:	job running the decompression
+ * @images:	images being booted
+ * @load_end:	end of the decompressed image, set by bootm_decomp_os()
+ * @started:	true if the job was started by bootm_start_decomp()
+ */
+static struct bootm_decomp {
+	struct smp_job job;
+	bootm_headers_t *images;
+	ulong load_end;
+	bool started;
+} bootm_decomp;
+
+static int bootm_decomp_os(void *arg)
+{
+	struct bootm_decomp *decomp = arg;
+	image_info_t *os = &decomp->images->os;
+	void *load_buf, *image_buf;
+
+	load_buf = map_sysmem(os->load, 0);
+	image_buf = map_sysmem(os->image_start, os->image_len);
+
+	return image_decomp(os->comp, os->load, os->image_start, os->type,
+			    load_buf, image_buf, os->image_len,
+			    CONFIG_SYS_BOOTM_LEN, &decomp->load_end);
+}
+
+#if IMAGE_ENABLE_FIT
+/* Check if bootm_find_other() may copy images from the FIT to fixed places */
+static bool bootm_fit_loads_images(bootm_headers_t *images)
+{
+	static const char *const props[] = {
+		FIT_RAMDISK_PROP, FIT_FDT_PROP, FIT_LOADABLE_PROP, FIT_FPGA_PROP,
+	};
+	const void *fit = images->fit_hdr_os;
+	int conf, count, node, i, j;
+
+	conf = fit_conf_get_node(fit, images->fit_uname_cfg);
+	if (conf < 0)
+		return true;
+
+	for (i = 0; i < ARRAY_SIZE(props); i++) {
+		count = fdt_stringlist_count(fit, conf, props[i]);
+		for (j = 0; j < count; j++) {
+			node = fit_image_get_node(fit,
+				fdt_stringlist_get(fit, conf, props[i], j,
+						   NULL));
+			if (node < 0 ||
+			    fdt_getprop(fit, node, FIT_LOAD_PROP, NULL))
+				return true;
+		}
+	}
+
+	return false;
+}
+#endif
+
+/**
+ * bootm_start_decomp() - start decompressing the OS on a secondary CPU
+ *
+ * This lets the kernel be inflated while the ramdisk and FDT are located and
+ * verified. It is only done when these come from the OS image itself and
+ * nothing is copied while doing so, and if the decompressed image cannot
+ * overwrite the image blob, which bootm_find_other() reads.
+ *
+ * @images:	images being booted
+ * @argc:	number of arguments, more than one if the ramdisk or FDT are
+ *		given separately
+ */
+static void bootm_start_decomp(bootm_headers_t *images, int argc)
+{
+	image_info_t *os = &images->os;
+
+	if (!CONFIG_IS_ENABLED(SMP_JOB) || os->comp == IH_COMP_NONE ||
+	    argc > 1)
+		return;
+	if (os->load < os->end && os->load + CONFIG_SYS_BOOTM_LEN > os->start)
+		return;
+#if IMAGE_ENABLE_FIT
+	if (images->fit_hdr_os && bootm_fit_loads_images(images))
+		return;
+#endif
+
+	bootm_decomp.images = images;
+	bootm_decomp.started = true;
+	smp_job_start(&bootm_decomp.job, bootm_decomp_os, &bootm_decomp);
+}
+
+/**
+ * bootm_finish_decomp() - decompress the OS, or wait for it to be done
+ *
+ * @images:	images being booted
+ * Return: 0 if OK, or error from image_decomp()
+ */
+static int bootm_finish_decomp(bootm_headers_t *images)
+{
+	int err;
+
+	if (!bootm_decomp.started) {
+		bootm_decomp.images = images;
+		return bootm_decomp_os(&bootm_decomp);
+	}
+
+	err = smp_job_wait(&bootm_decomp.job);
+	bootm_decomp.started = false;
+	smp_job_stop();
+
+	return err;
+}
+
 static int bootm_load_os(bootm_headers_t *images, int boot_progress)
 {
 	image_info_t os = images->os;
@@ -381,17 +489,12 @@ static int bootm_load_os(bootm_headers_t *images, int boot_progress)
 	ulong blob_start = os.start;
 	ulong blob_end = os.end;
 	ulong image_start = os.image_start;
-	ulong image_len = os.image_len;
 	ulong flush_start = ALIGN_DOWN(load, ARCH_DMA_MINALIGN);
 	bool no_overlap;
-	void *load_buf, *image_buf;
 	int err;
 
-	load_buf = map_sysmem(load, 0);
-	image_buf = map_sysmem(os.image_start, image_len);
-	err = image_decomp(os.comp, load, os.image_start, os.type,
-			   load_buf, image_buf, image_len,
-			   CONFIG_SYS_BOOTM_LEN, &load_end);
+	err = bootm_finish_decomp(images);
+	load_end = bootm_decomp.load_end;
 	if (err) {
 		err = handle_decomp_error(os.comp, load_end - load, err);
 		bootstage_error(BOOTSTAGE_ID_DECOMP_IMAGE);
@@ -680,8 +783,13 @@ int do_bootm_states(struct cmd_tbl *cmdtp, int flag, int argc,
 	if (!ret && (states & BOOTM_STATE_FINDOS))
 		ret = bootm_find_os(cmdtp, flag, argc, argv);
 
-	if (!ret && (states & BOOTM_STATE_FINDOTHER))
+	if (!ret && (states & BOOTM_STATE_FINDOTHER)) {
+		if (states & BOOTM_STATE_LOADOS)
+			bootm_start_decomp(images, argc);
 		ret = bootm_find_other(cmdtp, flag, argc, argv);
+		if (ret && bootm_decomp.started)
+			bootm_finish_decomp(images);
+	}
 
 	/* Load the OS */
 	if (!ret && (states & BOOTM_STATE_LOADOS)) {
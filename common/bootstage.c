@@ -19,6 +19,7 @@
 #include <sort.h>
 #include <spl.h>
 #include <asm/global_data.h>
+#include <dm/probe-times.h>
 #include <linux/compiler.h>
 #include <linux/libfdt.h>
 
@@ -321,6 +322,9 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 			return -EINVAL;
 	}
 
+	if (dm_probe_times_add_fdt(blob, bootstage))
+		return -EINVAL;
+
 	return 0;
 }
 
@@ -15,6 +15,7 @@
 #include <mapmem.h>
 #include <os.h>
 #include <serial.h>
+#include <smp_job.h>
 #include <stdio_dev.h>
 #include <exports.h>
 #include <env_internal.h>
@@ -638,7 +639,7 @@ static inline void pre_console_puts(const char *s) {}
 static inline void print_pre_console_buffer(int flushpoint) {}
 #endif
 
-void putc(const char c)
+static void do_putc(const char c)
 {
 	if (!gd)
 		return;
@@ -679,7 +680,7 @@ void putc(const char c)
 	}
 }
 
-void puts(const char *s)
+static void do_puts(const char *s)
 {
 	if (!gd)
 		return;
@@ -723,6 +724,21 @@ void puts(const char *s)
 	}
 }
 
+/* Jobs on secondary CPUs may print, so keep their output in one piece */
+void putc(const char c)
+{
+	smp_job_lock();
+	do_putc(c);
+	smp_job_unlock();
+}
+
+void puts(const char *s)
+{
+	smp_job_lock();
+	do_puts(s);
+	smp_job_unlock();
+}
+
 #ifdef CONFIG_CONSOLE_RECORD
 int console_record_init(void)
 {
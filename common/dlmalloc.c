@@ -7,8 +7,38 @@
 #endif
 
 #include <malloc.h>
+#include <smp_job.h>
 #include <asm/io.h>
 
+#if CONFIG_IS_ENABLED(SMP_JOB)
+/*
+ * Jobs on secondary CPUs may allocate memory, so the entry points at the end
+ * of this file take the job lock around the allocator proper
+ */
+#undef cALLOc
+#undef fREe
+#undef mALLOc
+#undef mEMALIGn
+#undef rEALLOc
+#undef vALLOc
+#undef pvALLOc
+#define cALLOc		calloc_unlocked
+#define fREe		free_unlocked
+#define mALLOc		malloc_unlocked
+#define mEMALIGn	memalign_unlocked
+#define rEALLOc		realloc_unlocked
+#define vALLOc		valloc_unlocked
+#define pvALLOc		pvalloc_unlocked
+
+Void_t *mALLOc(size_t bytes);
+void fREe(Void_t *mem);
+Void_t *rEALLOc(Void_t *oldmem, size_t bytes);
+Void_t *mEMALIGn(size_t alignment, size_t bytes);
+Void_t *vALLOc(size_t bytes);
+Void_t *pvALLOc(size_t bytes);
+Void_t *cALLOc(size_t n, size_t elem_size);
+#endif
+
 #ifdef DEBUG
 #if __STD_C
 static void malloc_update_mallinfo (void);
@@ -2420,6 +2450,81 @@ int mALLOPt(param_number, value) int param_number; int value;
   }
 }
 
+#if CONFIG_IS_ENABLED(SMP_JOB)
+void *malloc(size_t bytes)
+{
+	void *ptr;
+
+	smp_job_lock();
+	ptr = malloc_unlocked(bytes);
+	smp_job_unlock();
+
+	return ptr;
+}
+
+void free(void *mem)
+{
+	smp_job_lock();
+	free_unlocked(mem);
+	smp_job_unlock();
+}
+
+void *realloc(void *oldmem, size_t bytes)
+{
+	void *ptr;
+
+	smp_job_lock();
+	ptr = realloc_unlocked(oldmem, bytes);
+	smp_job_unlock();
+
+	return ptr;
+}
+
+void *memalign(size_t alignment, size_t bytes)
+{
+	void *ptr;
+
+	smp_job_lock();
+	ptr = memalign_unlocked(alignment, bytes);
+	smp_job_unlock();
+
+	return ptr;
+}
+
+void *valloc(size_t bytes)
+{
+	void *ptr;
+
+	smp_job_lock();
+	ptr = valloc_unlocked(bytes);
+	smp_job_unlock();
+
+	return ptr;
+}
+
+void *pvalloc(size_t bytes)
+{
+	void *ptr;
+
+	smp_job_lock();
+	ptr = pvalloc_unlocked(bytes);
+	smp_job_unlock();
+
+	return ptr;
+}
+
+void *calloc(size_t n, size_t elem_size)
+{
+	void *ptr;
+
+	smp_job_lock();
+	ptr = calloc_unlocked(n, elem_size);
+	smp_job_unlock();
+
+	return ptr;
+}
+#endif
+
 int initf_malloc(void)
 {
 #if CONFIG_VAL(SYS_MALLOC_F_LEN)
@@ -0,0 +1,588 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Streaming loader for FIT images held on storage
+ *
+ * Rather than reading the whole FIT into memory, then hashing each image
+ * and finally decompressing it to its load address, the image data is read
+ * a chunk at a time and each chunk is hashed and decompressed while the
+ * next one is being read.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <blk.h>
+#include <decomp_frames.h>
+#include <fit_stream.h>
+#include <gzip.h>
+#include <hash.h>
+#include <image.h>
+#include <log.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <memalign.h>
+#include <watchdog.h>
+#include <asm/global_data.h>
+#include <linux/kernel.h>
+#include <linux/libfdt.h>
+#include <u-boot/zlib.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define FIT_STREAM_MAX_HASHES	4
+#define FIT_STREAM_GZIP_TRAILER	8
+
+typedef int (*fit_stream_fn)(void *priv, const void *buf, ulong size);
+
+struct fit_stream_hash {
+	int noffset;
+	struct hash_algo *algo;
+	void *ctx;
+};
+
+/**
+ * struct fit_stream_state - state of an image being loaded
+ *
+ * @hash:	Hashes being calculated
+ * @hash_count:	Number of entries in @hash
+ * @comp:	Compression used by the image (IH_COMP_...)
+ * @dst:	Where to put the image
+ * @max_len:	Space available at @dst
+ * @size:	Size of the image data
+ * @pos:	Number of bytes of image data processed so far
+ * @stage:	Buffer holding the complete image data, if it cannot be
+ *		decompressed as it is read, else NULL
+ * @zs:		zlib state, for gzip
+ * @zs_active:	true once @zs has been set up
+ * @zs_end:	true once the end of the deflate stream has been seen
+ * @zs_tail:	Number of bytes read after the end of the deflate stream
+ */
+struct fit_stream_state {
+	struct fit_stream_hash hash[FIT_STREAM_MAX_HASHES];
+	int hash_count;
+	u8 comp;
+	void *dst;
+	ulong max_len;
+	ulong size;
+	ulong pos;
+	void *stage;
+	z_stream zs;
+	bool zs_active;
+	bool zs_end;
+	ulong zs_tail;
+};
+
+static ulong fit_stream_chunk(struct fit_stream_src *src)
+{
+	ulong chunk = src->chunk ? src->chunk : CONFIG_FIT_STREAM_CHUNK_SIZE;
+
+	if (src->desc)
+		chunk = max(rounddown(chunk, src->desc->blksz),
+			    src->desc->blksz);
+
+	return chunk;
+}
+
+/* Read from a block device, keeping the next chunk in flight */
+static int fit_stream_read_blk(struct fit_stream_src *src, ulong offset,
+			       ulong size, void *dest, fit_stream_fn fn,
+			       void *priv)
+{
+	struct blk_desc *desc = src->desc;
+	ulong blksz = desc->blksz;
+	lbaint_t chunk = fit_stream_chunk(src) / blksz;
+	lbaint_t first = src->start + offset / blksz;
+	lbaint_t end = src->start + DIV_ROUND_UP(offset + size, blksz);
+	ulong skip = offset % blksz;
+	struct blk_req req[2];
+	char *bounce[2];
+	lbaint_t blk = first;
+	ulong pos = 0;
+	int cur, ret;
+	long nread;
+
+	bounce[0] = malloc_cache_aligned(chunk * blksz);
+	bounce[1] = malloc_cache_aligned(chunk * blksz);
+	if (!bounce[0] || !bounce[1]) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (cur = 0, ret = 0; blk < end || pos < size; cur = !cur) {
+		struct blk_req *next = &req[!cur];
+		bool more = false;
+		void *data;
+		ulong len;
+
+		/* The first request is started here, the rest ahead of use */
+		if (!pos) {
+			req[cur].start = blk;
+			req[cur].blkcnt = min(chunk, end - blk);
+			req[cur].buffer = bounce[cur];
+			if (dest && !skip &&
+			    req[cur].blkcnt * blksz <= size)
+				req[cur].buffer = dest;
+			blk += req[cur].blkcnt;
+			ret = blk_dsubmit(desc, &req[cur]);
+			if (ret)
+				break;
+		}
+		if (blk < end) {
+			ulong npos = (blk - first) * blksz - skip;
+
+			next->start = blk;
+			next->blkcnt = min(chunk, end - blk);
+			next->buffer = bounce[!cur];
+			/* whole blocks can go straight to the destination */
+			if (dest && !skip &&
+			    npos + next->blkcnt * blksz <= size)
+				next->buffer = dest + npos;
+			blk += next->blkcnt;
+			ret = blk_dsubmit(desc, next);
+			if (ret) {
+				blk_dwait(desc, &req[cur]);
+				break;
+			}
+			more = true;
+		}
+
+		nread = blk_dwait(desc, &req[cur]);
+		if (nread != req[cur].blkcnt) {
+			ret = nread < 0 ? nread : -EIO;
+		} else {
+			data = req[cur].buffer + (pos ? 0 : skip);
+			len = min(req[cur].blkcnt * blksz - (pos ? 0 : skip),
+				  size - pos);
+			if (dest && data != dest + pos) {
+				memcpy(dest + pos, data, len);
+				data = dest + pos;
+			}
+			ret = fn(priv, data, len);
+			pos += len;
+		}
+		if (ret) {
+			if (more)
+				blk_dwait(desc, next);
+			break;
+		}
+	}
+
+out:
+	free(bounce[0]);
+	free(bounce[1]);
+
+	return ret;
+}
+
+/**
+ * fit_stream_read() - read part of a FIT, a chunk at a time
+ *
+ * @src:	Storage to read from
+ * @offset:	Byte offset of the data in the FIT
+ * @size:	Number of bytes to read
+ * @dest:	Buffer to read into, or NULL to read into a temporary buffer
+ * @fn:		Function to call with each chunk of data
+ * @priv:	Private data for @fn
+ * @return 0 if OK, -ve on error
+ */
+static int fit_stream_read(struct fit_stream_src *src, ulong offset,
+			   ulong size, void *dest, fit_stream_fn fn, void *priv)
+{
+	ulong chunk = fit_stream_chunk(src);
+	void *buf = NULL;
+	ulong pos, len;
+	int ret = 0;
+
+	if (!size)
+		return 0;
+	if (src->desc)
+		return fit_stream_read_blk(src, offset, size, dest, fn, priv);
+
+	if (!dest) {
+		buf = malloc(chunk);
+		if (!buf)
+			return -ENOMEM;
+	}
+	for (pos = 0; pos < size; pos += len) {
+		len = min(chunk, size - pos);
+		ret = src->read(src, offset + pos, len, dest ? dest + pos : buf);
+		if (ret)
+			break;
+		ret = fn(priv, dest ? dest + pos : buf, len);
+		if (ret)
+			break;
+	}
+	free(buf);
+
+	return ret;
+}
+
+static int fit_stream_copy(void *priv, const void *buf, ulong size)
+{
+	return 0;
+}
+
+int fit_stream_read_header(struct fit_stream_src *src, void **fitp)
+{
+	struct fdt_header hdr;
+	void *fit;
+	int ret;
+
+	ret = fit_stream_read(src, 0, sizeof(hdr), &hdr, fit_stream_copy,
+			      NULL);
+	if (ret)
+		return log_msg_ret("hdr", ret);
+	if (fdt_check_header(&hdr))
+		return log_msg_ret("fdt", -ENOEXEC);
+
+	fit = malloc(fdt_totalsize(&hdr));
+	if (!fit)
+		return log_msg_ret("fit", -ENOMEM);
+	ret = fit_stream_read(src, 0, fdt_totalsize(&hdr), fit,
+			      fit_stream_copy, NULL);
+	if (!ret && fit_check_format(fit, fdt_totalsize(&hdr)))
+		ret = -ENOEXEC;
+	if (ret) {
+		free(fit);
+		return log_msg_ret("read", ret);
+	}
+	*fitp = fit;
+
+	return 0;
+}
+
+static int fit_stream_inflate(struct fit_stream_state *st, const void *buf,
+			      ulong size)
+{
+	int ret;
+
+	if (!st->zs_active) {
+		ret = gzip_parse_header(buf, size);
+		if (ret < 0)
+			return -EILSEQ;
+		buf += ret;
+		size -= ret;
+		st->zs.zalloc = gzalloc;
+		st->zs.zfree = gzfree;
+		if (inflateInit2(&st->zs, -MAX_WBITS) != Z_OK)
+			return -EIO;
+		st->zs.next_out = st->dst;
+		st->zs.avail_out = st->max_len;
+		st->zs_active = true;
+	}
+	/* only the gzip trailer may follow, checked once all is read */
+	if (st->zs_end) {
+		st->zs_tail += size;
+		return 0;
+	}
+
+	st->zs.next_in = (Bytef *)buf;
+	st->zs.avail_in = size;
+	ret = inflate(&st->zs, Z_NO_FLUSH);
+	if (ret == Z_STREAM_END) {
+		st->zs_end = true;
+		st->zs_tail = st->zs.avail_in;
+	} else if (ret != Z_OK && ret != Z_BUF_ERROR)
+		return -EIO;
+	else if (!st->zs.avail_out && st->zs.avail_in)
+		return -ENOSPC;
+
+	return 0;
+}
+
+/* Process a chunk of image data */
+static int fit_stream_update(void *priv, const void *buf, ulong size)
+{
+	struct fit_stream_state *st = priv;
+	struct fit_stream_hash *hash;
+	int ret = 0;
+
+	for (hash = st->hash; hash < st->hash + st->hash_count; hash++) {
+		ret = hash->algo->hash_update(hash->algo, hash->ctx, buf,
+					      size, 0);
+		if (ret) {
+			/* the context has been freed */
+			hash->algo = NULL;
+			return -EIO;
+		}
+	}
+
+	/*
+	 * gzip members which give their size are inflated in parallel by
+	 * image_decomp() once read, rather than one after the other here.
+	 * The header of the first member is enough to tell.
+	 */
+	if (CONFIG_IS_ENABLED(GZIP) && st->comp == IH_COMP_GZIP && !st->pos &&
+	    !st->stage && gzip_frame_size(buf, size)) {
+		st->stage = malloc(st->size);
+		if (!st->stage)
+			return -ENOMEM;
+	}
+
+	if (st->stage)
+		memcpy(st->stage + st->pos, buf, size);
+	else if (st->comp == IH_COMP_GZIP)
+		ret = fit_stream_inflate(st, buf, size);
+	st->pos += size;
+	WATCHDOG_RESET();
+
+	return ret;
+}
+
+static int fit_stream_check_hashes(const void *fit, int noffset,
+				   struct fit_stream_state *st)
+{
+	u8 value[HASH_MAX_DIGEST_SIZE];
+	struct fit_stream_hash *hash;
+	const u8 *fit_value;
+	int fit_value_len;
+	int ret = 0;
+
+	if (st->hash_count)
+		puts("   Verifying Hash Integrity ... ");
+	for (hash = st->hash; hash < st->hash + st->hash_count; hash++) {
+		struct hash_algo *algo = hash->algo;
+
+		hash->algo = NULL;
+		if (algo->hash_finish(algo, hash->ctx, value, sizeof(value)) ||
+		    ret) {
+			ret = -EACCES;
+			continue;
+		}
+		/* FIT stores crc32 values big-endian, as calculate_hash() */
+		if (!strcmp(algo->name, "crc32"))
+			*(u32 *)value = cpu_to_uimage(*(u32 *)value);
+
+		printf("%s", algo->name);
+		fit_value = fdt_getprop(fit, hash->noffset, FIT_VALUE_PROP,
+					&fit_value_len);
+		if (!fit_value || fit_value_len != algo->digest_size ||
+		    memcmp(value, fit_value, fit_value_len)) {
+			printf(" error!\nBad hash value for '%s' hash node in '%s' image node\n",
+			       fit_get_name(fit, hash->noffset, NULL),
+			       fit_get_name(fit, noffset, NULL));
+			ret = -EACCES;
+			continue;
+		}
+		puts("+ ");
+	}
+	if (st->hash_count && !ret)
+		puts("OK\n");
+
+	return ret;
+}
+
+static int fit_stream_setup_hashes(const void *fit, int noffset,
+				   struct fit_stream_state *st)
+{
+	struct fit_stream_hash *hash;
+	int node, ret;
+
+	fdt_for_each_subnode(node, fit, noffset) {
+		const char *name = fit_get_name(fit, node, NULL);
+		char *algo;
+
+		if (strncmp(name, FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)))
+			continue;
+		if (IMAGE_ENABLE_IGNORE &&
+		    fdt_getprop(fit, node, FIT_IGNORE_PROP, NULL))
+			continue;
+		if (fit_image_hash_get_algo(fit, node, &algo))
+			return -EINVAL;
+		if (st->hash_count == FIT_STREAM_MAX_HASHES)
+			return -E2BIG;
+
+		hash = &st->hash[st->hash_count];
+		hash->noffset = node;
+		ret = hash_progressive_lookup_algo(algo, &hash->algo);
+		if (ret) {
+			printf("Unsupported hash algorithm '%s'\n", algo);
+			return ret;
+		}
+		ret = hash->algo->hash_init(hash->algo, &hash->ctx);
+		if (ret)
+			return -ENOMEM;
+		st->hash_count++;
+	}
+
+	return 0;
+}
+
+bool fit_stream_key_required(const char *level)
+{
+	const void *blob = gd_fdt_blob();
+	int sig_node, node;
+
+	sig_node = fdt_subnode_offset(blob, 0, FIT_SIG_NODENAME);
+	if (sig_node < 0)
+		return false;
+
+	fdt_for_each_subnode(node, blob, sig_node) {
+		const char *required;
+
+		required = fdt_getprop(blob, node, FIT_KEY_REQUIRED, NULL);
+		if (required && (!level || !strcmp(required, level)))
+			return true;
+	}
+
+	return false;
+}
+
+static void fit_stream_cleanup(struct fit_stream_state *st)
+{
+	u8 value[HASH_MAX_DIGEST_SIZE];
+	struct fit_stream_hash *hash;
+
+	/* finishing a hash is the only way to free its context */
+	for (hash = st->hash; hash < st->hash + st->hash_count; hash++) {
+		if (hash->algo)
+			hash->algo->hash_finish(hash->algo, hash->ctx, value,
+						sizeof(value));
+	}
+	if (st->zs_active)
+		inflateEnd(&st->zs);
+	free(st->stage);
+}
+
+int fit_stream_load_image(struct fit_stream_src *src, const void *fit,
+			  int noffset, ulong load, ulong max_len,
+			  ulong *lenp)
+{
+	struct fit_stream_state st;
+	const void *data = NULL;
+	bool need_sigs = false;
+	int offset, size, cipher;
+	size_t len;
+	u8 type;
+	int ret;
+
+	memset(&st, '\0', sizeof(st));
+	st.dst = map_sysmem(load, max_len);
+	st.max_len = max_len;
+
+	if (!fit_image_get_data_position(fit, noffset, &offset)) {
+		ret = fit_image_get_data_size(fit, noffset, &size);
+	} else if (!fit_image_get_data_offset(fit, noffset, &offset)) {
+		offset += ALIGN(fdt_totalsize(fit), 4);
+		ret = fit_image_get_data_size(fit, noffset, &size);
+	} else {
+		/* embedded data was read along with the FIT structure */
+		ret = fit_image_get_data(fit, noffset, &data, &len);
+		size = len;
+	}
+	if (ret)
+		return log_msg_ret("data", -ENOENT);
+	st.size = size;
+
+	if (fit_image_get_comp(fit, noffset, &st.comp))
+		st.comp = IH_COMP_NONE;
+	if (st.comp == IH_COMP_NONE && size > max_len)
+		return log_msg_ret("len", -ENOSPC);
+
+	/* encrypted data cannot be used until all of it has been read */
+	cipher = fdt_subnode_offset(fit, noffset, FIT_CIPHER_NODENAME);
+	if (cipher >= 0 &&
+	    !(IS_ENABLED(CONFIG_FIT_CIPHER) && IMAGE_ENABLE_DECRYPT)) {
+		puts("Image is encrypted but decryption is not supported\n");
+		return log_msg_ret("cipher", -EACCES);
+	}
+
+	/* required signatures cover the compressed data, so keep it */
+	if (FIT_IMAGE_ENABLE_VERIFY)
+		need_sigs = fit_stream_key_required("image");
+	if (cipher >= 0 ||
+	    (st.comp != IH_COMP_NONE &&
+	     (need_sigs || st.comp != IH_COMP_GZIP ||
+	      !CONFIG_IS_ENABLED(GZIP)))) {
+		st.stage = malloc(size);
+		if (!st.stage)
+			return log_msg_ret("stage", -ENOMEM);
+	}
+
+	ret = fit_stream_setup_hashes(fit, noffset, &st);
+	if (ret)
+		goto err;
+
+	if (data) {
+		if (st.comp == IH_COMP_NONE && !st.stage) {
+			memmove(st.dst, data, size);
+			data = st.dst;
+		}
+		ret = fit_stream_update(&st, data, size);
+	} else {
+		ret = fit_stream_read(src, offset, size,
+				      st.comp == IH_COMP_NONE && !st.stage ?
+				      st.dst : NULL, fit_stream_update, &st);
+	}
+	if (ret)
+		goto err;
+
+	ret = fit_stream_check_hashes(fit, noffset, &st);
+	if (ret)
+		goto err;
+
+	if (need_sigs) {
+		int verify_all = 1;
+
+		if (fit_image_verify_required_sigs(fit, noffset,
+						   st.stage ? st.stage : st.dst,
+						   size, gd_fdt_blob(),
+						   &verify_all)) {
+			puts("Unable to verify required signature\n");
+			ret = -EACCES;
+			goto err;
+		}
+	}
+
+	/* as fit_image_load(), hashes and signatures cover the ciphertext */
+	if (IS_ENABLED(CONFIG_FIT_CIPHER) && IMAGE_ENABLE_DECRYPT &&
+	    cipher >= 0) {
+		size_t plain_size;
+		void *plain;
+
+		puts("   Decrypting Data ... ");
+		if (fit_image_decrypt_data(fit, noffset, cipher, st.stage, size,
+					   &plain, &plain_size)) {
+			puts("Error\n");
+			ret = -EACCES;
+			goto err;
+		}
+		puts("OK\n");
+		free(st.stage);
+		st.stage = plain;
+		size = plain_size;
+	}
+
+	if (st.stage) {
+		ulong load_end;
+
+		if (fit_image_get_type(fit, noffset, &type))
+			type = IH_TYPE_INVALID;
+		ret = image_decomp(st.comp, load, map_to_sysmem(st.stage),
+				   type, st.dst, st.stage, size, max_len,
+				   &load_end);
+		if (ret) {
+			ret = ret == -ENOSPC ? ret : -EIO;
+			goto err;
+		}
+		*lenp = load_end - load;
+	} else if (st.comp == IH_COMP_GZIP) {
+		/* inflate() stops at the end of the first member */
+		if (!st.zs_end || st.zs_tail != FIT_STREAM_GZIP_TRAILER) {
+			ret = -EIO;
+			goto err;
+		}
+		*lenp = st.zs.total_out;
+	} else {
+		*lenp = size;
+	}
+	fit_stream_cleanup(&st);
+
+	return 0;
+
+err:
+	fit_stream_cleanup(&st);
+
+	return log_msg_ret("load", ret);
+}
@@ -10,6 +10,7 @@
 #include <common.h>
 #include <bootstage.h>
 #include <cpu_func.h>
+#include <decomp_frames.h>
 #include <env.h>
 #include <lmb.h>
 #include <log.h>
@@ -531,6 +532,20 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 		ZSTD_outBuffer out_buf;
 		void *workspace;
 		size_t wsize;
+		ulong len;
+
+		/* Frames which give their size can be decompressed in parallel */
+		ret = zstd_decomp_frames(load_buf, unc_len, image_buf,
+					 image_len, &len);
+		if (ret != -ENOENT) {
+			if (ret)
+				printf("%s: zstd frames error %d\n", __func__,
+				       ret);
+			else
+				image_len = len;
+			break;
+		}
+		ret = 0;
 
 		wsize = ZSTD_DStreamWorkspaceBound(image_len);
 		workspace = malloc(wsize);
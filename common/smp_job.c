@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running jobs on secondary CPUs
+ *
+ * Each secondary CPU has a single job slot, claimed atomically by the CPU
+ * starting a job and cleared by the secondary CPU once the job is done, so no
+ * lock is needed to hand out jobs. A job may itself start jobs, e.g. to
+ * decompress the frames of the image it is decompressing.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <log.h>
+#include <smp_job.h>
+#include <watchdog.h>
+
+/**
+ * struct smp_job_slot - job slot of a secondary CPU
+ *
+ * @job:	job to run, or NULL if idle
+ * @id:		value of arch_smp_job_cpu_id() on this CPU
+ */
+struct smp_job_slot {
+	struct smp_job *job;
+	ulong id;
+};
+
+static struct smp_job_slot smp_job_slots[CONFIG_SMP_JOB_CPUS];
+static int smp_job_count;	/* number of secondary CPUs running */
+static bool smp_job_running;	/* true while secondary CPUs may run code */
+static bool smp_job_stopping;
+static bool smp_job_failed;	/* the CPUs could not be started */
+
+static char smp_job_lock_flag;
+static ulong smp_job_lock_owner;
+static int smp_job_lock_depth;
+
+void smp_job_lock(void)
+{
+	ulong id;
+
+	if (!__atomic_load_n(&smp_job_running, __ATOMIC_ACQUIRE))
+		return;
+
+	id = arch_smp_job_cpu_id();
+	if (__atomic_load_n(&smp_job_lock_owner, __ATOMIC_RELAXED) == id) {
+		smp_job_lock_depth++;
+		return;
+	}
+	while (__atomic_test_and_set(&smp_job_lock_flag, __ATOMIC_ACQUIRE))
+		;
+	__atomic_store_n(&smp_job_lock_owner, id, __ATOMIC_RELAXED);
+	smp_job_lock_depth = 1;
+}
+
+void smp_job_unlock(void)
+{
+	if (!__atomic_load_n(&smp_job_running, __ATOMIC_ACQUIRE))
+		return;
+
+	if (--smp_job_lock_depth)
+		return;
+	__atomic_store_n(&smp_job_lock_owner, 0, __ATOMIC_RELAXED);
+	__atomic_clear(&smp_job_lock_flag, __ATOMIC_RELEASE);
+}
+
+int smp_job_cpu(void)
+{
+	ulong id;
+	int i;
+
+	if (!__atomic_load_n(&smp_job_running, __ATOMIC_ACQUIRE))
+		return 0;
+
+	id = arch_smp_job_cpu_id();
+	for (i = 0; i < CONFIG_SMP_JOB_CPUS; i++) {
+		if (__atomic_load_n(&smp_job_slots[i].id,
+				    __ATOMIC_ACQUIRE) == id)
+			return i + 1;
+	}
+
+	return 0;
+}
+
+/* Main loop of the secondary CPUs */
+static void smp_job_secondary(int cpu)
+{
+	struct smp_job_slot *slot = &smp_job_slots[cpu - 1];
+	struct smp_job *job;
+
+	__atomic_store_n(&slot->id, arch_smp_job_cpu_id(), __ATOMIC_RELEASE);
+
+	while (1) {
+		job = __atomic_load_n(&slot->job, __ATOMIC_ACQUIRE);
+		if (job) {
+			job->cpu = cpu;
+			job->ret = job->func(job->arg);
+			__atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+			__atomic_store_n(&slot->job, NULL, __ATOMIC_RELEASE);
+			arch_smp_job_send_event();
+		} else if (__atomic_load_n(&smp_job_stopping, __ATOMIC_ACQUIRE)) {
+			break;
+		} else {
+			arch_smp_job_wait_event();
+		}
+	}
+}
+
+static int smp_job_start_cpus(void)
+{
+	int ret;
+
+	/* From here on, malloc() and the console must be locked */
+	__atomic_store_n(&smp_job_running, true, __ATOMIC_RELEASE);
+
+	ret = arch_smp_job_start(CONFIG_SMP_JOB_CPUS, smp_job_secondary);
+	if (ret <= 0) {
+		__atomic_store_n(&smp_job_running, false, __ATOMIC_RELEASE);
+		smp_job_failed = true;
+		log_debug("Cannot start secondary CPUs (err=%d)\n", ret);
+		return ret ? ret : -ENODEV;
+	}
+	smp_job_count = ret;
+	log_debug("Started %d secondary CPUs\n", ret);
+
+	return 0;
+}
+
+void smp_job_start(struct smp_job *job, int (*func)(void *arg), void *arg)
+{
+	struct smp_job_slot *slot;
+	int i;
+
+	job->func = func;
+	job->arg = arg;
+	job->ret = 0;
+	job->cpu = 0;
+	job->done = 0;
+
+	/* Jobs only run once the CPUs are started, so this is the boot CPU */
+	if (!smp_job_count && !smp_job_failed)
+		smp_job_start_cpus();
+
+	for (i = 0, slot = smp_job_slots; i < smp_job_count; i++, slot++) {
+		struct smp_job *idle = NULL;
+
+		/* the boot CPU and other jobs may be looking for a slot too */
+		if (__atomic_compare_exchange_n(&slot->job, &idle, job, false,
+						__ATOMIC_ACQ_REL,
+						__ATOMIC_ACQUIRE)) {
+			arch_smp_job_send_event();
+			return;
+		}
+	}
+
+	/* All busy, so do it ourselves */
+	job->ret = func(arg);
+	job->done = 1;
+}
+
+int smp_job_wait(struct smp_job *job)
+{
+	while (!__atomic_load_n(&job->done, __ATOMIC_ACQUIRE)) {
+		/* a job waiting for its own jobs must leave the watchdog */
+		if (!smp_job_cpu())
+			WATCHDOG_RESET();
+		arch_smp_job_wait_event();
+	}
+
+	return job->ret;
+}
+
+void smp_job_stop(void)
+{
+	struct smp_job_slot *slot;
+	int i;
+
+	if (!smp_job_count)
+		return;
+
+	for (i = 0, slot = smp_job_slots; i < smp_job_count; i++, slot++) {
+		while (__atomic_load_n(&slot->job, __ATOMIC_ACQUIRE)) {
+			WATCHDOG_RESET();
+			arch_smp_job_wait_event();
+		}
+	}
+
+	__atomic_store_n(&smp_job_stopping, true, __ATOMIC_RELEASE);
+	arch_smp_job_send_event();
+	arch_smp_job_stop();
+
+	for (i = 0, slot = smp_job_slots; i < smp_job_count; i++, slot++)
+		slot->id = 0;
+	smp_job_count = 0;
+	smp_job_stopping = false;
+	__atomic_store_n(&smp_job_running, false, __ATOMIC_RELEASE);
+	log_debug("Stopped secondary CPUs\n");
+}
@@ -437,7 +437,9 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
+	lbaint_t wstart, wcnt;
 	ulong blks_read;
+	void *wbuf;
 
 	if (!ops->read)
 		return -ENOSYS;
@@ -445,6 +447,19 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	if (blkcache_read(block_dev->if_type, block_dev->devnum,
 			  start, blkcnt, block_dev->blksz, buffer))
 		return blkcnt;
+
+	/* read a whole cache window in one transfer, if worthwhile */
+	wbuf = blkcache_window(block_dev->if_type, block_dev->devnum,
+			       start, blkcnt, block_dev->blksz, block_dev->lba,
+			       &wstart, &wcnt);
+	if (wbuf && ops->read(dev, wstart, wcnt, wbuf) == wcnt) {
+		blkcache_fill(block_dev->if_type, block_dev->devnum,
+			      wstart, wcnt, block_dev->blksz, wbuf);
+		memcpy(buffer, wbuf + (start - wstart) * block_dev->blksz,
+		       blkcnt * block_dev->blksz);
+		return blkcnt;
+	}
+
 	blks_read = ops->read(dev, start, blkcnt, buffer);
 	if (blks_read == blkcnt)
 		blkcache_fill(block_dev->if_type, block_dev->devnum,
@@ -453,6 +468,118 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	return blks_read;
 }
 
+int blk_dsubmit(struct blk_desc *block_dev, struct blk_req *req)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	int ret;
+
+	req->done = false;
+	req->result = 0;
+	if (!ops->read && !ops->submit)
+		return -ENOSYS;
+
+	if (blkcache_read(block_dev->if_type, block_dev->devnum,
+			  req->start, req->blkcnt, block_dev->blksz,
+			  req->buffer)) {
+		req->result = req->blkcnt;
+		req->done = true;
+		return 0;
+	}
+
+	if (ops->submit) {
+		ret = ops->submit(dev, req);
+		if (ret != -ENOSYS)
+			return ret;
+	}
+	if (!ops->read)
+		return -ENOSYS;
+
+	/* no asynchronous support, so read it now */
+	req->result = ops->read(dev, req->start, req->blkcnt, req->buffer);
+	req->done = true;
+
+	return 0;
+}
+
+long blk_dwait(struct blk_desc *block_dev, struct blk_req *req)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	int ret;
+
+	if (!req->done) {
+		ret = ops->wait(dev, req);
+		if (ret)
+			return ret;
+	}
+	if (req->result == req->blkcnt)
+		blkcache_fill(block_dev->if_type, block_dev->devnum,
+			      req->start, req->blkcnt, block_dev->blksz,
+			      req->buffer);
+
+	return req->result;
+}
+
+long blk_dread_stream(struct blk_desc *block_dev, lbaint_t start,
+		      lbaint_t blkcnt, void *buffer, lbaint_t chunk,
+		      blk_stream_fn fn, void *priv)
+{
+	struct blk_req req[2], *cur, *next, *tmp;
+	lbaint_t pos, todo;
+	long ret;
+
+	if (!chunk)
+		return -EINVAL;
+	if (!blkcnt)
+		return 0;
+
+	cur = &req[0];
+	next = &req[1];
+	cur->start = start;
+	cur->blkcnt = min(chunk, blkcnt);
+	cur->buffer = buffer;
+	ret = blk_dsubmit(block_dev, cur);
+	if (ret)
+		return ret;
+
+	for (pos = cur->blkcnt; ; pos += cur->blkcnt) {
+		/* keep the following chunk in flight while this one is used */
+		todo = min(chunk, blkcnt - pos);
+		if (todo) {
+			next->start = start + pos;
+			next->blkcnt = todo;
+			next->buffer = buffer + pos * block_dev->blksz;
+			ret = blk_dsubmit(block_dev, next);
+			if (ret) {
+				blk_dwait(block_dev, cur);
+				return ret;
+			}
+		}
+
+		ret = blk_dwait(block_dev, cur);
+		if (ret == cur->blkcnt && fn) {
+			int err = fn(priv, cur->buffer, cur->blkcnt);
+
+			if (err)
+				ret = err;
+		}
+		if (ret != cur->blkcnt) {
+			if (todo)
+				blk_dwait(block_dev, next);
+			return ret < 0 ? ret : -EIO;
+		}
+		if (!todo)
+			break;
+
+		tmp = cur;
+		cur = next;
+		next = tmp;
+	}
+
+	return blkcnt;
+}
+
 unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			 lbaint_t blkcnt, const void *buffer)
 {
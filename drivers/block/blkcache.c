@@ -6,32 +6,60 @@
  */
 #include <common.h>
 #include <blk.h>
+#include <div64.h>
 #include <log.h>
 #include <malloc.h>
+#include <memalign.h>
 #include <part.h>
 #include <asm/global_data.h>
 #include <linux/ctype.h>
+#include <linux/kernel.h>
 #include <linux/list.h>
 
 #ifdef CONFIG_NEEDS_MANUAL_RELOC
 DECLARE_GLOBAL_DATA_PTR;
 #endif
 
-struct block_cache_node {
+#define BLKCACHE_HASH_BITS	7
+#define BLKCACHE_HASH_SIZE	(1 << BLKCACHE_HASH_BITS)
+
+/*
+ * The cache holds fixed-size lines of max_blocks_per_entry blocks, aligned
+ * to a multiple of the line size on the device. Each line is on its
+ * device's hash chain (for lookup) and LRU list (for eviction).
+ */
+struct block_cache_line {
+	struct hlist_node hn;
+	struct list_head lh;
+	lbaint_t index;
+	char data[];
+};
+
+struct block_cache_dev {
 	struct list_head lh;
 	int iftype;
 	int devnum;
-	lbaint_t start;
-	lbaint_t blkcnt;
 	unsigned long blksz;
-	char *cache;
+	struct hlist_head hash[BLKCACHE_HASH_SIZE];
+	struct list_head lru;
+	unsigned entries;
+	/* read-ahead state */
+	lbaint_t next;
+	lbaint_t ra_blocks;
+	char *ra_buf;
+	lbaint_t ra_size;
+	/* statistics */
+	unsigned hits;
+	unsigned misses;
+	unsigned readaheads;
 };
 
 static LIST_HEAD(block_cache);
 
 static struct block_cache_stats _stats = {
 	.max_blocks_per_entry = 8,
-	.max_entries = 32
+	.max_entries = 32,
+	.max_readahead = CONFIG_BLOCK_CACHE_READAHEAD,
 };
 
 #ifdef CONFIG_NEEDS_MANUAL_RELOC
@@ -46,145 +74,307 @@ int blkcache_init(void)
 }
 #endif
 
-static struct block_cache_node *cache_find(int iftype, int devnum,
-					   lbaint_t start, lbaint_t blkcnt,
-					   unsigned long blksz)
+static lbaint_t line_of(lbaint_t blk)
 {
-	struct block_cache_node *node;
-
-	list_for_each_entry(node, &block_cache, lh)
-		if ((node->iftype == iftype) &&
-		    (node->devnum == devnum) &&
-		    (node->blksz == blksz) &&
-		    (node->start <= start) &&
-		    (node->start + node->blkcnt >= start + blkcnt)) {
-			if (block_cache.next != &node->lh) {
+	return lldiv(blk, _stats.max_blocks_per_entry);
+}
+
+static unsigned int line_hash(lbaint_t index)
+{
+	return ((u32)index * 0x9e370001U) >> (32 - BLKCACHE_HASH_BITS);
+}
+
+static void cache_flush_dev(struct block_cache_dev *bdev)
+{
+	struct block_cache_line *line, *n;
+
+	list_for_each_entry_safe(line, n, &bdev->lru, lh) {
+		list_del(&line->lh);
+		hlist_del(&line->hn);
+		free(line);
+	}
+	bdev->entries = 0;
+	bdev->next = 0;
+	bdev->ra_blocks = 0;
+	free(bdev->ra_buf);
+	bdev->ra_buf = NULL;
+	bdev->ra_size = 0;
+}
+
+static struct block_cache_dev *cache_get_dev(int iftype, int devnum,
+					     unsigned long blksz)
+{
+	struct block_cache_dev *bdev;
+	int i;
+
+	list_for_each_entry(bdev, &block_cache, lh) {
+		if (bdev->iftype == iftype && bdev->devnum == devnum) {
+			if (bdev->blksz != blksz) {
+				cache_flush_dev(bdev);
+				bdev->blksz = blksz;
+			}
+			return bdev;
+		}
+	}
+
+	bdev = calloc(1, sizeof(*bdev));
+	if (!bdev)
+		return NULL;
+	bdev->iftype = iftype;
+	bdev->devnum = devnum;
+	bdev->blksz = blksz;
+	for (i = 0; i < BLKCACHE_HASH_SIZE; i++)
+		INIT_HLIST_HEAD(&bdev->hash[i]);
+	INIT_LIST_HEAD(&bdev->lru);
+	list_add(&bdev->lh, &block_cache);
+
+	return bdev;
+}
+
+static struct block_cache_line *cache_find(struct block_cache_dev *bdev,
+					   lbaint_t index)
+{
+	struct block_cache_line *line;
+	struct hlist_node *pos;
+
+	hlist_for_each_entry(line, pos, &bdev->hash[line_hash(index)], hn) {
+		if (line->index == index) {
+			if (bdev->lru.next != &line->lh) {
 				/* maintain MRU ordering */
-				list_del(&node->lh);
-				list_add(&node->lh, &block_cache);
+				list_del(&line->lh);
+				list_add(&line->lh, &bdev->lru);
 			}
-			return node;
+			return line;
 		}
-	return 0;
+	}
+
+	return NULL;
 }
 
 int blkcache_read(int iftype, int devnum,
 		  lbaint_t start, lbaint_t blkcnt,
 		  unsigned long blksz, void *buffer)
 {
-	struct block_cache_node *node = cache_find(iftype, devnum, start,
-						   blkcnt, blksz);
-	if (node) {
-		const char *src = node->cache + (start - node->start) * blksz;
-		memcpy(buffer, src, blksz * blkcnt);
-		debug("hit: start " LBAF ", count " LBAFU "\n",
-		      start, blkcnt);
-		++_stats.hits;
-		return 1;
+	unsigned per_line = _stats.max_blocks_per_entry;
+	struct block_cache_dev *bdev;
+	struct block_cache_line *line;
+	lbaint_t index, last, blk;
+
+	if (!per_line || !_stats.max_entries || !blkcnt)
+		return 0;
+
+	bdev = cache_get_dev(iftype, devnum, blksz);
+	if (!bdev)
+		return 0;
+
+	index = line_of(start);
+	last = line_of(start + blkcnt - 1);
+	if (last - index >= bdev->entries)
+		goto miss;
+
+	for (blk = start; index <= last; index++) {
+		lbaint_t offset, count;
+
+		line = cache_find(bdev, index);
+		if (!line)
+			goto miss;
+		offset = blk - index * per_line;
+		count = min_t(lbaint_t, per_line - offset,
+			      start + blkcnt - blk);
+		memcpy(buffer, line->data + offset * blksz, count * blksz);
+		buffer += count * blksz;
+		blk += count;
 	}
 
+	debug("hit: start " LBAF ", count " LBAFU "\n",
+	      start, blkcnt);
+	++bdev->hits;
+	return 1;
+
+miss:
 	debug("miss: start " LBAF ", count " LBAFU "\n",
 	      start, blkcnt);
-	++_stats.misses;
+	++bdev->misses;
 	return 0;
 }
 
+void *blkcache_window(int iftype, int devnum,
+		      lbaint_t start, lbaint_t blkcnt,
+		      unsigned long blksz, lbaint_t lba,
+		      lbaint_t *wstartp, lbaint_t *wcntp)
+{
+	unsigned per_line = _stats.max_blocks_per_entry;
+	struct block_cache_dev *bdev;
+	lbaint_t wstart, wend, ra_max;
+
+	if (!per_line || !_stats.max_entries)
+		return NULL;
+
+	/* keep read-ahead from evicting more than half the cache */
+	ra_max = min(_stats.max_readahead, _stats.max_entries * per_line / 2);
+	ra_max = line_of(ra_max) * per_line;
+	if (blkcnt > ra_max)
+		return NULL;
+
+	bdev = cache_get_dev(iftype, devnum, blksz);
+	if (!bdev)
+		return NULL;
+
+	/* grow the window while the device is read sequentially */
+	if (start == bdev->next)
+		bdev->ra_blocks = min(max(bdev->ra_blocks * 2,
+					  (lbaint_t)per_line), ra_max);
+	else
+		bdev->ra_blocks = 0;
+
+	wstart = line_of(start) * per_line;
+	wend = line_of(start + blkcnt + bdev->ra_blocks + per_line - 1) *
+		per_line;
+	wend = min(wend, wstart + ra_max);
+	wend = min(wend, line_of(lba) * per_line);
+	bdev->next = max(wend, start + blkcnt);
+	if (wend < start + blkcnt ||
+	    (wstart == start && wend == start + blkcnt))
+		return NULL;
+
+	if (bdev->ra_size < wend - wstart) {
+		free(bdev->ra_buf);
+		bdev->ra_size = 0;
+		bdev->ra_buf = malloc_cache_aligned(ra_max * blksz);
+		if (!bdev->ra_buf)
+			return NULL;
+		bdev->ra_size = ra_max;
+	}
+
+	debug("window: start " LBAF ", count " LBAFU " for " LBAF
+	      ", count " LBAFU "\n", wstart, wend - wstart, start, blkcnt);
+	++bdev->readaheads;
+	*wstartp = wstart;
+	*wcntp = wend - wstart;
+
+	return bdev->ra_buf;
+}
+
 void blkcache_fill(int iftype, int devnum,
 		   lbaint_t start, lbaint_t blkcnt,
 		   unsigned long blksz, void const *buffer)
 {
-	lbaint_t bytes;
-	struct block_cache_node *node;
+	unsigned per_line = _stats.max_blocks_per_entry;
+	struct block_cache_dev *bdev;
+	struct block_cache_line *line;
+	lbaint_t index, end;
 
 	/* don't cache big stuff */
-	if (blkcnt > _stats.max_blocks_per_entry)
+	if (blkcnt > max(_stats.max_readahead, per_line))
 		return;
 
-	if (_stats.max_entries == 0)
+	if (!per_line || _stats.max_entries == 0)
 		return;
 
-	bytes = blksz * blkcnt;
-	if (_stats.max_entries <= _stats.entries) {
-		/* pop LRU */
-		node = (struct block_cache_node *)block_cache.prev;
-		list_del(&node->lh);
-		_stats.entries--;
-		debug("drop: start " LBAF ", count " LBAFU "\n",
-		      node->start, node->blkcnt);
-		if (node->blkcnt * node->blksz < bytes) {
-			free(node->cache);
-			node->cache = 0;
-		}
-	} else {
-		node = malloc(sizeof(*node));
-		if (!node)
-			return;
-		node->cache = 0;
-	}
+	bdev = cache_get_dev(iftype, devnum, blksz);
+	if (!bdev)
+		return;
 
-	if (!node->cache) {
-		node->cache = malloc(bytes);
-		if (!node->cache) {
-			free(node);
-			return;
-		}
-	}
+	/* only whole lines can be cached */
+	index = line_of(start + per_line - 1);
+	end = line_of(start + blkcnt);
+	for (; index < end; index++) {
+		if (cache_find(bdev, index))
+			continue;
 
-	debug("fill: start " LBAF ", count " LBAFU "\n",
-	      start, blkcnt);
+		if (bdev->entries >= _stats.max_entries) {
+			/* pop LRU */
+			line = list_last_entry(&bdev->lru,
+					       struct block_cache_line, lh);
+			list_del(&line->lh);
+			hlist_del(&line->hn);
+			bdev->entries--;
+			debug("drop: line " LBAF "\n", line->index);
+		} else {
+			line = malloc(sizeof(*line) + per_line * blksz);
+			if (!line)
+				return;
+		}
 
-	node->iftype = iftype;
-	node->devnum = devnum;
-	node->start = start;
-	node->blkcnt = blkcnt;
-	node->blksz = blksz;
-	memcpy(node->cache, buffer, bytes);
-	list_add(&node->lh, &block_cache);
-	_stats.entries++;
+		debug("fill: line " LBAF "\n", index);
+		line->index = index;
+		memcpy(line->data, buffer + (index * per_line - start) * blksz,
+		       per_line * blksz);
+		hlist_add_head(&line->hn, &bdev->hash[line_hash(index)]);
+		list_add(&line->lh, &bdev->lru);
+		bdev->entries++;
+	}
 }
 
 void blkcache_invalidate(int iftype, int devnum)
 {
-	struct list_head *entry, *n;
-	struct block_cache_node *node;
-
-	list_for_each_safe(entry, n, &block_cache) {
-		node = (struct block_cache_node *)entry;
-		if ((node->iftype == iftype) &&
-		    (node->devnum == devnum)) {
-			list_del(entry);
-			free(node->cache);
-			free(node);
-			--_stats.entries;
+	struct block_cache_dev *bdev;
+
+	list_for_each_entry(bdev, &block_cache, lh) {
+		if ((bdev->iftype == iftype) &&
+		    (bdev->devnum == devnum)) {
+			cache_flush_dev(bdev);
+			break;
 		}
 	}
 }
 
-void blkcache_configure(unsigned blocks, unsigned entries)
+void blkcache_configure(unsigned blocks, unsigned entries,
+			unsigned readahead)
 {
-	struct block_cache_node *node;
+	struct block_cache_dev *bdev;
+
 	if ((blocks != _stats.max_blocks_per_entry) ||
 	    (entries != _stats.max_entries)) {
 		/* invalidate cache */
-		while (!list_empty(&block_cache)) {
-			node = (struct block_cache_node *)block_cache.next;
-			list_del(&node->lh);
-			free(node->cache);
-			free(node);
-		}
-		_stats.entries = 0;
+		list_for_each_entry(bdev, &block_cache, lh)
+			cache_flush_dev(bdev);
 	}
 
 	_stats.max_blocks_per_entry = blocks;
 	_stats.max_entries = entries;
+	_stats.max_readahead = readahead;
 
-	_stats.hits = 0;
-	_stats.misses = 0;
+	list_for_each_entry(bdev, &block_cache, lh) {
+		bdev->hits = 0;
+		bdev->misses = 0;
+		bdev->readaheads = 0;
+	}
+}
+
+int blkcache_dev_stats(int index, struct block_cache_dev_stats *stats)
+{
+	struct block_cache_dev *bdev;
+
+	list_for_each_entry(bdev, &block_cache, lh) {
+		if (index--)
+			continue;
+		stats->iftype = bdev->iftype;
+		stats->devnum = bdev->devnum;
+		stats->hits = bdev->hits;
+		stats->misses = bdev->misses;
+		stats->readaheads = bdev->readaheads;
+		stats->entries = bdev->entries;
+		return 0;
+	}
+
+	return -ENOENT;
 }
 
 void blkcache_stats(struct block_cache_stats *stats)
 {
-	memcpy(stats, &_stats, sizeof(*stats));
+	struct block_cache_dev *bdev;
+
 	_stats.hits = 0;
 	_stats.misses = 0;
+	_stats.entries = 0;
+	list_for_each_entry(bdev, &block_cache, lh) {
+		_stats.hits += bdev->hits;
+		_stats.misses += bdev->misses;
+		_stats.entries += bdev->entries;
+		bdev->hits = 0;
+		bdev->misses = 0;
+		bdev->readaheads = 0;
+	}
+	memcpy(stats, &_stats, sizeof(*stats));
 }
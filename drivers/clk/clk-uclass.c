@@ -16,6 +16,7 @@
 #include <malloc.h>
 #include <dm/device-internal.h>
 #include <dm/devres.h>
+#include <dm/probe-times.h>
 #include <dm/read.h>
 #include <linux/bug.h>
 #include <linux/clk-provider.h>
@@ -345,6 +346,7 @@ fail:
 
 int clk_set_defaults(struct udevice *dev, int stage)
 {
+	ulong start;
 	int ret;
 
 	if (!dev_has_ofnode(dev))
@@ -356,11 +358,11 @@ int clk_set_defaults(struct udevice *dev, int stage)
 
 	debug("%s(%s)\n", __func__, dev_read_name(dev));
 
+	start = dm_time_start(DM_TIME_CLK);
 	ret = clk_set_default_parents(dev, stage);
-	if (ret)
-		return ret;
-
-	ret = clk_set_default_rates(dev, stage);
+	if (!ret)
+		ret = clk_set_default_rates(dev, stage);
+	dm_time_end(DM_TIME_CLK, start);
 	if (ret < 0)
 		return ret;
 
@@ -548,6 +550,7 @@ ulong clk_round_rate(struct clk *clk, ulong rate)
 ulong clk_set_rate(struct clk *clk, ulong rate)
 {
 	const struct clk_ops *ops;
+	ulong start;
 
 	debug("%s(clk=%p, rate=%lu)\n", __func__, clk, rate);
 	if (!clk_valid(clk))
@@ -557,7 +560,11 @@ ulong clk_set_rate(struct clk *clk, ulong rate)
 	if (!ops->set_rate)
 		return -ENOSYS;
 
-	return ops->set_rate(clk, rate);
+	start = dm_time_start(DM_TIME_CLK);
+	rate = ops->set_rate(clk, rate);
+	dm_time_end(DM_TIME_CLK, start);
+
+	return rate;
 }
 
 int clk_set_parent(struct clk *clk, struct clk *parent)
@@ -587,6 +594,7 @@ int clk_enable(struct clk *clk)
 {
 	const struct clk_ops *ops;
 	struct clk *clkp = NULL;
+	ulong start;
 	int ret;
 
 	debug("%s(clk=%p)\n", __func__, clk);
@@ -613,7 +621,9 @@ int clk_enable(struct clk *clk)
 		}
 
 		if (ops->enable) {
+			start = dm_time_start(DM_TIME_CLK);
 			ret = ops->enable(clk);
+			dm_time_end(DM_TIME_CLK, start);
 			if (ret) {
 				printf("Enable %s failed\n", clk->dev->name);
 				return ret;
@@ -624,7 +634,11 @@ int clk_enable(struct clk *clk)
 	} else {
 		if (!ops->enable)
 			return -ENOSYS;
-		return ops->enable(clk);
+		start = dm_time_start(DM_TIME_CLK);
+		ret = ops->enable(clk);
+		dm_time_end(DM_TIME_CLK, start);
+		if (ret)
+			return ret;
 	}
 
 	return 0;
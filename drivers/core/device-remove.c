@@ -16,6 +16,7 @@
 #include <malloc.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
+#include <dm/lazy.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
@@ -94,6 +95,7 @@ int device_unbind(struct udevice *dev)
 	ret = device_chld_unbind(dev, NULL);
 	if (ret)
 		return log_msg_ret("child unbind", ret);
+	dm_lazy_forget(dev);
 
 	if (dev_get_flags(dev) & DM_FLAG_ALLOC_PDATA) {
 		free(dev_get_plat(dev));
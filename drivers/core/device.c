@@ -20,10 +20,12 @@
 #include <asm/cache.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
+#include <dm/lazy.h>
 #include <dm/lists.h>
 #include <dm/of_access.h>
 #include <dm/pinctrl.h>
 #include <dm/platdata.h>
+#include <dm/probe-times.h>
 #include <dm/read.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
@@ -34,10 +36,9 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-static int device_bind_common(struct udevice *parent, const struct driver *drv,
-			      const char *name, void *plat,
-			      ulong driver_data, ofnode node,
-			      uint of_plat_size, struct udevice **devp)
+static int device_do_bind(struct udevice *parent, const struct driver *drv,
+			  const char *name, void *plat, ulong driver_data,
+			  ofnode node, uint of_plat_size, struct udevice **devp)
 {
 	struct udevice *dev;
 	struct uclass *uc;
@@ -232,6 +233,25 @@ fail_alloc1:
 	return ret;
 }
 
+static int device_bind_common(struct udevice *parent, const struct driver *drv,
+			      const char *name, void *plat,
+			      ulong driver_data, ofnode node,
+			      uint of_plat_size, struct udevice **devp)
+{
+	struct dm_time_frame frame;
+	struct udevice *dev = NULL;
+	int ret;
+
+	dm_time_enter(&frame, NULL);
+	ret = device_do_bind(parent, drv, name, plat, driver_data, node,
+			     of_plat_size, &dev);
+	dm_time_leave(&frame, ret ? NULL : dev, DM_TIME_BIND);
+	if (devp)
+		*devp = dev;
+
+	return ret;
+}
+
 int device_bind_with_driver_data(struct udevice *parent,
 				 const struct driver *drv, const char *name,
 				 ulong driver_data, ofnode node,
@@ -479,7 +499,7 @@ static int device_get_dma_constraints(struct udevice *dev)
 	return 0;
 }
 
-int device_probe(struct udevice *dev)
+static int device_do_probe(struct udevice *dev)
 {
 	const struct driver *drv;
 	int ret;
@@ -513,6 +533,9 @@ int device_probe(struct udevice *dev)
 			return 0;
 	}
 
+	/* A bus expects to find its children already bound */
+	dm_lazy_bind_children(dev);
+
 	dev_or_flags(dev, DM_FLAG_ACTIVATED);
 
 	/*
@@ -593,6 +616,22 @@ fail:
 	return ret;
 }
 
+int device_probe(struct udevice *dev)
+{
+	struct dm_time_frame frame;
+	int ret;
+
+	if (!CONFIG_IS_ENABLED(DM_PROBE_TIMES) || !dev ||
+	    (dev_get_flags(dev) & DM_FLAG_ACTIVATED))
+		return device_do_probe(dev);
+
+	dm_time_enter(&frame, dev);
+	ret = device_do_probe(dev);
+	dm_time_leave(&frame, dev, DM_TIME_PROBE);
+
+	return ret;
+}
+
 void *dev_get_plat(const struct udevice *dev)
 {
 	if (!dev) {
@@ -797,6 +836,7 @@ static struct udevice *_device_find_global_by_ofnode(struct udevice *parent,
 
 int device_find_global_by_ofnode(ofnode ofnode, struct udevice **devp)
 {
+	dm_lazy_bind_node(ofnode);
 	*devp = _device_find_global_by_ofnode(gd->dm_root, ofnode);
 
 	return *devp ? 0 : -ENOENT;
@@ -806,6 +846,7 @@ int device_get_global_by_ofnode(ofnode ofnode, struct udevice **devp)
 {
 	struct udevice *dev;
 
+	dm_lazy_bind_node(ofnode);
 	dev = _device_find_global_by_ofnode(gd->dm_root, ofnode);
 	return device_get_device_tail(dev, dev ? 0 : -ENOENT, devp);
 }
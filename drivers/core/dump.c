@@ -6,6 +6,7 @@
 #include <common.h>
 #include <dm.h>
 #include <mapmem.h>
+#include <dm/lazy.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/uclass-internal.h>
@@ -49,6 +50,8 @@ void dm_dump_all(void)
 {
 	struct udevice *root;
 
+	/* Show every device, not just those bound so far */
+	dm_lazy_bind_all();
 	root = dm_root();
 	if (root) {
 		printf(" Class     Index  Probed  Driver                Name\n");
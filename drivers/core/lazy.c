@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Binding devicetree nodes when their uclass is first used
+ *
+ * A large SoC devicetree has many nodes whose devices are never used in a
+ * given boot. Rather than binding them all when the devicetree is scanned
+ * after relocation, the nodes are recorded with the uclass of the driver
+ * that would be bound, and bound together when that uclass is first looked
+ * at.
+ */
+
+#define LOG_CATEGORY LOGC_DM
+
+#include <common.h>
+#include <dm.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <dm/lazy.h>
+#include <dm/lists.h>
+#include <dm/util.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Entries added to the list at a time */
+#define DM_LAZY_GROW	32
+
+/**
+ * struct dm_lazy_node - a devicetree node not bound yet
+ *
+ * @node: the node
+ * @parent: device to bind it under
+ * @uclass_id: uclass of the driver it matches
+ * @has_subnodes: the node has subnodes, which may be bound under it
+ */
+struct dm_lazy_node {
+	ofnode node;
+	struct udevice *parent;
+	u16 uclass_id;
+	bool has_subnodes;
+};
+
+/**
+ * struct dm_lazy - nodes waiting to be bound
+ *
+ * @busy: non-zero while nodes are bound, so that uclass_get() calls made
+ *	while binding do not start binding other nodes
+ * @count: number of entries in @node
+ * @size: number of entries allocated
+ * @node: the nodes, in devicetree order
+ */
+struct dm_lazy {
+	int busy;
+	int count;
+	int size;
+	struct dm_lazy_node *node;
+};
+
+static struct dm_lazy *dm_lazy_get(void)
+{
+	struct dm_lazy *lazy = gd_dm_lazy();
+
+	if (!lazy) {
+		lazy = calloc(1, sizeof(*lazy));
+		gd_set_dm_lazy(lazy);
+	}
+
+	return lazy;
+}
+
+/* Take entry @i off the list and bind it */
+static int dm_lazy_bind(struct dm_lazy *lazy, int i)
+{
+	struct dm_lazy_node ln = lazy->node[i];
+	int ret;
+
+	lazy->count--;
+	memmove(&lazy->node[i], &lazy->node[i + 1],
+		(lazy->count - i) * sizeof(ln));
+
+	lazy->busy++;
+	ret = lists_bind_fdt(ln.parent, ln.node, NULL, false);
+	lazy->busy--;
+	if (ret)
+		dm_warn("Cannot bind node '%s': %d\n", ofnode_get_name(ln.node),
+			ret);
+
+	return ret;
+}
+
+int dm_lazy_add(struct udevice *parent, ofnode node)
+{
+	struct dm_lazy *lazy = dm_lazy_get();
+	const char *compat_list, *compat;
+	const struct udevice_id *id;
+	struct dm_lazy_node *ln;
+	struct driver *drv = NULL;
+	int compat_length, i;
+	int ret;
+
+	if (!lazy)
+		return -ENOMEM;
+
+	compat_list = ofnode_get_property(node, "compatible", &compat_length);
+	for (i = 0; compat_list && i < compat_length;
+	     i += strlen(compat) + 1) {
+		compat = compat_list + i;
+		drv = lists_driver_lookup_compat(compat, &id);
+		if (drv)
+			break;
+	}
+
+	/*
+	 * Leave lists_bind_fdt() to deal with errors and unknown nodes. A bus
+	 * which scans its subnodes in its probe() method has already had
+	 * dm_lazy_bind_children() called, so bind those at once too.
+	 */
+	if (!drv || ofnode_pre_reloc(node) || (drv->flags & DM_FLAG_PRE_RELOC) ||
+	    (parent != gd->dm_root &&
+	     (dev_get_flags(parent) & DM_FLAG_ACTIVATED))) {
+		lazy->busy++;
+		ret = lists_bind_fdt(parent, node, NULL, false);
+		lazy->busy--;
+
+		return ret;
+	}
+
+	if (lazy->count == lazy->size) {
+		ln = realloc(lazy->node,
+			     (lazy->size + DM_LAZY_GROW) * sizeof(*ln));
+		if (!ln)
+			return log_msg_ret("lazy", -ENOMEM);
+		lazy->node = ln;
+		lazy->size += DM_LAZY_GROW;
+	}
+
+	ln = &lazy->node[lazy->count++];
+	ln->node = node;
+	ln->parent = parent;
+	ln->uclass_id = drv->id;
+	ln->has_subnodes = ofnode_valid(ofnode_first_subnode(node));
+	log_debug("Deferring node '%s' (%s)\n", ofnode_get_name(node),
+		  drv->name);
+
+	return 0;
+}
+
+void dm_lazy_bind_uclass(enum uclass_id id)
+{
+	struct dm_lazy *lazy = gd_dm_lazy();
+	int i;
+
+	if (!lazy || lazy->busy)
+		return;
+
+	/* Subnodes are added at the end, so they are seen in the same pass */
+	for (i = 0; i < lazy->count;) {
+		if (lazy->node[i].uclass_id == id || lazy->node[i].has_subnodes)
+			dm_lazy_bind(lazy, i);
+		else
+			i++;
+	}
+}
+
+/* Check whether @node is @anc or one of its subnodes */
+static bool dm_lazy_is_within(ofnode node, ofnode anc)
+{
+	for (; ofnode_valid(node); node = ofnode_get_parent(node)) {
+		if (ofnode_equal(node, anc))
+			return true;
+	}
+
+	return false;
+}
+
+void dm_lazy_bind_node(ofnode node)
+{
+	struct dm_lazy *lazy = gd_dm_lazy();
+	int i;
+
+	if (!lazy || lazy->busy || !ofnode_valid(node))
+		return;
+
+	/* Subnodes of an ancestor are added at the end, as above */
+	for (i = 0; i < lazy->count;) {
+		if (dm_lazy_is_within(node, lazy->node[i].node))
+			dm_lazy_bind(lazy, i);
+		else
+			i++;
+	}
+}
+
+void dm_lazy_bind_children(struct udevice *dev)
+{
+	struct dm_lazy *lazy = gd_dm_lazy();
+	int i;
+
+	if (!lazy || lazy->busy)
+		return;
+
+	for (i = 0; i < lazy->count;) {
+		if (lazy->node[i].parent == dev)
+			dm_lazy_bind(lazy, i);
+		else
+			i++;
+	}
+}
+
+void dm_lazy_bind_all(void)
+{
+	struct dm_lazy *lazy = gd_dm_lazy();
+
+	if (!lazy || lazy->busy)
+		return;
+
+	while (lazy->count)
+		dm_lazy_bind(lazy, 0);
+}
+
+void dm_lazy_forget(struct udevice *dev)
+{
+	struct dm_lazy *lazy = gd_dm_lazy();
+	int i, j;
+
+	if (!lazy)
+		return;
+
+	for (i = 0, j = 0; i < lazy->count; i++) {
+		if (lazy->node[i].parent != dev)
+			lazy->node[j++] = lazy->node[i];
+	}
+	lazy->count = j;
+}
+
+void dm_lazy_reset(void)
+{
+	struct dm_lazy *lazy = gd_dm_lazy();
+
+	if (!lazy)
+		return;
+
+	free(lazy->node);
+	free(lazy);
+	gd_set_dm_lazy(NULL);
+}
@@ -11,6 +11,9 @@
 #include <common.h>
 #include <errno.h>
 #include <log.h>
+#include <malloc.h>
+#include <sort.h>
+#include <asm/global_data.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -20,6 +23,8 @@
 #include <fdtdec.h>
 #include <linux/compiler.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 struct driver *lists_driver_lookup_name(const char *name)
 {
 	struct driver *drv =
@@ -181,11 +186,150 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
-		   bool pre_reloc_only)
+#if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+/**
+ * struct dm_compat_index - Compatible strings of all drivers, sorted
+ *
+ * Entries hold indexes rather than pointers so that they are small and do
+ * not need relocating. The index is only built once the full malloc() area
+ * is set up, after relocation; before that, drivers are found by a linear
+ * search.
+ *
+ * @drivers: start of the driver list
+ * @count: number of entries in @entry
+ * @entry: one for each compatible string of each driver, sorted by string
+ *	and then by position in the driver list. @drv is the index of the
+ *	driver, @id that of the string in its of_match table.
+ */
+struct dm_compat_index {
+	struct driver *drivers;
+	int count;
+	struct dm_compat_entry {
+		u16 drv;
+		u16 id;
+	} entry[];
+};
+
+static const struct udevice_id *entry_id(const struct dm_compat_entry *e)
+{
+	struct driver *drv = gd_dm_compat_index()->drivers + e->drv;
+
+	return drv->of_match + e->id;
+}
+
+static int compat_entry_cmp(const void *a, const void *b)
+{
+	const struct dm_compat_entry *ea = a, *eb = b;
+	int ret;
+
+	ret = strcmp(entry_id(ea)->compatible, entry_id(eb)->compatible);
+	if (ret)
+		return ret;
+	if (ea->drv != eb->drv)
+		return ea->drv - eb->drv;
+
+	return ea->id - eb->id;
+}
+
+int lists_init_compat_index(void)
+{
+	struct driver *drv = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct dm_compat_index *index;
+	const struct udevice_id *id;
+	struct dm_compat_entry *e;
+	struct driver *entry;
+	int count = 0;
+
+	/* The malloc() area before relocation is too small to spend on this */
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return 0;
+
+	/* The driver list never changes */
+	if (gd_dm_compat_index())
+		return 0;
+
+	/* Entries only have room for 16-bit indexes */
+	if (n_ents > U16_MAX)
+		return log_msg_ret("drivers", -E2BIG);
+	for (entry = drv; entry != drv + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++)
+			count++;
+		if (id && id - entry->of_match > U16_MAX)
+			return log_msg_ret("ids", -E2BIG);
+	}
+
+	index = malloc(sizeof(*index) + count * sizeof(*e));
+	if (!index)
+		return log_msg_ret("index", -ENOMEM);
+	index->drivers = drv;
+	index->count = count;
+
+	e = index->entry;
+	for (entry = drv; entry != drv + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++) {
+			e->drv = entry - drv;
+			e->id = id - entry->of_match;
+			e++;
+		}
+	}
+	/* entry_id() finds the drivers through gd */
+	gd_set_dm_compat_index(index);
+	qsort(index->entry, count, sizeof(*e), compat_entry_cmp);
+
+	return 0;
+}
+
+/* Binary search for the first entry for @compat */
+static struct driver *lookup_compat_index(struct dm_compat_index *index,
+					  const char *compat,
+					  const struct udevice_id **idp)
+{
+	const struct udevice_id *id;
+	int lo = 0, hi = index->count;
+	int mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		id = entry_id(&index->entry[mid]);
+		if (strcmp(id->compatible, compat) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == index->count)
+		return NULL;
+	id = entry_id(&index->entry[lo]);
+	if (strcmp(id->compatible, compat))
+		return NULL;
+	*idp = id;
+
+	return index->drivers + index->entry[lo].drv;
+}
+#endif
+
+struct driver *lists_driver_lookup_compat(const char *compat,
+					  const struct udevice_id **idp)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+
+#if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+	if (gd_dm_compat_index())
+		return lookup_compat_index(gd_dm_compat_index(), compat, idp);
+#endif
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, idp, compat))
+			return entry;
+	}
+
+	return NULL;
+}
+
+int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
+		   bool pre_reloc_only)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
@@ -222,13 +366,8 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		log_debug("   - attempt to match compatible string '%s'\n",
 			  compat);
 
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
-		}
-		if (entry == driver + n_ents)
+		entry = lists_driver_lookup_compat(compat, &id);
+		if (!entry)
 			continue;
 
 		if (pre_reloc_only) {
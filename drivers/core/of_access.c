@@ -22,6 +22,7 @@
 #include <common.h>
 #include <log.h>
 #include <malloc.h>
+#include <of_live.h>
 #include <asm/global_data.h>
 #include <linux/bug.h>
 #include <linux/libfdt.h>
@@ -126,13 +127,23 @@ int of_simple_size_cells(const struct device_node *np)
 struct property *of_find_property(const struct device_node *np,
 				  const char *name, int *lenp)
 {
+	const struct of_live_names *names = gd_of_live_names();
+	const char *key = NULL;
 	struct property *pp;
 
 	if (!np)
 		return NULL;
 
+	/*
+	 * Names from the devicetree are shared, so only names added since the
+	 * live tree was built need a string compare
+	 */
+	if (names)
+		key = of_live_find_name(names, name);
 	for (pp = np->properties; pp; pp = pp->next) {
-		if (strcmp(pp->name, name) == 0) {
+		if (pp->name == key ||
+		    (!of_live_name_shared(names, pp->name) &&
+		     strcmp(pp->name, name) == 0)) {
 			if (lenp)
 				*lenp = pp->length;
 			break;
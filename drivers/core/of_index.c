@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Index of phandles and paths in the flat devicetree
+ *
+ * Without a live tree, finding a node by phandle or by path means walking the
+ * devicetree blob from the start, and drivers do this many times as they are
+ * probed. After relocation, a table of all phandles in the control devicetree,
+ * sorted for a binary search, is built the first time one is looked up, and
+ * the results of the most recent path lookups are kept.
+ *
+ * Adding or removing nodes or properties changes the size of the structure
+ * block of the devicetree, which makes the index be built again. Each node
+ * found through the index is also checked against the phandle or name it was
+ * looked up by, following aliases. Changes which keep the size, such as
+ * renaming a node or setting an alias to another path of the same length, can
+ * still leave the index stale, and paths which were not found are not checked
+ * at all, so code making such changes must call of_index_invalidate().
+ */
+
+#define LOG_CATEGORY LOGC_DT
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <sort.h>
+#include <asm/global_data.h>
+#include <dm/of_index.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Number of paths to remember */
+#define OF_INDEX_PATHS	16
+
+/**
+ * struct of_index_phandle - a node with a phandle
+ *
+ * @phandle: phandle of the node
+ * @offset: offset of the node
+ */
+struct of_index_phandle {
+	u32 phandle;
+	int offset;
+};
+
+/**
+ * struct of_index_path - result of a path lookup
+ *
+ * @path: path looked up, allocated, or NULL if the entry is unused
+ * @offset: offset of the node, or -ve FDT_ERR_... if there is none
+ */
+struct of_index_path {
+	char *path;
+	int offset;
+};
+
+/**
+ * struct of_index - index of the control devicetree
+ *
+ * @blob: devicetree indexed
+ * @size: size of the structure block of @blob when the index was built
+ * @next_path: entry of @path to replace next
+ * @path: paths looked up most recently
+ * @count: number of entries in @phandle
+ * @phandle: all nodes with a phandle, sorted by phandle
+ */
+struct of_index {
+	const void *blob;
+	int size;
+	int next_path;
+	struct of_index_path path[OF_INDEX_PATHS];
+	int count;
+	struct of_index_phandle phandle[];
+};
+
+static int of_index_phandle_cmp(const void *a, const void *b)
+{
+	const struct of_index_phandle *pa = a, *pb = b;
+
+	if (pa->phandle != pb->phandle)
+		return pa->phandle < pb->phandle ? -1 : 1;
+
+	return 0;
+}
+
+static struct of_index *of_index_build(const void *blob)
+{
+	struct of_index_phandle *e;
+	struct of_index *index;
+	int node, count = 0;
+	u32 phandle;
+
+	for (node = fdt_next_node(blob, -1, NULL); node >= 0;
+	     node = fdt_next_node(blob, node, NULL)) {
+		if (fdt_get_phandle(blob, node))
+			count++;
+	}
+
+	index = calloc(1, sizeof(*index) + count * sizeof(*e));
+	if (!index)
+		return NULL;
+	index->blob = blob;
+	index->size = fdt_size_dt_struct(blob);
+
+	e = index->phandle;
+	for (node = fdt_next_node(blob, -1, NULL); node >= 0 && count;
+	     node = fdt_next_node(blob, node, NULL)) {
+		phandle = fdt_get_phandle(blob, node);
+		if (phandle) {
+			e->phandle = phandle;
+			e->offset = node;
+			e++;
+			count--;
+		}
+	}
+	index->count = e - index->phandle;
+	qsort(index->phandle, index->count, sizeof(*e), of_index_phandle_cmp);
+	log_debug("Indexed %d phandles\n", index->count);
+
+	return index;
+}
+
+/* Get the index of @blob, building it if needed, or NULL if there is none */
+static struct of_index *of_index_get(const void *blob)
+{
+	struct of_index *index = gd_of_index();
+
+	/* Memory before relocation is too scarce to spend on this */
+	if (blob != gd->fdt_blob || !(gd->flags & GD_FLG_RELOC))
+		return NULL;
+
+	if (index && index->blob == blob &&
+	    index->size == fdt_size_dt_struct(blob))
+		return index;
+
+	of_index_invalidate();
+	index = of_index_build(blob);
+	gd_set_of_index(index);
+
+	return index;
+}
+
+int of_index_phandle(const void *blob, uint phandle)
+{
+	struct of_index *index = of_index_get(blob);
+	int lo, hi, mid;
+
+	if (!index || !phandle || phandle == (u32)-1)
+		return fdt_node_offset_by_phandle(blob, phandle);
+
+	lo = 0;
+	hi = index->count;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (index->phandle[mid].phandle < phandle)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < index->count && index->phandle[lo].phandle == phandle) {
+		mid = index->phandle[lo].offset;
+		if (fdt_get_phandle(blob, mid) == phandle)
+			return mid;
+
+		/* The devicetree was changed without changing its size */
+		of_index_invalidate();
+	}
+
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+
+/*
+ * Check that the node at @offset still has the name at the end of @path. For
+ * an alias, the alias is looked up again and its value checked instead.
+ */
+static bool of_index_path_ok(const void *blob, const char *path, int offset)
+{
+	const char *name, *last;
+	int len, last_len;
+
+	if (offset < 0)
+		return true;
+
+	name = fdt_get_name(blob, offset, &len);
+	if (!name)
+		return false;
+
+	last = strrchr(path, '/');
+	if (*path != '/' && !last) {
+		path = fdt_get_alias(blob, path);
+		if (!path)
+			return false;
+		last = strrchr(path, '/');
+		if (!last)
+			return false;
+	}
+
+	/* As in fdt_path_offset(), the unit address may be left out */
+	last++;
+	last_len = strlen(last);
+
+	return len >= last_len && !memcmp(name, last, last_len) &&
+	       (len == last_len || (name[last_len] == '@' &&
+				    !memchr(last, '@', last_len)));
+}
+
+int of_index_path(const void *blob, const char *path)
+{
+	struct of_index *index = of_index_get(blob);
+	struct of_index_path *entry;
+	int offset, i;
+
+	if (!index)
+		return fdt_path_offset(blob, path);
+
+	for (i = 0; i < OF_INDEX_PATHS; i++) {
+		entry = &index->path[i];
+		if (entry->path && !strcmp(entry->path, path)) {
+			if (of_index_path_ok(blob, path, entry->offset))
+				return entry->offset;
+			break;
+		}
+	}
+
+	offset = fdt_path_offset(blob, path);
+
+	/* Reuse a stale entry for this path, else the oldest one */
+	if (i == OF_INDEX_PATHS) {
+		entry = &index->path[index->next_path];
+		index->next_path = (index->next_path + 1) % OF_INDEX_PATHS;
+		free(entry->path);
+		entry->path = strdup(path);
+	}
+	entry->offset = offset;
+
+	return offset;
+}
+
+void of_index_invalidate(void)
+{
+	struct of_index *index = gd_of_index();
+	int i;
+
+	if (!index)
+		return;
+
+	for (i = 0; i < OF_INDEX_PATHS; i++)
+		free(index->path[i].path);
+	free(index);
+	gd_set_of_index(NULL);
+}
@@ -13,6 +13,7 @@
 #include <linux/libfdt.h>
 #include <dm/of_access.h>
 #include <dm/of_addr.h>
+#include <dm/of_index.h>
 #include <dm/ofnode.h>
 #include <linux/err.h>
 #include <linux/ioport.h>
@@ -293,8 +294,7 @@ ofnode ofnode_get_by_phandle(uint phandle)
 	if (of_live_active())
 		node = np_to_ofnode(of_find_node_by_phandle(phandle));
 	else
-		node.of_offset = fdt_node_offset_by_phandle(gd->fdt_blob,
-							    phandle);
+		node.of_offset = of_index_phandle(gd->fdt_blob, phandle);
 
 	return node;
 }
@@ -473,7 +473,7 @@ ofnode ofnode_path(const char *path)
 	if (of_live_active())
 		return np_to_ofnode(of_find_node_by_path(path));
 	else
-		return offset_to_ofnode(fdt_path_offset(gd->fdt_blob, path));
+		return offset_to_ofnode(of_index_path(gd->fdt_blob, path));
 }
 
 const void *ofnode_read_chosen_prop(const char *propname, int *sizep)
@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Time taken to bind and probe each device
+ *
+ * device_bind_common() and device_probe() save the timing state in a frame on
+ * the stack while they run, so that the time spent binding or probing other
+ * devices in the meantime can be taken off the device's own time. clk, reset
+ * and pinctrl operations are timed where they call the driver and added to
+ * the device being probed at the time.
+ */
+
+#define LOG_CATEGORY LOGC_DM
+
+#include <common.h>
+#include <bootstage.h>
+#include <dm.h>
+#include <malloc.h>
+#include <sort.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <dm/probe-times.h>
+#include <dm/root.h>
+#include <dm/util.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static const char *const dm_time_name[DM_TIME_COUNT] = {
+	[DM_TIME_BIND]		= "bind",
+	[DM_TIME_PROBE]		= "probe",
+	[DM_TIME_PROBE_TOTAL]	= "probe-total",
+	[DM_TIME_CLK]		= "clk",
+	[DM_TIME_RESET]		= "reset",
+	[DM_TIME_PINCTRL]	= "pinctrl",
+};
+
+/* Get the time in microseconds, or 0 if it cannot be read yet */
+static ulong dm_time_now(void)
+{
+#if defined(CONFIG_TIMER) && !defined(CONFIG_TIMER_EARLY)
+	/* Reading the timer before it is set up would probe devices */
+	if (!gd->timer)
+		return 0;
+#endif
+	return timer_get_us();
+}
+
+void dm_time_enter(struct dm_time_frame *frame, struct udevice *dev)
+{
+	struct dm_time_state *st = &gd->dm_times;
+
+	frame->dev = st->dev;
+	frame->nested = st->nested;
+	frame->open = st->open;
+	frame->start = dm_time_now();
+
+	/* Probing from the top level adds up to the time shown by bootstage */
+	if (dev && !st->depth && frame->start)
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DM_PROBE, "dm_probe");
+
+	st->dev = dev;
+	st->nested = 0;
+	st->open = 0;
+	st->depth++;
+}
+
+void dm_time_leave(struct dm_time_frame *frame, struct udevice *dev,
+		   enum dm_time_id id)
+{
+	struct dm_time_state *st = &gd->dm_times;
+	ulong total = 0;
+
+	if (frame->start)
+		total = dm_time_now() - frame->start;
+	if (dev) {
+		dev->times_[id] += total - min(st->nested, total);
+		if (id == DM_TIME_PROBE)
+			dev->times_[DM_TIME_PROBE_TOTAL] += total;
+	}
+
+	st->dev = frame->dev;
+	st->nested = frame->nested + total;
+	st->open = frame->open;
+	st->depth--;
+
+	if (id == DM_TIME_PROBE && !st->depth && frame->start)
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DM_PROBE);
+}
+
+ulong dm_time_start(enum dm_time_id id)
+{
+	struct dm_time_state *st = &gd->dm_times;
+	ulong start;
+
+	if (!st->dev || (st->open & BIT(id)))
+		return 0;
+
+	start = dm_time_now();
+	if (start)
+		st->open |= BIT(id);
+
+	return start;
+}
+
+void dm_time_end(enum dm_time_id id, ulong start)
+{
+	struct dm_time_state *st = &gd->dm_times;
+
+	if (!start)
+		return;
+
+	st->open &= ~BIT(id);
+	st->dev->times_[id] += dm_time_now() - start;
+}
+
+u32 dev_get_time(const struct udevice *dev, enum dm_time_id id)
+{
+	return dev->times_[id];
+}
+
+/* Time which the device itself is responsible for */
+static u32 dm_time_cost(const struct udevice *dev)
+{
+	return dev->times_[DM_TIME_BIND] + dev->times_[DM_TIME_PROBE];
+}
+
+static int dm_time_cmp(const void *a, const void *b)
+{
+	u32 cost_a = dm_time_cost(*(struct udevice **)a);
+	u32 cost_b = dm_time_cost(*(struct udevice **)b);
+
+	return cost_a < cost_b ? 1 : cost_a > cost_b ? -1 : 0;
+}
+
+/* Count the devices which took some time, adding them to @list if not NULL */
+static int dm_time_collect(struct udevice *dev, struct udevice **list,
+			   int count)
+{
+	struct udevice *child;
+
+	if (dm_time_cost(dev)) {
+		if (list)
+			list[count] = dev;
+		count++;
+	}
+	device_foreach_child(child, dev)
+		count = dm_time_collect(child, list, count);
+
+	return count;
+}
+
+/**
+ * dm_time_sorted() - Get the devices which took some time, most costly first
+ *
+ * @listp: returns a list of devices, which must be freed by the caller
+ * Return: number of devices in the list, or -ENOMEM
+ */
+static int dm_time_sorted(struct udevice ***listp)
+{
+	struct udevice *root = dm_root();
+	struct udevice **list;
+	int count;
+
+	count = root ? dm_time_collect(root, NULL, 0) : 0;
+	list = malloc(max(count, 1) * sizeof(*list));
+	if (!list)
+		return -ENOMEM;
+	if (root)
+		dm_time_collect(root, list, 0);
+	qsort(list, count, sizeof(*list), dm_time_cmp);
+	*listp = list;
+
+	return count;
+}
+
+int dm_probe_times_add_fdt(void *blob, int parent)
+{
+	struct udevice **list;
+	int node, sub, count, i, id;
+	int ret = 0;
+
+	count = dm_time_sorted(&list);
+	if (count < 0)
+		return -FDT_ERR_NOSPACE;
+
+	node = fdt_add_subnode(blob, parent, "dm");
+	if (node < 0) {
+		ret = node;
+		goto out;
+	}
+
+	/* Subnodes are added at the start, so add the most costly last */
+	for (i = count - 1; i >= 0; i--) {
+		sub = fdt_add_subnode(blob, node, simple_itoa(i));
+		if (sub < 0) {
+			ret = sub;
+			goto out;
+		}
+		ret = fdt_setprop_string(blob, sub, "name", list[i]->name);
+		for (id = 0; !ret && id < DM_TIME_COUNT; id++)
+			ret = fdt_setprop_u32(blob, sub, dm_time_name[id],
+					      list[i]->times_[id]);
+		if (ret)
+			goto out;
+	}
+
+out:
+	free(list);
+
+	return ret;
+}
+
+void dm_dump_probe_times(int limit)
+{
+	struct udevice **list;
+	u32 sum[DM_TIME_COUNT] = {};
+	int count, i, id;
+
+	count = dm_time_sorted(&list);
+	if (count < 0) {
+		printf("Out of memory\n");
+		return;
+	}
+
+	printf("    Bind    Probe    Total      Clk    Reset  Pinctrl  Class       Name\n");
+	printf("-------------------------------------------------------------------------------\n");
+	for (i = 0; i < count; i++) {
+		struct udevice *dev = list[i];
+
+		for (id = 0; id < DM_TIME_COUNT; id++)
+			sum[id] += dev->times_[id];
+		if (limit > 0 && i >= limit)
+			continue;
+		for (id = 0; id < DM_TIME_COUNT; id++)
+			printf("%8u ", dev->times_[id]);
+		printf(" %-10.10s  %s\n", dev->uclass->uc_drv->name, dev->name);
+	}
+	printf("-------------------------------------------------------------------------------\n");
+	printf("%8u %8u %d devices, times in us\n", sum[DM_TIME_BIND],
+	       sum[DM_TIME_PROBE], count);
+
+	free(list);
+}
@@ -7,6 +7,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <errno.h>
 #include <fdtdec.h>
 #include <log.h>
@@ -17,6 +18,7 @@
 #include <dm/acpi.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
+#include <dm/lazy.h>
 #include <dm/lists.h>
 #include <dm/of.h>
 #include <dm/of_access.h>
@@ -178,12 +180,22 @@ int dm_init(bool of_live)
 		INIT_LIST_HEAD(DM_UCLASS_ROOT_NON_CONST);
 	}
 
+	/* Any nodes left unbound belong under the old devices */
+	dm_lazy_reset();
+
 	if (IS_ENABLED(CONFIG_NEEDS_MANUAL_RELOC)) {
 		fix_drivers();
 		fix_uclass();
 		fix_devices();
 	}
 
+	if (CONFIG_IS_ENABLED(DM_COMPAT_INDEX)) {
+		/* Without the index, drivers are found by a linear search */
+		ret = lists_init_compat_index();
+		if (ret)
+			log_debug("Cannot index compatible strings: %d\n", ret);
+	}
+
 	if (CONFIG_IS_ENABLED(OF_PLATDATA_INST)) {
 		ret = dm_setup_inst();
 		if (ret) {
@@ -280,7 +292,12 @@ static int dm_scan_fdt_node(struct udevice *parent, ofnode parent_node,
 			pr_debug("   - ignoring disabled device\n");
 			continue;
 		}
-		err = lists_bind_fdt(parent, node, NULL, pre_reloc_only);
+		if (CONFIG_IS_ENABLED(DM_LAZY_BIND) && !pre_reloc_only &&
+		    (gd->flags & GD_FLG_RELOC))
+			err = dm_lazy_add(parent, node);
+		else
+			err = lists_bind_fdt(parent, node, NULL,
+					     pre_reloc_only);
 		if (err && !ret) {
 			ret = err;
 			debug("%s: ret=%d\n", node_name, ret);
@@ -401,7 +418,9 @@ int dm_init_and_scan(bool pre_reloc_only)
 		return ret;
 	}
 	if (!CONFIG_IS_ENABLED(OF_PLATDATA_INST)) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DM_BIND, "dm_bind");
 		ret = dm_scan(pre_reloc_only);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DM_BIND);
 		if (ret) {
 			log_debug("dm_scan() failed: %d\n", ret);
 			return ret;
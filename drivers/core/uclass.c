@@ -16,6 +16,7 @@
 #include <asm/global_data.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
+#include <dm/lazy.h>
 #include <dm/lists.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
@@ -147,6 +148,8 @@ int uclass_get(enum uclass_id id, struct uclass **ucp)
 	struct uclass *uc;
 
 	*ucp = NULL;
+	/* Bind any devices of this uclass which were left until now */
+	dm_lazy_bind_uclass(id);
 	uc = uclass_find(id);
 	if (!uc) {
 		if (CONFIG_IS_ENABLED(OF_PLATDATA_INST))
@@ -349,6 +352,7 @@ int uclass_find_device_by_of_offset(enum uclass_id id, int node,
 	*devp = NULL;
 	if (node < 0)
 		return -ENODEV;
+	dm_lazy_bind_node(offset_to_ofnode(node));
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
@@ -374,6 +378,7 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	*devp = NULL;
 	if (!ofnode_valid(node))
 		return -ENODEV;
+	dm_lazy_bind_node(node);
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
@@ -407,6 +412,7 @@ int uclass_find_device_by_phandle(enum uclass_id id, struct udevice *parent,
 	find_phandle = dev_read_u32_default(parent, name, -1);
 	if (find_phandle <= 0)
 		return -ENOENT;
+	dm_lazy_bind_node(ofnode_get_by_phandle(find_phandle));
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
@@ -528,6 +534,7 @@ int uclass_get_device_by_phandle_id(enum uclass_id id, uint phandle_id,
 	int ret;
 
 	*devp = NULL;
+	dm_lazy_bind_node(ofnode_get_by_phandle(phandle_id));
 	ret = uclass_get(id, &uc);
 	if (ret)
 		return ret;
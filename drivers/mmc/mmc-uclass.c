@@ -38,6 +38,11 @@ int dm_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 	struct dm_mmc_ops *ops = mmc_get_ops(dev);
 	int ret;
 
+#if CONFIG_IS_ENABLED(BLK)
+	/* the host can only handle one command at a time */
+	if (mmc->async_req)
+		mmc_async_finish(mmc);
+#endif
 	mmmc_trace_before_send(mmc, cmd);
 	if (ops->send_cmd)
 		ret = ops->send_cmd(dev, cmd, data);
@@ -53,6 +58,36 @@ int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data)
 	return dm_mmc_send_cmd(mmc->dev, cmd, data);
 }
 
+int dm_mmc_send_cmd_start(struct udevice *dev, struct mmc_cmd *cmd,
+			  struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+	int ret;
+
+	if (!ops->send_cmd_start || !ops->send_cmd_wait)
+		return -ENOSYS;
+	mmmc_trace_before_send(mmc, cmd);
+	ret = ops->send_cmd_start(dev, cmd, data);
+	if (ret)
+		mmmc_trace_after_send(mmc, cmd, ret);
+
+	return ret;
+}
+
+int dm_mmc_send_cmd_wait(struct udevice *dev, struct mmc_cmd *cmd,
+			 struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+	int ret;
+
+	ret = ops->send_cmd_wait(dev, cmd, data);
+	mmmc_trace_after_send(mmc, cmd, ret);
+
+	return ret;
+}
+
 int dm_mmc_set_ios(struct udevice *dev)
 {
 	struct dm_mmc_ops *ops = mmc_get_ops(dev);
@@ -480,6 +515,8 @@ static int mmc_blk_remove(struct udevice *dev)
 
 static const struct blk_ops mmc_blk_ops = {
 	.read	= mmc_bread,
+	.submit	= mmc_bread_submit,
+	.wait	= mmc_bread_wait,
 #if CONFIG_IS_ENABLED(MMC_WRITE)
 	.write	= mmc_bwrite,
 	.erase	= mmc_berase,
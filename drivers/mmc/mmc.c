@@ -505,6 +505,102 @@ ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 	return blkcnt;
 }
 
+#if CONFIG_IS_ENABLED(DM_MMC) && CONFIG_IS_ENABLED(BLK)
+void mmc_async_finish(struct mmc *mmc)
+{
+	struct blk_req *req = mmc->async_req;
+	struct mmc_cmd *cmd = &mmc->async_cmd;
+	int err;
+
+	mmc->async_req = NULL;
+	err = dm_mmc_send_cmd_wait(mmc->dev, cmd, &mmc->async_data);
+	if (!err && req->blkcnt > 1) {
+		cmd->cmdidx = MMC_CMD_STOP_TRANSMISSION;
+		cmd->cmdarg = 0;
+		cmd->resp_type = MMC_RSP_R1b;
+		err = mmc_send_cmd(mmc, cmd, NULL);
+#if !defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBCOMMON_SUPPORT)
+		if (err)
+			pr_err("mmc fail to send stop cmd\n");
+#endif
+	}
+	req->result = err ? err : req->blkcnt;
+	req->done = true;
+}
+
+int mmc_bread_submit(struct udevice *dev, struct blk_req *req)
+{
+	struct blk_desc *block_dev = dev_get_uclass_plat(dev);
+	struct mmc_cmd *cmd;
+	struct mmc_data *data;
+	struct mmc *mmc;
+	int err;
+
+	mmc = find_mmc_device(block_dev->devnum);
+	if (!mmc)
+		return -ENODEV;
+	if (mmc->async_req)
+		mmc_async_finish(mmc);
+
+	if (CONFIG_IS_ENABLED(MMC_TINY))
+		err = mmc_switch_part(mmc, block_dev->hwpart);
+	else
+		err = blk_dselect_hwpart(block_dev, block_dev->hwpart);
+	if (err < 0)
+		return err;
+	if (req->start + req->blkcnt > block_dev->lba)
+		return -ERANGE;
+	if (mmc_set_blocklen(mmc, mmc->read_bl_len))
+		return -EIO;
+
+	/* a read that must be split up is done synchronously */
+	if (!req->blkcnt ||
+	    req->blkcnt > mmc_get_b_max(mmc, req->buffer, req->blkcnt))
+		return -ENOSYS;
+
+	cmd = &mmc->async_cmd;
+	data = &mmc->async_data;
+	if (req->blkcnt > 1)
+		cmd->cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
+	else
+		cmd->cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
+
+	if (mmc->high_capacity)
+		cmd->cmdarg = req->start;
+	else
+		cmd->cmdarg = req->start * mmc->read_bl_len;
+
+	cmd->resp_type = MMC_RSP_R1;
+
+	data->dest = req->buffer;
+	data->blocks = req->blkcnt;
+	data->blocksize = mmc->read_bl_len;
+	data->flags = MMC_DATA_READ;
+
+	err = dm_mmc_send_cmd_start(mmc->dev, cmd, data);
+	if (err)
+		return err;
+	mmc->async_req = req;
+
+	return 0;
+}
+
+int mmc_bread_wait(struct udevice *dev, struct blk_req *req)
+{
+	struct blk_desc *block_dev = dev_get_uclass_plat(dev);
+	struct mmc *mmc;
+
+	mmc = find_mmc_device(block_dev->devnum);
+	if (!mmc)
+		return -ENODEV;
+	if (mmc->async_req != req)
+		return -EINVAL;
+	mmc_async_finish(mmc);
+
+	return 0;
+}
+#endif
+
 static int mmc_go_idle(struct mmc *mmc)
 {
 	struct mmc_cmd cmd;
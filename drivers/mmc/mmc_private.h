@@ -21,6 +21,17 @@ int mmc_set_blocklen(struct mmc *mmc, int len);
 #if CONFIG_IS_ENABLED(BLK)
 ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
+int mmc_bread_submit(struct udevice *dev, struct blk_req *req);
+int mmc_bread_wait(struct udevice *dev, struct blk_req *req);
+
+/**
+ * mmc_async_finish() - Complete the read started by mmc_bread_submit()
+ *
+ * This must be called before anything else is sent to the card.
+ *
+ * @mmc:	MMC device with a read in flight
+ */
+void mmc_async_finish(struct mmc *mmc);
 #else
 ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
@@ -196,17 +196,43 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data)
 #define SDHCI_CMD_DEFAULT_TIMEOUT		100
 #define SDHCI_READ_STATUS_TIMEOUT		1000
 
-#ifdef CONFIG_DM_MMC
-static int sdhci_send_command(struct udevice *dev, struct mmc_cmd *cmd,
-			      struct mmc_data *data)
+static int sdhci_finish_command(struct sdhci_host *host,
+				struct mmc_data *data, int ret, int is_aligned)
 {
-	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	unsigned int stat;
 
-#else
-static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
-			      struct mmc_data *data)
+	if (!ret && data)
+		ret = sdhci_transfer_data(host, data);
+
+	if (host->quirks & SDHCI_QUIRK_WAIT_SEND_CMD)
+		udelay(1000);
+
+	stat = sdhci_readl(host, SDHCI_INT_STATUS);
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+	if (!ret) {
+		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
+				!is_aligned && (data->flags == MMC_DATA_READ))
+			memcpy(data->dest, host->align_buffer,
+			       data->blocks * data->blocksize);
+		return 0;
+	}
+
+	sdhci_reset(host, SDHCI_RESET_CMD);
+	sdhci_reset(host, SDHCI_RESET_DATA);
+	if (stat & SDHCI_INT_TIMEOUT)
+		return -ETIMEDOUT;
+	else
+		return -ECOMM;
+}
+
+/*
+ * Send a command and wait for its response. Unless @async is set, also wait
+ * for any data; otherwise the data transfer is left running and must be
+ * finished by sdhci_finish_command().
+ */
+static int __sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
+				struct mmc_data *data, bool async)
 {
-#endif
 	struct sdhci_host *host = mmc->priv;
 	unsigned int stat = 0;
 	int ret = 0;
@@ -321,29 +347,50 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	} else
 		ret = -1;
 
-	if (!ret && data)
-		ret = sdhci_transfer_data(host, data);
-
-	if (host->quirks & SDHCI_QUIRK_WAIT_SEND_CMD)
-		udelay(1000);
-
-	stat = sdhci_readl(host, SDHCI_INT_STATUS);
-	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
-	if (!ret) {
-		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
-				!is_aligned && (data->flags == MMC_DATA_READ))
-			memcpy(data->dest, host->align_buffer, trans_bytes);
+	if (!ret && async) {
+		host->is_aligned = is_aligned;
 		return 0;
 	}
 
-	sdhci_reset(host, SDHCI_RESET_CMD);
-	sdhci_reset(host, SDHCI_RESET_DATA);
-	if (stat & SDHCI_INT_TIMEOUT)
-		return -ETIMEDOUT;
-	else
-		return -ECOMM;
+	return sdhci_finish_command(host, data, ret, is_aligned);
 }
 
+#ifdef CONFIG_DM_MMC
+static int sdhci_send_command(struct udevice *dev, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
+{
+	return __sdhci_send_command(mmc_get_mmc_dev(dev), cmd, data, false);
+}
+
+static int sdhci_send_command_start(struct udevice *dev, struct mmc_cmd *cmd,
+				    struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	/* PIO transfers need the CPU, so there is nothing to overlap */
+	if (!data || !(host->flags & USE_DMA))
+		return -ENOSYS;
+
+	return __sdhci_send_command(mmc, cmd, data, true);
+}
+
+static int sdhci_send_command_wait(struct udevice *dev, struct mmc_cmd *cmd,
+				   struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	return sdhci_finish_command(host, data, 0, host->is_aligned);
+}
+#else
+static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
+{
+	return __sdhci_send_command(mmc, cmd, data, false);
+}
+#endif
+
 #if defined(CONFIG_DM_MMC) && defined(MMC_SUPPORTS_TUNING)
 static int sdhci_execute_tuning(struct udevice *dev, uint opcode)
 {
@@ -774,6 +821,8 @@ static int sdhci_get_cd(struct udevice *dev)
 
 const struct dm_mmc_ops sdhci_ops = {
 	.send_cmd	= sdhci_send_command,
+	.send_cmd_start	= sdhci_send_command_start,
+	.send_cmd_wait	= sdhci_send_command_wait,
 	.set_ios	= sdhci_set_ios,
 	.get_cd		= sdhci_get_cd,
 	.deferred_probe	= sdhci_deferred_probe,
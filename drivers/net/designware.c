@@ -729,6 +729,15 @@ int designware_eth_recv(struct udevice *dev, int flags, uchar **packetp)
 {
 	struct dw_eth_dev *priv = dev_get_priv(dev);
 
+	/* Collect the frames lost since the last poll */
+	if (flags & ETH_RECV_CHECK_DEVICE) {
+		u32 missed = readl(&priv->dma_regs_p->missedframes);
+
+		eth_get_stats(dev)->rx_dropped +=
+			(missed & MISSED_BY_CTRL_MASK) +
+			((missed & MISSED_BY_APP_MASK) >> MISSED_BY_APP_SHIFT);
+	}
+
 	return _dw_eth_recv(priv, packetp);
 }
 
@@ -15,7 +15,7 @@
 #endif
 
 #define CONFIG_TX_DESCR_NUM	16
-#define CONFIG_RX_DESCR_NUM	16
+#define CONFIG_RX_DESCR_NUM	CONFIG_ETH_DESIGNWARE_RX_DESCS
 #define CONFIG_ETH_BUFSIZE	2048
 #define TX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_TX_DESCR_NUM)
 #define RX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_RX_DESCR_NUM)
@@ -74,7 +74,8 @@ struct eth_dma_regs {
 	u32 status;		/* 0x14 */
 	u32 opmode;		/* 0x18 */
 	u32 intenable;		/* 0x1c */
-	u32 reserved1[2];
+	u32 missedframes;	/* 0x20 */
+	u32 reserved1;
 	u32 axibus;		/* 0x28 */
 	u32 reserved2[7];
 	u32 currhosttxdesc;	/* 0x48 */
@@ -110,6 +111,11 @@ struct eth_dma_regs {
 #define TXSECONDFRAME		(1 << 2)
 #define RXSTART			(1 << 1)
 
+/* Missed frame counter definitions (cleared on read) */
+#define MISSED_BY_APP_MASK	(0x7ff << 17)	/* rx FIFO overflow */
+#define MISSED_BY_APP_SHIFT	17
+#define MISSED_BY_CTRL_MASK	0xffff		/* no rx descriptor */
+
 /* Descriptior related definitions */
 #define MAC_MAX_FRAME_SZ	(1600)
 
@@ -81,6 +81,7 @@ struct eqos_mac_regs {
 	uint32_t address0_low;				/* 0x304 */
 };
 
+#define EQOS_MAC_CONFIGURATION_IPC			BIT(27)
 #define EQOS_MAC_CONFIGURATION_GPSLCE			BIT(23)
 #define EQOS_MAC_CONFIGURATION_CST			BIT(21)
 #define EQOS_MAC_CONFIGURATION_ACS			BIT(20)
@@ -112,6 +113,8 @@ struct eqos_mac_regs {
 #define EQOS_MAC_RXQ_CTRL2_PSRQ0_SHIFT			0
 #define EQOS_MAC_RXQ_CTRL2_PSRQ0_MASK			0xff
 
+#define EQOS_MAC_HW_FEATURE0_RXCOESEL			BIT(16)
+#define EQOS_MAC_HW_FEATURE0_TXCOESEL			BIT(14)
 #define EQOS_MAC_HW_FEATURE0_MMCSEL_SHIFT		8
 #define EQOS_MAC_HW_FEATURE0_HDSEL_SHIFT		2
 #define EQOS_MAC_HW_FEATURE0_GMIISEL_SHIFT		1
@@ -259,7 +262,19 @@ struct eqos_desc {
 #define EQOS_DESC3_OWN		BIT(31)
 #define EQOS_DESC3_FD		BIT(29)
 #define EQOS_DESC3_LD		BIT(28)
+#define EQOS_DESC3_RS1V		BIT(26)
 #define EQOS_DESC3_BUF1V	BIT(24)
+/* Insert the IP header and TCP/UDP checksums, pseudo header included */
+#define EQOS_DESC3_CIC_FULL	(3 << 16)
+
+/* RX write-back descriptor word 1 */
+#define EQOS_DESC1_IPCE		BIT(7)
+#define EQOS_DESC1_IPCB		BIT(6)
+#define EQOS_DESC1_IPV4		BIT(4)
+#define EQOS_DESC1_IPHE		BIT(3)
+#define EQOS_DESC1_PT_MASK	0x7
+#define EQOS_DESC1_PT_UDP	1
+#define EQOS_DESC1_PT_TCP	2
 
 #define EQOS_AXI_WIDTH_32	4
 #define EQOS_AXI_WIDTH_64	8
@@ -1125,6 +1140,7 @@ static int eqos_read_rom_hwaddr(struct udevice *dev)
 static int eqos_start(struct udevice *dev)
 {
 	struct eqos_priv *eqos = dev_get_priv(dev);
+	struct eth_pdata *pdata = dev_get_plat(dev);
 	int ret, i;
 	ulong rate;
 	u32 val, tx_fifo_sz, rx_fifo_sz, tqs, rqs, pbl;
@@ -1353,6 +1369,17 @@ static int eqos_start(struct udevice *dev)
 			EQOS_MAC_CONFIGURATION_CST |
 			EQOS_MAC_CONFIGURATION_ACS);
 
+	/* Checksum offload, if the MAC was synthesized with it */
+	val = readl(&eqos->mac_regs->hw_feature0);
+	pdata->features = 0;
+	if (val & EQOS_MAC_HW_FEATURE0_TXCOESEL)
+		pdata->features |= ETH_FEAT_TX_CSUM;
+	if (val & EQOS_MAC_HW_FEATURE0_RXCOESEL) {
+		pdata->features |= ETH_FEAT_RX_CSUM;
+		setbits_le32(&eqos->mac_regs->configuration,
+			     EQOS_MAC_CONFIGURATION_IPC);
+	}
+
 	eqos_write_hwaddr(dev);
 
 	/* Configure DMA */
@@ -1524,13 +1551,24 @@ static void eqos_stop(struct udevice *dev)
 static int eqos_send(struct udevice *dev, void *packet, int length)
 {
 	struct eqos_priv *eqos = dev_get_priv(dev);
+	struct eth_pdata *pdata = dev_get_plat(dev);
 	struct eqos_desc *tx_desc;
+	u32 cic = 0;
+	int start, offset;
 	int i;
 
 	debug("%s(dev=%p, packet=%p, length=%d):\n", __func__, dev, packet,
 	      length);
 
 	memcpy(eqos->tx_dma_buf, packet, length);
+	if (pdata->features & ETH_FEAT_TX_CSUM) {
+		start = eth_get_tx_csum(packet, length, &offset);
+		if (start >= 0) {
+			/* The MAC sums the pseudo header itself */
+			memset(eqos->tx_dma_buf + start + offset, 0, 2);
+			cic = EQOS_DESC3_CIC_FULL;
+		}
+	}
 	eqos->config->ops->eqos_flush_buffer(eqos->tx_dma_buf, length);
 
 	tx_desc = eqos_get_desc(eqos, eqos->tx_desc_idx, false);
@@ -1545,7 +1583,8 @@ static int eqos_send(struct udevice *dev, void *packet, int length)
 	 * writes to the rest of the descriptor too.
 	 */
 	mb();
-	tx_desc->des3 = EQOS_DESC3_OWN | EQOS_DESC3_FD | EQOS_DESC3_LD | length;
+	tx_desc->des3 = EQOS_DESC3_OWN | EQOS_DESC3_FD | EQOS_DESC3_LD | cic |
+			length;
 	eqos->config->ops->eqos_flush_desc(tx_desc);
 
 	writel((ulong)eqos_get_desc(eqos, eqos->tx_desc_idx, false),
@@ -1583,6 +1622,18 @@ static int eqos_recv(struct udevice *dev, int flags, uchar **packetp)
 	length = rx_desc->des3 & 0x7fff;
 	debug("%s: *packetp=%p, length=%d\n", __func__, *packetp, length);
 
+	/* With IPC set, the MAC checks IPv4 TCP/UDP checksums */
+	if (rx_desc->des3 & EQOS_DESC3_RS1V) {
+		u32 des1 = rx_desc->des1;
+		u32 pt = des1 & EQOS_DESC1_PT_MASK;
+
+		if ((des1 & EQOS_DESC1_IPV4) &&
+		    !(des1 & (EQOS_DESC1_IPHE | EQOS_DESC1_IPCE |
+			      EQOS_DESC1_IPCB)) &&
+		    (pt == EQOS_DESC1_PT_UDP || pt == EQOS_DESC1_PT_TCP))
+			eth_set_rx_csum_ok(dev);
+	}
+
 	eqos->config->ops->eqos_inval_buffer(*packetp, length);
 
 	return length;
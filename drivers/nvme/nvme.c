@@ -180,9 +180,16 @@ static void nvme_submit_cmd(struct nvme_queue *nvmeq, struct nvme_command *cmd)
 	nvmeq->sq_tail = tail;
 }
 
-static int nvme_submit_sync_cmd(struct nvme_queue *nvmeq,
-				struct nvme_command *cmd,
-				u32 *result, unsigned timeout)
+/**
+ * nvme_wait_cmd() - wait for the oldest outstanding command to complete
+ *
+ * @nvmeq:	The queue the command was submitted to
+ * @result:	Returns the command-specific result, if not NULL
+ * @timeout:	Timeout, or 0 to wait for ever
+ * @return 0 if OK, -ve on error
+ */
+static int nvme_wait_cmd(struct nvme_queue *nvmeq, u32 *result,
+			 unsigned timeout)
 {
 	u16 head = nvmeq->cq_head;
 	u16 phase = nvmeq->cq_phase;
@@ -190,9 +197,6 @@ static int nvme_submit_sync_cmd(struct nvme_queue *nvmeq,
 	ulong start_time;
 	ulong timeout_us = timeout * 100000;
 
-	cmd->common.command_id = nvme_get_cmd_id();
-	nvme_submit_cmd(nvmeq, cmd);
-
 	start_time = timer_get_us();
 
 	for (;;) {
@@ -234,6 +238,16 @@ static int nvme_submit_sync_cmd(struct nvme_queue *nvmeq,
 	return status;
 }
 
+static int nvme_submit_sync_cmd(struct nvme_queue *nvmeq,
+				struct nvme_command *cmd,
+				u32 *result, unsigned timeout)
+{
+	cmd->common.command_id = nvme_get_cmd_id();
+	nvme_submit_cmd(nvmeq, cmd);
+
+	return nvme_wait_cmd(nvmeq, result, timeout);
+}
+
 static int nvme_submit_admin_cmd(struct nvme_dev *dev, struct nvme_command *cmd,
 				 u32 *result)
 {
@@ -736,6 +750,36 @@ static int nvme_blk_probe(struct udevice *udev)
 	return 0;
 }
 
+static void nvme_init_rw(struct nvme_command *c, struct nvme_ns *ns,
+			 bool read)
+{
+	c->rw.opcode = read ? nvme_cmd_read : nvme_cmd_write;
+	c->rw.flags = 0;
+	c->rw.nsid = cpu_to_le32(ns->ns_id);
+	c->rw.control = 0;
+	c->rw.dsmgmt = 0;
+	c->rw.reftag = 0;
+	c->rw.apptag = 0;
+	c->rw.appmask = 0;
+	c->rw.metadata = 0;
+}
+
+static void nvme_async_finish(struct nvme_dev *dev)
+{
+	struct blk_req *req = dev->async_req;
+	struct blk_desc *desc;
+	int status;
+
+	dev->async_req = NULL;
+	status = nvme_wait_cmd(dev->queues[NVME_IO_Q], NULL, IO_TIMEOUT);
+	desc = (struct blk_desc *)req->priv[0];
+	invalidate_dcache_range((unsigned long)req->buffer,
+				(unsigned long)req->buffer +
+				(req->blkcnt << desc->log2blksz));
+	req->result = status ? -EIO : req->blkcnt;
+	req->done = true;
+}
+
 static ulong nvme_blk_rw(struct udevice *udev, lbaint_t blknr,
 			 lbaint_t blkcnt, void *buffer, bool read)
 {
@@ -752,18 +796,13 @@ static ulong nvme_blk_rw(struct udevice *udev, lbaint_t blknr,
 	u16 lbas = 1 << (dev->max_transfer_shift - ns->lba_shift);
 	u64 total_lbas = blkcnt;
 
+	if (dev->async_req)
+		nvme_async_finish(dev);
+
 	flush_dcache_range((unsigned long)buffer,
 			   (unsigned long)buffer + total_len);
 
-	c.rw.opcode = read ? nvme_cmd_read : nvme_cmd_write;
-	c.rw.flags = 0;
-	c.rw.nsid = cpu_to_le32(ns->ns_id);
-	c.rw.control = 0;
-	c.rw.dsmgmt = 0;
-	c.rw.reftag = 0;
-	c.rw.apptag = 0;
-	c.rw.appmask = 0;
-	c.rw.metadata = 0;
+	nvme_init_rw(&c, ns, read);
 
 	while (total_lbas) {
 		if (total_lbas < lbas) {
@@ -808,9 +847,59 @@ static ulong nvme_blk_write(struct udevice *udev, lbaint_t blknr,
 	return nvme_blk_rw(udev, blknr, blkcnt, (void *)buffer, false);
 }
 
+static int nvme_blk_submit(struct udevice *udev, struct blk_req *req)
+{
+	struct nvme_ns *ns = dev_get_priv(udev);
+	struct nvme_dev *dev = ns->dev;
+	struct blk_desc *desc = dev_get_uclass_plat(udev);
+	struct nvme_command c;
+	u64 len = req->blkcnt << desc->log2blksz;
+	u64 prp2;
+
+	/* reads needing more than one command are done synchronously */
+	if (!req->blkcnt ||
+	    req->blkcnt > 1 << (dev->max_transfer_shift - ns->lba_shift))
+		return -ENOSYS;
+
+	if (dev->async_req)
+		nvme_async_finish(dev);
+
+	flush_dcache_range((unsigned long)req->buffer,
+			   (unsigned long)req->buffer + len);
+
+	if (nvme_setup_prps(dev, &prp2, len, (ulong)req->buffer))
+		return -EIO;
+	nvme_init_rw(&c, ns, true);
+	c.rw.slba = cpu_to_le64(req->start);
+	c.rw.length = cpu_to_le16(req->blkcnt - 1);
+	c.rw.prp1 = cpu_to_le64((ulong)req->buffer);
+	c.rw.prp2 = cpu_to_le64(prp2);
+	c.common.command_id = nvme_get_cmd_id();
+	nvme_submit_cmd(dev->queues[NVME_IO_Q], &c);
+
+	req->priv[0] = (ulong)desc;
+	dev->async_req = req;
+
+	return 0;
+}
+
+static int nvme_blk_wait(struct udevice *udev, struct blk_req *req)
+{
+	struct nvme_ns *ns = dev_get_priv(udev);
+	struct nvme_dev *dev = ns->dev;
+
+	if (dev->async_req != req)
+		return -EINVAL;
+	nvme_async_finish(dev);
+
+	return 0;
+}
+
 static const struct blk_ops nvme_blk_ops = {
 	.read	= nvme_blk_read,
 	.write	= nvme_blk_write,
+	.submit	= nvme_blk_submit,
+	.wait	= nvme_blk_wait,
 };
 
 U_BOOT_DRIVER(nvme_blk) = {
@@ -619,6 +619,8 @@ struct nvme_dev {
 	u64 *prp_pool;
 	u32 prp_entry_num;
 	u32 nn;
+	/* read issued on the I/O queue by nvme_blk_submit(), not yet reaped */
+	struct blk_req *async_req;
 };
 
 /*
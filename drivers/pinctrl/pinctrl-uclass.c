@@ -13,6 +13,7 @@
 #include <dm.h>
 #include <dm/lists.h>
 #include <dm/pinctrl.h>
+#include <dm/probe-times.h>
 #include <dm/util.h>
 #include <dm/of_access.h>
 
@@ -304,6 +305,9 @@ static int pinctrl_select_state_simple(struct udevice *dev)
 
 int pinctrl_select_state(struct udevice *dev, const char *statename)
 {
+	ulong start;
+	int ret = 0;
+
 	/*
 	 * Some device which is logical like mmc.blk, do not have
 	 * a valid ofnode.
@@ -314,10 +318,12 @@ int pinctrl_select_state(struct udevice *dev, const char *statename)
 	 * Try full-implemented pinctrl first.
 	 * If it fails or is not implemented, try simple one.
 	 */
+	start = dm_time_start(DM_TIME_PINCTRL);
 	if (pinctrl_select_state_full(dev, statename))
-		return pinctrl_select_state_simple(dev);
+		ret = pinctrl_select_state_simple(dev);
+	dm_time_end(DM_TIME_PINCTRL, start);
 
-	return 0;
+	return ret;
 }
 
 int pinctrl_request(struct udevice *dev, int func, int flags)
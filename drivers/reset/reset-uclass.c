@@ -12,6 +12,7 @@
 #include <reset-uclass.h>
 #include <dm/devres.h>
 #include <dm/lists.h>
+#include <dm/probe-times.h>
 
 static inline struct reset_ops *reset_dev_ops(struct udevice *dev)
 {
@@ -181,10 +182,16 @@ int reset_free(struct reset_ctl *reset_ctl)
 int reset_assert(struct reset_ctl *reset_ctl)
 {
 	struct reset_ops *ops = reset_dev_ops(reset_ctl->dev);
+	ulong start;
+	int ret;
 
 	debug("%s(reset_ctl=%p)\n", __func__, reset_ctl);
 
-	return ops->rst_assert(reset_ctl);
+	start = dm_time_start(DM_TIME_RESET);
+	ret = ops->rst_assert(reset_ctl);
+	dm_time_end(DM_TIME_RESET, start);
+
+	return ret;
 }
 
 int reset_assert_bulk(struct reset_ctl_bulk *bulk)
@@ -203,10 +210,16 @@ int reset_assert_bulk(struct reset_ctl_bulk *bulk)
 int reset_deassert(struct reset_ctl *reset_ctl)
 {
 	struct reset_ops *ops = reset_dev_ops(reset_ctl->dev);
+	ulong start;
+	int ret;
 
 	debug("%s(reset_ctl=%p)\n", __func__, reset_ctl);
 
-	return ops->rst_deassert(reset_ctl);
+	start = dm_time_start(DM_TIME_RESET);
+	ret = ops->rst_deassert(reset_ctl);
+	dm_time_end(DM_TIME_RESET, start);
+
+	return ret;
 }
 
 int reset_deassert_bulk(struct reset_ctl_bulk *bulk)
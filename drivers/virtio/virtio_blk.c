@@ -17,22 +17,31 @@ struct virtio_blk_priv {
 	struct virtqueue *vq;
 };
 
-static ulong virtio_blk_do_req(struct udevice *dev, u64 sector,
-			       lbaint_t blkcnt, void *buffer, u32 type)
+/* Per-request state kept in struct blk_req->priv for asynchronous reads */
+struct virtio_blk_req {
+	struct virtio_blk_outhdr out_hdr;
+	u8 status;
+};
+
+/*
+ * Queue a request. The out_hdr is the first buffer, so virtqueue_get_buf()
+ * returns its address when the request completes.
+ */
+static int virtio_blk_add_req(struct udevice *dev, u64 sector,
+			      lbaint_t blkcnt, void *buffer, u32 type,
+			      struct virtio_blk_outhdr *out_hdr, u8 *status)
 {
 	struct virtio_blk_priv *priv = dev_get_priv(dev);
 	unsigned int num_out = 0, num_in = 0;
 	struct virtio_sg *sgs[3];
-	u8 status;
+	struct virtio_sg hdr_sg = { out_hdr, sizeof(*out_hdr) };
+	struct virtio_sg data_sg = { buffer, blkcnt * 512 };
+	struct virtio_sg status_sg = { status, sizeof(*status) };
 	int ret;
 
-	struct virtio_blk_outhdr out_hdr = {
-		.type = cpu_to_virtio32(dev, type),
-		.sector = cpu_to_virtio64(dev, sector),
-	};
-	struct virtio_sg hdr_sg = { &out_hdr, sizeof(out_hdr) };
-	struct virtio_sg data_sg = { buffer, blkcnt * 512 };
-	struct virtio_sg status_sg = { &status, sizeof(status) };
+	out_hdr->type = cpu_to_virtio32(dev, type);
+	out_hdr->ioprio = 0;
+	out_hdr->sector = cpu_to_virtio64(dev, sector);
 
 	sgs[num_out++] = &hdr_sg;
 
@@ -49,12 +58,73 @@ static ulong virtio_blk_do_req(struct udevice *dev, u64 sector,
 
 	virtqueue_kick(priv->vq);
 
-	while (!virtqueue_get_buf(priv->vq, NULL))
-		;
+	return 0;
+}
+
+/*
+ * Wait until the request with header @out_hdr completes. Asynchronous reads
+ * which complete in the meantime are marked as done.
+ */
+static void virtio_blk_wait_req(struct udevice *dev,
+				struct virtio_blk_outhdr *out_hdr)
+{
+	struct virtio_blk_priv *priv = dev_get_priv(dev);
+	struct virtio_blk_req *vreq;
+	struct blk_req *req;
+	void *hdr;
+
+	while ((hdr = virtqueue_get_buf(priv->vq, NULL)) != out_hdr) {
+		if (!hdr)
+			continue;
+		vreq = hdr;
+		req = container_of((void *)vreq, struct blk_req, priv);
+		req->result = vreq->status == VIRTIO_BLK_S_OK ?
+			req->blkcnt : -EIO;
+		req->done = true;
+	}
+}
+
+static ulong virtio_blk_do_req(struct udevice *dev, u64 sector,
+			       lbaint_t blkcnt, void *buffer, u32 type)
+{
+	struct virtio_blk_outhdr out_hdr;
+	u8 status;
+	int ret;
+
+	ret = virtio_blk_add_req(dev, sector, blkcnt, buffer, type, &out_hdr,
+				 &status);
+	if (ret)
+		return ret;
+	virtio_blk_wait_req(dev, &out_hdr);
 
 	return status == VIRTIO_BLK_S_OK ? blkcnt : -EIO;
 }
 
+static int virtio_blk_submit(struct udevice *dev, struct blk_req *req)
+{
+	struct virtio_blk_req *vreq = (struct virtio_blk_req *)req->priv;
+
+	BUILD_BUG_ON(sizeof(*vreq) > sizeof(req->priv));
+
+	return virtio_blk_add_req(dev, req->start, req->blkcnt, req->buffer,
+				  VIRTIO_BLK_T_IN, &vreq->out_hdr,
+				  &vreq->status);
+}
+
+static int virtio_blk_wait(struct udevice *dev, struct blk_req *req)
+{
+	struct virtio_blk_req *vreq = (struct virtio_blk_req *)req->priv;
+
+	if (!req->done) {
+		virtio_blk_wait_req(dev, &vreq->out_hdr);
+		req->result = vreq->status == VIRTIO_BLK_S_OK ?
+			req->blkcnt : -EIO;
+		req->done = true;
+	}
+
+	return 0;
+}
+
 static ulong virtio_blk_read(struct udevice *dev, lbaint_t start,
 			     lbaint_t blkcnt, void *buffer)
 {
@@ -125,6 +195,8 @@ static int virtio_blk_probe(struct udevice *dev)
 static const struct blk_ops virtio_blk_ops = {
 	.read	= virtio_blk_read,
 	.write	= virtio_blk_write,
+	.submit	= virtio_blk_submit,
+	.wait	= virtio_blk_wait,
 };
 
 U_BOOT_DRIVER(virtio_blk) = {
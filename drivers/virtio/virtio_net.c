@@ -13,7 +13,7 @@
 #include "virtio_net.h"
 
 /* Amount of buffers to keep in the RX virtqueue */
-#define VIRTIO_NET_NUM_RX_BUFS	32
+#define VIRTIO_NET_NUM_RX_BUFS	CONFIG_VIRTIO_NET_RX_BUFS
 
 /*
  * This value comes from the VirtIO spec: 1500 for maximum packet size,
@@ -36,15 +36,21 @@ struct virtio_net_priv {
 };
 
 /*
- * For simplicity, the driver only negotiates the VIRTIO_NET_F_MAC feature.
- * For the VIRTIO_NET_F_STATUS feature, we don't negotiate it, hence per spec
- * we should assume the link is always active.
+ * For simplicity, the driver only negotiates the VIRTIO_NET_F_MAC feature
+ * and the checksum offloads. For the VIRTIO_NET_F_STATUS feature, we don't
+ * negotiate it, hence per spec we should assume the link is always active.
+ * With VIRTIO_NET_F_GUEST_CSUM the host may pass on packets with a partial
+ * checksum, which recv() finishes.
  */
 static const u32 feature[] = {
+	VIRTIO_NET_F_CSUM,
+	VIRTIO_NET_F_GUEST_CSUM,
 	VIRTIO_NET_F_MAC
 };
 
 static const u32 feature_legacy[] = {
+	VIRTIO_NET_F_CSUM,
+	VIRTIO_NET_F_GUEST_CSUM,
 	VIRTIO_NET_F_MAC
 };
 
@@ -74,25 +80,42 @@ static int virtio_net_start(struct udevice *dev)
 	return 0;
 }
 
-static int virtio_net_send(struct udevice *dev, void *packet, int length)
+static int virtio_net_send_sg(struct udevice *dev, const struct eth_sg *sg,
+			      int count)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
-	struct virtio_net_hdr hdr;
-	struct virtio_net_hdr_v1 hdr_v1;
-	struct virtio_sg hdr_sg;
-	struct virtio_sg data_sg = { packet, length };
-	struct virtio_sg *sgs[] = { &hdr_sg, &data_sg };
+	struct eth_pdata *pdata = dev_get_plat(dev);
+	/* The legacy header is the same, only without num_buffers */
+	struct virtio_net_hdr_v1 hdr;
+	struct virtio_sg data_sg[1 + ETH_SG_MAX];
+	struct virtio_sg *sgs[1 + ETH_SG_MAX];
+	int length = 0;
+	int start, offset;
 	int ret;
+	int i;
 
-	if (priv->net_hdr_len == sizeof(struct virtio_net_hdr))
-		hdr_sg.addr = &hdr;
-	else
-		hdr_sg.addr = &hdr_v1;
-	hdr_sg.length = priv->net_hdr_len;
+	memset(&hdr, 0, sizeof(hdr));
+	data_sg[0].addr = &hdr;
+	data_sg[0].length = priv->net_hdr_len;
+	sgs[0] = &data_sg[0];
+	for (i = 0; i < count; i++) {
+		data_sg[1 + i].addr = (void *)sg[i].addr;
+		data_sg[1 + i].length = sg[i].length;
+		sgs[1 + i] = &data_sg[1 + i];
+		length += sg[i].length;
+	}
 
-	memset(hdr_sg.addr, 0, priv->net_hdr_len);
+	/* The first buffer holds all the headers */
+	if (pdata->features & ETH_FEAT_TX_CSUM) {
+		start = eth_get_tx_csum(sg[0].addr, sg[0].length, &offset);
+		if (start >= 0) {
+			hdr.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+			hdr.csum_start = cpu_to_virtio16(dev, start);
+			hdr.csum_offset = cpu_to_virtio16(dev, offset);
+		}
+	}
 
-	ret = virtqueue_add(priv->tx_vq, sgs, 2, 0);
+	ret = virtqueue_add(priv->tx_vq, sgs, 1 + count, 0);
 	if (ret)
 		return ret;
 
@@ -106,18 +129,47 @@ static int virtio_net_send(struct udevice *dev, void *packet, int length)
 	return 0;
 }
 
+static int virtio_net_send(struct udevice *dev, void *packet, int length)
+{
+	struct eth_sg sg = { packet, length };
+
+	return virtio_net_send_sg(dev, &sg, 1);
+}
+
 static int virtio_net_recv(struct udevice *dev, int flags, uchar **packetp)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
-	unsigned int len;
+	struct virtio_net_hdr_v1 *hdr;
+	unsigned int len, start, offset;
+	uchar *packet;
 	void *buf;
 
 	buf = virtqueue_get_buf(priv->rx_vq, &len);
 	if (!buf)
 		return -EAGAIN;
+	packet = buf + priv->net_hdr_len;
+	len -= priv->net_hdr_len;
+
+	hdr = buf;
+	if (hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) {
+		/*
+		 * The checksum only holds the pseudo-header sum. Finish it,
+		 * since the packet may be passed on as it is, e.g. to EFI
+		 * applications. A bad one is left for the stack to drop.
+		 */
+		start = virtio16_to_cpu(dev, hdr->csum_start);
+		offset = virtio16_to_cpu(dev, hdr->csum_offset);
+		if (!(start & 1) && start + offset + 2 <= len) {
+			ip_checksum_complete(packet + start, len - start,
+					     offset);
+			eth_set_rx_csum_ok(dev);
+		}
+	} else if (hdr->flags & VIRTIO_NET_HDR_F_DATA_VALID) {
+		eth_set_rx_csum_ok(dev);
+	}
 
-	*packetp = buf + priv->net_hdr_len;
-	return len - priv->net_hdr_len;
+	*packetp = packet;
+	return len;
 }
 
 static int virtio_net_free_pkt(struct udevice *dev, uchar *packet, int length)
@@ -195,6 +247,7 @@ static int virtio_net_probe(struct udevice *dev)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
 	struct virtio_dev_priv *uc_priv = dev_get_uclass_priv(dev->parent);
+	struct eth_pdata *pdata = dev_get_plat(dev);
 	int ret;
 
 	ret = virtio_find_vqs(dev, 2, priv->vqs);
@@ -213,6 +266,12 @@ static int virtio_net_probe(struct udevice *dev)
 	else
 		priv->net_hdr_len = sizeof(struct virtio_net_hdr_v1);
 
+	pdata->features = ETH_FEAT_SG;
+	if (virtio_has_feature(dev, VIRTIO_NET_F_CSUM))
+		pdata->features |= ETH_FEAT_TX_CSUM;
+	if (virtio_has_feature(dev, VIRTIO_NET_F_GUEST_CSUM))
+		pdata->features |= ETH_FEAT_RX_CSUM;
+
 	return 0;
 }
 
@@ -224,6 +283,7 @@ static const struct eth_ops virtio_net_ops = {
 	.stop = virtio_net_stop,
 	.write_hwaddr = virtio_net_write_hwaddr,
 	.read_rom_hwaddr = virtio_net_read_rom_hwaddr,
+	.send_sg = virtio_net_send_sg,
 };
 
 U_BOOT_DRIVER(virtio_net) = {
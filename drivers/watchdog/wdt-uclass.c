@@ -8,6 +8,7 @@
 #include <errno.h>
 #include <hang.h>
 #include <log.h>
+#include <smp_job.h>
 #include <time.h>
 #include <wdt.h>
 #include <asm/global_data.h>
@@ -146,6 +147,10 @@ void watchdog_reset(void)
 	if (!gd || !(gd->flags & GD_FLG_WDT_READY))
 		return;
 
+	/* Leave the watchdog device to the boot CPU */
+	if (smp_job_cpu())
+		return;
+
 	/* Do not reset the watchdog too often */
 	now = get_timer(0);
 	if (time_after_eq(now, next_reset)) {
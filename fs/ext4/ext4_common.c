@@ -1995,6 +1995,219 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock,
 	return blknr;
 }
 
+/* Extents longer than this are unwritten and read back as zeroes */
+#define EXT_INIT_MAX_LEN	(1U << 15)
+
+/* Extent trees are at most this deep, which bounds the recursion */
+#define EXT4_MAX_EXTENT_DEPTH	5
+
+/* A run of file blocks which are contiguous on disk */
+struct ext4_extent_run {
+	uint32_t fileblock;
+	uint32_t len;
+	uint64_t start;
+};
+
+/* The decoded extents of a file, sorted by file block */
+struct ext4_extent_map {
+	struct ext4_extent_run *runs;
+	int count;
+	int alloced;
+};
+
+static int ext4fs_add_extent_run(struct ext4_extent_map *map,
+				 uint32_t fileblock, uint32_t len,
+				 uint64_t start)
+{
+	struct ext4_extent_run *run;
+
+	if (map->count) {
+		run = &map->runs[map->count - 1];
+		if (fileblock < run->fileblock + run->len)
+			return -EINVAL;
+
+		/* Merge with the previous run if it carries on from it */
+		if (run->fileblock + run->len == fileblock &&
+		    run->start + run->len == start) {
+			run->len += len;
+			return 0;
+		}
+	}
+
+	if (map->count == map->alloced) {
+		int alloced = map->alloced ? map->alloced * 2 : 16;
+
+		run = realloc(map->runs, alloced * sizeof(*run));
+		if (!run)
+			return -ENOMEM;
+		map->runs = run;
+		map->alloced = alloced;
+	}
+
+	run = &map->runs[map->count++];
+	run->fileblock = fileblock;
+	run->len = len;
+	run->start = start;
+
+	return 0;
+}
+
+static int ext4fs_walk_extents(struct ext4_extent_map *map,
+			       struct ext4_extent_header *ext_block, int depth)
+{
+	int blksz = EXT2_BLOCK_SIZE(ext4fs_root);
+	int log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root) -
+		get_fs()->dev_desc->log2blksz;
+	struct ext4_extent_idx *index;
+	struct ext4_extent *extent;
+	unsigned long long block;
+	int entries, i, ret = 0;
+	uint32_t len;
+	char *buf;
+
+	entries = le16_to_cpu(ext_block->eh_entries);
+	if (le16_to_cpu(ext_block->eh_magic) != EXT4_EXT_MAGIC ||
+	    le16_to_cpu(ext_block->eh_depth) != depth ||
+	    entries > le16_to_cpu(ext_block->eh_max))
+		return -EINVAL;
+
+	if (!depth) {
+		extent = (struct ext4_extent *)(ext_block + 1);
+		for (i = 0; i < entries; i++) {
+			len = le16_to_cpu(extent[i].ee_len);
+			if (len > EXT_INIT_MAX_LEN)
+				continue;
+			block = le16_to_cpu(extent[i].ee_start_hi);
+			block = (block << 32) +
+				le32_to_cpu(extent[i].ee_start_lo);
+			ret = ext4fs_add_extent_run(map,
+					le32_to_cpu(extent[i].ee_block),
+					len, block);
+			if (ret)
+				return ret;
+		}
+
+		return 0;
+	}
+
+	buf = zalloc(blksz);
+	if (!buf)
+		return -ENOMEM;
+
+	index = (struct ext4_extent_idx *)(ext_block + 1);
+	for (i = 0; i < entries; i++) {
+		block = le16_to_cpu(index[i].ei_leaf_hi);
+		block = (block << 32) + le32_to_cpu(index[i].ei_leaf_lo);
+		if (!ext4fs_devread((lbaint_t)block << log2_blksz, 0, blksz,
+				    buf)) {
+			ret = -EIO;
+			break;
+		}
+		ret = ext4fs_walk_extents(map,
+					  (struct ext4_extent_header *)buf,
+					  depth - 1);
+		if (ret)
+			break;
+	}
+	free(buf);
+
+	return ret;
+}
+
+static int ext4fs_read_extent_map(struct ext2fs_node *node)
+{
+	struct ext4_extent_header *ext_block;
+	struct ext4_extent_map *map;
+	int depth, ret;
+
+	map = calloc(1, sizeof(*map));
+	if (!map)
+		return -ENOMEM;
+
+	ext_block = (struct ext4_extent_header *)node->inode.b.blocks.dir_blocks;
+	depth = le16_to_cpu(ext_block->eh_depth);
+	if (depth > EXT4_MAX_EXTENT_DEPTH)
+		ret = -EINVAL;
+	else
+		ret = ext4fs_walk_extents(map, ext_block, depth);
+	if (ret) {
+		printf("invalid extent block\n");
+		free(map->runs);
+		free(map);
+		return ret;
+	}
+	debug("ext4fs inode %d: %d extent runs\n", node->ino, map->count);
+	node->extents = map;
+
+	return 0;
+}
+
+void ext4fs_free_extent_map(struct ext2fs_node *node)
+{
+	if (node->extents) {
+		free(node->extents->runs);
+		free(node->extents);
+		node->extents = NULL;
+	}
+}
+
+int ext4fs_map_blocks(struct ext2fs_node *node, uint32_t fileblock,
+		      uint32_t max, uint64_t *pblk)
+{
+	struct ext4_extent_map *map;
+	struct ext4_extent_run *run;
+	long int blknr, next;
+	int lo, hi, mid, ret;
+	uint32_t n;
+
+	if (le32_to_cpu(node->inode.flags) & EXT4_EXTENTS_FL) {
+		if (!node->extents) {
+			ret = ext4fs_read_extent_map(node);
+			if (ret)
+				return ret;
+		}
+		map = node->extents;
+
+		/* Find the first run which ends after fileblock */
+		lo = 0;
+		hi = map->count;
+		while (lo < hi) {
+			mid = (lo + hi) / 2;
+			run = &map->runs[mid];
+			if (run->fileblock + run->len <= fileblock)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == map->count) {
+			*pblk = 0;
+			return max;
+		}
+
+		run = &map->runs[lo];
+		if (fileblock < run->fileblock) {
+			*pblk = 0;
+			return min(run->fileblock - fileblock, max);
+		}
+		*pblk = run->start + fileblock - run->fileblock;
+
+		return min(run->fileblock + run->len - fileblock, max);
+	}
+
+	/* Indirect blocks: the lookups are cheap as the blocks are cached */
+	blknr = read_allocated_block(&node->inode, fileblock, NULL);
+	if (blknr < 0)
+		return -EIO;
+	for (n = 1; n < max; n++) {
+		next = read_allocated_block(&node->inode, fileblock + n, NULL);
+		if (next < 0 || next != (blknr ? blknr + n : 0))
+			break;
+	}
+	*pblk = blknr;
+
+	return n;
+}
+
 /**
  * ext4fs_reinit_global() - Reinitialize values of ext4 write implementation's
  *			    global pointers
@@ -2035,6 +2248,7 @@ void ext4fs_close(void)
 		ext4fs_file = NULL;
 	}
 	if (ext4fs_root != NULL) {
+		ext4fs_free_extent_map(&ext4fs_root->diropen);
 		free(ext4fs_root);
 		ext4fs_root = NULL;
 	}
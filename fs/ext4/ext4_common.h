@@ -50,6 +50,22 @@ static inline void *zalloc(size_t size)
 
 int ext4fs_read_inode(struct ext2_data *data, int ino,
 		      struct ext2_inode *inode);
+/**
+ * ext4fs_map_blocks() - Find the physical blocks behind some file blocks
+ *
+ * This finds the run of blocks starting at @fileblock which are either
+ * contiguous on disk or all in a hole. For extent-mapped files the extent
+ * tree is decoded on first use and kept in @node until it is freed.
+ *
+ * @node: File to look in
+ * @fileblock: First logical block in the file
+ * @max: Maximum number of blocks to return
+ * @pblk: Returns the first physical block, or 0 for a hole
+ * Return: number of blocks in the run (at least 1), or -ve on error
+ */
+int ext4fs_map_blocks(struct ext2fs_node *node, uint32_t fileblock,
+		      uint32_t max, uint64_t *pblk);
+void ext4fs_free_extent_map(struct ext2fs_node *node);
 int ext4fs_read_file(struct ext2fs_node *node, loff_t pos, loff_t len,
 		     char *buf, loff_t *actread);
 int ext4fs_find_file(const char *path, struct ext2fs_node *rootnode,
@@ -11,6 +11,7 @@
 #include <common.h>
 #include <blk.h>
 #include <config.h>
+#include <div64.h>
 #include <exports.h>
 #include <fat.h>
 #include <fs.h>
@@ -307,6 +308,74 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(FS_FAT_RUN_CACHE)
+/**
+ * struct fat_run - run of contiguous clusters in a file
+ *
+ * @clust:	first cluster of the run
+ * @count:	number of clusters in the run
+ */
+struct fat_run {
+	__u32 clust;
+	__u32 count;
+};
+
+/**
+ * fat_get_runs() - decode a cluster chain into runs of contiguous clusters
+ *
+ * Follow the chain from @clust for @nclust clusters, merging consecutive
+ * clusters into runs, so that each run can be read in one go.
+ *
+ * @mydata:	file system description
+ * @clust:	first cluster of the chain
+ * @nclust:	number of clusters to decode
+ * @runsp:	returns the runs, which must be freed by the caller
+ * Return:	number of runs, or -1 on error
+ */
+static int fat_get_runs(fsdata *mydata, __u32 clust, __u32 nclust,
+			struct fat_run **runsp)
+{
+	struct fat_run *runs = NULL, *run = NULL;
+	int nruns = 0, alloced = 0;
+	__u32 i;
+
+	for (i = 0; i < nclust; i++) {
+		if (i)
+			clust = get_fatent(mydata, clust);
+		if (CHECK_CLUST(clust, mydata->fatsize)) {
+			debug("curclust: 0x%x\n", clust);
+			printf("Invalid FAT entry\n");
+			goto err;
+		}
+
+		if (run && run->clust + run->count == clust) {
+			run->count++;
+			continue;
+		}
+		if (nruns == alloced) {
+			alloced = alloced ? alloced * 2 : 16;
+			run = realloc(runs, alloced * sizeof(*runs));
+			if (!run) {
+				debug("Error: allocating runs\n");
+				goto err;
+			}
+			runs = run;
+		}
+		run = &runs[nruns++];
+		run->clust = clust;
+		run->count = 1;
+	}
+	debug("%u clusters in %d runs\n", nclust, nruns);
+	*runsp = runs;
+
+	return nruns;
+err:
+	free(runs);
+
+	return -1;
+}
+#endif
+
 /**
  * get_contents() - read from file
  *
@@ -322,6 +391,91 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
  * @gotsize:	number of bytes actually read
  * Return:	-1 on error, otherwise 0
  */
+#if CONFIG_IS_ENABLED(FS_FAT_RUN_CACHE)
+static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
+			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
+{
+	loff_t filesize = FAT2CPU32(dentptr->size);
+	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
+	struct fat_run *runs, *run;
+	__u32 clust, count, skip;
+	loff_t actsize, offset;
+	__u8 *tmp_buffer;
+	int nruns;
+
+	*gotsize = 0;
+	debug("Filesize: %llu bytes\n", filesize);
+
+	if (pos >= filesize) {
+		debug("Read position past EOF: %llu\n", pos);
+		return 0;
+	}
+
+	if (maxsize > 0 && filesize > pos + maxsize)
+		filesize = pos + maxsize;
+
+	nruns = fat_get_runs(mydata, START(dentptr),
+			     lldiv(filesize + bytesperclust - 1, bytesperclust),
+			     &runs);
+	if (nruns < 0)
+		return -1;
+
+	skip = lldiv(pos, bytesperclust);
+	offset = pos - (loff_t)skip * bytesperclust;
+
+	for (run = runs; run < runs + nruns && pos < filesize; run++) {
+		if (skip >= run->count) {
+			skip -= run->count;
+			continue;
+		}
+		clust = run->clust + skip;
+		count = run->count - skip;
+		skip = 0;
+
+		/* read a partial first cluster through a bounce buffer */
+		if (offset) {
+			actsize = min(filesize - pos + offset,
+				      (loff_t)bytesperclust);
+			tmp_buffer = malloc_cache_aligned(actsize);
+			if (!tmp_buffer) {
+				debug("Error: allocating buffer\n");
+				goto err;
+			}
+			if (get_cluster(mydata, clust, tmp_buffer, actsize)) {
+				free(tmp_buffer);
+				goto err_read;
+			}
+			actsize -= offset;
+			memcpy(buffer, tmp_buffer + offset, actsize);
+			free(tmp_buffer);
+			buffer += actsize;
+			pos += actsize;
+			*gotsize += actsize;
+			offset = 0;
+			clust++;
+			if (!--count || pos >= filesize)
+				continue;
+		}
+
+		actsize = min((loff_t)count * bytesperclust, filesize - pos);
+		if (get_cluster(mydata, clust, buffer, actsize))
+			goto err_read;
+		buffer += actsize;
+		pos += actsize;
+		*gotsize += actsize;
+	}
+	free(runs);
+
+	return 0;
+
+err_read:
+	printf("Error reading cluster\n");
+err:
+	free(runs);
+
+	return -1;
+}
+#else
 static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
 {
@@ -440,6 +594,7 @@ getit:
 		endclust = curclust;
 	} while (1);
 }
+#endif
 
 /*
  * Extract the file name information from 'slotptr' into 'l_name',
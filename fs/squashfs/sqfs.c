@@ -23,7 +23,24 @@
 #include "sqfs_filesystem.h"
 #include "sqfs_utils.h"
 
-static struct squashfs_ctxt ctxt;
+static struct squashfs_ctxt ctxt = {
+	.cache = LIST_HEAD_INIT(ctxt.cache),
+};
+
+/**
+ * struct sqfs_cache_entry - decompressed block held in the block cache
+ *
+ * @list:	node in ctxt.cache
+ * @start:	byte offset of the block's data on the device, used as key
+ * @len:	size of the decompressed data
+ * @data:	decompressed data
+ */
+struct sqfs_cache_entry {
+	struct list_head list;
+	u64 start;
+	u32 len;
+	unsigned char data[];
+};
 
 static int sqfs_disk_read(__u32 block, __u32 nr_blocks, void *buf)
 {
@@ -92,46 +109,190 @@ static int sqfs_calc_n_blks(__le64 start, __le64 end, u64 *offset)
 	return DIV_ROUND_UP(table_size + *offset, ctxt.cur_dev->blksz);
 }
 
+static void *sqfs_cache_lookup(u64 start, u32 *len)
+{
+	struct sqfs_cache_entry *entry;
+
+	list_for_each_entry(entry, &ctxt.cache, list) {
+		if (entry->start == start) {
+			list_move(&entry->list, &ctxt.cache);
+			*len = entry->len;
+			return entry->data;
+		}
+	}
+
+	return NULL;
+}
+
+/* Adds an entry to the cache, evicting the least recently used ones */
+static void sqfs_cache_add(struct sqfs_cache_entry *new)
+{
+	struct sqfs_cache_entry *entry;
+
+	list_add(&new->list, &ctxt.cache);
+	ctxt.cache_used += new->len;
+
+	while (ctxt.cache_used > CONFIG_SQUASHFS_CACHE_SIZE * 1024) {
+		entry = list_last_entry(&ctxt.cache, struct sqfs_cache_entry,
+					list);
+		if (entry == new)
+			break;
+		list_del(&entry->list);
+		ctxt.cache_used -= entry->len;
+		free(entry);
+	}
+}
+
+static void sqfs_cache_free(void)
+{
+	struct sqfs_cache_entry *entry, *next;
+
+	list_for_each_entry_safe(entry, next, &ctxt.cache, list) {
+		list_del(&entry->list);
+		free(entry);
+	}
+	ctxt.cache_used = 0;
+}
+
 /*
- * Retrieves fragment block entry and returns true if the fragment block is
- * compressed
+ * Returns the decompressed content of the 'size' bytes at byte offset 'start'
+ * on the device, going through the block cache. The result is valid until the
+ * next call, which may evict it.
  */
-static int sqfs_frag_lookup(u32 inode_fragment_index,
-			    struct squashfs_fragment_block_entry *e)
+static void *sqfs_cache_read(u64 start, u32 size, bool compressed,
+			     u32 max_len, u32 *len)
 {
-	u64 start, n_blks, src_len, table_offset, start_block;
-	unsigned char *metadata_buffer, *metadata, *table;
-	struct squashfs_fragment_block_entry *entries;
-	struct squashfs_super_block *sblk = ctxt.sblk;
+	struct sqfs_cache_entry *entry;
+	u64 blk, n_blks, offset;
 	unsigned long dest_len;
-	int block, offset, ret;
-	u16 header;
+	unsigned char *buffer;
+	void *data;
+	int ret;
 
-	metadata_buffer = NULL;
-	entries = NULL;
-	table = NULL;
+	data = sqfs_cache_lookup(start, len);
+	if (data)
+		return data;
 
-	if (inode_fragment_index >= get_unaligned_le32(&sblk->fragments))
-		return -EINVAL;
+	if (size > max_len && !compressed)
+		return NULL;
+
+	blk = start / ctxt.cur_dev->blksz;
+	offset = start - blk * ctxt.cur_dev->blksz;
+	n_blks = DIV_ROUND_UP(size + offset, ctxt.cur_dev->blksz);
+
+	buffer = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
+	if (!buffer)
+		return NULL;
+
+	entry = malloc(sizeof(*entry) + max_len);
+	if (!entry)
+		goto out;
+
+	if (sqfs_disk_read(blk, n_blks, buffer) < 0)
+		goto out;
+
+	if (compressed) {
+		dest_len = max_len;
+		ret = sqfs_decompress(&ctxt, entry->data, &dest_len,
+				      buffer + offset, size);
+		if (ret)
+			goto out;
+	} else {
+		memcpy(entry->data, buffer + offset, size);
+		dest_len = size;
+	}
+	free(buffer);
+
+	/* Fragment blocks at the end of the image are often short */
+	if (dest_len < max_len) {
+		data = realloc(entry, sizeof(*entry) + dest_len);
+		if (data)
+			entry = data;
+	}
+	entry->start = start;
+	entry->len = dest_len;
+	sqfs_cache_add(entry);
+	*len = dest_len;
+
+	return entry->data;
+
+out:
+	free(entry);
+	free(buffer);
+
+	return NULL;
+}
 
+/* Reads the fragment index table, i.e. the fragment entries' locations */
+static int sqfs_read_frag_index(void)
+{
+	struct squashfs_super_block *sblk = ctxt.sblk;
+	u64 start, n_blks, table_offset;
+	unsigned char *table;
+	u32 count;
+	int ret = 0;
+
+	count = SQFS_FRAGMENT_INDEX(get_unaligned_le32(&sblk->fragments) - 1) +
+		1;
 	start = get_unaligned_le64(&sblk->fragment_table_start) /
 		ctxt.cur_dev->blksz;
 	n_blks = sqfs_calc_n_blks(sblk->fragment_table_start,
 				  sblk->export_table_start,
 				  &table_offset);
+	if (table_offset + count * sizeof(u64) >
+	    n_blks * ctxt.cur_dev->blksz)
+		return -EINVAL;
 
 	/* Allocate a proper sized buffer to store the fragment index table */
 	table = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
-	if (!table) {
+	if (!table)
+		return -ENOMEM;
+
+	ctxt.frag_index = malloc(count * sizeof(u64));
+	if (!ctxt.frag_index) {
 		ret = -ENOMEM;
 		goto out;
 	}
 
 	if (sqfs_disk_read(start, n_blks, table) < 0) {
+		free(ctxt.frag_index);
+		ctxt.frag_index = NULL;
 		ret = -EINVAL;
 		goto out;
 	}
 
+	memcpy(ctxt.frag_index, table + table_offset, count * sizeof(u64));
+
+out:
+	free(table);
+
+	return ret;
+}
+
+/*
+ * Retrieves fragment block entry and returns true if the fragment block is
+ * compressed
+ */
+static int sqfs_frag_lookup(u32 inode_fragment_index,
+			    struct squashfs_fragment_block_entry *e)
+{
+	struct squashfs_fragment_block_entry *entries;
+	struct squashfs_super_block *sblk = ctxt.sblk;
+	u64 start, n_blks, table_offset, start_block;
+	unsigned char *header_buffer;
+	int block, offset, ret;
+	u32 len;
+	u16 header;
+
+	if (inode_fragment_index >= get_unaligned_le32(&sblk->fragments))
+		return -EINVAL;
+
+	if (!ctxt.frag_index) {
+		ret = sqfs_read_frag_index();
+		if (ret)
+			return ret;
+	}
+
 	block = SQFS_FRAGMENT_INDEX(inode_fragment_index);
 	offset = SQFS_FRAGMENT_INDEX_OFFSET(inode_fragment_index);
 
@@ -139,61 +300,45 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 	 * Get the start offset of the metadata block that contains the right
 	 * fragment block entry
 	 */
-	start_block = get_unaligned_le64(table + table_offset + block *
-					 sizeof(u64));
+	start_block = get_unaligned_le64(&ctxt.frag_index[block]);
 
-	start = start_block / ctxt.cur_dev->blksz;
-	n_blks = sqfs_calc_n_blks(cpu_to_le64(start_block),
-				  sblk->fragment_table_start, &table_offset);
+	entries = sqfs_cache_lookup(start_block + SQFS_HEADER_SIZE, &len);
+	if (!entries) {
+		/* Every metadata block starts with a 16-bit header */
+		start = start_block / ctxt.cur_dev->blksz;
+		table_offset = start_block - start * ctxt.cur_dev->blksz;
+		n_blks = DIV_ROUND_UP(table_offset + SQFS_HEADER_SIZE,
+				      ctxt.cur_dev->blksz);
 
-	metadata_buffer = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
-	if (!metadata_buffer) {
-		ret = -ENOMEM;
-		goto out;
-	}
+		header_buffer = malloc_cache_aligned(n_blks *
+						     ctxt.cur_dev->blksz);
+		if (!header_buffer)
+			return -ENOMEM;
 
-	if (sqfs_disk_read(start, n_blks, metadata_buffer) < 0) {
-		ret = -EINVAL;
-		goto out;
-	}
-
-	/* Every metadata block starts with a 16-bit header */
-	header = get_unaligned_le16(metadata_buffer + table_offset);
-	metadata = metadata_buffer + table_offset + SQFS_HEADER_SIZE;
+		if (sqfs_disk_read(start, n_blks, header_buffer) < 0) {
+			free(header_buffer);
+			return -EINVAL;
+		}
+		header = get_unaligned_le16(header_buffer + table_offset);
+		free(header_buffer);
 
-	if (!metadata || !header) {
-		ret = -ENOMEM;
-		goto out;
-	}
+		if (!header)
+			return -EINVAL;
 
-	entries = malloc(SQFS_METADATA_BLOCK_SIZE);
-	if (!entries) {
-		ret = -ENOMEM;
-		goto out;
+		entries = sqfs_cache_read(start_block + SQFS_HEADER_SIZE,
+					  SQFS_METADATA_SIZE(header),
+					  SQFS_COMPRESSED_METADATA(header),
+					  SQFS_METADATA_BLOCK_SIZE, &len);
+		if (!entries)
+			return -EINVAL;
 	}
 
-	if (SQFS_COMPRESSED_METADATA(header)) {
-		src_len = SQFS_METADATA_SIZE(header);
-		dest_len = SQFS_METADATA_BLOCK_SIZE;
-		ret = sqfs_decompress(&ctxt, entries, &dest_len, metadata,
-				      src_len);
-		if (ret) {
-			ret = -EINVAL;
-			goto out;
-		}
-	} else {
-		memcpy(entries, metadata, SQFS_METADATA_SIZE(header));
-	}
+	if ((offset + 1) * sizeof(*entries) > len)
+		return -EINVAL;
 
 	*e = entries[offset];
-	ret = SQFS_COMPRESSED_BLOCK(e->size);
-
-out:
-	free(entries);
-	free(metadata_buffer);
-	free(table);
 
-	return ret;
+	return SQFS_COMPRESSED_BLOCK(e->size);
 }
 
 /*
@@ -868,13 +1013,59 @@ out:
 	return metablks_count;
 }
 
+static void sqfs_put_metadata(struct squashfs_metadata *meta)
+{
+	if (!meta || --meta->refcount)
+		return;
+
+	free(meta->inode_table);
+	free(meta->dir_table);
+	free(meta->pos_list);
+	free(meta);
+}
+
+/*
+ * Returns the decompressed inode and directory tables, which are only read
+ * once per mount. The caller gets a reference to drop with
+ * sqfs_put_metadata().
+ */
+static struct squashfs_metadata *sqfs_get_metadata(void)
+{
+	struct squashfs_metadata *meta = ctxt.meta;
+
+	if (!meta) {
+		meta = calloc(1, sizeof(*meta));
+		if (!meta)
+			return NULL;
+		meta->refcount = 1;
+
+		if (sqfs_read_inode_table(&meta->inode_table))
+			goto err;
+
+		meta->metablks_count =
+			sqfs_read_directory_table(&meta->dir_table,
+						  &meta->pos_list);
+		if (meta->metablks_count < 1)
+			goto err;
+
+		ctxt.meta = meta;
+	}
+	meta->refcount++;
+
+	return meta;
+
+err:
+	sqfs_put_metadata(meta);
+
+	return NULL;
+}
+
 int sqfs_opendir(const char *filename, struct fs_dir_stream **dirsp)
 {
-	unsigned char *inode_table = NULL, *dir_table = NULL;
-	int j, token_count = 0, ret = 0, metablks_count;
+	int j, token_count = 0, ret = 0;
 	struct squashfs_dir_stream *dirs;
 	char **token_list = NULL, *path = NULL;
-	u32 *pos_list = NULL;
+	struct squashfs_metadata *meta;
 
 	dirs = malloc(sizeof(*dirs));
 	if (!dirs)
@@ -887,17 +1078,12 @@ int sqfs_opendir(const char *filename, struct fs_dir_stream **dirsp)
 	dirs->inode_table = NULL;
 	dirs->dir_table = NULL;
 
-	ret = sqfs_read_inode_table(&inode_table);
-	if (ret) {
-		ret = -EINVAL;
-		goto out;
-	}
-
-	metablks_count = sqfs_read_directory_table(&dir_table, &pos_list);
-	if (metablks_count < 1) {
-		ret = -EINVAL;
-		goto out;
+	meta = sqfs_get_metadata();
+	if (!meta) {
+		free(dirs);
+		return -EINVAL;
 	}
+	dirs->meta = meta;
 
 	/* Tokenize filename */
 	token_count = sqfs_count_tokens(filename);
@@ -926,10 +1112,10 @@ int sqfs_opendir(const char *filename, struct fs_dir_stream **dirsp)
 	 * ldir's (extended directory) size is greater than dir, so it works as
 	 * a general solution for the malloc size, since 'i' is a union.
 	 */
-	dirs->inode_table = inode_table;
-	dirs->dir_table = dir_table;
-	ret = sqfs_search_dir(dirs, token_list, token_count, pos_list,
-			      metablks_count);
+	dirs->inode_table = meta->inode_table;
+	dirs->dir_table = meta->dir_table;
+	ret = sqfs_search_dir(dirs, token_list, token_count, meta->pos_list,
+			      meta->metablks_count);
 	if (ret)
 		goto out;
 
@@ -953,10 +1139,9 @@ out:
 	for (j = 0; j < token_count; j++)
 		free(token_list[j]);
 	free(token_list);
-	free(pos_list);
 	free(path);
 	if (ret) {
-		free(inode_table);
+		sqfs_put_metadata(meta);
 		free(dirs);
 	}
 
@@ -1309,7 +1494,7 @@ int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
 	      loff_t *actread)
 {
 	char *dir = NULL, *fragment_block, *datablock = NULL, *data_buffer = NULL;
-	char *fragment = NULL, *file = NULL, *resolved, *data;
+	char *file = NULL, *resolved, *data;
 	u64 start, n_blks, table_size, data_offset, table_offset, sparse_size;
 	int ret, j, i_number, datablk_count = 0;
 	struct squashfs_super_block *sblk = ctxt.sblk;
@@ -1322,6 +1507,7 @@ int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
 	struct squashfs_base_inode *base;
 	struct squashfs_reg_inode *reg;
 	unsigned long dest_len;
+	u32 frag_len;
 	struct fs_dirent *dent;
 	unsigned char *ipos;
 
@@ -1509,62 +1695,32 @@ int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
 	/*
 	 * There is no need to continue if the file is not fragmented.
 	 */
-	if (!finfo.frag) {
+	if (!finfo.frag || *actread >= finfo.size) {
 		ret = 0;
 		goto out;
 	}
 
-	start = frag_entry.start / ctxt.cur_dev->blksz;
-	table_size = SQFS_BLOCK_SIZE(frag_entry.size);
-	table_offset = frag_entry.start - (start * ctxt.cur_dev->blksz);
-	n_blks = DIV_ROUND_UP(table_size + table_offset, ctxt.cur_dev->blksz);
-
-	fragment = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
-
-	if (!fragment) {
-		ret = -ENOMEM;
+	/*
+	 * The fragment block holds the tail of the file, and is likely shared
+	 * with other small files
+	 */
+	fragment_block = sqfs_cache_read(frag_entry.start,
+					 SQFS_BLOCK_SIZE(frag_entry.size),
+					 SQFS_COMPRESSED_BLOCK(frag_entry.size),
+					 get_unaligned_le32(&sblk->block_size),
+					 &frag_len);
+	if (!fragment_block ||
+	    finfo.offset + finfo.size - *actread > frag_len) {
+		ret = -EINVAL;
 		goto out;
 	}
 
-	ret = sqfs_disk_read(start, n_blks, fragment);
-	if (ret < 0)
-		goto out;
-
-	/* File compressed and fragmented */
-	if (finfo.frag && finfo.comp) {
-		dest_len = get_unaligned_le32(&sblk->block_size);
-		fragment_block = malloc(dest_len);
-		if (!fragment_block) {
-			ret = -ENOMEM;
-			goto out;
-		}
-
-		ret = sqfs_decompress(&ctxt, fragment_block, &dest_len,
-				      (void *)fragment  + table_offset,
-				      frag_entry.size);
-		if (ret) {
-			free(fragment_block);
-			goto out;
-		}
-
-		for (j = *actread; j < finfo.size; j++) {
-			memcpy(buf + j, &fragment_block[finfo.offset + j], 1);
-			(*actread)++;
-		}
-
-		free(fragment_block);
-
-	} else if (finfo.frag && !finfo.comp) {
-		fragment_block = (void *)fragment + table_offset;
-
-		for (j = *actread; j < finfo.size; j++) {
-			memcpy(buf + j, &fragment_block[finfo.offset + j], 1);
-			(*actread)++;
-		}
-	}
+	memcpy(buf + *actread, fragment_block + finfo.offset,
+	       finfo.size - *actread);
+	*actread = finfo.size;
+	ret = 0;
 
 out:
-	free(fragment);
 	if (datablk_count) {
 		free(data_buffer);
 		free(datablock);
@@ -1706,6 +1862,11 @@ free_strings:
 
 void sqfs_close(void)
 {
+	sqfs_put_metadata(ctxt.meta);
+	ctxt.meta = NULL;
+	free(ctxt.frag_index);
+	ctxt.frag_index = NULL;
+	sqfs_cache_free();
 	sqfs_decompressor_cleanup(&ctxt);
 	free(ctxt.sblk);
 	ctxt.sblk = NULL;
@@ -1720,8 +1881,7 @@ void sqfs_closedir(struct fs_dir_stream *dirs)
 		return;
 
 	sqfs_dirs = (struct squashfs_dir_stream *)dirs;
-	free(sqfs_dirs->inode_table);
-	free(sqfs_dirs->dir_table);
+	sqfs_put_metadata(sqfs_dirs->meta);
 	free(sqfs_dirs->dir_header);
 	free(sqfs_dirs);
 }
@@ -11,6 +11,7 @@
 #include <asm/unaligned.h>
 #include <fs.h>
 #include <part.h>
+#include <linux/list.h>
 #include <stdint.h>
 
 #define SQFS_UNCOMPRESSED_DATA 0x0002
@@ -73,6 +74,20 @@ struct squashfs_super_block {
 	__le64 export_table_start;
 };
 
+/*
+ * Decompressed inode and directory tables. They are shared by every lookup
+ * made while the filesystem is mounted, and by the directory streams opened
+ * meanwhile, which may outlive the mount.
+ */
+struct squashfs_metadata {
+	int refcount;
+	unsigned char *inode_table;
+	unsigned char *dir_table;
+	/* Positions of the directory table's metadata blocks */
+	u32 *pos_list;
+	int metablks_count;
+};
+
 struct squashfs_ctxt {
 	struct disk_partition cur_part_info;
 	struct blk_desc *cur_dev;
@@ -80,6 +95,14 @@ struct squashfs_ctxt {
 #if IS_ENABLED(CONFIG_ZSTD)
 	void *zstd_workspace;
 #endif
+	/* The items below are only valid until sqfs_close() */
+	struct squashfs_metadata *meta;
+	/* Fragment index table, i.e. the fragment entries' metadata blocks */
+	u64 *frag_index;
+	/* Decompressed metadata and fragment blocks, most recently used first */
+	struct list_head cache;
+	/* Total size of the blocks in the cache */
+	u32 cache_used;
 };
 
 struct squashfs_directory_index {
@@ -274,8 +297,10 @@ struct squashfs_dir_stream {
 	struct squashfs_ldir_inode i_ldir;
 	/*
 	 * References to the tables' beginnings. They are assigned in
-	 * sqfs_opendir() and freed in sqfs_closedir().
+	 * sqfs_opendir(), which takes a reference to 'meta', and released in
+	 * sqfs_closedir().
 	 */
+	struct squashfs_metadata *meta;
 	unsigned char *inode_table;
 	unsigned char *dir_table;
 };
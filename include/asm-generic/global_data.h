@@ -22,6 +22,7 @@
 #ifndef __ASSEMBLY__
 #include <fdtdec.h>
 #include <membuff.h>
+#include <dm/probe-times.h>
 #include <linux/list.h>
 
 struct acpi_ctx;
@@ -215,6 +216,26 @@ struct global_data {
 	 * @uclass_root_s.
 	 */
 	struct list_head *uclass_root;
+# if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+	/**
+	 * @dm_compat_index: compatible strings of all drivers, sorted so that
+	 * a devicetree node can be matched with a binary search
+	 */
+	struct dm_compat_index *dm_compat_index;
+# endif
+# if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	/**
+	 * @dm_lazy: devicetree nodes not bound yet, see &struct dm_lazy
+	 */
+	struct dm_lazy *dm_lazy;
+# endif
+# if CONFIG_IS_ENABLED(DM_PROBE_TIMES)
+	/**
+	 * @dm_times: device being bound or probed, for the times recorded
+	 * in each device
+	 */
+	struct dm_time_state dm_times;
+# endif
 # if CONFIG_IS_ENABLED(OF_PLATDATA_DRIVER_RT)
 	/** @dm_driver_rt: Dynamic info about the driver */
 	struct driver_rt *dm_driver_rt;
@@ -253,6 +274,18 @@ struct global_data {
 	 * @of_root: root node of the live tree
 	 */
 	struct device_node *of_root;
+	/**
+	 * @of_live_names: property names of the live tree, see
+	 * &struct of_live_names
+	 */
+	struct of_live_names *of_live_names;
+#endif
+#if CONFIG_IS_ENABLED(OF_INDEX)
+	/**
+	 * @of_index: phandles and recently used paths of @fdt_blob, see
+	 * &struct of_index
+	 */
+	struct of_index *of_index;
 #endif
 
 #if CONFIG_IS_ENABLED(MULTI_DTB_FIT)
@@ -487,10 +520,38 @@ struct global_data {
 #define gd_of_root()		gd->of_root
 #define gd_of_root_ptr()	&gd->of_root
 #define gd_set_of_root(_root)	gd->of_root = (_root)
+#define gd_of_live_names()	gd->of_live_names
+#define gd_set_of_live_names(_names)	gd->of_live_names = (_names)
 #else
 #define gd_of_root()		NULL
 #define gd_of_root_ptr()	NULL
 #define gd_set_of_root(_root)
+#define gd_of_live_names()	NULL
+#define gd_set_of_live_names(_names)
+#endif
+
+#if CONFIG_IS_ENABLED(OF_INDEX)
+#define gd_set_of_index(index)		gd->of_index = index
+#define gd_of_index()			gd->of_index
+#else
+#define gd_set_of_index(index)
+#define gd_of_index()			NULL
+#endif
+
+#if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+#define gd_set_dm_compat_index(index)	gd->dm_compat_index = index
+#define gd_dm_compat_index()		gd->dm_compat_index
+#else
+#define gd_set_dm_compat_index(index)
+#define gd_dm_compat_index()		NULL
+#endif
+
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+#define gd_set_dm_lazy(lazy)		gd->dm_lazy = lazy
+#define gd_dm_lazy()			gd->dm_lazy
+#else
+#define gd_set_dm_lazy(lazy)
+#define gd_dm_lazy()			NULL
 #endif
 
 #if CONFIG_IS_ENABLED(OF_PLATDATA_DRIVER_RT)
@@ -152,6 +152,31 @@ void blkcache_fill(int iftype, int dev,
 		   lbaint_t start, lbaint_t blkcnt,
 		   unsigned long blksz, void const *buffer);
 
+/**
+ * blkcache_window() - widen a read which missed the cache
+ *
+ * Small reads are widened to whole cache entries and, while the device is
+ * read sequentially, extended with read-ahead, so that following reads
+ * are served from the cache instead of by another transfer. The caller
+ * reads the window into the returned buffer and passes it to
+ * blkcache_fill().
+ *
+ * @param iftype - IF_TYPE_x for type of device
+ * @param dev - device index of particular type
+ * @param start - starting block number of the request
+ * @param blkcnt - number of blocks requested
+ * @param blksz - size in bytes of each block
+ * @param lba - number of blocks on the device
+ * @param wstart - returns the starting block number of the window
+ * @param wcnt - returns the number of blocks in the window
+ *
+ * @return - buffer for the window, or NULL to read the request as-is
+ */
+void *blkcache_window(int iftype, int dev,
+		      lbaint_t start, lbaint_t blkcnt,
+		      unsigned long blksz, lbaint_t lba,
+		      lbaint_t *wstart, lbaint_t *wcnt);
+
 /**
  * blkcache_invalidate() - discard the cache for a set of blocks
  * because of a write or device (re)initialization.
@@ -164,10 +189,12 @@ void blkcache_invalidate(int iftype, int dev);
 /**
  * blkcache_configure() - configure block cache
  *
- * @param blocks - maximum blocks per entry
- * @param entries - maximum entries in cache
+ * @param blocks - blocks per entry
+ * @param entries - maximum entries in cache, per device
+ * @param readahead - maximum read-ahead window, in blocks
  */
-void blkcache_configure(unsigned blocks, unsigned entries);
+void blkcache_configure(unsigned blocks, unsigned entries,
+			unsigned readahead);
 
 /*
  * statistics of the block cache
@@ -178,8 +205,33 @@ struct block_cache_stats {
 	unsigned entries; /* current entry count */
 	unsigned max_blocks_per_entry;
 	unsigned max_entries;
+	unsigned max_readahead;
+};
+
+/*
+ * statistics of the block cache for one device
+ */
+struct block_cache_dev_stats {
+	int iftype;
+	int devnum;
+	unsigned hits;
+	unsigned misses;
+	unsigned readaheads; /* misses widened by read-ahead */
+	unsigned entries; /* current entry count */
 };
 
+/**
+ * blkcache_dev_stats() - return statistics for one cached device
+ *
+ * Unlike blkcache_stats(), this does not reset the statistics.
+ *
+ * @param index - index of the device in the cache, starting at 0
+ * @param stats - statistics are copied here
+ *
+ * @return - 0 if OK, -ENOENT if there is no device at @index
+ */
+int blkcache_dev_stats(int index, struct block_cache_dev_stats *stats);
+
 /**
  * get_blkcache_stats() - return statistics and reset
  *
@@ -200,10 +252,51 @@ static inline void blkcache_fill(int iftype, int dev,
 				 lbaint_t start, lbaint_t blkcnt,
 				 unsigned long blksz, void const *buffer) {}
 
+static inline void *blkcache_window(int iftype, int dev,
+				    lbaint_t start, lbaint_t blkcnt,
+				    unsigned long blksz, lbaint_t lba,
+				    lbaint_t *wstart, lbaint_t *wcnt)
+{
+	return NULL;
+}
+
 static inline void blkcache_invalidate(int iftype, int dev) {}
 
 #endif
 
+/**
+ * struct blk_req - an asynchronous read from a block device
+ *
+ * Requests are started with blk_dsubmit() and finished with blk_dwait(). The
+ * caller owns the request and must keep it in place until it has been
+ * waited for.
+ *
+ * @start:	Start block number to read (0=first)
+ * @blkcnt:	Number of blocks to read
+ * @buffer:	Destination buffer for data read
+ * @result:	Number of blocks read, or -ve error number, once @done is set
+ * @done:	true once the request has completed
+ * @priv:	Private data for use by the block driver
+ */
+struct blk_req {
+	lbaint_t start;
+	lbaint_t blkcnt;
+	void *buffer;
+	long result;
+	bool done;
+	u64 priv[4];
+};
+
+/**
+ * typedef blk_stream_fn - process a chunk read by blk_dread_stream()
+ *
+ * @priv:	Private data passed to blk_dread_stream()
+ * @buf:	Chunk that has just been read
+ * @blkcnt:	Number of blocks in the chunk
+ * @return 0 to continue, -ve error number to stop reading
+ */
+typedef int (*blk_stream_fn)(void *priv, void *buf, lbaint_t blkcnt);
+
 #if CONFIG_IS_ENABLED(BLK)
 struct udevice;
 
@@ -265,6 +358,35 @@ struct blk_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*select_hwpart)(struct udevice *dev, int hwpart);
+
+	/**
+	 * submit() - start reading from a block device
+	 *
+	 * Start the transfer and return without waiting for it, so that the
+	 * caller can get on with other work. The request is finished by
+	 * wait(). A driver which runs out of room for requests in flight
+	 * may wait for earlier ones itself, setting their @result and
+	 * @done.
+	 *
+	 * This is optional. Without it, blk_dsubmit() reads synchronously.
+	 *
+	 * @dev:	Device to read from
+	 * @req:	Request to start
+	 * @return 0 if OK, -ENOSYS to read synchronously instead, other -ve
+	 * on error
+	 */
+	int (*submit)(struct udevice *dev, struct blk_req *req);
+
+	/**
+	 * wait() - wait for a request started by submit() to complete
+	 *
+	 * This must set @result and @done in the request.
+	 *
+	 * @dev:	Device the request was submitted to
+	 * @req:	Request to wait for
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*wait)(struct udevice *dev, struct blk_req *req);
 };
 
 #define blk_get_ops(dev)	((struct blk_ops *)(dev)->driver->ops)
@@ -282,6 +404,48 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			 lbaint_t blkcnt);
 
+/**
+ * blk_dsubmit() - start an asynchronous read from a block device
+ *
+ * Blocks found in the block cache complete straight away. Devices without
+ * submit() support are read synchronously.
+ *
+ * @block_dev:	Block device descriptor
+ * @req:	Request to start, with @start, @blkcnt and @buffer set up
+ * @return 0 if OK, -ve on error
+ */
+int blk_dsubmit(struct blk_desc *block_dev, struct blk_req *req);
+
+/**
+ * blk_dwait() - wait for an asynchronous read to complete
+ *
+ * @block_dev:	Block device descriptor
+ * @req:	Request started by blk_dsubmit()
+ * @return number of blocks read, or -ve error number
+ */
+long blk_dwait(struct blk_desc *block_dev, struct blk_req *req);
+
+/**
+ * blk_dread_stream() - read blocks in chunks, processing each as it arrives
+ *
+ * This reads the blocks into @buffer a chunk at a time, keeping the next
+ * chunk in flight while @fn processes the one before it, so that work such
+ * as hashing or decompression overlaps with the transfer on devices which
+ * support blk_dsubmit().
+ *
+ * @block_dev:	Block device descriptor
+ * @start:	Start block number to read (0=first)
+ * @blkcnt:	Number of blocks to read
+ * @buffer:	Destination buffer for data read
+ * @chunk:	Number of blocks to read at a time
+ * @fn:		Function to call for each chunk, or NULL for none
+ * @priv:	Private data to pass to @fn
+ * @return number of blocks read, or -ve error number
+ */
+long blk_dread_stream(struct blk_desc *block_dev, lbaint_t start,
+		      lbaint_t blkcnt, void *buffer, lbaint_t chunk,
+		      blk_stream_fn fn, void *priv);
+
 /**
  * blk_find_device() - Find a block device
  *
@@ -453,6 +617,21 @@ static inline ulong blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	return blks_read;
 }
 
+static inline int blk_dsubmit(struct blk_desc *block_dev,
+			      struct blk_req *req)
+{
+	req->result = blk_dread(block_dev, req->start, req->blkcnt,
+				req->buffer);
+	req->done = true;
+
+	return 0;
+}
+
+static inline long blk_dwait(struct blk_desc *block_dev, struct blk_req *req)
+{
+	return req->result;
+}
+
 static inline ulong blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt, const void *buffer)
 {
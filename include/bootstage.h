@@ -205,6 +205,8 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_DM_BIND,
+	BOOTSTAGE_ID_ACCUM_DM_PROBE,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Decompression of payloads made of independently compressed frames
+ *
+ * A gzip file may hold several members, each a complete gzip stream, and a
+ * zstd file several frames. When the position and size of each of these can
+ * be found without decompressing them, they are handed to the secondary CPUs
+ * as separate jobs (see smp_job.h) and written straight to their place in the
+ * output.
+ *
+ * gzip members are found through a subfield of the header's extra field
+ * giving the compressed size of the member: either GZIP_SUBFIELD_UB, as
+ * written by 'mkimage -Z', or the BGZF 'BC' subfield written by bgzip. zstd
+ * frames are found from the seek table of the zstd seekable format if there
+ * is one, else by walking the frame headers, which requires each frame to
+ * record its content size (pzstd and 'mkimage -Z' do this).
+ */
+
+#ifndef __DECOMP_FRAMES_H
+#define __DECOMP_FRAMES_H
+
+/*
+ * gzip extra subfield holding the total size of the member in bytes, from
+ * the start of its header to the end of its trailer, as a 32-bit
+ * little-endian value
+ */
+#define GZIP_SUBFIELD_UB1	'U'
+#define GZIP_SUBFIELD_UB2	'B'
+#define GZIP_SUBFIELD_UB_LEN	4
+
+/* Skippable frame holding the seek table of the zstd seekable format */
+#define ZSTD_SEEKABLE_MAGIC		0x184d2a5e
+#define ZSTD_SEEKABLE_FOOTER_MAGIC	0x8f92eab1
+#define ZSTD_SEEKABLE_FOOTER_SIZE	9
+#define ZSTD_SEEKABLE_CHECKSUM_FLAG	0x80
+
+#if CONFIG_IS_ENABLED(DECOMP_FRAMES)
+/**
+ * gzip_frame_size() - get the size of a gzip member from its header
+ *
+ * Only the header, including its extra field, needs to be within @len; the
+ * rest of the member may not have been read yet.
+ *
+ * @buf:	start of the gzip member
+ * @len:	number of bytes available at @buf
+ * Return: total size of the member, or 0 if it does not give its size or its
+ *	header is not entirely within @len
+ */
+ulong gzip_frame_size(const void *buf, ulong len);
+
+/**
+ * gzip_decomp_frames() - decompress gzip members in parallel
+ *
+ * @dst:	destination buffer
+ * @dstlen:	size of @dst
+ * @src:	gzip data
+ * @srclen:	size of @src, or ~0UL if not known, in which case the data
+ *		ends with the first byte which does not start a gzip member
+ * @lenp:	returns the number of bytes written to @dst
+ * Return: 0 if OK, -ENOENT if @src does not have more than one member or its
+ *	members cannot be found without decompressing them, -ENOSPC if @dst
+ *	is too small, other -ve on error
+ */
+int gzip_decomp_frames(void *dst, ulong dstlen, const void *src, ulong srclen,
+		       ulong *lenp);
+
+/**
+ * zstd_decomp_frames() - decompress zstd frames in parallel
+ *
+ * @dst:	destination buffer
+ * @dstlen:	size of @dst
+ * @src:	zstd data
+ * @srclen:	size of @src
+ * @lenp:	returns the number of bytes written to @dst
+ * Return: 0 if OK, -ENOENT if @src does not have more than one frame or the
+ *	content size of a frame is not known, -ENOSPC if @dst is too small,
+ *	other -ve on error
+ */
+int zstd_decomp_frames(void *dst, ulong dstlen, const void *src, ulong srclen,
+		       ulong *lenp);
+#else
+static inline ulong gzip_frame_size(const void *buf, ulong len)
+{
+	return 0;
+}
+
+static inline int gzip_decomp_frames(void *dst, ulong dstlen, const void *src,
+				     ulong srclen, ulong *lenp)
+{
+	return -ENOENT;
+}
+
+static inline int zstd_decomp_frames(void *dst, ulong dstlen, const void *src,
+				     ulong srclen, ulong *lenp)
+{
+	return -ENOENT;
+}
+#endif
+
+#endif /* __DECOMP_FRAMES_H */
@@ -11,6 +11,7 @@
 #define _DM_DEVICE_H
 
 #include <dm/ofnode.h>
+#include <dm/probe-times.h>
 #include <dm/uclass-id.h>
 #include <fdtdec.h>
 #include <linker_lists.h>
@@ -161,6 +162,8 @@ enum {
  *		automatically when the device is removed / unbound
  * @dma_offset: Offset between the physical address space (CPU's) and the
  *		device's bus address space
+ * @times_: Time taken to bind and probe this device, in microseconds, indexed
+ *	by enum dm_time_id (do not access outside driver model)
  */
 struct udevice {
 	const struct driver *driver;
@@ -190,6 +193,9 @@ struct udevice {
 #if CONFIG_IS_ENABLED(DM_DMA)
 	ulong dma_offset;
 #endif
+#if CONFIG_IS_ENABLED(DM_PROBE_TIMES)
+	u32 times_[DM_TIME_COUNT];
+#endif
 };
 
 /**
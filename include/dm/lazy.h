@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Binding devicetree nodes when their uclass is first used
+ */
+
+#ifndef _DM_LAZY_H_
+#define _DM_LAZY_H_
+
+#include <dm/ofnode.h>
+#include <dm/uclass-id.h>
+#include <linux/errno.h>
+
+struct udevice;
+
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/**
+ * dm_lazy_add() - Bind a devicetree node now or when its uclass is used
+ *
+ * Called instead of lists_bind_fdt() when scanning the devicetree after
+ * relocation. Nodes marked for pre-relocation, nodes of drivers with the
+ * DM_FLAG_PRE_RELOC flag and subnodes of a device which is already probed are
+ * bound at once. Others are only recorded, to be bound by
+ * dm_lazy_bind_uclass(), dm_lazy_bind_node(), dm_lazy_bind_children() or
+ * dm_lazy_bind_all().
+ *
+ * @parent: device to bind the node under
+ * @node: node to bind
+ * @return 0 if OK, -ve on error
+ */
+int dm_lazy_add(struct udevice *parent, ofnode node);
+
+/**
+ * dm_lazy_bind_uclass() - Bind the recorded nodes of a uclass
+ *
+ * Nodes with subnodes are bound too, whatever their uclass, since they may be
+ * the parents of devices in @id. This is called by uclass_get(), so that the
+ * devices of a uclass are all there when it is first looked at.
+ *
+ * @id: uclass whose nodes to bind
+ */
+void dm_lazy_bind_uclass(enum uclass_id id);
+
+/**
+ * dm_lazy_bind_node() - Bind a recorded node and its ancestors
+ *
+ * A driver's bind() method may create devices in other uclasses, such as a
+ * clock driver binding a reset device for the same node, so looking a node
+ * up by its own uclass is not enough. This is called by the uclass lookups by
+ * node and by phandle.
+ *
+ * @node: node to bind
+ */
+void dm_lazy_bind_node(ofnode node);
+
+/**
+ * dm_lazy_bind_children() - Bind the recorded nodes under a device
+ *
+ * This is called by device_probe(), so that a bus finds its children.
+ *
+ * @dev: parent device
+ */
+void dm_lazy_bind_children(struct udevice *dev);
+
+/**
+ * dm_lazy_bind_all() - Bind all recorded nodes
+ *
+ * This gives the same devices as a full scan, e.g. for 'dm tree'.
+ */
+void dm_lazy_bind_all(void);
+
+/**
+ * dm_lazy_forget() - Drop the recorded nodes under a device being unbound
+ *
+ * @dev: parent device
+ */
+void dm_lazy_forget(struct udevice *dev);
+
+/**
+ * dm_lazy_reset() - Drop all recorded nodes
+ *
+ * This is called by dm_init(), as the devices they belong under are gone.
+ */
+void dm_lazy_reset(void);
+#else
+static inline int dm_lazy_add(struct udevice *parent, ofnode node)
+{
+	return -ENOSYS;
+}
+
+static inline void dm_lazy_bind_uclass(enum uclass_id id) {}
+static inline void dm_lazy_bind_node(ofnode node) {}
+static inline void dm_lazy_bind_children(struct udevice *dev) {}
+static inline void dm_lazy_bind_all(void) {}
+static inline void dm_lazy_forget(struct udevice *dev) {}
+static inline void dm_lazy_reset(void) {}
+#endif
+
+#endif
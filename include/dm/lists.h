@@ -12,6 +12,8 @@
 #include <dm/ofnode.h>
 #include <dm/uclass-id.h>
 
+struct udevice_id;
+
 /**
  * lists_driver_lookup_name() - Return u_boot_driver corresponding to name
  *
@@ -61,6 +63,40 @@ int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
 int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		   bool pre_reloc_only);
 
+/**
+ * lists_driver_lookup_compat() - Find the driver for a compatible string
+ *
+ * If several drivers have the string, the first one in the driver list is
+ * returned, as lists_bind_fdt() would bind it.
+ *
+ * @compat: Compatible string to look up
+ * @idp: Returns the driver's entry for @compat in its of_match table
+ * @return pointer to driver, or NULL if not found
+ */
+struct driver *lists_driver_lookup_compat(const char *compat,
+					  const struct udevice_id **idp);
+
+/**
+ * lists_init_compat_index() - Index the compatible strings of all drivers
+ *
+ * This sorts the compatible strings of all drivers, so that
+ * lists_driver_lookup_compat() can use a binary search rather than comparing
+ * a string with those of every driver. Called from dm_init(), but only
+ * builds the index once the full malloc() area is set up. Without the index,
+ * as when this fails, drivers are still found by a linear search.
+ *
+ * @return 0 if OK, -ENOMEM if out of memory, -E2BIG if there are too many
+ * drivers or compatible strings to index
+ */
+#if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+int lists_init_compat_index(void);
+#else
+static inline int lists_init_compat_index(void)
+{
+	return 0;
+}
+#endif
+
 /**
  * device_bind_driver() - bind a device to a driver
  *
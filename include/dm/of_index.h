@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Index of phandles and paths in the flat devicetree
+ */
+
+#ifndef _DM_OF_INDEX_H_
+#define _DM_OF_INDEX_H_
+
+#include <linux/libfdt.h>
+
+#if CONFIG_IS_ENABLED(OF_INDEX)
+/**
+ * of_index_phandle() - Find a node in a flat devicetree by its phandle
+ *
+ * For the control devicetree after relocation, this looks the phandle up in
+ * a table built on first use. Otherwise it is the same as
+ * fdt_node_offset_by_phandle().
+ *
+ * @blob: devicetree to search
+ * @phandle: phandle to find
+ * Return: offset of the node, or -ve FDT_ERR_... on error
+ */
+int of_index_phandle(const void *blob, uint phandle);
+
+/**
+ * of_index_path() - Find a node in a flat devicetree by its path
+ *
+ * For the control devicetree after relocation, the paths looked up most
+ * recently are remembered. Otherwise it is the same as fdt_path_offset().
+ *
+ * @blob: devicetree to search
+ * @path: full path of the node, or an alias
+ * Return: offset of the node, or -ve FDT_ERR_... on error
+ */
+int of_index_path(const void *blob, const char *path);
+
+/**
+ * of_index_invalidate() - Drop the index
+ *
+ * The index is rebuilt when nodes or properties are added or removed, and
+ * each node found is checked against the phandle or name looked up. Code
+ * changing the control devicetree in a way that keeps its size, such as
+ * renaming a node or changing an alias in place, must call this.
+ */
+void of_index_invalidate(void);
+#else
+static inline int of_index_phandle(const void *blob, uint phandle)
+{
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+
+static inline int of_index_path(const void *blob, const char *path)
+{
+	return fdt_path_offset(blob, path);
+}
+
+static inline void of_index_invalidate(void)
+{
+}
+#endif
+
+#endif
@@ -0,0 +1,154 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Time taken to bind and probe each device
+ */
+
+#ifndef _DM_PROBE_TIMES_H_
+#define _DM_PROBE_TIMES_H_
+
+#include <linux/types.h>
+
+struct udevice;
+
+/**
+ * enum dm_time_id - what a device spent its time on
+ *
+ * All times are in microseconds. Time spent binding or probing another device
+ * is only counted for that device, except in @DM_TIME_PROBE_TOTAL and in the
+ * clk, reset and pinctrl times, which include whatever had to be probed to
+ * carry out the operation.
+ *
+ * @DM_TIME_BIND: binding the device
+ * @DM_TIME_PROBE: probing the device itself
+ * @DM_TIME_PROBE_TOTAL: probing the device, including its parents and the
+ *	devices it uses
+ * @DM_TIME_CLK: setting up and enabling clocks while the device was probed
+ * @DM_TIME_RESET: asserting and deasserting resets while the device was probed
+ * @DM_TIME_PINCTRL: selecting pin states while the device was probed
+ * @DM_TIME_COUNT: number of times recorded for each device
+ */
+enum dm_time_id {
+	DM_TIME_BIND,
+	DM_TIME_PROBE,
+	DM_TIME_PROBE_TOTAL,
+	DM_TIME_CLK,
+	DM_TIME_RESET,
+	DM_TIME_PINCTRL,
+
+	DM_TIME_COUNT,
+};
+
+/**
+ * struct dm_time_state - the device being bound or probed
+ *
+ * This is kept in global_data, as devices are probed before relocation.
+ *
+ * @dev: device that clk, reset and pinctrl time is added to, or NULL
+ * @nested: time spent so far binding or probing other devices
+ * @open: mask of (1 << enum dm_time_id) for the operations being timed, so
+ *	that nested operations are not counted twice
+ * @depth: number of devices being bound or probed
+ */
+struct dm_time_state {
+	struct udevice *dev;
+	ulong nested;
+	uint open;
+	int depth;
+};
+
+/**
+ * struct dm_time_frame - saved state while a device is bound or probed
+ *
+ * @dev: previous value of &dm_time_state.dev
+ * @nested: previous value of &dm_time_state.nested
+ * @open: previous value of &dm_time_state.open
+ * @start: time at which binding or probing started, or 0 if not timed
+ */
+struct dm_time_frame {
+	struct udevice *dev;
+	ulong nested;
+	uint open;
+	ulong start;
+};
+
+#if CONFIG_IS_ENABLED(DM_PROBE_TIMES)
+/**
+ * dm_time_enter() - Start timing the binding or probing of a device
+ *
+ * @frame: place to save the state, to pass to dm_time_leave()
+ * @dev: device being probed, or NULL when binding
+ */
+void dm_time_enter(struct dm_time_frame *frame, struct udevice *dev);
+
+/**
+ * dm_time_leave() - Record the time taken to bind or probe a device
+ *
+ * @frame: state saved by dm_time_enter()
+ * @dev: device to record the time for, or NULL if it could not be bound
+ * @id: DM_TIME_BIND or DM_TIME_PROBE
+ */
+void dm_time_leave(struct dm_time_frame *frame, struct udevice *dev,
+		   enum dm_time_id id);
+
+/**
+ * dm_time_start() - Start timing an operation for the device being probed
+ *
+ * @id: DM_TIME_CLK, DM_TIME_RESET or DM_TIME_PINCTRL
+ * Return: value to pass to dm_time_end()
+ */
+ulong dm_time_start(enum dm_time_id id);
+
+/**
+ * dm_time_end() - Add the time taken by an operation to the device
+ *
+ * @id: value passed to dm_time_start()
+ * @start: value returned by dm_time_start()
+ */
+void dm_time_end(enum dm_time_id id, ulong start);
+
+/**
+ * dev_get_time() - Get a time recorded for a device
+ *
+ * @dev: device to check
+ * @id: time to get
+ * Return: time in microseconds
+ */
+u32 dev_get_time(const struct udevice *dev, enum dm_time_id id);
+
+/**
+ * dm_probe_times_add_fdt() - Add the recorded times to a devicetree
+ *
+ * A 'dm' subnode is added under @parent, with a subnode for each device that
+ * took some time, the most costly first. Each has the device's name and one
+ * cell for each time.
+ *
+ * @blob: devicetree to update
+ * @parent: offset of the node to add to, i.e. /bootstage
+ * Return: 0 if OK, -ve FDT_ERR_... on error
+ */
+int dm_probe_times_add_fdt(void *blob, int parent);
+#else
+static inline void dm_time_enter(struct dm_time_frame *frame,
+				 struct udevice *dev) {}
+static inline void dm_time_leave(struct dm_time_frame *frame,
+				 struct udevice *dev, enum dm_time_id id) {}
+
+static inline ulong dm_time_start(enum dm_time_id id)
+{
+	return 0;
+}
+
+static inline void dm_time_end(enum dm_time_id id, ulong start) {}
+
+static inline u32 dev_get_time(const struct udevice *dev, enum dm_time_id id)
+{
+	return 0;
+}
+
+static inline int dm_probe_times_add_fdt(void *blob, int parent)
+{
+	return 0;
+}
+#endif
+
+#endif
@@ -48,6 +48,20 @@ void dm_dump_driver_compat(void);
 /* Dump out a list of drivers with static platform data */
 void dm_dump_static_driver_info(void);
 
+#if CONFIG_IS_ENABLED(DM_PROBE_TIMES)
+/**
+ * dm_dump_probe_times() - Dump out the time taken by each device
+ *
+ * @limit: maximum number of devices to show, the most costly first, or 0 for
+ *	all
+ */
+void dm_dump_probe_times(int limit);
+#else
+static inline void dm_dump_probe_times(int limit)
+{
+}
+#endif
+
 #endif
 
 #if CONFIG_IS_ENABLED(OF_PLATDATA_INST) && CONFIG_IS_ENABLED(READ_ONLY)
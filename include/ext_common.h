@@ -203,6 +203,7 @@ struct ext2fs_node {
 	struct ext2_inode inode;
 	int ino;
 	int inode_read;
+	struct ext4_extent_map *extents;	/* decoded extents, if read */
 };
 
 /* Information about a "mounted" ext2 filesystem. */
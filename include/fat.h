@@ -25,7 +25,12 @@ struct disk_partition;
 #define DIRENTSPERCLUST	((mydata->clust_size * mydata->sect_size) / \
 			 sizeof(dir_entry))
 
+/* The FAT window must be a multiple of 3 sectors so FAT12 entries fit */
+#if CONFIG_IS_ENABLED(FS_FAT_RUN_CACHE)
+#define FATBUFBLOCKS	48
+#else
 #define FATBUFBLOCKS	6
+#endif
 #define FATBUFSIZE	(mydata->sect_size * FATBUFBLOCKS)
 #define FAT12BUFSIZE	((FATBUFSIZE*2)/3)
 #define FAT16BUFSIZE	(FATBUFSIZE/2)
@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Streaming loader for FIT images held on storage
+ */
+
+#ifndef __FIT_STREAM_H
+#define __FIT_STREAM_H
+
+#include <blk.h>
+
+/**
+ * struct fit_stream_src - storage holding a FIT
+ *
+ * The FIT is read either from a block device, starting at block @start of
+ * @desc, or through @read if @desc is NULL.
+ *
+ * @desc:	Block device holding the FIT, or NULL to use @read
+ * @start:	First block of the FIT on @desc
+ * @read:	Read @size bytes at byte offset @offset in the FIT into @buf,
+ *		returning 0 if OK or -ve on error
+ * @chunk:	Number of bytes to read at a time, or 0 for the default
+ *		(CONFIG_FIT_STREAM_CHUNK_SIZE)
+ * @priv:	Private data for @read
+ */
+struct fit_stream_src {
+	struct blk_desc *desc;
+	lbaint_t start;
+	int (*read)(struct fit_stream_src *src, ulong offset, ulong size,
+		    void *buf);
+	ulong chunk;
+	void *priv;
+};
+
+/**
+ * fit_stream_read_header() - read the FIT structure from storage
+ *
+ * This reads the device tree part of the FIT, which for a FIT with external
+ * data does not include the images themselves.
+ *
+ * @src:	Storage to read from
+ * @fitp:	Returns the FIT, allocated with malloc()
+ * @return 0 if OK, -ENOEXEC if this is not a FIT, other -ve on error
+ */
+int fit_stream_read_header(struct fit_stream_src *src, void **fitp);
+
+/**
+ * fit_stream_key_required() - check whether the control FDT requires a key
+ *
+ * @level:	"image" or "conf" to check for keys required at that level,
+ *		or NULL to check for any required key
+ * @return true if a key in the /signature node is marked as required
+ */
+bool fit_stream_key_required(const char *level);
+
+/**
+ * fit_stream_load_image() - load an image from a FIT on storage
+ *
+ * This reads the image data a chunk at a time, updating each of the image's
+ * hashes and decompressing it to @load as the data arrives. The data is
+ * therefore only read once, with no copy of the whole compressed image
+ * being made. If a required image signature must be checked, or the
+ * compression algorithm has no streaming decoder, the compressed data is
+ * gathered in memory first and decompressed once it has been verified.
+ * Encrypted images are gathered the same way and decrypted after
+ * verification, or refused if FIT_CIPHER is not enabled.
+ *
+ * @src:	Storage holding the FIT
+ * @fit:	FIT structure, as returned by fit_stream_read_header()
+ * @noffset:	Offset of the image node in @fit
+ * @load:	Address to load the image to
+ * @max_len:	Space available at @load
+ * @lenp:	Returns the number of bytes loaded
+ * @return 0 if OK, -EACCES if the image failed verification, -ENOSPC if
+ * it does not fit in @max_len bytes, other -ve on error
+ */
+int fit_stream_load_image(struct fit_stream_src *src, const void *fit,
+			  int noffset, ulong load, ulong max_len,
+			  ulong *lenp);
+
+#endif
@@ -26,8 +26,9 @@ int gzip_parse_header(const unsigned char *src, unsigned long len);
  * @dst: Destination for uncompressed data
  * @dstlen: Size of destination buffer
  * @src: Source data to decompress
- * @lenp: Returns length of uncompressed data
- * @return 0 if OK, -1 on error
+ * @lenp: On entry, size of @src (~0UL if not known); returns length of
+ *	uncompressed data
+ * @return 0 if OK, -ve on error
  */
 int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp);
 
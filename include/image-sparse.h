@@ -40,3 +40,67 @@ static inline int is_sparse_image(void *buf)
 
 int write_sparse_image(struct sparse_storage *info, const char *part_name,
 		       void *data, char *response);
+
+/**
+ * struct sparse_stream - a sparse image written as it arrives
+ *
+ * Unlike write_sparse_image(), which needs the whole image in memory, the
+ * image can be passed to sparse_stream_write() a piece at a time.
+ *
+ * @info: where to write the image
+ * @response: passed to @info->mssg
+ * @header: the image's file header, once it has been seen
+ * @have_header: @header is valid
+ * @blk: next block to write
+ * @chunk: number of chunks started
+ * @total_blocks: number of image blocks in those chunks
+ * @bytes_written: bytes written to @info so far
+ * @raw_left: bytes of the current RAW chunk still to write
+ * @skip_left: bytes of the current chunk still to skip
+ */
+struct sparse_stream {
+	struct sparse_storage	*info;
+	char			*response;
+	sparse_header_t		header;
+	bool			have_header;
+	lbaint_t		blk;
+	uint32_t		chunk;
+	uint32_t		total_blocks;
+	u64			bytes_written;
+	uint32_t		raw_left;
+	uint32_t		skip_left;
+};
+
+/**
+ * sparse_stream_init() - Prepare to write a sparse image piece by piece
+ *
+ * @ss: stream state to set up
+ * @info: where to write the image
+ * @response: passed to @info->mssg
+ * Return: 0
+ */
+int sparse_stream_init(struct sparse_stream *ss, struct sparse_storage *info,
+		       char *response);
+
+/**
+ * sparse_stream_write() - Write the next part of a sparse image
+ *
+ * Headers and blocks are only processed once they have arrived in full, so
+ * the end of @buf may not be consumed. The caller must pass it again at the
+ * start of the next call, followed by what came after it.
+ *
+ * @ss: stream state
+ * @buf: image data following what has been consumed so far
+ * @len: number of bytes at @buf
+ * Return: number of bytes consumed, or -1 on error
+ */
+long sparse_stream_write(struct sparse_stream *ss, void *buf, ulong len);
+
+/**
+ * sparse_stream_finish() - Check that the whole image was written
+ *
+ * @ss: stream state
+ * @part_name: name of the partition, for messages
+ * Return: 0 if all chunks were written, -1 if not
+ */
+int sparse_stream_finish(struct sparse_stream *ss, const char *part_name);
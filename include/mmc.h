@@ -454,6 +454,36 @@ struct dm_mmc_ops {
 	int (*send_cmd)(struct udevice *dev, struct mmc_cmd *cmd,
 			struct mmc_data *data);
 
+	/**
+	 * send_cmd_start() - Send a data command without waiting for the data
+	 *
+	 * This returns once the command has been accepted, leaving the data
+	 * to be transferred (e.g. by DMA) while the caller gets on with other
+	 * work. The transfer must be finished with send_cmd_wait() before any
+	 * other command is sent.
+	 *
+	 * This is optional.
+	 *
+	 * @dev:	Device to receive the command
+	 * @cmd:	Command to send
+	 * @data:	Data to send/receive
+	 * @return 0 if OK, -ENOSYS if the transfer cannot be started
+	 * this way, other -ve on error
+	 */
+	int (*send_cmd_start)(struct udevice *dev, struct mmc_cmd *cmd,
+			      struct mmc_data *data);
+
+	/**
+	 * send_cmd_wait() - Finish a transfer started by send_cmd_start()
+	 *
+	 * @dev:	Device which received the command
+	 * @cmd:	Command passed to send_cmd_start()
+	 * @data:	Data passed to send_cmd_start()
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*send_cmd_wait)(struct udevice *dev, struct mmc_cmd *cmd,
+			     struct mmc_data *data);
+
 	/**
 	 * set_ios() - Set the I/O speed/width for an MMC device
 	 *
@@ -541,6 +571,10 @@ struct dm_mmc_ops {
 
 int dm_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 		    struct mmc_data *data);
+int dm_mmc_send_cmd_start(struct udevice *dev, struct mmc_cmd *cmd,
+			  struct mmc_data *data);
+int dm_mmc_send_cmd_wait(struct udevice *dev, struct mmc_cmd *cmd,
+			 struct mmc_data *data);
 int dm_mmc_set_ios(struct udevice *dev);
 int dm_mmc_get_cd(struct udevice *dev);
 int dm_mmc_get_wp(struct udevice *dev);
@@ -738,6 +772,12 @@ struct mmc {
 				  */
 	u32 quirks;
 	u8 hs400_tuning;
+#if CONFIG_IS_ENABLED(DM_MMC) && CONFIG_IS_ENABLED(BLK)
+	/* read started by mmc_bread_submit(), still in flight */
+	struct blk_req *async_req;
+	struct mmc_cmd async_cmd;
+	struct mmc_data async_data;
+#endif
 };
 
 #if CONFIG_IS_ENABLED(DM_MMC)
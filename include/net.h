@@ -107,7 +107,41 @@ enum eth_state_t {
 	ETH_STATE_ACTIVE
 };
 
+/* Most buffers a packet sent by eth_send_sg() may be gathered from */
+#define ETH_SG_MAX	4
+
+/**
+ * struct eth_sg - one buffer of a packet sent by eth_send_sg()
+ *
+ * @addr: start of the buffer
+ * @length: number of bytes in the buffer
+ */
+struct eth_sg {
+	const void *addr;
+	int length;
+};
+
 #ifdef CONFIG_DM_ETH
+/**
+ * enum eth_features - offloads which an Ethernet MAC may support
+ *
+ * The network stack works the same without them, doing the job in software.
+ *
+ * @ETH_FEAT_RX_CSUM: recv() calls eth_set_rx_csum_ok() for IPv4 TCP/UDP
+ *		      packets whose checksum the hardware has verified. Packets
+ *		      are always returned with a finished checksum.
+ * @ETH_FEAT_TX_CSUM: the hardware completes the TCP/UDP checksum of IPv4
+ *		      packets which eth_get_tx_csum() reports. The stack
+ *		      leaves the pseudo-header sum in their checksum field.
+ *		      Other packets are sent as they are.
+ * @ETH_FEAT_SG: send_sg() sends a packet gathered from several buffers
+ */
+enum eth_features {
+	ETH_FEAT_RX_CSUM	= 1 << 0,
+	ETH_FEAT_TX_CSUM	= 1 << 1,
+	ETH_FEAT_SG		= 1 << 2,
+};
+
 /**
  * struct eth_pdata - Platform data for Ethernet MAC controllers
  *
@@ -115,6 +149,8 @@ enum eth_state_t {
  * @enetaddr: The Ethernet MAC address that is loaded from EEPROM or env
  * @phy_interface: PHY interface to use - see PHY_INTERFACE_MODE_...
  * @max_speed: Maximum speed of Ethernet connection supported by MAC
+ * @features: Offloads supported by the MAC, see enum eth_features. Drivers
+ *	      set these by the time the device is started.
  * @priv_pdata: device specific plat
  */
 struct eth_pdata {
@@ -122,6 +158,7 @@ struct eth_pdata {
 	unsigned char enetaddr[ARP_HLEN];
 	int phy_interface;
 	int max_speed;
+	unsigned int features;
 	void *priv_pdata;
 };
 
@@ -158,6 +195,8 @@ enum eth_recv_flags {
  *		    ROM on the board. This is how the driver should expose it
  *		    to the network stack. This function should fill in the
  *		    eth_pdata::enetaddr field - optional
+ * send_sg: Send a packet made of "count" buffers, the first of which holds
+ *	    all the protocol headers. Only used with ETH_FEAT_SG - optional
  */
 struct eth_ops {
 	int (*start)(struct udevice *dev);
@@ -168,10 +207,73 @@ struct eth_ops {
 	int (*mcast)(struct udevice *dev, const u8 *enetaddr, int join);
 	int (*write_hwaddr)(struct udevice *dev);
 	int (*read_rom_hwaddr)(struct udevice *dev);
+	int (*send_sg)(struct udevice *dev, const struct eth_sg *sg, int count);
 };
 
 #define eth_get_ops(dev) ((struct eth_ops *)(dev)->driver->ops)
 
+/**
+ * struct eth_stats - traffic counters of an Ethernet device
+ *
+ * These are kept by the uclass from the time the device is probed, except
+ * for @rx_dropped which is updated by drivers able to tell.
+ *
+ * @rx_packets: packets received and passed to the network stack
+ * @rx_bytes: bytes in the packets received
+ * @rx_errors: errors returned by recv()
+ * @rx_dropped: packets lost by the hardware, e.g. for lack of receive
+ *		descriptors
+ * @rx_full_polls: polls which stopped after ETH_PACKETS_BATCH_RECV packets,
+ *		   with more possibly waiting
+ * @tx_packets: packets sent
+ * @tx_bytes: bytes in the packets sent
+ * @tx_errors: errors returned by send()
+ */
+struct eth_stats {
+	ulong rx_packets;
+	ulong rx_bytes;
+	ulong rx_errors;
+	ulong rx_dropped;
+	ulong rx_full_polls;
+	ulong tx_packets;
+	ulong tx_bytes;
+	ulong tx_errors;
+};
+
+/**
+ * eth_get_stats() - get the traffic counters of an Ethernet device
+ *
+ * @dev: probed Ethernet device
+ * Return: pointer to the counters of @dev
+ */
+struct eth_stats *eth_get_stats(struct udevice *dev);
+
+/**
+ * eth_set_rx_csum_ok() - report a packet with a verified TCP/UDP checksum
+ *
+ * Called by recv() of a driver with ETH_FEAT_RX_CSUM for the packet it is
+ * returning, so that the network stack does not check the checksum again.
+ *
+ * @dev: Ethernet device receiving the packet
+ */
+void eth_set_rx_csum_ok(struct udevice *dev);
+
+/**
+ * eth_get_tx_csum() - find the checksum a packet leaves to the hardware
+ *
+ * For drivers with ETH_FEAT_TX_CSUM. Only a packet built by the network
+ * stack and marked with net_tx_csum_mark() has a checksum to complete. The
+ * hardware sums the packet from the returned start to its end and adds the
+ * result to the pseudo-header sum found at @offset bytes after the start.
+ *
+ * @packet: Ethernet frame about to be sent
+ * @length: number of bytes at @packet
+ * @offset: returns the offset of the checksum field from the start
+ * Return: offset in @packet to start summing from, or -ENOENT if the packet
+ *	   has no checksum to complete
+ */
+int eth_get_tx_csum(const void *packet, int length, int *offset);
+
 struct udevice *eth_get_dev(void); /* get the current device */
 /*
  * The devname can be either an exact name given by the driver or device tree
@@ -300,6 +402,33 @@ int eth_env_get_enetaddr_by_index(const char *base_name, int index,
 int eth_init(void);			/* Initialize the device */
 int eth_send(void *packet, int length);	   /* Send a packet */
 
+/**
+ * eth_send_sg() - send a packet gathered from several buffers
+ *
+ * The buffers are handed as they are to a device with ETH_FEAT_SG, otherwise
+ * they are copied one after the other and sent with eth_send().
+ *
+ * @sg: buffers of the packet, the first holding all the protocol headers
+ * @count: number of buffers, at most ETH_SG_MAX
+ * Return: 0 if OK, -ve on error
+ */
+int eth_send_sg(const struct eth_sg *sg, int count);
+
+#ifdef CONFIG_DM_ETH
+bool eth_rx_csum_ok(void);	/* Received packet checksum verified? */
+bool eth_tx_csum_offload(void);	/* Device completes sent checksums? */
+#else
+static inline bool eth_rx_csum_ok(void)
+{
+	return false;
+}
+
+static inline bool eth_tx_csum_offload(void)
+{
+	return false;
+}
+#endif
+
 #if defined(CONFIG_API) || defined(CONFIG_EFI_LOADER)
 int eth_receive(void *packet, int length); /* Receive a packet*/
 extern void (*push_packet)(void *packet, int length);
@@ -369,6 +498,7 @@ struct vlan_ethernet_hdr {
 #define PROT_NCSI	0x88f8		/* NC-SI control packets        */
 
 #define IPPROTO_ICMP	 1	/* Internet Control Message Protocol	*/
+#define IPPROTO_TCP	 6	/* Transmission Control Protocol	*/
 #define IPPROTO_UDP	17	/* User Datagram Protocol		*/
 
 /*
@@ -560,7 +690,7 @@ extern int		net_restart_wrap;	/* Tried all network devices */
 
 enum proto_t {
 	BOOTP, RARP, ARP, TFTPGET, DHCP, PING, DNS, NFS, CDP, NETCONS, SNTP,
-	TFTPSRV, TFTPPUT, LINKLOCAL, FASTBOOT, WOL, UDP
+	TFTPSRV, TFTPPUT, LINKLOCAL, FASTBOOT, WOL, UDP, WGET
 };
 
 extern char	net_boot_file_name[1024];/* Boot File name */
@@ -621,6 +751,39 @@ void net_set_ip_header(uchar *pkt, struct in_addr dest, struct in_addr source,
 void net_set_udp_header(uchar *pkt, struct in_addr dest, int dport,
 				int sport, int len);
 
+/**
+ * ip_pseudo_checksum() - checksum of the IPv4 pseudo header
+ *
+ * This covers the part of the IP header included in TCP and UDP checksums.
+ * Combine it with the checksum of the segment using add_ip_checksums().
+ *
+ * @src:	source address
+ * @dst:	destination address
+ * @proto:	IPPROTO_TCP or IPPROTO_UDP
+ * @len:	length of the TCP/UDP header and data
+ * @return 16-bit IP checksum of the pseudo header
+ */
+uint ip_pseudo_checksum(struct in_addr src, struct in_addr dst, u8 proto,
+			uint len);
+
+/**
+ * net_tx_csum_mark() - mark a packet whose checksum is left to the device
+ *
+ * Called by net_set_udp_header() and tcp_set_tcp_header() when they put only
+ * the pseudo-header sum in the checksum field, for a device with
+ * ETH_FEAT_TX_CSUM. The mark is dropped when the next IP header is built.
+ *
+ * @ip:		IP header of the packet
+ */
+void net_tx_csum_mark(const void *ip);
+
+/**
+ * net_tx_csum_marked() - get the packet whose checksum is left to the device
+ *
+ * @return IP header passed to net_tx_csum_mark(), or NULL if none
+ */
+const void *net_tx_csum_marked(void);
+
 /**
  * compute_ip_checksum() - Compute IP checksum
  *
@@ -651,12 +814,26 @@ unsigned add_ip_checksums(unsigned offset, unsigned sum, unsigned new_sum);
  */
 int ip_checksum_ok(const void *addr, unsigned nbytes);
 
+/**
+ * ip_checksum_complete() - finish a partial TCP/UDP checksum
+ *
+ * This does what a device with checksum offload does: the checksum field
+ * holds the pseudo-header sum, to which the sum of the segment is added.
+ *
+ * @seg:	TCP/UDP header, followed by the data (must be 16-bit aligned)
+ * @len:	Number of bytes in the segment
+ * @offset:	Offset of the checksum field in the segment
+ */
+void ip_checksum_complete(void *seg, uint len, uint offset);
+
 /* Callbacks */
 rxhand_f *net_get_udp_handler(void);	/* Get UDP RX packet handler */
 void net_set_udp_handler(rxhand_f *);	/* Set UDP RX packet handler */
 rxhand_f *net_get_arp_handler(void);	/* Get ARP RX packet handler */
 void net_set_arp_handler(rxhand_f *);	/* Set ARP RX packet handler */
 bool arp_is_waiting(void);		/* Waiting for ARP reply? */
+void arp_flush(void);			/* Forget all known neighbours */
+void arp_show(void);			/* Print the known neighbours */
 void net_set_icmp_handler(rxhand_icmp_f *f); /* Set ICMP RX handler */
 void net_set_timeout_handler(ulong, thand_f *);/* Set timeout handler */
 
@@ -691,14 +868,18 @@ static inline void net_send_packet(uchar *pkt, int len)
 }
 
 /*
- * Transmit "net_tx_packet" as UDP packet, performing ARP request if needed
- *  (ether will be populated)
+ * Transmit "net_tx_packet" as UDP or TCP packet, performing ARP request if
+ *  needed (ether will be populated)
  *
  * @param ether Raw packet buffer
  * @param dest IP address to send the datagram to
- * @param dport Destination UDP port
- * @param sport Source UDP port
- * @param payload_len Length of data after the UDP header
+ * @param dport Destination UDP/TCP port
+ * @param sport Source UDP/TCP port
+ * @param payload_len Length of data after the UDP/TCP header
+ * @param proto IPPROTO_UDP or IPPROTO_TCP
+ * @param action TCP control flags (TCP only)
+ * @param tcp_seq_num TCP sequence number (TCP only)
+ * @param tcp_ack_num TCP acknowledgment number (TCP only)
  */
 int net_send_ip_packet(uchar *ether, struct in_addr dest, int dport, int sport,
 		       int payload_len, int proto, u8 action, u32 tcp_seq_num,
@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * UDP throughput and latency benchmark
+ */
+
+#ifndef __NETPERF_H__
+#define __NETPERF_H__
+
+#include <net.h>
+
+#define NETPERF_PORT		5001
+#define NETPERF_MAGIC		0x4e505246	/* "NPRF" */
+/* UDP payload which fills a 1500-byte MTU */
+#define NETPERF_MAX_SIZE	(1500 - IP_UDP_HDR_SIZE)
+
+/**
+ * struct netperf_hdr - start of the payload of every benchmark packet
+ *
+ * All fields are in network byte order. The rest of the payload is filler.
+ *
+ * @magic: NETPERF_MAGIC
+ * @seq: sequence number, counting from 0
+ * @usec: sender's microsecond timer when the packet was sent
+ */
+struct netperf_hdr {
+	u32 magic;
+	u32 seq;
+	u32 usec;
+} __attribute__((packed));
+
+enum netperf_mode {
+	NETPERF_SINK,		/* count the packets a host sends us */
+	NETPERF_SOURCE,		/* send packets to a host */
+};
+
+/**
+ * struct netperf_params - what the benchmark should do
+ *
+ * @mode: sink or source
+ * @ip: host to send to, for a source
+ * @port: UDP port to listen on for a sink, to send to for a source
+ * @duration: length of the test in milliseconds. A sink also stops when no
+ *	      packet came for a while, a source only stops after @duration.
+ * @size: UDP payload size of the packets sent by a source
+ */
+struct netperf_params {
+	enum netperf_mode mode;
+	struct in_addr ip;
+	int port;
+	ulong duration;
+	int size;
+};
+
+int netperf_prereq(void *data);
+int netperf_start(void *data);	/* Begin the benchmark */
+
+#endif /* __NETPERF_H__ */
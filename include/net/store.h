@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Write a file to a block device while it is downloaded
+ */
+
+#ifndef __NET_STORE_H__
+#define __NET_STORE_H__
+
+#include <linux/errno.h>
+#include <linux/types.h>
+
+struct blk_desc;
+struct disk_partition;
+
+#ifdef CONFIG_CMD_NETINSTALL
+/**
+ * net_store_start() - Send the next download to a block device
+ *
+ * Until net_store_stop() is called, tftp and nfs pass the file to
+ * net_store_write() instead of storing it at the load address. The memory at
+ * the load address is used as a buffer of CONFIG_NET_STORE_BUF_SIZE bytes,
+ * which must not overlap memory reserved in lmb.
+ *
+ * @desc: device to write to
+ * @info: partition of @desc to write to, or the whole device
+ * @name: name of the partition, for messages
+ * Return: 0 if OK, -ve on error
+ */
+int net_store_start(struct blk_desc *desc, struct disk_partition *info,
+		    const char *name);
+
+/**
+ * net_store_active() - Check whether downloads go to a block device
+ *
+ * Return: true between net_store_start() and net_store_stop()
+ */
+bool net_store_active(void);
+
+/**
+ * net_store_write() - Store part of the file being downloaded
+ *
+ * The parts may come in any order, as long as none is more than the buffer
+ * size ahead of the first byte still missing. Parts that are already stored
+ * are ignored.
+ *
+ * @offset: offset of @src in the file
+ * @src: file data
+ * @len: number of bytes at @src
+ * Return: 0 if OK, -ve on error
+ */
+int net_store_write(ulong offset, const void *src, ulong len);
+
+/**
+ * net_store_fits() - Check whether a file fits on the device
+ *
+ * @size: size of the file in bytes
+ * Return: true if it does, as far as can be told before it is downloaded
+ */
+bool net_store_fits(ulong size);
+
+/**
+ * net_store_finish() - Write out the rest of the file
+ *
+ * The end of the file is padded with zeros to a whole block.
+ *
+ * Return: 0 if the whole file was written, -ve on error
+ */
+int net_store_finish(void);
+
+/* Let downloads go to the load address again */
+void net_store_stop(void);
+#else
+static inline bool net_store_active(void)
+{
+	return false;
+}
+
+static inline int net_store_write(ulong offset, const void *src, ulong len)
+{
+	return -ENOSYS;
+}
+
+static inline bool net_store_fits(ulong size)
+{
+	return false;
+}
+#endif
+
+#endif /* __NET_STORE_H__ */
@@ -0,0 +1,173 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Minimal TCP for downloading files
+ */
+
+#ifndef __TCP_H__
+#define __TCP_H__
+
+#include <net.h>
+
+/*
+ *	Internet Protocol (IP) + TCP header.
+ */
+struct ip_tcp_hdr {
+	u8		ip_hl_v;	/* header length and version	*/
+	u8		ip_tos;		/* type of service		*/
+	u16		ip_len;		/* total length			*/
+	u16		ip_id;		/* identification		*/
+	u16		ip_off;		/* fragment offset field	*/
+	u8		ip_ttl;		/* time to live			*/
+	u8		ip_p;		/* protocol			*/
+	u16		ip_sum;		/* checksum			*/
+	struct in_addr	ip_src;		/* Source IP address		*/
+	struct in_addr	ip_dst;		/* Destination IP address	*/
+	u16		tcp_src;	/* TCP source port		*/
+	u16		tcp_dst;	/* TCP destination port		*/
+	u32		tcp_seq;	/* Sequence number		*/
+	u32		tcp_ack;	/* Acknowledgment number	*/
+	u8		tcp_hlen;	/* 4 bits header length, 4 rsvd	*/
+	u8		tcp_flags;	/* Control flags		*/
+	u16		tcp_win;	/* Receive window		*/
+	u16		tcp_xsum;	/* Checksum			*/
+	u16		tcp_ugr;	/* Urgent pointer		*/
+} __attribute__((packed));
+
+#define IP_TCP_HDR_SIZE		(sizeof(struct ip_tcp_hdr))
+#define TCP_HDR_SIZE		(IP_TCP_HDR_SIZE - IP_HDR_SIZE)
+
+/* Control flags */
+#define TCP_FIN		0x01
+#define TCP_SYN		0x02
+#define TCP_RST		0x04
+#define TCP_PUSH	0x08
+#define TCP_ACK		0x10
+#define TCP_URG		0x20
+
+/* Options */
+#define TCP_O_END	0	/* End of option list */
+#define TCP_O_NOP	1	/* No operation */
+#define TCP_O_MSS	2	/* Maximum segment size */
+#define TCP_O_WS	3	/* Window scale */
+
+/* Options sent with our SYN: MSS, then a NOP to align the window scale */
+#define TCP_SYN_OPT_SIZE	8
+
+/* Largest segment fitting in an Ethernet frame without fragmentation */
+#define TCP_MSS			(1500 - IP_TCP_HDR_SIZE)
+/* MSS to assume if the other end does not give one */
+#define TCP_DEFAULT_MSS		536
+
+/* Largest window scale allowed by RFC 7323 */
+#define TCP_MAX_WSCALE		14
+
+/**
+ * enum tcp_event - events reported to the client of a connection
+ *
+ * @TCP_EV_CONNECTED:	the connection is established, data may be sent
+ * @TCP_EV_DATA:	more data was received in order, see tcp_rx_len()
+ * @TCP_EV_CLOSED:	the other end has closed the connection
+ * @TCP_EV_RESET:	the connection was reset by the other end
+ * @TCP_EV_TIMEOUT:	the other end stopped responding
+ */
+enum tcp_event {
+	TCP_EV_CONNECTED,
+	TCP_EV_DATA,
+	TCP_EV_CLOSED,
+	TCP_EV_RESET,
+	TCP_EV_TIMEOUT,
+};
+
+/**
+ * struct tcp_ops - client of a TCP connection
+ *
+ * @rx: called with each segment of data received, which may not be in
+ *	order. @offset is the position of @data in the stream received, from
+ *	0. Returns 0 if the data was stored, or -EAGAIN if it cannot be placed
+ *	yet, in which case it is dropped and will be sent again by the other
+ *	end. The same data may be passed more than once.
+ * @event: called when something happens to the connection. This may call
+ *	tcp_send() and tcp_close().
+ */
+struct tcp_ops {
+	int (*rx)(u32 offset, const uchar *data, uint len);
+	void (*event)(enum tcp_event event);
+};
+
+/**
+ * tcp_connect() - open a connection
+ *
+ * Only a single connection is supported, and any previous one is dropped.
+ * The result is reported through the @ops->event() callback.
+ *
+ * @dest:	IP address to connect to
+ * @dport:	port to connect to
+ * @ops:	client of the connection
+ * @rx_limit:	number of bytes the client can take, which bounds the
+ *		receive window advertised
+ * Return: 0 if OK, -ve on error
+ */
+int tcp_connect(struct in_addr dest, int dport, const struct tcp_ops *ops,
+		u32 rx_limit);
+
+/**
+ * tcp_send() - queue data to send on the connection
+ *
+ * @data:	data to send
+ * @len:	number of bytes at @data
+ * Return: 0 if OK, -ENOTCONN if the connection is not open, -ENOSPC if the
+ *	send buffer is full
+ */
+int tcp_send(const void *data, uint len);
+
+/**
+ * tcp_close() - close the connection
+ *
+ * A FIN is sent once the data queued has been sent. Data may still be
+ * received until the other end closes as well.
+ */
+void tcp_close(void);
+
+/**
+ * tcp_abort() - reset the connection
+ */
+void tcp_abort(void);
+
+/**
+ * tcp_rx_len() - get the number of bytes received in order
+ *
+ * Return: number of bytes received without a gap from the start of the
+ *	stream
+ */
+u32 tcp_rx_len(void);
+
+/**
+ * tcp_set_tcp_header() - set up the IP and TCP headers of a packet
+ *
+ * Any data must already be at @pkt + IP_TCP_HDR_SIZE. A SYN carries our
+ * options, and no data.
+ *
+ * @pkt:	start of the IP header
+ * @dest:	destination IP address
+ * @dport:	destination port
+ * @sport:	source port
+ * @payload_len: number of bytes of data
+ * @action:	TCP control flags
+ * @tcp_seq_num: sequence number
+ * @tcp_ack_num: acknowledgment number
+ * Return: size of the IP and TCP headers
+ */
+int tcp_set_tcp_header(uchar *pkt, struct in_addr dest, int dport, int sport,
+		       int payload_len, u8 action, u32 tcp_seq_num,
+		       u32 tcp_ack_num);
+
+/**
+ * tcp_receive() - process a TCP packet
+ *
+ * @ip:		IP packet
+ * @len:	length of the IP packet
+ * @csum_ok:	the device has already verified the TCP checksum
+ */
+void tcp_receive(struct ip_tcp_hdr *ip, int len, bool csum_ok);
+
+#endif /* __TCP_H__ */
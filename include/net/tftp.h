@@ -18,6 +18,13 @@
 /* tftp.c */
 void tftp_start(enum proto_t protocol);	/* Begin TFTP get/put */
 
+/*
+ * Fetch another file, from the same server, alongside the boot file in the
+ * next TFTP get. Returns -ENOSPC once CONFIG_TFTP_MAX_FILES are set.
+ */
+int tftp_add_file(ulong addr, const char *name);
+void tftp_clear_files(void);	/* Forget files from tftp_add_file() */
+
 #ifdef CONFIG_CMD_TFTPSRV
 void tftp_start_server(void);	/* Wait for incoming TFTP put */
 #endif
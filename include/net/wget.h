@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * HTTP/1.1 client for downloading files
+ */
+
+#ifndef __WGET_H__
+#define __WGET_H__
+
+/* Port of the HTTP server, unless set by the 'httpdstp' variable */
+#define WGET_PORT	80
+
+/**
+ * wget_start() - begin an HTTP GET of net_boot_file_name
+ *
+ * The file is given as [hostIPaddr:]path, and its body is stored at
+ * image_load_addr.
+ */
+void wget_start(void);
+
+#endif /* __WGET_H__ */
@@ -9,8 +9,58 @@
 #ifndef _OF_LIVE_H
 #define _OF_LIVE_H
 
+#include <linux/types.h>
+
 struct device_node;
 
+/**
+ * struct of_live_names - property names of the live tree
+ *
+ * The properties of the live tree point into the strings block of the flat
+ * devicetree for their names, using a single copy of each name, so that
+ * of_find_property() can compare them by pointer. Properties added later have
+ * names outside the strings block and are compared with strcmp().
+ *
+ * @strings: strings block of the devicetree the live tree was built from
+ * @strings_size: size of @strings in bytes
+ * @count: number of names in @slot
+ * @mask: number of entries in @slot, less one; the number is a power of two
+ * @slot: hash table of the names, NULL for unused entries
+ */
+struct of_live_names {
+	const char *strings;
+	int strings_size;
+	uint count;
+	uint mask;
+	const char *slot[];
+};
+
+/**
+ * of_live_name_shared() - Check if a property name is from the strings block
+ *
+ * @names: names of the live tree, or NULL if there are none
+ * @name: name of a property in the live tree
+ * @return true if @name is the single copy of the name, false if it must be
+ *	compared with strcmp()
+ */
+static inline bool of_live_name_shared(const struct of_live_names *names,
+				       const char *name)
+{
+	return names && name >= names->strings &&
+	       name < names->strings + names->strings_size;
+}
+
+/**
+ * of_live_find_name() - Find the single copy of a property name
+ *
+ * @names: names of the live tree
+ * @name: name to find
+ * @return copy of @name used by the live tree, or NULL if no property in the
+ *	devicetree has that name
+ */
+const char *of_live_find_name(const struct of_live_names *names,
+			      const char *name);
+
 /**
  * of_live_build() - build a live (hierarchical) tree from a flat DT
  *
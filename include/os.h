@@ -456,4 +456,32 @@ long os_get_time_offset(void);
  */
 void os_set_time_offset(long offset);
 
+/**
+ * os_thread_create() - start a host thread
+ *
+ * @func:	function to run in the thread
+ * @arg:	argument passed to @func
+ * Return:	thread handle, or NULL on error
+ */
+void *os_thread_create(void (*func)(void *arg), void *arg);
+
+/**
+ * os_thread_join() - wait for a host thread to finish and free it
+ *
+ * @thread:	thread handle returned by os_thread_create()
+ */
+void os_thread_join(void *thread);
+
+/**
+ * os_thread_self() - get a non-zero ID for the calling host thread
+ *
+ * Return:	thread ID
+ */
+unsigned long os_thread_self(void);
+
+/**
+ * os_thread_yield() - let other host threads run
+ */
+void os_thread_yield(void);
+
 #endif
@@ -326,6 +326,7 @@ struct sdhci_host {
 	void *align_buffer;
 	bool force_align_buffer;
 	dma_addr_t start_addr;
+	int is_aligned;		/* for a transfer left running by send_cmd_start */
 	int flags;
 #define USE_SDMA	(0x1 << 0)
 #define USE_ADMA	(0x1 << 1)
@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Running jobs on secondary CPUs
+ *
+ * U-Boot itself only runs on the boot CPU. This allows self-contained pieces
+ * of work, such as decompressing or hashing an image, to be handed to the
+ * other CPUs while the boot CPU carries on, then joined later.
+ *
+ * A job may allocate memory, print and run jobs of its own, but must not
+ * otherwise touch shared state (driver model, environment, etc.) without its
+ * own locking.
+ */
+
+#ifndef __SMP_JOB_H
+#define __SMP_JOB_H
+
+/**
+ * struct smp_job - a job to run on a secondary CPU
+ *
+ * @func:	function to run, returns 0 on success or an error code
+ * @arg:	argument passed to @func
+ * @ret:	return value of @func, valid once the job is done
+ * @cpu:	job CPU which ran the job (see smp_job_cpu())
+ * @done:	set once the job has finished
+ */
+struct smp_job {
+	int (*func)(void *arg);
+	void *arg;
+	int ret;
+	int cpu;
+	int done;
+};
+
+#if CONFIG_IS_ENABLED(SMP_JOB)
+/**
+ * smp_job_start() - start running a job
+ *
+ * The job is handed to an idle secondary CPU, starting them if needed. If
+ * there is none, it is run immediately on the calling CPU.
+ *
+ * This may also be called from a job, which may then wait for the jobs it
+ * started. The secondary CPUs are already running in that case.
+ *
+ * @job:	job to run, which must stay valid until smp_job_wait()
+ * @func:	function to run
+ * @arg:	argument passed to @func
+ */
+void smp_job_start(struct smp_job *job, int (*func)(void *arg), void *arg);
+
+/**
+ * smp_job_wait() - wait for a job to finish
+ *
+ * @job:	job started with smp_job_start()
+ * Return: the job's return value
+ */
+int smp_job_wait(struct smp_job *job);
+
+/**
+ * smp_job_stop() - wait for all jobs, then park the secondary CPUs
+ *
+ * This must be called before handing over to an OS, which expects to find
+ * the secondary CPUs where the firmware left them. They are started again
+ * by the next smp_job_start().
+ */
+void smp_job_stop(void);
+
+/**
+ * smp_job_cpu() - get the job CPU number of the caller
+ *
+ * Return: 0 on the boot CPU, or 1 to n on the secondary CPUs running jobs
+ */
+int smp_job_cpu(void);
+
+/**
+ * smp_job_lock() - take the lock serialising shared services
+ *
+ * This is used by malloc() and the console so that jobs may use them. The
+ * lock is recursive and does nothing while no secondary CPU is running.
+ */
+void smp_job_lock(void);
+
+/**
+ * smp_job_unlock() - release the lock taken by smp_job_lock()
+ */
+void smp_job_unlock(void);
+#else
+static inline void smp_job_start(struct smp_job *job, int (*func)(void *arg),
+				 void *arg)
+{
+	job->ret = func(arg);
+	job->cpu = 0;
+	job->done = 1;
+}
+
+static inline int smp_job_wait(struct smp_job *job)
+{
+	return job->ret;
+}
+
+static inline void smp_job_stop(void) {}
+
+static inline int smp_job_cpu(void)
+{
+	return 0;
+}
+
+static inline void smp_job_lock(void) {}
+static inline void smp_job_unlock(void) {}
+#endif
+
+/*
+ * Architecture hooks, used by common/smp_job.c
+ */
+
+/**
+ * arch_smp_job_start() - start the secondary CPUs
+ *
+ * Each secondary CPU calls @entry with its job CPU number, from 1 to the
+ * returned count. When @entry returns, the CPU must be parked as it was
+ * before this call.
+ *
+ * @max:	maximum number of CPUs to start
+ * @entry:	function to run on each CPU
+ * Return: number of CPUs started, or -ve on error
+ */
+int arch_smp_job_start(int max, void (*entry)(int cpu));
+
+/**
+ * arch_smp_job_stop() - wait for the secondary CPUs to be parked
+ *
+ * This is called once the @entry function passed to arch_smp_job_start() has
+ * returned, or is about to return, on every secondary CPU.
+ */
+void arch_smp_job_stop(void);
+
+/**
+ * arch_smp_job_cpu_id() - get a unique non-zero ID for the calling CPU
+ */
+ulong arch_smp_job_cpu_id(void);
+
+/**
+ * arch_smp_job_wait_event() - wait for an event from another CPU
+ *
+ * This may return early, so the caller must check its condition again.
+ */
+void arch_smp_job_wait_event(void);
+
+/**
+ * arch_smp_job_send_event() - wake up the CPUs in arch_smp_job_wait_event()
+ */
+void arch_smp_job_send_event(void);
+
+#endif /* __SMP_JOB_H */
@@ -60,6 +60,21 @@ void sha1_update(sha1_context *ctx, const unsigned char *input,
  */
 void sha1_finish( sha1_context *ctx, unsigned char output[20] );
 
+/**
+ * \brief	   SHA-1 process whole 64-byte blocks
+ *
+ * Architectures with SHA-1 instructions may provide their own version of
+ * this function; sha1_base_process() is the portable one.
+ *
+ * \param ctx	   SHA-1 context
+ * \param data	   buffer holding the blocks
+ * \param blocks   number of blocks to process
+ */
+void sha1_process(sha1_context *ctx, const unsigned char *data,
+		  unsigned int blocks);
+void sha1_base_process(sha1_context *ctx, const unsigned char *data,
+		       unsigned int blocks);
+
 /**
  * \brief	   Output = SHA-1( input buffer )
  *
@@ -19,6 +19,16 @@ void sha256_starts(sha256_context * ctx);
 void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length);
 void sha256_finish(sha256_context * ctx, uint8_t digest[SHA256_SUM_LEN]);
 
+/*
+ * Process whole 64-byte blocks. Architectures with SHA-256 instructions may
+ * provide their own sha256_process(); sha256_base_process() is the portable
+ * version.
+ */
+void sha256_process(sha256_context *ctx, const uint8_t *data,
+		    unsigned int blocks);
+void sha256_base_process(sha256_context *ctx, const uint8_t *data,
+			 unsigned int blocks);
+
 void sha256_csum_wd(const unsigned char *input, unsigned int ilen,
 		unsigned char *output, unsigned int chunk_sz);
 
@@ -22,6 +22,16 @@ void sha512_starts(sha512_context * ctx);
 void sha512_update(sha512_context *ctx, const uint8_t *input, uint32_t length);
 void sha512_finish(sha512_context * ctx, uint8_t digest[SHA512_SUM_LEN]);
 
+/*
+ * Process whole SHA512_BLOCK_SIZE blocks, for both SHA-512 and SHA-384.
+ * Architectures with SHA-512 instructions may provide their own
+ * sha512_process(); sha512_base_process() is the portable version.
+ */
+void sha512_process(sha512_context *ctx, const uint8_t *data,
+		    unsigned int blocks);
+void sha512_base_process(sha512_context *ctx, const uint8_t *data,
+			 unsigned int blocks);
+
 void sha512_csum_wd(const unsigned char *input, unsigned int ilen,
 		unsigned char *output, unsigned int chunk_sz);
 
@@ -12,10 +12,63 @@
 
 #include <common.h>
 #include <compiler.h>
+#include <u-boot/crc.h>
+#ifdef CONFIG_ARMV8_CE_CRC32
+#include <asm/armv8/crc32.h>
+#endif
+
+/* Bit-reflected CRC32C (Castagnoli) polynomial */
+#define CRC32C_POLY	0x82F63B78
+
+#if CONFIG_IS_ENABLED(CRC32_SLICE8)
+/*
+ * Slice-by-8 tables for the polynomial last passed to crc32c_init():
+ * crc32c_slice[k][n] is the CRC of byte n followed by k zero bytes. A
+ * reflected table holds its polynomial at index 128, which is how
+ * crc32c_cal() tells whether these match the table it is given.
+ */
+static uint32_t crc32c_slice[8][256];
+static uint32_t crc32c_slice_poly;
+
+static uint32_t crc32c_slice8(uint32_t crc, const u8 *p, int length)
+{
+	uint32_t (*tab)[256] = crc32c_slice;
+	uint32_t one, two;
+
+	while (length && ((ulong)p & 3)) {
+		crc = tab[0][(u8)(crc ^ *p++)] ^ (crc >> 8);
+		length--;
+	}
+
+	for (; length >= 8; length -= 8, p += 8) {
+		one = crc ^ le32_to_cpu(*(const uint32_t *)p);
+		two = le32_to_cpu(*(const uint32_t *)(p + 4));
+
+		crc = tab[7][one & 255] ^ tab[6][(one >> 8) & 255] ^
+		      tab[5][(one >> 16) & 255] ^ tab[4][one >> 24] ^
+		      tab[3][two & 255] ^ tab[2][(two >> 8) & 255] ^
+		      tab[1][(two >> 16) & 255] ^ tab[0][two >> 24];
+	}
+
+	while (length--)
+		crc = tab[0][(u8)(crc ^ *p++)] ^ (crc >> 8);
+
+	return crc;
+}
+#endif
 
 uint32_t crc32c_cal(uint32_t crc, const char *data, int length,
 		    uint32_t *crc32c_table)
 {
+#ifdef CONFIG_ARMV8_CE_CRC32
+	if (length > 0 && crc32c_table[128] == CRC32C_POLY &&
+	    crc32_armv8_supported())
+		return crc32c_armv8_le(crc, (const u8 *)data, length);
+#endif
+#if CONFIG_IS_ENABLED(CRC32_SLICE8)
+	if (crc32c_slice_poly && crc32c_table[128] == crc32c_slice_poly)
+		return crc32c_slice8(crc, (const u8 *)data, length);
+#endif
 	while (length--)
 		crc = crc32c_table[(u8)(crc ^ *data++)] ^ (crc >> 8);
 
@@ -35,4 +88,15 @@ void crc32c_init(uint32_t *crc32c_table, uint32_t pol)
 
 		crc32c_table[i] = v;
 	}
+
+#if CONFIG_IS_ENABLED(CRC32_SLICE8)
+	memcpy(crc32c_slice[0], crc32c_table, sizeof(crc32c_slice[0]));
+	for (i = 1; i < ARRAY_SIZE(crc32c_slice); i++) {
+		for (j = 0; j < 256; j++) {
+			v = crc32c_slice[i - 1][j];
+			crc32c_slice[i][j] = crc32c_slice[0][v & 0xff] ^ (v >> 8);
+		}
+	}
+	crc32c_slice_poly = poly;
+#endif
 }
@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Decompression of payloads made of independently compressed frames
+ *
+ * The payload is scanned twice, first to count the frames and then to fill
+ * in the list of jobs, which are then run on the secondary CPUs.
+ */
+
+#define LOG_CATEGORY LOGC_BOOT
+
+#include <common.h>
+#include <decomp_frames.h>
+#include <gzip.h>
+#include <log.h>
+#include <malloc.h>
+#include <smp_job.h>
+#include <asm/unaligned.h>
+#include <linux/zstd.h>
+
+#define GZIP_HEADER_SIZE	10
+#define GZIP_TRAILER_SIZE	8
+#define GZIP_FLAGS		3
+#define GZIP_EXTRA_FIELD	4
+#define GZIP_DEFLATED		8
+
+/**
+ * struct decomp_frame - a frame to decompress
+ *
+ * @job:	job decompressing the frame
+ * @src:	compressed frame
+ * @src_len:	size of @src
+ * @dst:	where to put the decompressed frame
+ * @dst_len:	size of the decompressed frame
+ */
+struct decomp_frame {
+	struct smp_job job;
+	const u8 *src;
+	ulong src_len;
+	u8 *dst;
+	ulong dst_len;
+};
+
+/**
+ * decomp_scan_t - find the frames in a payload
+ *
+ * @src:	payload
+ * @srclen:	size of @src
+ * @dst:	destination buffer
+ * @frames:	frames to fill in, or NULL to just count them
+ * Return: number of frames, or -ve on error
+ */
+typedef int (*decomp_scan_t)(const u8 *src, ulong srclen, u8 *dst,
+			     struct decomp_frame *frames);
+
+static void decomp_frame_set(struct decomp_frame *frame, const u8 *src,
+			     ulong src_len, u8 *dst, ulong dst_len)
+{
+	frame->src = src;
+	frame->src_len = src_len;
+	frame->dst = dst;
+	frame->dst_len = dst_len;
+}
+
+static int decomp_frames(void *dst, ulong dstlen, const void *src,
+			 ulong srclen, ulong *lenp, decomp_scan_t scan,
+			 int (*func)(void *arg))
+{
+	struct decomp_frame *frames, *last;
+	int count, ret, err, i;
+	ulong len;
+
+	count = scan(src, srclen, dst, NULL);
+	if (count < 0)
+		return count;
+	if (count < 2)
+		return -ENOENT;
+
+	frames = calloc(count, sizeof(*frames));
+	if (!frames)
+		return -ENOMEM;
+	scan(src, srclen, dst, frames);
+	last = &frames[count - 1];
+	len = last->dst + last->dst_len - (u8 *)dst;
+	if (len > dstlen) {
+		free(frames);
+		return -ENOSPC;
+	}
+
+	log_debug("Decompressing %d frames, %lx bytes\n", count, len);
+	for (i = 0; i < count; i++)
+		smp_job_start(&frames[i].job, func, &frames[i]);
+	ret = 0;
+	for (i = 0; i < count; i++) {
+		err = smp_job_wait(&frames[i].job);
+		if (err && !ret) {
+			log_debug("Frame %d failed (err=%d)\n", i, err);
+			ret = err;
+		}
+	}
+	free(frames);
+	if (ret)
+		return ret;
+	*lenp = len;
+
+	return 0;
+}
+
+#if CONFIG_IS_ENABLED(GZIP)
+ulong gzip_frame_size(const void *buf, ulong len)
+{
+	const u8 *src = buf, *extra, *end;
+	ulong size = 0;
+	uint xlen, slen;
+
+	if (len < GZIP_HEADER_SIZE + 2 || src[0] != 0x1f || src[1] != 0x8b ||
+	    src[2] != GZIP_DEFLATED || !(src[GZIP_FLAGS] & GZIP_EXTRA_FIELD))
+		return 0;
+	xlen = get_unaligned_le16(src + GZIP_HEADER_SIZE);
+	if (len - GZIP_HEADER_SIZE - 2 < xlen)
+		return 0;
+
+	extra = src + GZIP_HEADER_SIZE + 2;
+	end = extra + xlen;
+	for (; end - extra >= 4; extra += 4 + slen) {
+		slen = get_unaligned_le16(extra + 2);
+		if (end - extra - 4 < slen)
+			break;
+		if (extra[0] == GZIP_SUBFIELD_UB1 &&
+		    extra[1] == GZIP_SUBFIELD_UB2 &&
+		    slen == GZIP_SUBFIELD_UB_LEN)
+			size = get_unaligned_le32(extra + 4);
+		else if (extra[0] == 'B' && extra[1] == 'C' && slen == 2)
+			size = get_unaligned_le16(extra + 4) + 1;
+	}
+	if (size < end - src + GZIP_TRAILER_SIZE)
+		return 0;
+
+	return size;
+}
+
+static int gzip_scan(const u8 *src, ulong srclen, u8 *dst,
+		     struct decomp_frame *frames)
+{
+	ulong pos, size, isize;
+	int count = 0;
+
+	for (pos = 0; srclen - pos >= GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE &&
+	     src[pos] == 0x1f && src[pos + 1] == 0x8b; pos += size) {
+		size = gzip_frame_size(src + pos, srclen - pos);
+		if (!size || size > srclen - pos)
+			return -ENOENT;
+		isize = get_unaligned_le32(src + pos + size - 4);
+
+		/* bgzip ends its files with an empty member */
+		if (!isize)
+			continue;
+		if (frames)
+			decomp_frame_set(&frames[count], src + pos, size, dst,
+					 isize);
+		dst += isize;
+		count++;
+	}
+
+	return count;
+}
+
+static int gzip_decomp_frame(void *arg)
+{
+	struct decomp_frame *frame = arg;
+	ulong len = frame->src_len;
+	int offset;
+
+	offset = gzip_parse_header(frame->src, len);
+	if (offset < 0)
+		return -EINVAL;
+	if (zunzip(frame->dst, frame->dst_len, (uchar *)frame->src, &len, 1,
+		   offset))
+		return -EIO;
+
+	return len == frame->dst_len ? 0 : -EIO;
+}
+
+int gzip_decomp_frames(void *dst, ulong dstlen, const void *src, ulong srclen,
+		       ulong *lenp)
+{
+	return decomp_frames(dst, dstlen, src, srclen, lenp, gzip_scan,
+			     gzip_decomp_frame);
+}
+#endif /* GZIP */
+
+#if CONFIG_IS_ENABLED(ZSTD)
+/* Use the seek table of the zstd seekable format, if present */
+static int zstd_scan_seek_table(const u8 *src, ulong srclen, u8 *dst,
+				struct decomp_frame *frames)
+{
+	const u8 *footer, *entry;
+	uint count, entry_size, i;
+	ulong pos, csize, dsize;
+	u64 table_size;
+
+	if (srclen < 8 + ZSTD_SEEKABLE_FOOTER_SIZE)
+		return -ENOENT;
+	footer = src + srclen - ZSTD_SEEKABLE_FOOTER_SIZE;
+	if (get_unaligned_le32(footer + 5) != ZSTD_SEEKABLE_FOOTER_MAGIC)
+		return -ENOENT;
+	count = get_unaligned_le32(footer);
+	entry_size = footer[4] & ZSTD_SEEKABLE_CHECKSUM_FLAG ? 12 : 8;
+	table_size = 8 + (u64)count * entry_size + ZSTD_SEEKABLE_FOOTER_SIZE;
+	if (table_size > srclen || count > INT_MAX)
+		return -ENOENT;
+	entry = src + srclen - table_size;
+	if (get_unaligned_le32(entry) != ZSTD_SEEKABLE_MAGIC ||
+	    get_unaligned_le32(entry + 4) != table_size - 8)
+		return -ENOENT;
+
+	srclen -= table_size;
+	entry += 8;
+	for (i = 0, pos = 0; i < count; i++, entry += entry_size) {
+		csize = get_unaligned_le32(entry);
+		dsize = get_unaligned_le32(entry + 4);
+		if (csize > srclen - pos)
+			return -ENOENT;
+		if (frames)
+			decomp_frame_set(&frames[i], src + pos, csize, dst,
+					 dsize);
+		pos += csize;
+		dst += dsize;
+	}
+	if (pos != srclen)
+		return -ENOENT;
+
+	return count;
+}
+
+static int zstd_scan(const u8 *src, ulong srclen, u8 *dst,
+		     struct decomp_frame *frames)
+{
+	unsigned long long dsize;
+	size_t csize;
+	ulong pos;
+	int count;
+
+	count = zstd_scan_seek_table(src, srclen, dst, frames);
+	if (count != -ENOENT)
+		return count;
+
+	/* Otherwise walk the frames, which must each give their size */
+	for (pos = 0, count = 0; pos < srclen; pos += csize) {
+		csize = ZSTD_findFrameCompressedSize(src + pos, srclen - pos);
+		if (ZSTD_isError(csize))
+			return -ENOENT;
+		if (get_unaligned_le32(src + pos) != ZSTD_MAGICNUMBER)
+			continue;
+		dsize = ZSTD_getFrameContentSize(src + pos, srclen - pos);
+		if (dsize == ZSTD_CONTENTSIZE_UNKNOWN ||
+		    dsize == ZSTD_CONTENTSIZE_ERROR || dsize > ULONG_MAX)
+			return -ENOENT;
+		if (frames)
+			decomp_frame_set(&frames[count], src + pos, csize, dst,
+					 dsize);
+		dst += dsize;
+		count++;
+	}
+
+	return count;
+}
+
+static int zstd_decomp_frame(void *arg)
+{
+	struct decomp_frame *frame = arg;
+	ZSTD_DCtx *dctx;
+	void *workspace;
+	size_t wsize;
+	size_t ret;
+
+	wsize = ZSTD_DCtxWorkspaceBound();
+	workspace = malloc(wsize);
+	if (!workspace)
+		return -ENOMEM;
+	dctx = ZSTD_initDCtx(workspace, wsize);
+	if (!dctx) {
+		free(workspace);
+		return -EINVAL;
+	}
+	ret = ZSTD_decompressDCtx(dctx, frame->dst, frame->dst_len,
+				  frame->src, frame->src_len);
+	free(workspace);
+	if (ZSTD_isError(ret) || ret != frame->dst_len)
+		return -EIO;
+
+	return 0;
+}
+
+int zstd_decomp_frames(void *dst, ulong dstlen, const void *src, ulong srclen,
+		       ulong *lenp)
+{
+	return decomp_frames(dst, dstlen, src, srclen, lenp, zstd_scan,
+			     zstd_decomp_frame);
+}
+#endif /* ZSTD */
@@ -8,6 +8,7 @@
 #include <blk.h>
 #include <command.h>
 #include <console.h>
+#include <decomp_frames.h>
 #include <div64.h>
 #include <gzip.h>
 #include <image.h>
@@ -74,8 +75,15 @@ int gzip_parse_header(const unsigned char *src, unsigned long len)
 
 int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 {
-	int offset = gzip_parse_header(src, *lenp);
+	int offset;
+	int ret;
 
+	/* Members which give their size can be inflated in parallel */
+	ret = gzip_decomp_frames(dst, (uint)dstlen, src, *lenp, lenp);
+	if (ret != -ENOENT)
+		return ret;
+
+	offset = gzip_parse_header(src, *lenp);
 	if (offset < 0)
 		return offset;
 
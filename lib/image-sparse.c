@@ -49,6 +49,58 @@
 
 static void default_log(const char *ignored, char *response) {}
 
+/* Write @blkcnt blocks filled with @fill_val at *@blk and move *@blk on */
+static int write_fill(struct sparse_storage *info, lbaint_t *blk,
+		      lbaint_t blkcnt, uint32_t fill_val, char *response)
+{
+	int fill_buf_num_blks;
+	uint32_t *fill_buf;
+	lbaint_t blks;
+	int i;
+	int j;
+
+	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
+
+	if (*blk + blkcnt > info->start + info->size) {
+		printf("%s: Request would exceed partition size!\n", __func__);
+		info->mssg("Request would exceed partition size!", response);
+		return -1;
+	}
+
+	fill_buf = (uint32_t *)
+		   memalign(ARCH_DMA_MINALIGN,
+			    ROUNDUP(info->blksz * fill_buf_num_blks,
+				    ARCH_DMA_MINALIGN));
+	if (!fill_buf) {
+		info->mssg("Malloc failed for: CHUNK_TYPE_FILL", response);
+		return -1;
+	}
+
+	for (i = 0; i < (info->blksz * fill_buf_num_blks / sizeof(fill_val));
+	     i++)
+		fill_buf[i] = fill_val;
+
+	for (i = 0; i < blkcnt;) {
+		j = blkcnt - i;
+		if (j > fill_buf_num_blks)
+			j = fill_buf_num_blks;
+		blks = info->write(info, *blk, j, fill_buf);
+		/* blks might be > j (eg. NAND bad-blocks) */
+		if (blks < j) {
+			printf("%s: %s " LBAFU " [%d]\n", __func__,
+			       "Write failed, block #", *blk, j);
+			info->mssg("flash write failure", response);
+			free(fill_buf);
+			return -1;
+		}
+		*blk += blks;
+		i += j;
+	}
+
+	free(fill_buf);
+	return 0;
+}
+
 int write_sparse_image(struct sparse_storage *info,
 		       const char *part_name, void *data, char *response)
 {
@@ -59,16 +111,10 @@ int write_sparse_image(struct sparse_storage *info,
 	unsigned int chunk;
 	unsigned int offset;
 	unsigned int chunk_data_sz;
-	uint32_t *fill_buf = NULL;
 	uint32_t fill_val;
 	sparse_header_t *sparse_header;
 	chunk_header_t *chunk_header;
 	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
-	int i;
-	int j;
-
-	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
 
 	/* Read and skip over sparse image header */
 	sparse_header = (sparse_header_t *)data;
@@ -174,57 +220,13 @@ int write_sparse_image(struct sparse_storage *info,
 				return -1;
 			}
 
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
-			if (!fill_buf) {
-				info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
-					   response);
-				return -1;
-			}
-
 			fill_val = *(uint32_t *)data;
 			data = (char *)data + sizeof(uint32_t);
 
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
-				fill_buf[i] = fill_val;
-
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				info->mssg("Request would exceed partition size!",
-					   response);
+			if (write_fill(info, &blk, blkcnt, fill_val, response))
 				return -1;
-			}
-
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					info->mssg("flash write failure",
-						   response);
-					free(fill_buf);
-					return -1;
-				}
-				blk += blks;
-				i += j;
-			}
 			bytes_written += blkcnt * info->blksz;
 			total_blocks += chunk_data_sz / sparse_header->blk_sz;
-			free(fill_buf);
 			break;
 
 		case CHUNK_TYPE_DONT_CARE:
@@ -262,3 +264,194 @@ int write_sparse_image(struct sparse_storage *info,
 
 	return 0;
 }
+
+int sparse_stream_init(struct sparse_stream *ss, struct sparse_storage *info,
+		       char *response)
+{
+	memset(ss, 0, sizeof(*ss));
+	ss->info = info;
+	ss->response = response;
+	if (!info->mssg)
+		info->mssg = default_log;
+
+	return 0;
+}
+
+long sparse_stream_write(struct sparse_stream *ss, void *buf, ulong len)
+{
+	struct sparse_storage *info = ss->info;
+	sparse_header_t *sparse_header = &ss->header;
+	chunk_header_t chunk_header;
+	char *data = buf;
+	char *end = data + len;
+	unsigned int chunk_data_sz;
+	unsigned int offset;
+	uint32_t fill_val;
+	lbaint_t blkcnt;
+	lbaint_t blks;
+	ulong need;
+	ulong n;
+
+	if (!ss->have_header) {
+		if (len < sizeof(sparse_header_t))
+			return 0;
+		memcpy(sparse_header, data, sizeof(sparse_header_t));
+		if (len < sparse_header->file_hdr_sz)
+			return 0;
+		data += max_t(ulong, sparse_header->file_hdr_sz,
+			      sizeof(sparse_header_t));
+
+		div_u64_rem(sparse_header->blk_sz, info->blksz, &offset);
+		if (offset || sparse_header->chunk_hdr_sz <
+			      sizeof(chunk_header_t)) {
+			printf("%s: Sparse image block size issue [%u]\n",
+			       __func__, sparse_header->blk_sz);
+			info->mssg("sparse image block size issue",
+				   ss->response);
+			return -1;
+		}
+
+		puts("Flashing Sparse Image\n");
+		ss->have_header = true;
+		ss->blk = info->start;
+	}
+
+	while (data < end) {
+		/* Finish the chunk we are in the middle of */
+		if (ss->skip_left) {
+			n = min_t(ulong, ss->skip_left, end - data);
+			ss->skip_left -= n;
+			data += n;
+			continue;
+		}
+		if (ss->raw_left) {
+			n = min_t(ulong, ss->raw_left, end - data);
+			blkcnt = n / info->blksz;
+			if (!blkcnt)
+				break;
+			blks = info->write(info, ss->blk, blkcnt, data);
+			/* blks might be > blkcnt (eg. NAND bad-blocks) */
+			if (blks < blkcnt) {
+				printf("%s: %s" LBAFU " [" LBAFU "]\n",
+				       __func__, "Write failed, block #",
+				       ss->blk, blks);
+				info->mssg("flash write failure", ss->response);
+				return -1;
+			}
+			n = blkcnt * info->blksz;
+			ss->blk += blks;
+			ss->raw_left -= n;
+			ss->bytes_written += n;
+			data += n;
+			continue;
+		}
+
+		/* Anything after the last chunk is ignored */
+		if (ss->chunk == sparse_header->total_chunks) {
+			data = end;
+			break;
+		}
+
+		/* Wait until the whole chunk header is here */
+		if (end - data < sizeof(chunk_header_t))
+			break;
+		memcpy(&chunk_header, data, sizeof(chunk_header));
+		need = sparse_header->chunk_hdr_sz;
+		if (chunk_header.chunk_type == CHUNK_TYPE_FILL)
+			need += sizeof(uint32_t);
+		if (end - data < need)
+			break;
+		data += sparse_header->chunk_hdr_sz;
+		ss->chunk++;
+
+		chunk_data_sz = sparse_header->blk_sz * chunk_header.chunk_sz;
+		blkcnt = chunk_data_sz / info->blksz;
+		switch (chunk_header.chunk_type) {
+		case CHUNK_TYPE_RAW:
+			if (chunk_header.total_sz !=
+			    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
+				info->mssg("Bogus chunk size for chunk type Raw",
+					   ss->response);
+				return -1;
+			}
+
+			if (ss->blk + blkcnt > info->start + info->size) {
+				printf("%s: Request would exceed partition size!\n",
+				       __func__);
+				info->mssg("Request would exceed partition size!",
+					   ss->response);
+				return -1;
+			}
+
+			ss->raw_left = chunk_data_sz;
+			ss->total_blocks += chunk_header.chunk_sz;
+			break;
+
+		case CHUNK_TYPE_FILL:
+			if (chunk_header.total_sz !=
+			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
+				info->mssg("Bogus chunk size for chunk type FILL",
+					   ss->response);
+				return -1;
+			}
+
+			memcpy(&fill_val, data, sizeof(fill_val));
+			data += sizeof(fill_val);
+
+			if (write_fill(info, &ss->blk, blkcnt, fill_val,
+				       ss->response))
+				return -1;
+			ss->bytes_written += blkcnt * info->blksz;
+			ss->total_blocks += chunk_header.chunk_sz;
+			break;
+
+		case CHUNK_TYPE_DONT_CARE:
+			ss->blk += info->reserve(info, ss->blk, blkcnt);
+			ss->total_blocks += chunk_header.chunk_sz;
+			break;
+
+		case CHUNK_TYPE_CRC32:
+			if (chunk_header.total_sz !=
+			    sparse_header->chunk_hdr_sz) {
+				info->mssg("Bogus chunk size for chunk type Dont Care",
+					   ss->response);
+				return -1;
+			}
+			ss->total_blocks += chunk_header.chunk_sz;
+			ss->skip_left = chunk_data_sz;
+			break;
+
+		default:
+			printf("%s: Unknown chunk type: %x\n", __func__,
+			       chunk_header.chunk_type);
+			info->mssg("Unknown chunk type", ss->response);
+			return -1;
+		}
+	}
+
+	return data - (char *)buf;
+}
+
+int sparse_stream_finish(struct sparse_stream *ss, const char *part_name)
+{
+	sparse_header_t *sparse_header = &ss->header;
+
+	if (!ss->have_header || ss->raw_left || ss->skip_left ||
+	    ss->chunk != sparse_header->total_chunks) {
+		printf("%s: Sparse image is truncated\n", __func__);
+		ss->info->mssg("sparse image write failure", ss->response);
+		return -1;
+	}
+
+	debug("Wrote %d blocks, expected to write %d blocks\n",
+	      ss->total_blocks, sparse_header->total_blks);
+	printf("........ wrote %llu bytes to '%s'\n", ss->bytes_written,
+	       part_name);
+
+	if (ss->total_blocks != sparse_header->total_blks) {
+		ss->info->mssg("sparse image write failure", ss->response);
+		return -1;
+	}
+
+	return 0;
+}
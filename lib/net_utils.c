@@ -105,3 +105,13 @@ int ip_checksum_ok(const void *addr, uint nbytes)
 {
 	return !(compute_ip_checksum(addr, nbytes) & 0xfffe);
 }
+
+void ip_checksum_complete(void *seg, uint len, uint offset)
+{
+	u16 *xsum = seg + offset;
+	uint sum;
+
+	sum = compute_ip_checksum(seg, len);
+	/* A UDP checksum of 0 means there is none, so send the other zero */
+	*xsum = sum ? sum : 0xffff;
+}
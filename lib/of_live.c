@@ -11,11 +11,126 @@
 #include <common.h>
 #include <log.h>
 #include <linux/libfdt.h>
+#include <linux/log2.h>
 #include <of_live.h>
 #include <malloc.h>
+#include <asm/global_data.h>
 #include <dm/of_access.h>
 #include <linux/err.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
+static uint of_live_name_hash(const char *name)
+{
+	uint hash = 0;
+
+	while (*name)
+		hash = hash * 31 + *name++;
+
+	return hash;
+}
+
+/* Find the entry holding @name, or the unused entry where it should go */
+static const char **of_live_name_slot(const struct of_live_names *names,
+				      const char *name)
+{
+	uint i = of_live_name_hash(name) & names->mask;
+
+	while (names->slot[i] && strcmp(names->slot[i], name))
+		i = (i + 1) & names->mask;
+
+	return (const char **)&names->slot[i];
+}
+
+const char *of_live_find_name(const struct of_live_names *names,
+			      const char *name)
+{
+	return *of_live_name_slot(names, name);
+}
+
+static struct of_live_names *of_live_names_alloc(const void *blob, uint size)
+{
+	struct of_live_names *names;
+
+	names = calloc(1, sizeof(*names) + size * sizeof(names->slot[0]));
+	if (!names)
+		return NULL;
+	names->strings = blob + fdt_off_dt_strings(blob);
+	names->strings_size = fdt_size_dt_strings(blob);
+	names->mask = size - 1;
+
+	return names;
+}
+
+/**
+ * of_live_names_init() - Set up an empty table of property names
+ *
+ * The table is sized for each string in the strings block to be a name. It
+ * can still grow, since dtc stores a name which is the end of another one
+ * only once.
+ *
+ * @blob: devicetree the live tree is built from
+ */
+static void of_live_names_init(const void *blob)
+{
+	const char *strings = blob + fdt_off_dt_strings(blob);
+	int i, count = 0;
+
+	for (i = 0; i < fdt_size_dt_strings(blob); i++) {
+		if (!strings[i])
+			count++;
+	}
+
+	free(gd_of_live_names());
+	gd_set_of_live_names(of_live_names_alloc(blob,
+			roundup_pow_of_two(max(count * 2, 16))));
+}
+
+/**
+ * of_live_names_add() - Get the single copy of a property name
+ *
+ * @blob: devicetree the live tree is built from
+ * @name: name of a property in the strings block of @blob
+ * @return copy of @name to use in the live tree
+ */
+static const char *of_live_names_add(const void *blob, const char *name)
+{
+	struct of_live_names *names = gd_of_live_names();
+	struct of_live_names *bigger;
+	const char **slot;
+	uint i;
+
+	if (!names)
+		return name;
+	slot = of_live_name_slot(names, name);
+	if (*slot)
+		return *slot;
+
+	/* Keep at least half of the entries unused */
+	if ((names->count + 1) * 2 > names->mask + 1) {
+		bigger = of_live_names_alloc(blob, (names->mask + 1) * 2);
+		for (i = 0; bigger && i <= names->mask; i++) {
+			if (names->slot[i])
+				*of_live_name_slot(bigger, names->slot[i]) =
+					names->slot[i];
+		}
+		if (bigger)
+			bigger->count = names->count;
+		free(names);
+		gd_set_of_live_names(bigger);
+
+		/* Without the table, names are compared with strcmp() */
+		names = bigger;
+		if (!names)
+			return name;
+		slot = of_live_name_slot(names, name);
+	}
+	*slot = name;
+	names->count++;
+
+	return name;
+}
+
 static void *unflatten_dt_alloc(void **mem, unsigned long size,
 				unsigned long align)
 {
@@ -161,7 +276,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 			 * stuff */
 			if (strcmp(pname, "ibm,phandle") == 0)
 				np->phandle = be32_to_cpup(p);
-			pp->name = (char *)pname;
+			pp->name = (char *)of_live_names_add(blob, pname);
 			pp->length = sz;
 			pp->value = (__be32 *)p;
 			*prev_pp = pp;
@@ -295,6 +410,8 @@ static int unflatten_device_tree(const void *blob,
 
 	/* Allocate memory for the expanded device tree */
 	mem = malloc(size + 4);
+	if (!mem)
+		return -ENOMEM;
 	memset(mem, '\0', size);
 
 	*(__be32 *)(mem + size) = cpu_to_be32(0xdeadbeef);
@@ -302,6 +419,7 @@ static int unflatten_device_tree(const void *blob,
 	debug("  unflattening %p...\n", mem);
 
 	/* Second pass, do actual unflattening */
+	of_live_names_init(blob);
 	start = 0;
 	unflatten_dt_node(blob, mem, &start, NULL, mynodes, 0, false);
 	if (be32_to_cpup(mem + size) != 0xdeadbeef) {
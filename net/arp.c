@@ -41,6 +41,108 @@ int		arp_wait_try;
 uchar	       *arp_tx_packet; /* THE ARP transmit packet */
 static uchar	arp_tx_packet_buf[PKTSIZE_ALIGN + PKTALIGN];
 
+/* A neighbour whose MAC address is known */
+struct arp_entry {
+	struct in_addr ip;	/* 0 if the entry is free */
+	uchar ethaddr[ARP_HLEN];
+	int dev_index;		/* Ethernet device it was learnt on */
+	ulong time;		/* get_timer() when last confirmed */
+};
+
+static struct arp_entry arp_cache[CONFIG_NET_ARP_CACHE_SIZE];
+
+/* IP address whose MAC address is needed to reach @ip */
+static struct in_addr arp_next_hop(struct in_addr ip)
+{
+	if ((ip.s_addr & net_netmask.s_addr) !=
+	    (net_ip.s_addr & net_netmask.s_addr) && net_gateway.s_addr)
+		return net_gateway;
+
+	return ip;
+}
+
+static struct arp_entry *arp_find(struct in_addr ip)
+{
+	struct arp_entry *ent;
+	int dev_index = eth_get_dev_index();
+
+	for (ent = arp_cache; ent < arp_cache + ARRAY_SIZE(arp_cache); ent++) {
+		if (!ent->ip.s_addr || ent->ip.s_addr != ip.s_addr ||
+		    ent->dev_index != dev_index)
+			continue;
+		if (get_timer(ent->time) >= CONFIG_NET_ARP_CACHE_TIMEOUT * 1000) {
+			ent->ip.s_addr = 0;
+			return NULL;
+		}
+		return ent;
+	}
+
+	return NULL;
+}
+
+bool arp_lookup(struct in_addr ip, uchar *ethaddr)
+{
+	struct arp_entry *ent;
+
+	ent = arp_find(arp_next_hop(ip));
+	if (!ent)
+		return false;
+
+	debug_cond(DEBUG_DEV_PKT, "ARP cache: %pI4 is at %pM\n", &ent->ip,
+		   ent->ethaddr);
+	memcpy(ethaddr, ent->ethaddr, ARP_HLEN);
+
+	return true;
+}
+
+/*
+ * Record the MAC address of @ip. If there is no entry for it, one is only
+ * made when @create is true, taking the place of the oldest if need be.
+ */
+static void arp_learn(struct in_addr ip, const uchar *ethaddr, bool create)
+{
+	struct arp_entry *ent, *oldest = arp_cache;
+
+	if (!ip.s_addr || !is_valid_ethaddr(ethaddr))
+		return;
+
+	ent = arp_find(ip);
+	if (!ent) {
+		if (!create || !ARRAY_SIZE(arp_cache))
+			return;
+		for (ent = arp_cache; ent < arp_cache + ARRAY_SIZE(arp_cache);
+		     ent++) {
+			if (!ent->ip.s_addr)
+				break;
+			if (get_timer(ent->time) > get_timer(oldest->time))
+				oldest = ent;
+		}
+		if (ent == arp_cache + ARRAY_SIZE(arp_cache))
+			ent = oldest;
+		ent->ip = ip;
+		ent->dev_index = eth_get_dev_index();
+	}
+	memcpy(ent->ethaddr, ethaddr, ARP_HLEN);
+	ent->time = get_timer(0);
+}
+
+void arp_flush(void)
+{
+	memset(arp_cache, '\0', sizeof(arp_cache));
+}
+
+void arp_show(void)
+{
+	struct arp_entry *ent;
+
+	for (ent = arp_cache; ent < arp_cache + ARRAY_SIZE(arp_cache); ent++) {
+		if (!ent->ip.s_addr)
+			continue;
+		printf("%-15pI4  %pM  eth%d  %lus\n", &ent->ip, ent->ethaddr,
+		       ent->dev_index, get_timer(ent->time) / 1000);
+	}
+}
+
 void arp_init(void)
 {
 	/* XXX problem with bss workaround */
@@ -85,16 +187,9 @@ void arp_raw_request(struct in_addr source_ip, const uchar *target_ethaddr,
 void arp_request(void)
 {
 	if ((net_arp_wait_packet_ip.s_addr & net_netmask.s_addr) !=
-	    (net_ip.s_addr & net_netmask.s_addr)) {
-		if (net_gateway.s_addr == 0) {
-			puts("## Warning: gatewayip needed but not set\n");
-			net_arp_wait_reply_ip = net_arp_wait_packet_ip;
-		} else {
-			net_arp_wait_reply_ip = net_gateway;
-		}
-	} else {
-		net_arp_wait_reply_ip = net_arp_wait_packet_ip;
-	}
+	    (net_ip.s_addr & net_netmask.s_addr) && net_gateway.s_addr == 0)
+		puts("## Warning: gatewayip needed but not set\n");
+	net_arp_wait_reply_ip = arp_next_hop(net_arp_wait_packet_ip);
 
 	arp_raw_request(net_ip, net_null_ethaddr, net_arp_wait_reply_ip);
 }
@@ -159,6 +254,14 @@ void arp_receive(struct ethernet_hdr *et, struct ip_udp_hdr *ip, int len)
 	if (net_ip.s_addr == 0)
 		return;
 
+	/*
+	 * Keep known neighbours up to date from any ARP packet, including
+	 * gratuitous ones, and learn those which ask for our address
+	 */
+	arp_learn(net_read_ip(&arp->ar_spa), &arp->ar_sha,
+		  net_read_ip(&arp->ar_tpa).s_addr == net_ip.s_addr &&
+		  ntohs(arp->ar_op) == ARPOP_REQUEST);
+
 	if (net_read_ip(&arp->ar_tpa).s_addr != net_ip.s_addr)
 		return;
 
@@ -216,6 +319,7 @@ void arp_receive(struct ethernet_hdr *et, struct ip_udp_hdr *ip, int len)
 			if (arp_wait_packet_ethaddr != NULL)
 				memcpy(arp_wait_packet_ethaddr,
 				       &arp->ar_sha, ARP_HLEN);
+			arp_learn(reply_ip_addr, &arp->ar_sha, true);
 
 			net_get_arp_handler()((uchar *)arp, 0, reply_ip_addr,
 					      0, len);
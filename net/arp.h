@@ -29,4 +29,15 @@ void arp_raw_request(struct in_addr source_ip, const uchar *targetEther,
 int arp_timeout_check(void);
 void arp_receive(struct ethernet_hdr *et, struct ip_udp_hdr *ip, int len);
 
+/**
+ * arp_lookup() - find the MAC address to send to @ip from the ARP cache
+ *
+ * If @ip is not on our subnet, this is the MAC address of the gateway.
+ *
+ * @ip:		destination IP address
+ * @ethaddr:	set to the MAC address if found
+ * Return: true if the MAC address was found, false if it must be requested
+ */
+bool arp_lookup(struct in_addr ip, uchar *ethaddr);
+
 #endif /* __ARP_H__ */
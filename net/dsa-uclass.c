@@ -448,6 +448,14 @@ static int dsa_pre_probe(struct udevice *dev)
 
 	uclass_find_device_by_ofnode(UCLASS_ETH, pdata->master_node,
 				     &priv->master_dev);
+
+	/*
+	 * Switch drivers may use the master in their probe method, so probe
+	 * it now rather than rely on the order in which devices are probed
+	 */
+	if (priv->master_dev)
+		return device_probe(priv->master_dev);
+
 	return 0;
 }
 
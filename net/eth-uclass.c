@@ -15,6 +15,7 @@
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 #include <net/pcap.h>
+#include <net/tcp.h>
 #include "eth_internal.h"
 #include <eth_phy.h>
 
@@ -24,10 +25,14 @@ DECLARE_GLOBAL_DATA_PTR;
  * struct eth_device_priv - private structure for each Ethernet device
  *
  * @state: The state of the Ethernet MAC driver (defined by enum eth_state_t)
+ * @stats: Traffic counters of the device
+ * @rx_csum_ok: The driver verified the checksum of the packet being received
  */
 struct eth_device_priv {
 	enum eth_state_t state;
 	bool running;
+	struct eth_stats stats;
+	bool rx_csum_ok;
 };
 
 /**
@@ -345,9 +350,17 @@ int eth_is_active(struct udevice *dev)
 	return priv->state == ETH_STATE_ACTIVE;
 }
 
+struct eth_stats *eth_get_stats(struct udevice *dev)
+{
+	struct eth_device_priv *priv = dev_get_uclass_priv(dev);
+
+	return &priv->stats;
+}
+
 int eth_send(void *packet, int length)
 {
 	struct udevice *current;
+	struct eth_stats *stats;
 	int ret;
 
 	current = eth_get_dev();
@@ -357,10 +370,15 @@ int eth_send(void *packet, int length)
 	if (!eth_is_active(current))
 		return -EINVAL;
 
+	stats = eth_get_stats(current);
 	ret = eth_get_ops(current)->send(current, packet, length);
 	if (ret < 0) {
 		/* We cannot completely return the error at present */
 		debug("%s: send() returned error %d\n", __func__, ret);
+		stats->tx_errors++;
+	} else {
+		stats->tx_packets++;
+		stats->tx_bytes += length;
 	}
 #if defined(CONFIG_CMD_PCAP)
 	if (ret >= 0)
@@ -369,9 +387,126 @@ int eth_send(void *packet, int length)
 	return ret;
 }
 
+int eth_send_sg(const struct eth_sg *sg, int count)
+{
+	struct udevice *current;
+	struct eth_pdata *pdata;
+	struct eth_stats *stats;
+	int length = 0;
+	int ret;
+	int i;
+
+	current = eth_get_dev();
+	if (!current)
+		return -ENODEV;
+
+	pdata = dev_get_plat(current);
+	if (!(pdata->features & ETH_FEAT_SG) || !eth_get_ops(current)->send_sg)
+		return eth_send_gathered(sg, count);
+#if defined(CONFIG_CMD_PCAP)
+	/* pcap wants the whole packet in one piece */
+	if (pcap_active())
+		return eth_send_gathered(sg, count);
+#endif
+
+	if (!eth_is_active(current))
+		return -EINVAL;
+	if (count < 1 || count > ETH_SG_MAX)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++)
+		length += sg[i].length;
+
+	stats = eth_get_stats(current);
+	ret = eth_get_ops(current)->send_sg(current, sg, count);
+	if (ret < 0) {
+		debug("%s: send_sg() returned error %d\n", __func__, ret);
+		stats->tx_errors++;
+	} else {
+		stats->tx_packets++;
+		stats->tx_bytes += length;
+	}
+	return ret;
+}
+
+bool eth_tx_csum_offload(void)
+{
+	struct udevice *current = eth_get_dev();
+	struct eth_pdata *pdata;
+
+	if (!current)
+		return false;
+	pdata = dev_get_plat(current);
+
+	return pdata->features & ETH_FEAT_TX_CSUM;
+}
+
+void eth_set_rx_csum_ok(struct udevice *dev)
+{
+	struct eth_device_priv *priv = dev_get_uclass_priv(dev);
+
+	priv->rx_csum_ok = true;
+}
+
+bool eth_rx_csum_ok(void)
+{
+	struct udevice *current = eth_get_dev();
+	struct eth_device_priv *priv;
+
+	if (!current)
+		return false;
+	priv = dev_get_uclass_priv(current);
+
+	return priv->rx_csum_ok;
+}
+
+int eth_get_tx_csum(const void *packet, int length, int *offset)
+{
+	const struct ethernet_hdr *et = packet;
+	const struct ip_udp_hdr *ip;
+	int start = ETHER_HDR_SIZE;
+	u16 type = et->et_protlen;
+
+	if (length < VLAN_ETHER_HDR_SIZE)
+		return -ENOENT;
+	if (type == htons(PROT_VLAN)) {
+		start = VLAN_ETHER_HDR_SIZE;
+		type = ((const struct vlan_ethernet_hdr *)et)->vet_type;
+	}
+	if (type != htons(PROT_IP) || length < start + IP_UDP_HDR_SIZE)
+		return -ENOENT;
+
+	ip = packet + start;
+	/* Only what the stack sends: no IP options, no fragments */
+	if (ip->ip_hl_v != 0x45 ||
+	    (ip->ip_off & htons(IP_OFFS | IP_FLAGS_MFRAG)))
+		return -ENOENT;
+
+	/* Other packets, e.g. from EFI applications, have a finished sum */
+	if (ip != net_tx_csum_marked())
+		return -ENOENT;
+
+	switch (ip->ip_p) {
+	case IPPROTO_UDP:
+		*offset = offsetof(struct ip_udp_hdr, udp_xsum) - IP_HDR_SIZE;
+		break;
+	case IPPROTO_TCP:
+		if (length < start + IP_TCP_HDR_SIZE)
+			return -ENOENT;
+		*offset = offsetof(struct ip_tcp_hdr, tcp_xsum) - IP_HDR_SIZE;
+		break;
+	default:
+		return -ENOENT;
+	}
+
+	return start + IP_HDR_SIZE;
+}
+
 int eth_rx(void)
 {
+	struct eth_device_priv *priv;
 	struct udevice *current;
+	struct eth_stats *stats;
 	uchar *packet;
 	int flags;
 	int ret;
@@ -385,22 +520,31 @@ int eth_rx(void)
 		return -EINVAL;
 
 	/* Process up to 32 packets at one time */
+	priv = dev_get_uclass_priv(current);
+	stats = eth_get_stats(current);
 	flags = ETH_RECV_CHECK_DEVICE;
 	for (i = 0; i < ETH_PACKETS_BATCH_RECV; i++) {
+		priv->rx_csum_ok = false;
 		ret = eth_get_ops(current)->recv(current, flags, &packet);
 		flags = 0;
-		if (ret > 0)
+		if (ret > 0) {
+			stats->rx_packets++;
+			stats->rx_bytes += ret;
 			net_process_received_packet(packet, ret);
+		}
 		if (ret >= 0 && eth_get_ops(current)->free_pkt)
 			eth_get_ops(current)->free_pkt(current, packet, ret);
 		if (ret <= 0)
 			break;
 	}
+	if (i == ETH_PACKETS_BATCH_RECV)
+		stats->rx_full_polls++;
 	if (ret == -EAGAIN)
 		ret = 0;
 	if (ret < 0) {
 		/* We cannot completely return the error at present */
 		debug("%s: recv() returned error %d\n", __func__, ret);
+		stats->rx_errors++;
 	}
 	return ret;
 }
@@ -542,6 +686,9 @@ static int eth_post_probe(struct udevice *dev)
 	priv->state = ETH_STATE_INIT;
 	priv->running = false;
 
+	/* Neighbours learnt through a device of the same number are stale */
+	arp_flush();
+
 	/* Check if the device has a valid MAC address in device tree */
 	if (!eth_dev_get_mac_address(dev, pdata->enetaddr) ||
 	    !is_valid_ethaddr(pdata->enetaddr)) {
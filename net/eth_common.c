@@ -11,6 +11,7 @@
 #include <env.h>
 #include <miiphy.h>
 #include <net.h>
+#include <linux/errno.h>
 #include "eth_internal.h"
 
 int eth_env_get_enetaddr_by_index(const char *base_name, int index,
@@ -138,3 +139,28 @@ const char *eth_get_name(void)
 {
 	return eth_get_dev() ? eth_get_dev()->name : "unknown";
 }
+
+int eth_send_gathered(const struct eth_sg *sg, int count)
+{
+	static uchar buf[PKTSIZE_ALIGN] __aligned(PKTALIGN);
+	const void *mark = net_tx_csum_marked();
+	const void *hdr = sg[0].addr;
+	int length = 0;
+	int i;
+
+	if (count < 1 || count > ETH_SG_MAX)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++) {
+		if (length + sg[i].length > sizeof(buf))
+			return -EMSGSIZE;
+		memcpy(buf + length, sg[i].addr, sg[i].length);
+		length += sg[i].length;
+	}
+
+	/* The copy still leaves its checksum to the device */
+	if (mark >= hdr && mark < hdr + sg[0].length)
+		net_tx_csum_mark(buf + (mark - hdr));
+
+	return eth_send(buf, length);
+}
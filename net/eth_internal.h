@@ -36,4 +36,7 @@ void eth_set_dev(struct eth_device *dev);
 #endif
 void eth_set_current_to_next(void);
 
+/* Copy the buffers of a packet together and send it with eth_send() */
+int eth_send_gathered(const struct eth_sg *sg, int count);
+
 #endif
@@ -371,6 +371,11 @@ int eth_send(void *packet, int length)
 	return ret;
 }
 
+int eth_send_sg(const struct eth_sg *sg, int count)
+{
+	return eth_send_gathered(sg, count);
+}
+
 int eth_rx(void)
 {
 	if (!eth_current)
@@ -25,17 +25,28 @@ struct __packed fastboot_header {
 	unsigned short seq;
 };
 
-#define PACKET_SIZE 1024
-#define DATA_SIZE (PACKET_SIZE - sizeof(struct fastboot_header))
+#define PACKET_SIZE CONFIG_FASTBOOT_UDP_PACKET_SIZE
+#define REPLY_SIZE (sizeof(struct fastboot_header) + FASTBOOT_RESPONSE_LEN)
+
+/**
+ * struct fastboot_reply - a packet we sent, kept for resubmission
+ *
+ * @seq: sequence number of the packet
+ * @len: length of the packet, 0 if none was sent
+ * @data: the packet
+ */
+struct fastboot_reply {
+	unsigned short seq;
+	unsigned int len;
+	uchar data[REPLY_SIZE];
+};
 
 /* Sequence number sent for every packet */
 static unsigned short sequence_number = 1;
-static const unsigned short packet_size = PACKET_SIZE;
 static const unsigned short udp_version = 1;
 
-/* Keep track of last packet for resubmission */
-static uchar last_packet[PACKET_SIZE];
-static unsigned int last_packet_len;
+/* Keep track of the last packets for resubmission, by sequence number */
+static struct fastboot_reply replies[CONFIG_FASTBOOT_UDP_WINDOW];
 
 static struct in_addr fastboot_remote_ip;
 /* The UDP port at their end */
@@ -45,6 +56,25 @@ static int fastboot_our_port;
 
 static void boot_downloaded_image(void);
 
+/**
+ * fastboot_save_reply() - Keep a packet in case the host asks for it again
+ *
+ * @packet: Packet about to be sent, starting with its fastboot header
+ * @len: Length of the packet
+ */
+static void fastboot_save_reply(const uchar *packet, unsigned int len)
+{
+	struct fastboot_header header;
+	struct fastboot_reply *reply;
+
+	memcpy(&header, packet, sizeof(header));
+	header.seq = ntohs(header.seq);
+	reply = &replies[header.seq % CONFIG_FASTBOOT_UDP_WINDOW];
+	reply->seq = header.seq;
+	reply->len = min_t(unsigned int, len, REPLY_SIZE);
+	memcpy(reply->data, packet, reply->len);
+}
+
 #if CONFIG_IS_ENABLED(FASTBOOT_FLASH)
 /**
  * fastboot_udp_send_info() - Send an INFO packet during long commands.
@@ -78,8 +108,7 @@ static void fastboot_udp_send_info(const char *msg)
 	len = packet - packet_base;
 
 	/* Save packet for retransmitting */
-	last_packet_len = len;
-	memcpy(last_packet, packet_base, last_packet_len);
+	fastboot_save_reply(packet_base, len);
 
 	net_send_udp_packet(net_server_ethaddr, fastboot_remote_ip,
 			    fastboot_remote_port, fastboot_our_port, len);
@@ -115,15 +144,18 @@ static void fastboot_timed_send_info(const char *msg)
  * @header: Header for response packet
  * @fastboot_data: Pointer to received fastboot data
  * @fastboot_data_len: Length of received fastboot data
- * @retransmit: Nonzero if sending last sent packet
+ * @retransmit: Nonzero if sending the packet already sent for header.seq
  */
-static void fastboot_send(struct fastboot_header header, char *fastboot_data,
+static void fastboot_send(struct fastboot_header header,
+			  const uchar *fastboot_data,
 			  unsigned int fastboot_data_len, uchar retransmit)
 {
+	struct fastboot_reply *reply;
 	uchar *packet;
 	uchar *packet_base;
 	int len = 0;
 	const char *error_msg = "An error occurred.";
+	unsigned short size;
 	short tmp;
 	struct fastboot_header response_header = header;
 	static char command[FASTBOOT_COMMAND_LEN];
@@ -138,12 +170,15 @@ static void fastboot_send(struct fastboot_header header, char *fastboot_data,
 	packet = net_tx_packet + net_eth_hdr_size() + IP_UDP_HDR_SIZE;
 	packet_base = packet;
 
-	/* Resend last packet */
+	/* Resend the packet which answered this one */
 	if (retransmit) {
-		memcpy(packet, last_packet, last_packet_len);
+		reply = &replies[header.seq % CONFIG_FASTBOOT_UDP_WINDOW];
+		if (!reply->len || reply->seq != header.seq)
+			return;
+		memcpy(packet, reply->data, reply->len);
 		net_send_udp_packet(net_server_ethaddr, fastboot_remote_ip,
 				    fastboot_remote_port, fastboot_our_port,
-				    last_packet_len);
+				    reply->len);
 		return;
 	}
 
@@ -158,10 +193,17 @@ static void fastboot_send(struct fastboot_header header, char *fastboot_data,
 		packet += sizeof(tmp);
 		break;
 	case FASTBOOT_INIT:
+		/* The host sends its version and largest packet: use less */
+		size = PACKET_SIZE;
+		if (fastboot_data_len >= 2 * sizeof(tmp)) {
+			memcpy(&tmp, fastboot_data + sizeof(tmp), sizeof(tmp));
+			if (ntohs(tmp) < size)
+				size = ntohs(tmp);
+		}
 		tmp = htons(udp_version);
 		memcpy(packet, &tmp, sizeof(tmp));
 		packet += sizeof(tmp);
-		tmp = htons(packet_size);
+		tmp = htons(size);
 		memcpy(packet, &tmp, sizeof(tmp));
 		packet += sizeof(tmp);
 		break;
@@ -179,9 +221,10 @@ static void fastboot_send(struct fastboot_header header, char *fastboot_data,
 						       response);
 			}
 		} else if (!pending_command) {
-			strlcpy(command, fastboot_data,
-				min((size_t)fastboot_data_len + 1,
-				    sizeof(command)));
+			len = min_t(unsigned int, fastboot_data_len,
+				    sizeof(command) - 1);
+			memcpy(command, fastboot_data, len);
+			command[len] = '\0';
 			pending_command = true;
 		} else {
 			cmd = fastboot_handle_command(command, response);
@@ -208,8 +251,7 @@ static void fastboot_send(struct fastboot_header header, char *fastboot_data,
 	len = packet - packet_base;
 
 	/* Save packet for retransmitting */
-	last_packet_len = len;
-	memcpy(last_packet, packet_base, last_packet_len);
+	fastboot_save_reply(packet_base, len);
 
 	net_send_udp_packet(net_server_ethaddr, fastboot_remote_ip,
 			    fastboot_remote_port, fastboot_our_port, len);
@@ -261,8 +303,6 @@ static void fastboot_handler(uchar *packet, unsigned int dport,
 			     unsigned int len)
 {
 	struct fastboot_header header;
-	char fastboot_data[DATA_SIZE] = {0};
-	unsigned int fastboot_data_len = 0;
 
 	if (dport != fastboot_our_port)
 		return;
@@ -278,29 +318,26 @@ static void fastboot_handler(uchar *packet, unsigned int dport,
 	packet += sizeof(header);
 	len -= sizeof(header);
 
+	/* Data is used in place, it is not copied until it is stored */
 	switch (header.id) {
 	case FASTBOOT_QUERY:
-		fastboot_send(header, fastboot_data, 0, 0);
+		fastboot_send(header, packet, 0, 0);
 		break;
 	case FASTBOOT_INIT:
 	case FASTBOOT_FASTBOOT:
-		fastboot_data_len = len;
-		if (len > 0)
-			memcpy(fastboot_data, packet, len);
 		if (header.seq == sequence_number) {
-			fastboot_send(header, fastboot_data,
-				      fastboot_data_len, 0);
+			fastboot_send(header, packet, len, 0);
 			sequence_number++;
-		} else if (header.seq == sequence_number - 1) {
-			/* Retransmit last sent packet */
-			fastboot_send(header, fastboot_data,
-				      fastboot_data_len, 1);
+		} else if ((unsigned short)(sequence_number - header.seq) <=
+			   CONFIG_FASTBOOT_UDP_WINDOW) {
+			/* Retransmit a packet the host has not seen */
+			fastboot_send(header, packet, len, 1);
 		}
 		break;
 	default:
 		pr_err("ID %d not implemented.\n", header.id);
 		header.id = FASTBOOT_ERROR;
-		fastboot_send(header, fastboot_data, 0, 0);
+		fastboot_send(header, packet, 0, 0);
 		break;
 	}
 }
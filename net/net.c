@@ -96,7 +96,9 @@
 #if defined(CONFIG_CMD_PCAP)
 #include <net/pcap.h>
 #endif
+#include <net/tcp.h>
 #include <net/udp.h>
+#include <net/wget.h>
 #if defined(CONFIG_LED_STATUS)
 #include <miiphy.h>
 #include <status_led.h>
@@ -526,6 +528,11 @@ restart:
 		case WOL:
 			wol_start();
 			break;
+#endif
+#if defined(CONFIG_CMD_WGET)
+		case WGET:
+			wget_start();
+			break;
 #endif
 		default:
 			break;
@@ -809,6 +816,41 @@ uchar *net_get_async_tx_pkt_buf(void)
 		return net_tx_packet;
 }
 
+/*
+ * IP header of the packet just built whose TCP/UDP checksum is left to the
+ * device, or NULL. Packets built elsewhere, such as those sent by EFI
+ * applications, already carry a finished checksum and are never marked.
+ */
+static const void *net_tx_csum_ip;
+
+void net_tx_csum_mark(const void *ip)
+{
+	net_tx_csum_ip = ip;
+}
+
+const void *net_tx_csum_marked(void)
+{
+	return net_tx_csum_ip;
+}
+
+/* Finish in software the checksum of a packet which is not sent at once */
+static void net_tx_csum_finish(uchar *pkt)
+{
+	struct ip_udp_hdr *ip = (struct ip_udp_hdr *)pkt;
+	uint offset;
+
+	if (net_tx_csum_ip != pkt)
+		return;
+	net_tx_csum_ip = NULL;
+
+	if (ip->ip_p == IPPROTO_TCP)
+		offset = offsetof(struct ip_tcp_hdr, tcp_xsum);
+	else
+		offset = offsetof(struct ip_udp_hdr, udp_xsum);
+	ip_checksum_complete(pkt + IP_HDR_SIZE, ntohs(ip->ip_len) - IP_HDR_SIZE,
+			     offset - IP_HDR_SIZE);
+}
+
 int net_send_udp_packet(uchar *ether, struct in_addr dest, int dport, int sport,
 		int payload_len)
 {
@@ -836,6 +878,8 @@ int net_send_ip_packet(uchar *ether, struct in_addr dest, int dport, int sport,
 	/* if broadcast, make the ether address a broadcast and don't do ARP */
 	if (dest.s_addr == 0xFFFFFFFF)
 		ether = (uchar *)net_bcast_ethaddr;
+	else if (!memcmp(ether, net_null_ethaddr, ARP_HLEN))
+		arp_lookup(dest, ether);	/* try a known neighbour */
 
 	pkt = (uchar *)net_tx_packet;
 
@@ -847,6 +891,14 @@ int net_send_ip_packet(uchar *ether, struct in_addr dest, int dport, int sport,
 				   payload_len);
 		pkt_hdr_size = eth_hdr_size + IP_UDP_HDR_SIZE;
 		break;
+#if defined(CONFIG_PROT_TCP)
+	case IPPROTO_TCP:
+		pkt_hdr_size = eth_hdr_size +
+			tcp_set_tcp_header(pkt + eth_hdr_size, dest, dport,
+					   sport, payload_len, action,
+					   tcp_seq_num, tcp_ack_num);
+		break;
+#endif
 	default:
 		return -EINVAL;
 	}
@@ -861,6 +913,8 @@ int net_send_ip_packet(uchar *ether, struct in_addr dest, int dport, int sport,
 
 		/* size of the waiting packet */
 		arp_wait_tx_packet_size = pkt_hdr_size + payload_len;
+		/* other packets may be built before it goes */
+		net_tx_csum_finish(pkt + eth_hdr_size);
 
 		/* and do the ARP request */
 		arp_wait_try = 1;
@@ -1077,6 +1131,7 @@ void net_process_received_packet(uchar *in_packet, int len)
 	struct ip_udp_hdr *ip;
 	struct in_addr dst_ip;
 	struct in_addr src_ip;
+	bool csum_ok;
 	int eth_proto;
 #if defined(CONFIG_CMD_CDP)
 	int iscdp;
@@ -1221,6 +1276,12 @@ void net_process_received_packet(uchar *in_packet, int len)
 		}
 		/* Read source IP address for later use */
 		src_ip = net_read_ip(&ip->ip_src);
+		/*
+		 * The device only checks the TCP/UDP checksum of a whole
+		 * packet, never of fragments reassembled here
+		 */
+		csum_ok = eth_rx_csum_ok() &&
+			  !(ip->ip_off & htons(IP_OFFS | IP_FLAGS_MFRAG));
 		/*
 		 * The function returns the unchanged packet if it's not
 		 * a fragment, and either the complete packet or NULL if
@@ -1253,6 +1314,15 @@ void net_process_received_packet(uchar *in_packet, int len)
 		if (ip->ip_p == IPPROTO_ICMP) {
 			receive_icmp(ip, len, src_ip, et);
 			return;
+#if defined(CONFIG_PROT_TCP)
+		} else if (ip->ip_p == IPPROTO_TCP) {
+			debug_cond(DEBUG_DEV_PKT,
+				   "received TCP (to=%pI4, from=%pI4, len=%d)\n",
+				   &dst_ip, &src_ip, len);
+
+			tcp_receive((struct ip_tcp_hdr *)ip, len, csum_ok);
+			return;
+#endif
 		} else if (ip->ip_p != IPPROTO_UDP) {	/* Only UDP packets */
 			return;
 		}
@@ -1265,7 +1335,7 @@ void net_process_received_packet(uchar *in_packet, int len)
 			   &dst_ip, &src_ip, len);
 
 #ifdef CONFIG_UDP_CHECKSUM
-		if (ip->udp_xsum != 0) {
+		if (ip->udp_xsum != 0 && !csum_ok) {
 			ulong   xsum;
 			u8 *sumptr;
 			ushort  sumlen;
@@ -1355,6 +1425,9 @@ static int net_check_prereq(enum proto_t protocol)
 
 #if defined(CONFIG_CMD_NFS)
 	case NFS:
+#endif
+#if defined(CONFIG_CMD_WGET)
+	case WGET:
 #endif
 		/* Fall through */
 	case TFTPGET:
@@ -1478,6 +1551,9 @@ void net_set_ip_header(uchar *pkt, struct in_addr dest, struct in_addr source,
 {
 	struct ip_udp_hdr *ip = (struct ip_udp_hdr *)pkt;
 
+	/* A marked packet is sent before the next one is built */
+	net_tx_csum_ip = NULL;
+
 	/*
 	 *	Construct an IP header.
 	 */
@@ -1518,6 +1594,35 @@ void net_set_udp_header(uchar *pkt, struct in_addr dest, int dport, int sport,
 	ip->udp_dst  = htons(dport);
 	ip->udp_len  = htons(UDP_HDR_SIZE + len);
 	ip->udp_xsum = 0;
+	/* Checksums are free when the device completes them */
+	if (eth_tx_csum_offload()) {
+		ip->udp_xsum = ~ip_pseudo_checksum(net_ip, dest, IPPROTO_UDP,
+						   UDP_HDR_SIZE + len) & 0xffff;
+		net_tx_csum_mark(pkt);
+	}
+}
+
+/* Pseudo header used in TCP and UDP checksums */
+struct ip_pseudo_hdr {
+	struct in_addr	src;
+	struct in_addr	dst;
+	u8		rsvd;
+	u8		p;
+	u16		len;
+} __attribute__((packed));
+
+uint ip_pseudo_checksum(struct in_addr src, struct in_addr dst, u8 proto,
+			uint len)
+{
+	struct ip_pseudo_hdr ph;
+
+	net_copy_ip(&ph.src, &src);
+	net_copy_ip(&ph.dst, &dst);
+	ph.rsvd = 0;
+	ph.p = proto;
+	ph.len = htons(len);
+
+	return compute_ip_checksum(&ph, sizeof(ph));
 }
 
 void copy_filename(char *dst, const char *src, int size)
@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * UDP throughput and latency benchmark
+ *
+ * As a sink we count the packets a host sends to us, as a source we send
+ * packets to a host as fast as the device takes them. Either way the rate is
+ * printed with a histogram of per-packet times: the gap between packets
+ * received, or the time the driver took to send each one. Neither involves
+ * any protocol waiting on the other side, so the numbers are those of the
+ * device and its driver.
+ */
+
+#include <common.h>
+#include <div64.h>
+#include <net.h>
+#include <time.h>
+#include <net/netperf.h>
+
+/* A sink waits this long for the first packet (ms) */
+#define NETPERF_START_TIMEOUT	30000
+/* A sink stops when no packet came for this long (ms) */
+#define NETPERF_IDLE_TIMEOUT	3000
+/* A source sends for this long before net_loop() polls again (ms) */
+#define NETPERF_BURST_MS	100
+/* A source starts the next burst after this long (ms); 0 cancels instead */
+#define NETPERF_GAP_MS		1
+/* Bucket n of the histogram counts times from 2^n to 2^(n+1) - 1 us */
+#define NETPERF_BUCKETS		20
+
+static struct netperf_params *params;
+static uchar netperf_ether[ARP_HLEN];
+static ulong start_us, last_us;
+static ulong packets, drops, reordered;
+static u64 bytes;
+static u32 next_seq;
+static ulong hist[NETPERF_BUCKETS];
+#ifdef CONFIG_DM_ETH
+static ulong tx_errors;
+#endif
+
+static void netperf_count(ulong us)
+{
+	int bucket = 0;
+
+	while (bucket < NETPERF_BUCKETS - 1 && us >> (bucket + 1))
+		bucket++;
+	hist[bucket]++;
+}
+
+static void netperf_report(void)
+{
+	ulong ms = (last_us - start_us) / 1000;
+	int i;
+
+	printf("\n%lu packets, ", packets);
+	print_size(bytes, "");
+	printf(" in %lu.%03lu s\n", ms / 1000, ms % 1000);
+	if (ms) {
+		printf("%llu packets/s, ", lldiv((u64)packets * 1000, ms));
+		print_size(lldiv(bytes * 1000, ms), "/s\n");
+	}
+
+	if (params->mode == NETPERF_SINK) {
+		printf("%lu dropped, %lu out of order\n", drops, reordered);
+		puts("Gap between packets (us):\n");
+	} else {
+#ifdef CONFIG_DM_ETH
+		printf("%lu send errors\n",
+		       eth_get_stats(eth_get_dev())->tx_errors - tx_errors);
+#endif
+		puts("Time to send a packet (us):\n");
+	}
+	for (i = 0; i < NETPERF_BUCKETS; i++) {
+		if (hist[i])
+			printf("%8lu - %-8lu %lu\n", i ? 1UL << i : 0,
+			       (2UL << i) - 1, hist[i]);
+	}
+}
+
+static void netperf_idle(void)
+{
+	if (!packets) {
+		puts("No packets received\n");
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+
+	netperf_report();
+	net_set_state(NETLOOP_SUCCESS);
+}
+
+static void netperf_sink_handler(uchar *pkt, unsigned int dport,
+				 struct in_addr sip, unsigned int sport,
+				 unsigned int len)
+{
+	struct netperf_hdr hdr;
+	ulong now = timer_get_us();
+	u32 seq;
+
+	if (dport != params->port || len < sizeof(hdr))
+		return;
+	memcpy(&hdr, pkt, sizeof(hdr));
+	if (ntohl(hdr.magic) != NETPERF_MAGIC)
+		return;
+	seq = ntohl(hdr.seq);
+
+	/* Count from whichever packet arrives first */
+	if (!packets) {
+		printf("Receiving from %pI4:%u\n", &sip, sport);
+		start_us = now;
+		next_seq = seq;
+	} else {
+		netperf_count(now - last_us);
+	}
+	last_us = now;
+	packets++;
+	bytes += len;
+
+	if ((s32)(seq - next_seq) >= 0) {
+		drops += seq - next_seq;
+		next_seq = seq + 1;
+	} else {
+		/* Late, not lost after all */
+		reordered++;
+		if (drops)
+			drops--;
+	}
+
+	if (params->duration && now - start_us >= params->duration * 1000) {
+		netperf_report();
+		net_set_state(NETLOOP_SUCCESS);
+		return;
+	}
+	net_set_timeout_handler(NETPERF_IDLE_TIMEOUT, netperf_idle);
+}
+
+static void netperf_send_burst(void)
+{
+	uchar *pkt = net_tx_packet + net_eth_hdr_size() + IP_UDP_HDR_SIZE;
+	ulong burst_us = timer_get_us();
+	struct netperf_hdr hdr;
+	ulong now;
+	int ret;
+
+	hdr.magic = htonl(NETPERF_MAGIC);
+	for (;;) {
+		now = timer_get_us();
+		if (now - start_us >= params->duration * 1000) {
+			last_us = now;
+			netperf_report();
+			net_set_state(NETLOOP_SUCCESS);
+			return;
+		}
+		/* The packet waiting for ARP is held in net_tx_packet */
+		if (arp_is_waiting() ||
+		    now - burst_us >= NETPERF_BURST_MS * 1000)
+			break;
+
+		hdr.seq = htonl(next_seq++);
+		hdr.usec = htonl(now);
+		memcpy(pkt, &hdr, sizeof(hdr));
+		ret = net_send_udp_packet(netperf_ether, params->ip,
+					  params->port, params->port,
+					  params->size);
+		if (ret < 0)
+			break;
+		packets++;
+		bytes += params->size;
+		netperf_count(timer_get_us() - now);
+	}
+
+	net_set_timeout_handler(NETPERF_GAP_MS, netperf_send_burst);
+}
+
+int netperf_prereq(void *data)
+{
+	struct netperf_params *p = data;
+
+	if (p->mode == NETPERF_SOURCE && !p->ip.s_addr) {
+		puts("*** ERROR: netperf host not given\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+int netperf_start(void *data)
+{
+	params = data;
+	packets = 0;
+	bytes = 0;
+	drops = 0;
+	reordered = 0;
+	memset(hist, 0, sizeof(hist));
+
+	if (params->mode == NETPERF_SINK) {
+		printf("Listening on UDP port %d\n", params->port);
+		net_set_udp_handler(netperf_sink_handler);
+		net_set_timeout_handler(NETPERF_START_TIMEOUT, netperf_idle);
+		return 0;
+	}
+
+	printf("Sending %d byte packets to %pI4:%d for %lu s\n", params->size,
+	       &params->ip, params->port, params->duration / 1000);
+	memset(netperf_ether, 0, sizeof(netperf_ether));
+	memset(net_tx_packet + net_eth_hdr_size() + IP_UDP_HDR_SIZE, 0,
+	       params->size);
+	next_seq = 0;
+#ifdef CONFIG_DM_ETH
+	tx_errors = eth_get_stats(eth_get_dev())->tx_errors;
+#endif
+	start_us = timer_get_us();
+	net_set_udp_handler(NULL);
+	net_set_timeout_handler(NETPERF_GAP_MS, netperf_send_burst);
+
+	return 0;
+}
@@ -28,17 +28,21 @@
 
 #include <common.h>
 #include <command.h>
+#include <env.h>
 #include <flash.h>
 #include <image.h>
 #include <log.h>
 #include <net.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <net/store.h>
 #include "nfs.h"
 #include "bootp.h"
 #include <time.h>
+#include <linux/log2.h>
 
 #define HASHES_PER_LINE 65	/* Number of "loading" hashes per line	*/
+#define NFS_HASH_SIZE	(5 * 1024)	/* Bytes per "loading" hash	*/
 #define NFS_RETRY_COUNT 30
 #ifndef CONFIG_NFS_TIMEOUT
 # define NFS_TIMEOUT 2000UL
@@ -49,12 +53,39 @@
 #define NFS_RPC_ERR	1
 #define NFS_RPC_DROP	124
 
+/* Space taken in a READ reply by the RPC header and file attributes */
+#define NFS_READ_HDR_SIZE	((6 + NFS_MAX_ATTRS) * sizeof(uint32_t))
+/* Largest READ reply accepted, which may be made of several IP fragments */
+#ifdef CONFIG_IP_DEFRAG
+#define NFS_MAX_READ_REPLY	(CONFIG_NET_MAXDEFRAG - IP_UDP_HDR_SIZE)
+#else
+#define NFS_MAX_READ_REPLY	sizeof(struct rpc_t)
+#endif
+
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
+static u32 nfs_offset;		/* offset of the next READ to send */
+static u32 nfs_len;		/* size of each READ */
+static u32 nfs_file_end;	/* end of the file, once known */
 static ulong nfs_timeout = NFS_TIMEOUT;
 
+/* A READ request waiting for its reply */
+struct nfs_read_slot {
+	ulong id;		/* RPC transaction ID */
+	u32 offset;
+	u32 len;		/* bytes requested, 0 if the slot is free */
+	ulong time;		/* time the request was last sent */
+	int retries;
+};
+
+static struct nfs_read_slot nfs_reads[NFS_MAX_READ_WINDOW];
+static int nfs_read_window;
+static ulong nfs_rx_bytes;
+static int nfs_num_hash;
+static ulong nfs_time_start;
+static uint nfs_read_count;
+static uint nfs_rtx_count;
+
 static char dirfh[NFS_FHSIZE];	/* NFSv2 / NFSv3 file handle of directory */
 static char filefh[NFS3_FHSIZE]; /* NFSv2 / NFSv3 file handle */
 static int filefh3_length;	/* (variable) length of filefh when NFSv3 */
@@ -95,7 +126,14 @@ static inline int store_block(uchar *src, unsigned offset, unsigned len)
 			break;
 		}
 	}
+#endif /* CONFIG_SYS_DIRECT_FLASH_NFS */
 
+	if (net_store_active()) {
+		/* The file goes to a block device, not to memory */
+		if (net_store_write(offset, src, len))
+			return -1;
+	} else
+#ifdef CONFIG_SYS_DIRECT_FLASH_NFS
 	if (rc) { /* Flash is destination for this packet */
 		rc = flash_write((uchar *)src, (ulong)image_load_addr + offset,
 				 len);
@@ -420,9 +458,6 @@ static void nfs_send(void)
 	case STATE_LOOKUP_REQ:
 		nfs_lookup_req(nfs_filename);
 		break;
-	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
-		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
 		break;
@@ -664,19 +699,36 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 	return 0;
 }
 
+static void nfs_show_progress(void)
+{
+	while (nfs_num_hash < DIV_ROUND_UP(nfs_rx_bytes, NFS_HASH_SIZE)) {
+		if (nfs_num_hash && !(nfs_num_hash % HASHES_PER_LINE))
+			puts("\n\t ");
+		putc('#');
+		nfs_num_hash++;
+	}
+}
+
 static int nfs_read_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	struct nfs_read_slot *rd;
+	ulong id;
 	int rlen;
-	uchar *data_ptr;
+	uint data_off;
+	bool eof;
 
 	debug("%s\n", __func__);
 
-	memcpy(&rpc_pkt.u.data[0], pkt, sizeof(rpc_pkt.u.reply));
+	/* Only the header is copied, the data is stored straight from pkt */
+	memcpy(&rpc_pkt.u.data[0], pkt, NFS_READ_HDR_SIZE);
 
-	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
-		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+	id = ntohl(rpc_pkt.u.reply.id);
+	for (rd = nfs_reads; rd < nfs_reads + nfs_read_window; rd++) {
+		if (rd->len && rd->id == id)
+			break;
+	}
+	if (rd == nfs_reads + nfs_read_window)
 		return -NFS_RPC_DROP;
 
 	if (rpc_pkt.u.reply.rstatus  ||
@@ -690,36 +742,175 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
-		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
-		putc('#');
-
 	if (supported_nfs_versions & NFSV2_FLAG) {
 		rlen = ntohl(rpc_pkt.u.reply.data[18]);
-		data_ptr = (uchar *)&(rpc_pkt.u.reply.data[19]);
+		data_off = 19;
+		/* The attributes give the file size */
+		eof = rd->offset + rlen >= ntohl(rpc_pkt.u.reply.data[6]);
 	} else {  /* NFSV3_FLAG */
 		int nfsv3_data_offset =
 			nfs3_get_attributes_offset(rpc_pkt.u.reply.data);
 
 		/* count value */
 		rlen = ntohl(rpc_pkt.u.reply.data[1 + nfsv3_data_offset]);
+		eof = rpc_pkt.u.reply.data[2 + nfsv3_data_offset];
 		/* Skip unused values :
 			EOF:		32 bits value,
 			data_size:	32 bits value,
 		*/
-		data_ptr = (uchar *)
-			&(rpc_pkt.u.reply.data[4 + nfsv3_data_offset]);
+		data_off = 4 + nfsv3_data_offset;
+	}
+	data_off = (uchar *)&rpc_pkt.u.reply.data[data_off] - (uchar *)&rpc_pkt;
+
+	if (rlen < 0 || rlen > rd->len || data_off + rlen > len)
+		return -9999;
+
+	/* Replies past the end of the file carry no data */
+	if (rlen && store_block(pkt + data_off, rd->offset, rlen))
+		return -9999;
+
+	nfs_rx_bytes += rlen;
+	nfs_show_progress();
+
+	if (eof || !rlen)
+		nfs_file_end = min(nfs_file_end, rd->offset + rlen);
+	if (rlen < rd->len && rd->offset + rlen < nfs_file_end) {
+		/* Short read before the end of file: ask for the rest */
+		rd->offset += rlen;
+		rd->len -= rlen;
+		rd->retries = 0;
+		nfs_read_count++;
+		nfs_read_req(rd->offset, rd->len);
+		rd->id = rpc_id;
+		rd->time = get_timer(0);
+	} else {
+		rd->len = 0;
 	}
 
-	if (((uchar *)&(rpc_pkt.u.reply.data[0]) - (uchar *)(&rpc_pkt) + rlen) > len)
-			return -9999;
+	return rlen;
+}
 
-	if (store_block(data_ptr, nfs_offset, rlen))
-			return -9999;
+static void nfs_timeout_handler(void);
 
-	return rlen;
+/*
+ * Send READ requests until nfs_read_window are outstanding or the end of the
+ * file is reached. Returns the number of requests outstanding.
+ */
+static int nfs_read_fill(void)
+{
+	struct nfs_read_slot *rd;
+	int count = 0;
+
+	for (rd = nfs_reads; rd < nfs_reads + nfs_read_window; rd++) {
+		/* Requests past the end of the file are not needed */
+		if (rd->len && rd->offset >= nfs_file_end)
+			rd->len = 0;
+		if (!rd->len && nfs_offset < nfs_file_end) {
+			rd->offset = nfs_offset;
+			rd->len = nfs_len;
+			rd->retries = 0;
+			nfs_offset += nfs_len;
+			nfs_read_count++;
+			nfs_read_req(rd->offset, rd->len);
+			rd->id = rpc_id;
+			rd->time = get_timer(0);
+		}
+		if (rd->len)
+			count++;
+	}
+
+	return count;
+}
+
+static ulong nfs_read_timeout(struct nfs_read_slot *rd)
+{
+	return nfs_timeout + NFS_TIMEOUT * rd->retries;
+}
+
+/* Set the timeout handler to run when the oldest request expires */
+static void nfs_read_set_timeout(void)
+{
+	struct nfs_read_slot *rd;
+	ulong now = get_timer(0);
+	ulong left, next = nfs_timeout;
+
+	for (rd = nfs_reads; rd < nfs_reads + nfs_read_window; rd++) {
+		if (!rd->len)
+			continue;
+		left = nfs_read_timeout(rd);
+		if (now - rd->time < left)
+			left -= now - rd->time;
+		else
+			left = 1;
+		next = min(next, left);
+	}
+	net_set_timeout_handler(next, nfs_timeout_handler);
+}
+
+/* Send again each READ request which has not been answered in time */
+static void nfs_read_resend(void)
+{
+	struct nfs_read_slot *rd;
+	ulong now = get_timer(0);
+
+	for (rd = nfs_reads; rd < nfs_reads + nfs_read_window; rd++) {
+		if (!rd->len || now - rd->time < nfs_read_timeout(rd))
+			continue;
+		if (++rd->retries > NFS_RETRY_COUNT) {
+			puts("\nRetry count exceeded; starting again\n");
+			net_start_again();
+			return;
+		}
+		puts("T ");
+		nfs_rtx_count++;
+		nfs_read_req(rd->offset, rd->len);
+		rd->id = rpc_id;
+		rd->time = now;
+	}
+	nfs_read_set_timeout();
+}
+
+static void nfs_read_start(void)
+{
+	char *ep;
+
+	/* Use the largest power of two which fits in a reply */
+	nfs_len = rounddown_pow_of_two(NFS_MAX_READ_REPLY - NFS_READ_HDR_SIZE);
+	if (supported_nfs_versions & NFSV2_FLAG)
+		nfs_len = min_t(u32, nfs_len, NFS2_MAX_READ_SIZE);
+
+	nfs_read_window = CONFIG_NFS_READ_WINDOW;
+	ep = env_get("nfswindowsize");
+	if (ep)
+		nfs_read_window = clamp_t(int, simple_strtol(ep, NULL, 10), 1,
+					  NFS_MAX_READ_WINDOW);
+	debug("NFS read size = %u, window = %d\n", nfs_len, nfs_read_window);
+
+	nfs_offset = 0;
+	nfs_file_end = U32_MAX;
+	memset(nfs_reads, '\0', sizeof(nfs_reads));
+	nfs_rx_bytes = 0;
+	nfs_num_hash = 0;
+	nfs_read_count = 0;
+	nfs_rtx_count = 0;
+	nfs_time_start = get_timer(0);
+
+	nfs_state = STATE_READ_REQ;
+	nfs_read_fill();
+	nfs_read_set_timeout();
+}
+
+/* Report the throughput of the READ requests */
+static void nfs_read_stats(void)
+{
+	ulong time = get_timer(nfs_time_start);
+
+	if (time > 0) {
+		puts("\n\t ");	/* Line up with "Loading: " */
+		print_size(net_boot_file_size / time * 1000, "/s");
+	}
+	printf("\n\t %u reads of %u bytes, %u retransmitted, window %d",
+	       nfs_read_count, nfs_len, nfs_rtx_count, nfs_read_window);
 }
 
 /**************************************************************************
@@ -727,6 +918,11 @@ Interfaces of U-BOOT
 **************************************************************************/
 static void nfs_timeout_handler(void)
 {
+	if (nfs_state == STATE_READ_REQ) {
+		nfs_read_resend();
+		return;
+	}
+
 	if (++nfs_timeout_count > NFS_RETRY_COUNT) {
 		puts("\nRetry count exceeded; starting again\n");
 		net_start_again();
@@ -747,7 +943,8 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 	debug("%s\n", __func__);
 
-	if (len > sizeof(struct rpc_t))
+	if (len > (nfs_state == STATE_READ_REQ ? NFS_MAX_READ_REPLY :
+		   sizeof(struct rpc_t)))
 		return;
 
 	if (dest != nfs_our_port)
@@ -813,10 +1010,7 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			nfs_state = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
 			nfs_send();
 		} else {
-			nfs_state = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
-			nfs_send();
+			nfs_read_start();
 		}
 		break;
 
@@ -842,17 +1036,20 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		rlen = nfs_read_reply(pkt, len);
 		if (rlen == -NFS_RPC_DROP)
 			break;
+		if (rlen >= 0) {
+			if (nfs_read_fill()) {
+				nfs_read_set_timeout();
+				break;
+			}
+			nfs_read_stats();
+			nfs_download_state = NETLOOP_SUCCESS;
+		}
 		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
-		if (rlen > 0) {
-			nfs_offset += rlen;
-			nfs_send();
-		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
+		if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			nfs_state = STATE_READLINK_REQ;
 			nfs_send();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
 			if (rlen < 0)
 				debug("NFS READ error (%d)\n", rlen);
 			nfs_state = STATE_UMOUNT_REQ;
@@ -42,8 +42,12 @@
  * case, most NFS servers are optimized for a power of 2.
  */
 #define NFS_READ_SIZE	1024	/* biggest power of two that fits Ether frame */
+#define NFS2_MAX_READ_SIZE	8192	/* NFSv2 limit on a single READ */
 #define NFS_MAX_ATTRS	26
 
+/* Most READ requests kept outstanding at once */
+#define NFS_MAX_READ_WINDOW	32
+
 /* Values for Accept State flag on RPC answers (See: rfc1831) */
 enum rpc_accept_stat {
 	NFS_RPC_SUCCESS = 0,	/* RPC executed successfully */
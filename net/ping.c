@@ -38,10 +38,17 @@ static void set_icmp_header(uchar *pkt, struct in_addr dest)
 
 static int ping_send(void)
 {
+	uchar ethaddr[ARP_HLEN];
 	uchar *pkt;
 	int eth_hdr_size;
 
-	/* XXX always send arp request */
+	/* Send straight away to a known neighbour */
+	if (arp_lookup(net_ping_ip, ethaddr)) {
+		eth_hdr_size = net_set_ether(net_tx_packet, ethaddr, PROT_IP);
+		set_icmp_header(net_tx_packet + eth_hdr_size, net_ping_ip);
+		net_send_packet(net_tx_packet, eth_hdr_size + IP_ICMP_HDR_SIZE);
+		return 0;
+	}
 
 	debug_cond(DEBUG_DEV_PKT, "sending ARP for %pI4\n", &net_ping_ip);
 
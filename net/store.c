@@ -0,0 +1,320 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Write a file to a block device while it is downloaded
+ *
+ * tftp and nfs hand each block they receive to net_store_write() instead of
+ * copying it to the load address. The blocks are gathered in a buffer at the
+ * load address, and each time half of it is filled the contiguous data is
+ * written out in whole device blocks, either as it is or through the Android
+ * sparse image parser if the file starts with a sparse header. Whatever is
+ * left over is moved back to the start of the buffer. The file thus never
+ * has to fit in memory and the device is written to while the rest of the
+ * file is still coming in, rather than after it.
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <image.h>
+#include <image-sparse.h>
+#include <lmb.h>
+#include <mapmem.h>
+#include <part.h>
+#include <asm/global_data.h>
+#include <linux/errno.h>
+#include <net/store.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Out-of-order pieces which can be kept beyond the contiguous data */
+#define NET_STORE_RANGES	32
+
+struct net_store_range {
+	ulong start;
+	ulong end;
+};
+
+/**
+ * struct net_store - state of the file being written
+ *
+ * @desc: device written to
+ * @part: partition written to
+ * @name: name of the partition, for messages
+ * @active: downloads go to @desc
+ * @started: the file has been found to be sparse or not
+ * @sparse: the file is a sparse image, written through @stream
+ * @buf: buffer at the load address
+ * @size: size of @buf, a whole number of device blocks
+ * @base: offset in the file of @buf[0]
+ * @done: offset in the file up to which all data has been received
+ * @high: offset in the file of the end of the furthest data received
+ * @blk: next block to write, if the file is not sparse
+ * @nranges: number of entries in @ranges
+ * @ranges: data received beyond @done
+ */
+struct net_store {
+	struct blk_desc *desc;
+	struct disk_partition part;
+	const char *name;
+	bool active;
+	bool started;
+	bool sparse;
+	struct sparse_storage storage;
+	struct sparse_stream stream;
+	uchar *buf;
+	ulong size;
+	ulong base;
+	ulong done;
+	ulong high;
+	lbaint_t blk;
+	int nranges;
+	struct net_store_range ranges[NET_STORE_RANGES];
+};
+
+static struct net_store store;
+
+static lbaint_t net_store_sparse_write(struct sparse_storage *info,
+				       lbaint_t blk, lbaint_t blkcnt,
+				       const void *buffer)
+{
+	return blk_dwrite(store.desc, blk, blkcnt, buffer);
+}
+
+static lbaint_t net_store_sparse_reserve(struct sparse_storage *info,
+					 lbaint_t blk, lbaint_t blkcnt)
+{
+	return blkcnt;
+}
+
+static void net_store_sparse_mssg(const char *str, char *response)
+{
+	printf("\n*** ERROR: %s\n", str);
+}
+
+/* Write @len bytes at the start of the buffer as they are */
+static long net_store_write_raw(ulong len, bool final)
+{
+	ulong blksz = store.desc->blksz;
+	lbaint_t blkcnt;
+
+	/* The buffer is a whole number of blocks, so there is room to pad */
+	if (final && len % blksz) {
+		memset(store.buf + len, '\0', blksz - len % blksz);
+		len = roundup(len, blksz);
+	}
+
+	blkcnt = len / blksz;
+	if (!blkcnt)
+		return 0;
+	if (store.blk + blkcnt > store.part.start + store.part.size) {
+		printf("\n*** ERROR: file is larger than %s\n", store.name);
+		return -ENOSPC;
+	}
+	if (blk_dwrite(store.desc, store.blk, blkcnt, store.buf) != blkcnt) {
+		printf("\n*** ERROR: write to %s failed at block " LBAFU "\n",
+		       store.name, store.blk);
+		return -EIO;
+	}
+	store.blk += blkcnt;
+
+	return blkcnt * blksz;
+}
+
+/* Write out the contiguous data in the buffer, all of it if @final */
+static int net_store_flush(bool final)
+{
+	ulong len = store.done - store.base;
+	long used;
+
+	if (!store.started) {
+		if (len < sizeof(sparse_header_t) && !final)
+			return 0;
+		store.sparse = len >= sizeof(sparse_header_t) &&
+			       is_sparse_image(store.buf);
+		if (store.sparse)
+			sparse_stream_init(&store.stream, &store.storage, NULL);
+		store.started = true;
+	}
+
+	if (store.sparse)
+		used = sparse_stream_write(&store.stream, store.buf, len);
+	else
+		used = net_store_write_raw(len, final);
+	if (used < 0)
+		return used == -1 ? -EIO : used;
+
+	/* The last block may have been padded past the end of the file */
+	if (final || !used)
+		return 0;
+
+	memmove(store.buf, store.buf + used, store.high - store.base - used);
+	store.base += used;
+
+	return 0;
+}
+
+/* Record that the file data from @start to @end has been received */
+static int net_store_add_range(ulong start, ulong end)
+{
+	struct net_store_range *r;
+	int i;
+
+	if (start > store.done) {
+		for (i = 0; i < store.nranges; i++) {
+			r = &store.ranges[i];
+			if (start <= r->end && end >= r->start) {
+				r->start = min(r->start, start);
+				r->end = max(r->end, end);
+				return 0;
+			}
+		}
+		if (store.nranges == NET_STORE_RANGES) {
+			puts("\n*** ERROR: too many pieces of the file missing\n");
+			return -ENOSPC;
+		}
+		r = &store.ranges[store.nranges++];
+		r->start = start;
+		r->end = end;
+		return 0;
+	}
+
+	store.done = max(store.done, end);
+	/* Take in the pieces which now follow on */
+	for (i = 0; i < store.nranges;) {
+		r = &store.ranges[i];
+		if (r->start <= store.done) {
+			store.done = max(store.done, r->end);
+			*r = store.ranges[--store.nranges];
+			i = 0;
+		} else {
+			i++;
+		}
+	}
+
+	return 0;
+}
+
+int net_store_write(ulong offset, const void *src, ulong len)
+{
+	ulong end = offset + len;
+	int ret;
+
+	/* Already stored, maybe already written out */
+	if (end <= store.done)
+		return 0;
+	if (offset < store.done) {
+		src += store.done - offset;
+		offset = store.done;
+		len = end - offset;
+	}
+
+	if (end - store.base > store.size) {
+		ret = net_store_flush(false);
+		if (ret)
+			return ret;
+		if (end - store.base > store.size) {
+			puts("\n*** ERROR: file data too far ahead of the missing data\n");
+			return -ENOSPC;
+		}
+	}
+
+	memcpy(store.buf + offset - store.base, src, len);
+	store.high = max(store.high, end);
+	ret = net_store_add_range(offset, end);
+	if (ret)
+		return ret;
+
+	if (store.done - store.base >= store.size / 2)
+		return net_store_flush(false);
+
+	return 0;
+}
+
+bool net_store_fits(ulong size)
+{
+	/* A sparse image is checked chunk by chunk as it is written */
+	return (u64)size <= (u64)store.part.size * store.desc->blksz;
+}
+
+/* Check that the buffer does not overlap U-Boot, the FDT, etc. */
+static bool net_store_buf_free(ulong addr, ulong size)
+{
+#ifdef CONFIG_LMB
+	struct lmb lmb;
+
+	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
+
+	return lmb_get_free_size(&lmb, addr) >= size;
+#else
+	return true;
+#endif
+}
+
+int net_store_start(struct blk_desc *desc, struct disk_partition *info,
+		    const char *name)
+{
+	ulong size = rounddown(CONFIG_NET_STORE_BUF_SIZE, desc->blksz);
+
+	if (!size) {
+		puts("*** ERROR: buffer is smaller than a block\n");
+		return -EINVAL;
+	}
+	if (!net_store_buf_free(image_load_addr, size)) {
+		puts("*** ERROR: buffer would overwrite reserved memory\n");
+		return -EFAULT;
+	}
+
+	memset(&store, '\0', sizeof(store));
+	store.desc = desc;
+	store.part = *info;
+	store.name = name;
+	store.blk = info->start;
+	store.buf = map_sysmem(image_load_addr, size);
+	store.size = size;
+
+	store.storage.blksz = desc->blksz;
+	store.storage.start = info->start;
+	store.storage.size = info->size;
+	store.storage.write = net_store_sparse_write;
+	store.storage.reserve = net_store_sparse_reserve;
+	store.storage.mssg = net_store_sparse_mssg;
+
+	store.active = true;
+
+	return 0;
+}
+
+bool net_store_active(void)
+{
+	return store.active;
+}
+
+int net_store_finish(void)
+{
+	int ret;
+
+	if (store.nranges) {
+		printf("*** ERROR: file data missing after %lu bytes\n",
+		       store.done);
+		return -EIO;
+	}
+
+	ret = net_store_flush(true);
+	if (ret)
+		return ret;
+
+	if (store.sparse)
+		return sparse_stream_finish(&store.stream, store.name) ?
+		       -EIO : 0;
+
+	printf("%lu bytes written to %s\n", store.done, store.name);
+
+	return 0;
+}
+
+void net_store_stop(void)
+{
+	if (store.buf)
+		unmap_sysmem(store.buf);
+	store.buf = NULL;
+	store.active = false;
+}
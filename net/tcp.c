@@ -0,0 +1,673 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Minimal TCP for downloading files
+ *
+ * A single connection is supported, opened by us. Data received is handed
+ * to the client together with its offset in the stream, so that the client
+ * can store it straight into place whether it arrives in order or not: the
+ * load buffer is the receive buffer, and the window advertised is the space
+ * left in it.
+ *
+ * A segment received out of order is answered at once with a duplicate ACK,
+ * so that the other end retransmits the missing segment without waiting for
+ * its timer (fast retransmit). SACK is not used; instead the ranges received
+ * beyond the hole are remembered and the ACK moves past them as soon as the
+ * hole is filled. Data we send is retransmitted on a timer, or after three
+ * duplicate ACKs.
+ */
+
+#include <common.h>
+#include <log.h>
+#include <net.h>
+#include <net/tcp.h>
+#include <asm/unaligned.h>
+
+/* Timer tick, which also bounds how long an ACK may be delayed */
+#define TCP_TICK_MS		10
+/* Initial retransmission timeout, from RFC 6298 */
+#define TCP_RTO_MS		1000
+/* Number of retransmissions before giving up */
+#define TCP_RETRIES		6
+/* Time without hearing from the other end before giving up */
+#define TCP_TIMEOUT_MS		30000
+/* Number of duplicate ACKs which trigger a retransmission */
+#define TCP_DUP_ACKS		3
+/* Number of full segments received before an ACK is sent */
+#define TCP_ACK_SEGMENTS	2
+/* Number of out-of-order ranges remembered */
+#define TCP_OOO_RANGES		8
+/* Size of the send buffer */
+#define TCP_TX_SIZE		2048
+/* Largest window which can be advertised */
+#define TCP_MAX_WINDOW		(0xffffU << TCP_MAX_WSCALE)
+
+enum tcp_state {
+	TCP_CLOSED,
+	TCP_SYN_SENT,
+	TCP_ESTABLISHED,
+	TCP_CLOSE_WAIT,		/* the other end has closed */
+	TCP_FIN_WAIT,		/* we have closed */
+	TCP_LAST_ACK,		/* both have closed, waiting for our FIN ACK */
+};
+
+/**
+ * struct tcp_range - data received beyond a hole
+ *
+ * @start:	sequence number of the first byte
+ * @end:	sequence number after the last byte
+ */
+struct tcp_range {
+	u32 start;
+	u32 end;
+};
+
+/**
+ * struct tcp_conn - state of the connection
+ *
+ * Sequence numbers follow RFC 793
+ *
+ * @state:	connection state
+ * @ops:	client of the connection
+ * @remote_ip:	IP address of the other end
+ * @remote_ether: Ethernet address of the other end, found by ARP
+ * @remote_port: port of the other end
+ * @local_port:	our port
+ * @iss:	initial send sequence number
+ * @snd_una:	oldest sequence number sent but not acknowledged
+ * @snd_nxt:	next sequence number to send
+ * @snd_wnd:	window advertised by the other end
+ * @snd_mss:	largest segment to send
+ * @snd_wscale:	window scale of the other end
+ * @irs:	initial receive sequence number
+ * @rcv_nxt:	next sequence number expected
+ * @rx_limit:	number of bytes the client can take
+ * @rcv_wscale:	our window scale
+ * @tx_buf:	data to send, starting at @snd_una
+ * @tx_len:	number of bytes in @tx_buf
+ * @fin_queued:	tcp_close() was called, so a FIN follows the data
+ * @fin_sent:	our FIN was sent at @snd_nxt - 1
+ * @fin_rcvd:	the FIN of the other end was received at @rcv_nxt - 1
+ * @dup_acks:	number of duplicate ACKs received in a row
+ * @ack_pending: number of segments received and not yet acknowledged
+ * @ooo:	ranges received out of order
+ * @ooo_count:	number of entries in @ooo
+ * @rto:	current retransmission timeout in ms
+ * @retries:	number of retransmissions of the oldest data not acknowledged
+ * @rtx_start:	time at which the retransmission timer was started
+ * @rx_time:	time at which the last segment was received
+ * @ack_time:	time at which the last ACK was sent
+ */
+struct tcp_conn {
+	enum tcp_state state;
+	const struct tcp_ops *ops;
+	struct in_addr remote_ip;
+	uchar remote_ether[ARP_HLEN];
+	int remote_port;
+	int local_port;
+	u32 iss;
+	u32 snd_una;
+	u32 snd_nxt;
+	u32 snd_wnd;
+	uint snd_mss;
+	uint snd_wscale;
+	u32 irs;
+	u32 rcv_nxt;
+	u32 rx_limit;
+	uint rcv_wscale;
+	uchar tx_buf[TCP_TX_SIZE];
+	uint tx_len;
+	bool fin_queued;
+	bool fin_sent;
+	bool fin_rcvd;
+	int dup_acks;
+	int ack_pending;
+	struct tcp_range ooo[TCP_OOO_RANGES];
+	int ooo_count;
+	ulong rto;
+	int retries;
+	ulong rtx_start;
+	ulong rx_time;
+	ulong ack_time;
+};
+
+static struct tcp_conn tcp;
+
+static inline bool tcp_seq_lt(u32 a, u32 b)
+{
+	return (s32)(a - b) < 0;
+}
+
+static inline bool tcp_seq_le(u32 a, u32 b)
+{
+	return (s32)(a - b) <= 0;
+}
+
+static uint tcp_checksum(struct in_addr src, struct in_addr dst,
+			 const void *seg, uint len)
+{
+	return add_ip_checksums(0, ip_pseudo_checksum(src, dst, IPPROTO_TCP,
+						      len),
+				compute_ip_checksum(seg, len));
+}
+
+u32 tcp_rx_len(void)
+{
+	if (tcp.state == TCP_CLOSED || tcp.state == TCP_SYN_SENT)
+		return 0;
+
+	return tcp.rcv_nxt - tcp.irs - 1 - tcp.fin_rcvd;
+}
+
+/* Space the client has left, which is the receive window */
+static u32 tcp_rcv_space(void)
+{
+	return min(tcp.rx_limit - tcp_rx_len(), TCP_MAX_WINDOW);
+}
+
+int tcp_set_tcp_header(uchar *pkt, struct in_addr dest, int dport, int sport,
+		       int payload_len, u8 action, u32 tcp_seq_num,
+		       u32 tcp_ack_num)
+{
+	struct ip_tcp_hdr *ip = (struct ip_tcp_hdr *)pkt;
+	uchar *opt = pkt + IP_TCP_HDR_SIZE;
+	int hlen = TCP_HDR_SIZE;
+
+	if (action & TCP_SYN) {
+		opt[0] = TCP_O_MSS;
+		opt[1] = 4;
+		put_unaligned_be16(TCP_MSS, opt + 2);
+		opt[4] = TCP_O_NOP;
+		opt[5] = TCP_O_WS;
+		opt[6] = 3;
+		opt[7] = tcp.rcv_wscale;
+		hlen += TCP_SYN_OPT_SIZE;
+	}
+
+	/* Zero the byte after odd-sized data so that the checksum works */
+	if (payload_len & 1)
+		pkt[IP_HDR_SIZE + hlen + payload_len] = 0;
+
+	net_set_ip_header(pkt, dest, net_ip, IP_HDR_SIZE + hlen + payload_len,
+			  IPPROTO_TCP);
+
+	ip->tcp_src = htons(sport);
+	ip->tcp_dst = htons(dport);
+	ip->tcp_seq = htonl(tcp_seq_num);
+	ip->tcp_ack = action & TCP_ACK ? htonl(tcp_ack_num) : 0;
+	ip->tcp_hlen = (hlen / 4) << 4;
+	ip->tcp_flags = action;
+	/* The window in a SYN is never scaled */
+	if (action & TCP_SYN)
+		ip->tcp_win = htons(min_t(u32, tcp_rcv_space(), 0xffff));
+	else
+		ip->tcp_win = htons(min_t(u32, tcp_rcv_space() >>
+					  tcp.rcv_wscale, 0xffff));
+	ip->tcp_xsum = 0;
+	ip->tcp_ugr = 0;
+	/* Leave the device to sum the segment when it can */
+	if (eth_tx_csum_offload()) {
+		ip->tcp_xsum = ~ip_pseudo_checksum(net_ip, dest, IPPROTO_TCP,
+						   hlen + payload_len) & 0xffff;
+		net_tx_csum_mark(pkt);
+	} else {
+		ip->tcp_xsum = tcp_checksum(net_ip, dest, pkt + IP_HDR_SIZE,
+					    hlen + payload_len);
+	}
+
+	return IP_HDR_SIZE + hlen;
+}
+
+static void tcp_send_segment(u8 action, u32 seq, const uchar *data, uint len)
+{
+	uchar *pkt = net_tx_packet + net_eth_hdr_size() + IP_TCP_HDR_SIZE;
+
+	if (len)
+		memcpy(pkt, data, len);
+	if (tcp.state != TCP_SYN_SENT)
+		action |= TCP_ACK;
+	tcp.ack_pending = 0;
+	tcp.ack_time = get_timer(0);
+	net_send_ip_packet(tcp.remote_ether, tcp.remote_ip, tcp.remote_port,
+			   tcp.local_port, len, IPPROTO_TCP, action, seq,
+			   tcp.rcv_nxt);
+}
+
+static void tcp_send_ack(void)
+{
+	tcp_send_segment(0, tcp.snd_nxt, NULL, 0);
+}
+
+static void tcp_start_rtx(void)
+{
+	if (tcp.snd_una == tcp.snd_nxt)
+		tcp.rtx_start = get_timer(0);
+}
+
+/* Send what the window of the other end allows of the data queued */
+static void tcp_output(void)
+{
+	uint sent, len;
+	u8 action;
+
+	if (tcp.state == TCP_CLOSED || tcp.state == TCP_SYN_SENT)
+		return;
+
+	sent = tcp.snd_nxt - tcp.snd_una;
+	while (sent < tcp.tx_len && sent < tcp.snd_wnd) {
+		len = min(tcp.tx_len - sent, tcp.snd_mss);
+		len = min_t(u32, len, tcp.snd_wnd - sent);
+		action = sent + len == tcp.tx_len ? TCP_PUSH : 0;
+		tcp_start_rtx();
+		tcp_send_segment(action, tcp.snd_nxt, tcp.tx_buf + sent, len);
+		tcp.snd_nxt += len;
+		sent += len;
+	}
+	if (tcp.fin_queued && !tcp.fin_sent && sent == tcp.tx_len) {
+		tcp_start_rtx();
+		tcp_send_segment(TCP_FIN, tcp.snd_nxt, NULL, 0);
+		tcp.snd_nxt++;
+		tcp.fin_sent = true;
+	}
+}
+
+/* Send again everything not acknowledged */
+static void tcp_retransmit(void)
+{
+	tcp.dup_acks = 0;
+	tcp.rtx_start = get_timer(0);
+	if (tcp.state == TCP_SYN_SENT) {
+		tcp_send_segment(TCP_SYN, tcp.iss, NULL, 0);
+		return;
+	}
+	tcp.snd_nxt = tcp.snd_una;
+	tcp.fin_sent = false;
+	tcp_output();
+}
+
+static void tcp_set_closed(void)
+{
+	tcp.state = TCP_CLOSED;
+	net_set_timeout_handler(0, NULL);
+}
+
+static void tcp_timeout_handler(void)
+{
+	ulong now = get_timer(0);
+
+	if (tcp.state == TCP_CLOSED)
+		return;
+	net_set_timeout_handler(TCP_TICK_MS, tcp_timeout_handler);
+
+	if (now - tcp.rx_time > TCP_TIMEOUT_MS) {
+		debug("TCP: timeout\n");
+		tcp_set_closed();
+		tcp.ops->event(TCP_EV_TIMEOUT);
+		return;
+	}
+
+	if (tcp.snd_una != tcp.snd_nxt && now - tcp.rtx_start > tcp.rto) {
+		if (++tcp.retries > TCP_RETRIES) {
+			debug("TCP: too many retransmissions\n");
+			tcp_set_closed();
+			tcp.ops->event(TCP_EV_TIMEOUT);
+			return;
+		}
+		debug("TCP: retransmit %u bytes (rto=%lu)\n",
+		      tcp.snd_nxt - tcp.snd_una, tcp.rto);
+		tcp.rto *= 2;
+		tcp_retransmit();
+		return;
+	}
+
+	/*
+	 * Send any ACK delayed, and repeat the last ACK now and then in case
+	 * it was lost while the other end has nothing more to send
+	 */
+	if (tcp.ack_pending ||
+	    (tcp.state != TCP_SYN_SENT && now - tcp.rx_time > TCP_RTO_MS &&
+	     now - tcp.ack_time > TCP_RTO_MS))
+		tcp_send_ack();
+}
+
+int tcp_connect(struct in_addr dest, int dport, const struct tcp_ops *ops,
+		u32 rx_limit)
+{
+	memset(&tcp, '\0', sizeof(tcp));
+	tcp.ops = ops;
+	tcp.remote_ip = dest;
+	tcp.remote_port = dport;
+	tcp.local_port = 49152 + (rand() & 0x3fff);
+	tcp.iss = rand();
+	tcp.snd_una = tcp.iss;
+	tcp.snd_nxt = tcp.iss + 1;
+	tcp.snd_mss = TCP_DEFAULT_MSS;
+	tcp.rto = TCP_RTO_MS;
+
+	tcp.rx_limit = rx_limit;
+	while ((min(rx_limit, TCP_MAX_WINDOW) >> tcp.rcv_wscale) > 0xffff)
+		tcp.rcv_wscale++;
+
+	tcp.state = TCP_SYN_SENT;
+	tcp.rx_time = get_timer(0);
+	tcp.rtx_start = tcp.rx_time;
+	net_set_timeout_handler(TCP_TICK_MS, tcp_timeout_handler);
+	tcp_send_segment(TCP_SYN, tcp.iss, NULL, 0);
+
+	return 0;
+}
+
+int tcp_send(const void *data, uint len)
+{
+	if (tcp.state != TCP_ESTABLISHED && tcp.state != TCP_CLOSE_WAIT)
+		return -ENOTCONN;
+	if (tcp.fin_queued || len > TCP_TX_SIZE - tcp.tx_len)
+		return -ENOSPC;
+	memcpy(tcp.tx_buf + tcp.tx_len, data, len);
+	tcp.tx_len += len;
+	tcp_output();
+
+	return 0;
+}
+
+void tcp_close(void)
+{
+	switch (tcp.state) {
+	case TCP_SYN_SENT:
+		tcp_abort();
+		return;
+	case TCP_ESTABLISHED:
+		tcp.state = TCP_FIN_WAIT;
+		break;
+	case TCP_CLOSE_WAIT:
+		tcp.state = TCP_LAST_ACK;
+		break;
+	default:
+		return;
+	}
+	tcp.fin_queued = true;
+	tcp_output();
+}
+
+void tcp_abort(void)
+{
+	if (tcp.state == TCP_CLOSED)
+		return;
+	tcp_send_segment(TCP_RST, tcp.snd_nxt, NULL, 0);
+	tcp_set_closed();
+}
+
+/* Read the options of a SYN */
+static void tcp_parse_options(const uchar *opt, int len)
+{
+	bool wscale = false;
+	int olen;
+
+	while (len > 0 && *opt != TCP_O_END) {
+		if (*opt == TCP_O_NOP) {
+			opt++;
+			len--;
+			continue;
+		}
+		if (len < 2 || opt[1] < 2 || opt[1] > len)
+			break;
+		olen = opt[1];
+		if (*opt == TCP_O_MSS && olen == 4) {
+			tcp.snd_mss = min_t(uint, get_unaligned_be16(opt + 2),
+					    TCP_MSS);
+		} else if (*opt == TCP_O_WS && olen == 3) {
+			tcp.snd_wscale = min_t(uint, opt[2], TCP_MAX_WSCALE);
+			wscale = true;
+		}
+		opt += olen;
+		len -= olen;
+	}
+
+	/* Scaling is only used if both ends ask for it */
+	if (!wscale)
+		tcp.rcv_wscale = 0;
+}
+
+/* Record data received beyond a hole */
+static void tcp_ooo_add(u32 start, u32 end)
+{
+	struct tcp_range *range;
+	int i;
+
+	for (i = 0; i < tcp.ooo_count; i++) {
+		range = &tcp.ooo[i];
+		if (tcp_seq_le(start, range->end) &&
+		    tcp_seq_le(range->start, end)) {
+			if (tcp_seq_lt(start, range->start))
+				range->start = start;
+			if (tcp_seq_lt(range->end, end))
+				range->end = end;
+			return;
+		}
+	}
+
+	/* If there is no room, the data will simply be sent again */
+	if (tcp.ooo_count < TCP_OOO_RANGES) {
+		range = &tcp.ooo[tcp.ooo_count++];
+		range->start = start;
+		range->end = end;
+	}
+}
+
+/* Move past any ranges received beyond the hole just filled */
+static bool tcp_ooo_advance(void)
+{
+	bool moved = false;
+	bool found;
+	int i;
+
+	do {
+		found = false;
+		for (i = 0; i < tcp.ooo_count; i++) {
+			struct tcp_range *range = &tcp.ooo[i];
+
+			if (!tcp_seq_le(range->start, tcp.rcv_nxt))
+				continue;
+			if (tcp_seq_lt(tcp.rcv_nxt, range->end))
+				tcp.rcv_nxt = range->end;
+			*range = tcp.ooo[--tcp.ooo_count];
+			moved = found = true;
+			break;
+		}
+	} while (found);
+
+	return moved;
+}
+
+static void tcp_rx_ack(u32 ack, uint win, bool has_data)
+{
+	u32 acked;
+
+	if (tcp_seq_lt(tcp.snd_una, ack) && tcp_seq_le(ack, tcp.snd_nxt)) {
+		acked = min(ack - tcp.snd_una, tcp.tx_len);
+		memmove(tcp.tx_buf, tcp.tx_buf + acked, tcp.tx_len - acked);
+		tcp.tx_len -= acked;
+		tcp.snd_una = ack;
+		tcp.dup_acks = 0;
+		tcp.retries = 0;
+		tcp.rto = TCP_RTO_MS;
+		tcp.rtx_start = get_timer(0);
+		if (tcp.fin_sent && ack == tcp.snd_nxt) {
+			if (tcp.state == TCP_LAST_ACK)
+				tcp_set_closed();
+		}
+	} else if (ack == tcp.snd_una && tcp.snd_una != tcp.snd_nxt &&
+		   !has_data && (win << tcp.snd_wscale) == tcp.snd_wnd) {
+		if (++tcp.dup_acks == TCP_DUP_ACKS) {
+			debug("TCP: fast retransmit\n");
+			tcp_retransmit();
+		}
+	}
+	tcp.snd_wnd = win << tcp.snd_wscale;
+}
+
+/*
+ * Handle data received. Returns true if more data is now available in
+ * order, and sets @finp if the other end has closed.
+ */
+static bool tcp_rx_data(u32 seq, const uchar *data, uint len, u8 flags,
+			bool *finp)
+{
+	bool fin = flags & TCP_FIN;
+	bool in_order = false;
+	bool ack_now = false;
+	u32 skip, off, space;
+
+	/* Drop anything we already have */
+	if (tcp_seq_lt(seq, tcp.rcv_nxt)) {
+		skip = tcp.rcv_nxt - seq;
+		if (skip > len || (skip == len && !fin)) {
+			tcp_send_ack();
+			return false;
+		}
+		seq += skip;
+		data += skip;
+		len -= skip;
+	}
+
+	/* ...and anything beyond the window */
+	off = seq - tcp.rcv_nxt;
+	space = tcp_rcv_space();
+	if (len > space || off > space - len) {
+		if (off >= space) {
+			tcp_send_ack();
+			return false;
+		}
+		len = space - off;
+		fin = false;
+	}
+
+	if (len) {
+		if (tcp.ops->rx(seq - tcp.irs - 1, data, len)) {
+			tcp_send_ack();
+			return false;
+		}
+		/* The client may have given up on the connection */
+		if (tcp.state == TCP_CLOSED)
+			return false;
+		if (seq == tcp.rcv_nxt) {
+			tcp.rcv_nxt += len;
+			in_order = true;
+			if (tcp_ooo_advance())
+				ack_now = true;
+		} else {
+			/* Tell the other end at once where the hole is */
+			tcp_ooo_add(seq, seq + len);
+			ack_now = true;
+			fin = false;
+		}
+	}
+
+	if (fin && seq + len == tcp.rcv_nxt) {
+		tcp.rcv_nxt++;
+		tcp.fin_rcvd = true;
+		*finp = true;
+		ack_now = true;
+	}
+
+	if (in_order && ++tcp.ack_pending >= TCP_ACK_SEGMENTS)
+		ack_now = true;
+	if (ack_now || (flags & TCP_PUSH))
+		tcp_send_ack();
+
+	return in_order;
+}
+
+void tcp_receive(struct ip_tcp_hdr *ip, int len, bool csum_ok)
+{
+	struct in_addr src = net_read_ip(&ip->ip_src);
+	struct in_addr dst = net_read_ip(&ip->ip_dst);
+	const struct tcp_ops *ops = tcp.ops;
+	bool fin = false, more;
+	const uchar *data;
+	u32 seq, ack;
+	int hlen;
+	u8 flags;
+	uint win;
+
+	if (len < IP_TCP_HDR_SIZE)
+		return;
+	hlen = (ip->tcp_hlen >> 4) * 4;
+	if (hlen < TCP_HDR_SIZE || IP_HDR_SIZE + hlen > len)
+		return;
+	if (tcp.state == TCP_CLOSED || src.s_addr != tcp.remote_ip.s_addr ||
+	    ntohs(ip->tcp_src) != tcp.remote_port ||
+	    ntohs(ip->tcp_dst) != tcp.local_port)
+		return;
+	if (!csum_ok && tcp_checksum(src, dst, (uchar *)ip + IP_HDR_SIZE,
+				     len - IP_HDR_SIZE)) {
+		debug("TCP: bad checksum\n");
+		return;
+	}
+
+	flags = ip->tcp_flags;
+	seq = ntohl(ip->tcp_seq);
+	ack = ntohl(ip->tcp_ack);
+	win = ntohs(ip->tcp_win);
+	data = (uchar *)ip + IP_HDR_SIZE + hlen;
+	len -= IP_HDR_SIZE + hlen;
+
+	if (tcp.state == TCP_SYN_SENT) {
+		if ((flags & TCP_ACK) && ack != tcp.iss + 1)
+			return;
+		if (flags & TCP_RST) {
+			if (flags & TCP_ACK) {
+				tcp_set_closed();
+				ops->event(TCP_EV_RESET);
+			}
+			return;
+		}
+		if ((flags & (TCP_SYN | TCP_ACK)) != (TCP_SYN | TCP_ACK))
+			return;
+		tcp_parse_options((uchar *)ip + IP_TCP_HDR_SIZE,
+				  hlen - TCP_HDR_SIZE);
+		tcp.irs = seq;
+		tcp.rcv_nxt = seq + 1;
+		tcp.snd_una = ack;
+		tcp.snd_wnd = win;
+		tcp.rx_time = get_timer(0);
+		tcp.state = TCP_ESTABLISHED;
+		debug("TCP: connected, mss %u, window scale %u/%u\n",
+		      tcp.snd_mss, tcp.snd_wscale, tcp.rcv_wscale);
+		tcp_send_ack();
+		ops->event(TCP_EV_CONNECTED);
+		return;
+	}
+
+	if (flags & TCP_RST) {
+		if (seq - tcp.rcv_nxt <= tcp_rcv_space()) {
+			tcp_set_closed();
+			ops->event(TCP_EV_RESET);
+		}
+		return;
+	}
+	if (!(flags & TCP_ACK))
+		return;
+	tcp.rx_time = get_timer(0);
+
+	tcp_rx_ack(ack, win, len || (flags & TCP_FIN));
+	if (tcp.state == TCP_CLOSED)
+		return;
+
+	more = false;
+	if (len || (flags & TCP_FIN))
+		more = tcp_rx_data(seq, data, len, flags, &fin);
+	if (fin) {
+		if (tcp.state == TCP_ESTABLISHED)
+			tcp.state = TCP_CLOSE_WAIT;
+		else if (tcp.state == TCP_FIN_WAIT)
+			tcp_set_closed();
+		else
+			fin = false;
+	}
+	tcp_output();
+
+	if (more)
+		ops->event(TCP_EV_DATA);
+	if (fin)
+		ops->event(TCP_EV_CLOSED);
+}
@@ -15,6 +15,8 @@
 #include <mapmem.h>
 #include <net.h>
 #include <asm/global_data.h>
+#include <linux/errno.h>
+#include <net/store.h>
 #include <net/tftp.h>
 #include "bootp.h"
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
@@ -73,37 +75,70 @@ enum {
 	TFTP_ERR_OPTION_NEGOTIATION = 8,
 };
 
-static struct in_addr tftp_remote_ip;
-/* The UDP port at their end */
-static int	tftp_remote_port;
-/* The UDP port at our end */
-static int	tftp_our_port;
-static int	timeout_count;
-/* packet sequence number */
-static ulong	tftp_cur_block;
-/* last packet sequence number received */
-static ulong	tftp_prev_block;
-/* count of sequence number wraparounds */
-static ulong	tftp_block_wrap;
-/* memory offset due to wrapping */
-static ulong	tftp_block_wrap_offset;
-static int	tftp_state;
-static ulong	tftp_load_addr;
+#ifndef CONFIG_TFTP_FILE_NAME_MAX_LEN
+#define MAX_LEN 128
+#else
+#define MAX_LEN CONFIG_TFTP_FILE_NAME_MAX_LEN
+#endif
+
+/*
+ * State of one file transfer. A get may fetch several files at once, each
+ * from its own UDP port at our end; put and the server use a single one.
+ */
+struct tftp_session {
+	struct in_addr	remote_ip;
+	/* The UDP port at their end */
+	int		remote_port;
+	/* The UDP port at our end */
+	int		our_port;
+	int		timeout_count;
+	/* Time at which we last heard from the server or sent a retry */
+	ulong		time_active;
+	/* packet sequence number */
+	ulong		cur_block;
+	/* last packet sequence number received */
+	ulong		prev_block;
+	/* count of sequence number wraparounds */
+	ulong		block_wrap;
+	/* memory offset due to wrapping */
+	ulong		block_wrap_offset;
+	int		state;
+	ulong		load_addr;
 #ifdef CONFIG_LMB
-static ulong	tftp_load_size;
+	ulong		load_size;
+#endif
+	/* load_addr mapped once for the whole transfer */
+	uchar		*load_buf;
+	/* Number of bytes which may be stored in RAM at load_buf */
+	ulong		store_limit;
+	/* Number of bytes stored so far */
+	ulong		file_size;
+#ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
+	/* Offset from load_addr from which blocks are written to flash */
+	ulong		flash_offset;
 #endif
 #ifdef CONFIG_TFTP_TSIZE
-/* The file size reported by the server */
-static int	tftp_tsize;
-/* The number of hashes we printed */
-static short	tftp_tsize_num_hash;
-#endif
-/* The window size negotiated */
-static ushort	tftp_windowsize;
-/* Next block to send ack to */
-static ushort	tftp_next_ack;
-/* Last nack block we send */
-static ushort	tftp_last_nack;
+	/* The file size reported by the server */
+	int		tsize;
+	/* The number of hashes we printed */
+	short		tsize_num_hash;
+#endif
+	/* The block size negotiated */
+	unsigned short	block_size;
+	/* The window size negotiated */
+	ushort		windowsize;
+	/* Next block to send ack to */
+	ushort		next_ack;
+	/* Last nack block we send */
+	ushort		last_nack;
+	char		filename[MAX_LEN];
+};
+
+static struct tftp_session tftp_sessions[CONFIG_TFTP_MAX_FILES];
+/* Number of sessions in use by the current transfer */
+static int	tftp_num_sessions;
+/* Number of files added by tftp_add_file(), kept in tftp_sessions[1..] */
+static int	tftp_extra_files;
 #ifdef CONFIG_CMD_TFTPPUT
 /* 1 if writing, else 0 */
 static int	tftp_put_active;
@@ -121,6 +156,9 @@ static int	tftp_put_final_block_sent;
 #define STATE_RECV_WRQ	6
 #define STATE_SEND_WRQ	7
 #define STATE_INVALID_OPTION	8
+/* RRQ held back until the server's MAC address is known */
+#define STATE_QUEUED	9
+#define STATE_DONE	10
 
 /* default TFTP block size */
 #define TFTP_BLOCK_SIZE		512
@@ -130,14 +168,6 @@ static int	tftp_put_final_block_sent;
 #define DEFAULT_NAME_LEN	(8 + 4 + 1)
 static char default_filename[DEFAULT_NAME_LEN];
 
-#ifndef CONFIG_TFTP_FILE_NAME_MAX_LEN
-#define MAX_LEN 128
-#else
-#define MAX_LEN CONFIG_TFTP_FILE_NAME_MAX_LEN
-#endif
-
-static char tftp_filename[MAX_LEN];
-
 /* 512 is poor choice for ethernet, MTU is typically 1500.
  * Minus eth.hdrs thats 1468.  Can get 2x better throughput with
  * almost-MTU block sizes.  At least try... fall back to 512 if need be.
@@ -154,31 +184,72 @@ static char tftp_filename[MAX_LEN];
 #define TFTP_WINDOWSIZE 1
 #endif
 
-static unsigned short tftp_block_size = TFTP_BLOCK_SIZE;
 static unsigned short tftp_block_size_option = CONFIG_TFTP_BLOCKSIZE;
 static unsigned short tftp_window_size_option = TFTP_WINDOWSIZE;
 
-static inline int store_block(int block, uchar *src, unsigned int len)
+/*
+ * Work out once where the file may be stored, so that store_block() has only
+ * to check each block against the store limit before copying it.
+ */
+static void tftp_init_store(struct tftp_session *sess)
 {
-	ulong offset = block * tftp_block_size + tftp_block_wrap_offset -
-			tftp_block_size;
-	ulong newsize = offset + len;
-	ulong store_addr = tftp_load_addr + offset;
+	ulong limit = ULONG_MAX - sess->load_addr;
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
-	int i, rc = 0;
+	int i;
 
+	/* Blocks from the start of the first flash bank on go to flash */
+	sess->flash_offset = ULONG_MAX;
 	for (i = 0; i < CONFIG_SYS_MAX_FLASH_BANKS; i++) {
-		/* start address in flash? */
 		if (flash_info[i].flash_id == FLASH_UNKNOWN)
 			continue;
-		if (store_addr >= flash_info[i].start[0]) {
-			rc = 1;
+		if (flash_info[i].start[0] <= sess->load_addr) {
+			sess->flash_offset = 0;
 			break;
 		}
+		sess->flash_offset = min(sess->flash_offset,
+					 flash_info[i].start[0] -
+					 sess->load_addr);
 	}
+#endif
+#ifdef CONFIG_LMB
+	limit = min(limit, sess->load_size);
+#endif
+	sess->store_limit = limit;
+	sess->load_buf = map_sysmem(sess->load_addr, 0);
+}
+
+#ifdef CONFIG_TFTP_TSIZE
+/* Check whether a file of @size bytes fits in the space for it */
+static bool tftp_store_fits(struct tftp_session *sess, ulong size)
+{
+	if (net_store_active())
+		return net_store_fits(size);
+#ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
+	/* Only the part of the file before flash is stored in RAM */
+	size = min(size, sess->flash_offset);
+#endif
+	return size <= sess->store_limit;
+}
+#endif
+
+static inline int store_block(struct tftp_session *sess, int block,
+			      uchar *src, unsigned int len)
+{
+	ulong offset = block * sess->block_size + sess->block_wrap_offset -
+			sess->block_size;
+	ulong newsize = offset + len;
+
+	if (net_store_active()) {
+		/* The file goes to a block device, not to memory */
+		if (net_store_write(offset, src, len))
+			return -1;
+	} else
+#ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
+	if (offset >= sess->flash_offset) {
+		/* Flash is destination for this packet */
+		int rc = flash_write((char *)src, sess->load_addr + offset,
+				     len);
 
-	if (rc) { /* Flash is destination for this packet */
-		rc = flash_write((char *)src, store_addr, len);
 		if (rc) {
 			flash_perror(rc);
 			return rc;
@@ -186,38 +257,27 @@ static inline int store_block(int block, uchar *src, unsigned int len)
 	} else
 #endif /* CONFIG_SYS_DIRECT_FLASH_TFTP */
 	{
-		void *ptr;
-
-#ifdef CONFIG_LMB
-		ulong end_addr = tftp_load_addr + tftp_load_size;
-
-		if (!end_addr)
-			end_addr = ULONG_MAX;
-
-		if (store_addr < tftp_load_addr ||
-		    store_addr + len > end_addr) {
+		if (len > sess->store_limit ||
+		    offset > sess->store_limit - len) {
 			puts("\nTFTP error: ");
 			puts("trying to overwrite reserved memory...\n");
 			return -1;
 		}
-#endif
-		ptr = map_sysmem(store_addr, len);
-		memcpy(ptr, src, len);
-		unmap_sysmem(ptr);
+		memcpy(sess->load_buf + offset, src, len);
 	}
 
-	if (net_boot_file_size < newsize)
-		net_boot_file_size = newsize;
+	if (sess->file_size < newsize)
+		sess->file_size = newsize;
 
 	return 0;
 }
 
 /* Clear our state ready for a new transfer */
-static void new_transfer(void)
+static void new_transfer(struct tftp_session *sess)
 {
-	tftp_prev_block = 0;
-	tftp_block_wrap = 0;
-	tftp_block_wrap_offset = 0;
+	sess->prev_block = 0;
+	sess->block_wrap = 0;
+	sess->block_wrap_offset = 0;
 #ifdef CONFIG_CMD_TFTPPUT
 	tftp_put_final_block_sent = 0;
 #endif
@@ -227,16 +287,18 @@ static void new_transfer(void)
 /**
  * Load the next block from memory to be sent over tftp.
  *
+ * @param sess	Session sending the block
  * @param block	Block number to send
  * @param dst	Destination buffer for data
  * @param len	Number of bytes in block (this one and every other)
  * @return number of bytes loaded
  */
-static int load_block(unsigned block, uchar *dst, unsigned len)
+static int load_block(struct tftp_session *sess, unsigned block, uchar *dst,
+		      unsigned len)
 {
 	/* We may want to get the final block from the previous set */
-	ulong offset = block * tftp_block_size + tftp_block_wrap_offset -
-		       tftp_block_size;
+	ulong offset = block * sess->block_size + sess->block_wrap_offset -
+		       sess->block_size;
 	ulong tosend = len;
 
 	tosend = min(net_boot_file_size - offset, tosend);
@@ -247,31 +309,31 @@ static int load_block(unsigned block, uchar *dst, unsigned len)
 }
 #endif
 
-static void tftp_send(void);
+static void tftp_send(struct tftp_session *sess);
 static void tftp_timeout_handler(void);
 
 /**********************************************************************/
 
-static void show_block_marker(void)
+static void show_block_marker(struct tftp_session *sess)
 {
 	ulong pos;
 
 #ifdef CONFIG_TFTP_TSIZE
-	if (tftp_tsize) {
-		pos = tftp_cur_block * tftp_block_size +
-			tftp_block_wrap_offset;
-		if (pos > tftp_tsize)
-			pos = tftp_tsize;
+	if (sess->tsize) {
+		pos = sess->cur_block * sess->block_size +
+			sess->block_wrap_offset;
+		if (pos > sess->tsize)
+			pos = sess->tsize;
 
-		while (tftp_tsize_num_hash < pos * 50 / tftp_tsize) {
+		while (sess->tsize_num_hash < pos * 50 / sess->tsize) {
 			putc('#');
-			tftp_tsize_num_hash++;
+			sess->tsize_num_hash++;
 		}
 	} else
 #endif
 	{
-		pos = (tftp_cur_block - 1) +
-			(tftp_block_wrap * TFTP_SEQUENCE_SIZE);
+		pos = (sess->cur_block - 1) +
+			(sess->block_wrap * TFTP_SEQUENCE_SIZE);
 		if ((pos % 10) == 0)
 			putc('#');
 		else if (((pos + 1) % (10 * HASHES_PER_LINE)) == 0)
@@ -292,10 +354,8 @@ static void restart(const char *msg)
 
 /*
  * Check if the block number has wrapped, and update progress
- *
- * TODO: The egregious use of global variables in this file should be tidied.
  */
-static void update_block_number(void)
+static void update_block_number(struct tftp_session *sess)
 {
 	/*
 	 * RFC1350 specifies that the first data packet will
@@ -303,43 +363,120 @@ static void update_block_number(void)
 	 * number of 0 this means that there was a wrap
 	 * around of the (16 bit) counter.
 	 */
-	if (tftp_cur_block == 0 && tftp_prev_block != 0) {
-		tftp_block_wrap++;
-		tftp_block_wrap_offset += tftp_block_size * TFTP_SEQUENCE_SIZE;
-		timeout_count = 0; /* we've done well, reset the timeout */
+	if (sess->cur_block == 0 && sess->prev_block != 0) {
+		sess->block_wrap++;
+		sess->block_wrap_offset += sess->block_size *
+					   TFTP_SEQUENCE_SIZE;
+		/* we've done well, reset the timeout */
+		sess->timeout_count = 0;
 	}
-	show_block_marker();
+	/* Progress of concurrent transfers would be interleaved */
+	if (tftp_num_sessions == 1)
+		show_block_marker(sess);
 }
 
-/* The TFTP get or put is complete */
-static void tftp_complete(void)
+/* Find the session a packet sent to our UDP port @port belongs to */
+static struct tftp_session *tftp_find_session(unsigned port)
 {
-#ifdef CONFIG_TFTP_TSIZE
-	/* Print hash marks for the last packet received */
-	while (tftp_tsize && tftp_tsize_num_hash < 49) {
-		putc('#');
-		tftp_tsize_num_hash++;
+	int i;
+
+	for (i = 0; i < tftp_num_sessions; i++) {
+		if (tftp_sessions[i].our_port == port)
+			return &tftp_sessions[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Arm the timeout for the session which has been waiting longest, so that
+ * one stalled transfer is retried even while the others make progress
+ */
+static void tftp_set_timeout(void)
+{
+	ulong idle = 0;
+	int i;
+
+	for (i = 0; i < tftp_num_sessions; i++) {
+		struct tftp_session *sess = &tftp_sessions[i];
+
+		if (sess->state != STATE_DONE && sess->state != STATE_QUEUED)
+			idle = max(idle, get_timer(sess->time_active));
 	}
-	puts("  ");
-	print_size(tftp_tsize, "");
+	net_set_timeout_handler(idle < timeout_ms ? timeout_ms - idle : 1,
+				tftp_timeout_handler);
+}
+
+/*
+ * Send the read requests of queued sessions. Only one packet can wait for
+ * an ARP reply, so the others are held back until the server's MAC address
+ * is known.
+ */
+static void tftp_send_queued(void)
+{
+	int i;
+
+	for (i = 0; i < tftp_num_sessions && !arp_is_waiting(); i++) {
+		struct tftp_session *sess = &tftp_sessions[i];
+
+		if (sess->state != STATE_QUEUED)
+			continue;
+		sess->state = STATE_SEND_RRQ;
+		sess->time_active = get_timer(0);
+		tftp_send(sess);
+	}
+}
+
+/* The TFTP get or put of @sess is complete */
+static void tftp_complete(struct tftp_session *sess)
+{
+	ulong total = 0;
+	int i;
+
+	sess->state = STATE_DONE;
+	if (tftp_num_sessions > 1) {
+		printf("\n\t '%s' ", sess->filename);
+		print_size(sess->file_size, "");
+	} else {
+#ifdef CONFIG_TFTP_TSIZE
+		/* Print hash marks for the last packet received */
+		while (sess->tsize && sess->tsize_num_hash < 49) {
+			putc('#');
+			sess->tsize_num_hash++;
+		}
+		puts("  ");
+		print_size(sess->tsize, "");
 #endif
+	}
+
+	for (i = 0; i < tftp_num_sessions; i++) {
+		if (tftp_sessions[i].state != STATE_DONE)
+			return;
+		total += tftp_sessions[i].file_size;
+	}
+	/* The size of the first file is reported as the one loaded */
+	if (tftp_put_active)
+		total = net_boot_file_size;
+	else
+		net_boot_file_size = tftp_sessions[0].file_size;
+
 	time_start = get_timer(time_start);
 	if (time_start > 0) {
 		puts("\n\t ");	/* Line up with "Loading: " */
-		print_size(net_boot_file_size /
-			time_start * 1000, "/s");
+		print_size(total / time_start * 1000, "/s");
 	}
 	puts("\ndone\n");
-	if (IS_ENABLED(CONFIG_CMD_BOOTEFI)) {
+	if (IS_ENABLED(CONFIG_CMD_BOOTEFI) && !net_store_active()) {
+		sess = &tftp_sessions[0];
 		if (!tftp_put_active)
-			efi_set_bootdev("Net", "", tftp_filename,
-					map_sysmem(tftp_load_addr, 0),
+			efi_set_bootdev("Net", "", sess->filename,
+					map_sysmem(sess->load_addr, 0),
 					net_boot_file_size);
 	}
 	net_set_state(NETLOOP_SUCCESS);
 }
 
-static void tftp_send(void)
+static void tftp_send(struct tftp_session *sess)
 {
 	uchar *pkt;
 	uchar *xp;
@@ -353,20 +490,20 @@ static void tftp_send(void)
 	 */
 	pkt = net_tx_packet + net_eth_hdr_size() + IP_UDP_HDR_SIZE;
 
-	switch (tftp_state) {
+	switch (sess->state) {
 	case STATE_SEND_RRQ:
 	case STATE_SEND_WRQ:
 		xp = pkt;
 		s = (ushort *)pkt;
 #ifdef CONFIG_CMD_TFTPPUT
-		*s++ = htons(tftp_state == STATE_SEND_RRQ ? TFTP_RRQ :
+		*s++ = htons(sess->state == STATE_SEND_RRQ ? TFTP_RRQ :
 			TFTP_WRQ);
 #else
 		*s++ = htons(TFTP_RRQ);
 #endif
 		pkt = (uchar *)s;
-		strcpy((char *)pkt, tftp_filename);
-		pkt += strlen(tftp_filename) + 1;
+		strcpy((char *)pkt, sess->filename);
+		pkt += strlen(sess->filename) + 1;
 		strcpy((char *)pkt, "octet");
 		pkt += 5 /*strlen("octet")*/ + 1;
 		strcpy((char *)pkt, "timeout");
@@ -386,7 +523,8 @@ static void tftp_send(void)
 		 * Implemented only for tftp get.
 		 * Don't bother sending if it's 1
 		 */
-		if (tftp_state == STATE_SEND_RRQ && tftp_window_size_option > 1)
+		if (sess->state == STATE_SEND_RRQ &&
+		    tftp_window_size_option > 1)
 			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
 					0, tftp_window_size_option, 0);
 		len = pkt - xp;
@@ -399,12 +537,13 @@ static void tftp_send(void)
 		xp = pkt;
 		s = (ushort *)pkt;
 		s[0] = htons(TFTP_ACK);
-		s[1] = htons(tftp_cur_block);
+		s[1] = htons(sess->cur_block);
 		pkt = (uchar *)(s + 2);
 #ifdef CONFIG_CMD_TFTPPUT
 		if (tftp_put_active) {
-			int toload = tftp_block_size;
-			int loaded = load_block(tftp_cur_block, pkt, toload);
+			int toload = sess->block_size;
+			int loaded = load_block(sess, sess->cur_block, pkt,
+						toload);
 
 			s[0] = htons(TFTP_DATA);
 			pkt += loaded;
@@ -453,8 +592,8 @@ static void tftp_send(void)
 		break;
 	}
 
-	net_send_udp_packet(net_server_ethaddr, tftp_remote_ip,
-			    tftp_remote_port, tftp_our_port, len);
+	net_send_udp_packet(net_server_ethaddr, sess->remote_ip,
+			    sess->remote_port, sess->our_port, len);
 
 	if (err_pkt)
 		net_set_state(NETLOOP_FAIL);
@@ -475,16 +614,20 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 unsigned src, unsigned len)
 {
+	struct tftp_session *sess;
 	__be16 proto;
 	__be16 *s;
 	int i;
 	u16 timeout_val_rcvd;
 
-	if (dest != tftp_our_port) {
-			return;
-	}
-	if (tftp_state != STATE_SEND_RRQ && src != tftp_remote_port &&
-	    tftp_state != STATE_RECV_WRQ && tftp_state != STATE_SEND_WRQ)
+	/* The server has been heard from, so its MAC address is known */
+	tftp_send_queued();
+
+	sess = tftp_find_session(dest);
+	if (!sess || sess->state == STATE_QUEUED || sess->state == STATE_DONE)
+		return;
+	if (sess->state != STATE_SEND_RRQ && src != sess->remote_port &&
+	    sess->state != STATE_RECV_WRQ && sess->state != STATE_SEND_WRQ)
 		return;
 
 	if (len < 2)
@@ -502,20 +645,21 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 #ifdef CONFIG_CMD_TFTPPUT
 		if (tftp_put_active) {
 			if (tftp_put_final_block_sent) {
-				tftp_complete();
+				tftp_complete(sess);
 			} else {
 				/*
 				 * Move to the next block. We want our block
 				 * count to wrap just like the other end!
 				 */
 				int block = ntohs(*s);
-				int ack_ok = (tftp_cur_block == block);
+				int ack_ok = (sess->cur_block == block);
 
-				tftp_prev_block = tftp_cur_block;
-				tftp_cur_block = (unsigned short)(block + 1);
-				update_block_number();
+				sess->prev_block = sess->cur_block;
+				sess->cur_block = (unsigned short)(block + 1);
+				update_block_number(sess);
+				/* Send next data block */
 				if (ack_ok)
-					tftp_send(); /* Send next data block */
+					tftp_send(sess);
 			}
 		}
 #endif
@@ -527,11 +671,11 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 #ifdef CONFIG_CMD_TFTPSRV
 	case TFTP_WRQ:
 		debug("Got WRQ\n");
-		tftp_remote_ip = sip;
-		tftp_remote_port = src;
-		tftp_our_port = 1024 + (get_timer(0) % 3072);
-		new_transfer();
-		tftp_send(); /* Send ACK(0) */
+		sess->remote_ip = sip;
+		sess->remote_port = src;
+		sess->our_port = 1024 + (get_timer(0) % 3072);
+		new_transfer(sess);
+		tftp_send(sess); /* Send ACK(0) */
 		break;
 #endif
 
@@ -544,8 +688,8 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 				debug("%c", pkt[i]);
 		}
 		debug("\n");
-		tftp_state = STATE_OACK;
-		tftp_remote_port = src;
+		sess->state = STATE_OACK;
+		sess->remote_port = src;
 		/*
 		 * Check for 'blksize' option.
 		 * Careful: "i" is signed, "len" is unsigned, thus
@@ -553,15 +697,15 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		 */
 		for (i = 0; i+8 < len; i++) {
 			if (strcasecmp((char *)pkt + i, "blksize") == 0) {
-				tftp_block_size = (unsigned short)
+				sess->block_size = (unsigned short)
 					simple_strtoul((char *)pkt + i + 8,
 						       NULL, 10);
 				debug("Blocksize oack: %s, %d\n",
-				      (char *)pkt + i + 8, tftp_block_size);
-				if (tftp_block_size > tftp_block_size_option) {
+				      (char *)pkt + i + 8, sess->block_size);
+				if (sess->block_size > tftp_block_size_option) {
 					printf("Invalid blk size(=%d)\n",
-					       tftp_block_size);
-					tftp_state = STATE_INVALID_OPTION;
+					       sess->block_size);
+					sess->state = STATE_INVALID_OPTION;
 				}
 			}
 			if (strcasecmp((char *)pkt + i, "timeout") == 0) {
@@ -573,105 +717,118 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 				if (timeout_val_rcvd != (timeout_ms / 1000)) {
 					printf("Invalid timeout val(=%d s)\n",
 					       timeout_val_rcvd);
-					tftp_state = STATE_INVALID_OPTION;
+					sess->state = STATE_INVALID_OPTION;
 				}
 			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcasecmp((char *)pkt + i, "tsize") == 0) {
-				tftp_tsize = simple_strtoul((char *)pkt + i + 6,
-							   NULL, 10);
+				sess->tsize =
+					simple_strtoul((char *)pkt + i + 6,
+						       NULL, 10);
 				debug("size = %s, %d\n",
-				      (char *)pkt + i + 6, tftp_tsize);
+				      (char *)pkt + i + 6, sess->tsize);
 			}
 #endif
 			if (strcasecmp((char *)pkt + i,  "windowsize") == 0) {
-				tftp_windowsize =
+				sess->windowsize =
 					simple_strtoul((char *)pkt + i + 11,
 						       NULL, 10);
 				debug("windowsize = %s, %d\n",
-				      (char *)pkt + i + 11, tftp_windowsize);
+				      (char *)pkt + i + 11, sess->windowsize);
 			}
 		}
 
-		tftp_next_ack = tftp_windowsize;
+		sess->next_ack = sess->windowsize;
+
+#ifdef CONFIG_TFTP_TSIZE
+		/* Refuse a file which cannot fit before any of it is sent */
+		if (!tftp_put_active && sess->tsize > 0 &&
+		    !tftp_store_fits(sess, sess->tsize)) {
+			puts("\nTFTP error: ");
+			puts("trying to overwrite reserved memory...\n");
+			sess->state = STATE_TOO_LARGE;
+		}
+#endif
 
 #ifdef CONFIG_CMD_TFTPPUT
-		if (tftp_put_active && tftp_state == STATE_OACK) {
+		if (tftp_put_active && sess->state == STATE_OACK) {
 			/* Get ready to send the first block */
-			tftp_state = STATE_DATA;
-			tftp_cur_block++;
+			sess->state = STATE_DATA;
+			sess->cur_block++;
 		}
 #endif
-		tftp_send(); /* Send ACK or first data block */
+		tftp_send(sess); /* Send ACK or first data block */
 		break;
 	case TFTP_DATA:
 		if (len < 2)
 			return;
 		len -= 2;
 
-		if (ntohs(*(__be16 *)pkt) != (ushort)(tftp_cur_block + 1)) {
+		if (ntohs(*(__be16 *)pkt) != (ushort)(sess->cur_block + 1)) {
 			debug("Received unexpected block: %d, expected: %d\n",
 			      ntohs(*(__be16 *)pkt),
-			      (ushort)(tftp_cur_block + 1));
+			      (ushort)(sess->cur_block + 1));
 			/*
 			 * If one packet is dropped most likely
 			 * all other buffers in the window
 			 * that will arrive will cause a sending NACK.
 			 * This just overwellms the server, let's just send one.
 			 */
-			if (tftp_last_nack != tftp_cur_block) {
-				tftp_send();
-				tftp_last_nack = tftp_cur_block;
-				tftp_next_ack = (ushort)(tftp_cur_block +
-							 tftp_windowsize);
+			if (sess->last_nack != sess->cur_block) {
+				tftp_send(sess);
+				sess->last_nack = sess->cur_block;
+				sess->next_ack = (ushort)(sess->cur_block +
+							  sess->windowsize);
 			}
 			break;
 		}
 
-		tftp_cur_block++;
-		tftp_cur_block %= TFTP_SEQUENCE_SIZE;
+		sess->cur_block++;
+		sess->cur_block %= TFTP_SEQUENCE_SIZE;
 
-		if (tftp_state == STATE_SEND_RRQ) {
+		if (sess->state == STATE_SEND_RRQ) {
 			debug("Server did not acknowledge any options!\n");
-			tftp_next_ack = tftp_windowsize;
+			sess->next_ack = sess->windowsize;
 		}
 
-		if (tftp_state == STATE_SEND_RRQ || tftp_state == STATE_OACK ||
-		    tftp_state == STATE_RECV_WRQ) {
+		if (sess->state == STATE_SEND_RRQ ||
+		    sess->state == STATE_OACK ||
+		    sess->state == STATE_RECV_WRQ) {
 			/* first block received */
-			tftp_state = STATE_DATA;
-			tftp_remote_port = src;
-			new_transfer();
+			sess->state = STATE_DATA;
+			sess->remote_port = src;
+			new_transfer(sess);
 
-			if (tftp_cur_block != 1) {	/* Assertion */
+			if (sess->cur_block != 1) {	/* Assertion */
 				puts("\nTFTP error: ");
 				printf("First block is not block 1 (%ld)\n",
-				       tftp_cur_block);
+				       sess->cur_block);
 				puts("Starting again\n\n");
 				net_start_again();
 				break;
 			}
 		}
 
-		if (tftp_cur_block == tftp_prev_block) {
+		if (sess->cur_block == sess->prev_block) {
 			/* Same block again; ignore it. */
 			break;
 		}
 
-		update_block_number();
-		tftp_prev_block = tftp_cur_block;
+		update_block_number(sess);
+		sess->prev_block = sess->cur_block;
 		timeout_count_max = tftp_timeout_count_max;
-		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
+		sess->time_active = get_timer(0);
+		tftp_set_timeout();
 
-		if (store_block(tftp_cur_block, pkt + 2, len)) {
+		if (store_block(sess, sess->cur_block, pkt + 2, len)) {
 			eth_halt();
 			net_set_state(NETLOOP_FAIL);
 			break;
 		}
 
-		if (len < tftp_block_size) {
-			tftp_send();
-			tftp_complete();
+		if (len < sess->block_size) {
+			tftp_send(sess);
+			tftp_complete(sess);
 			break;
 		}
 
@@ -679,9 +836,9 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		 *	Acknowledge the block just received, which will prompt
 		 *	the remote for the next one.
 		 */
-		if (tftp_cur_block == tftp_next_ack) {
-			tftp_send();
-			tftp_next_ack += tftp_windowsize;
+		if (sess->cur_block == sess->next_ack) {
+			tftp_send(sess);
+			sess->next_ack += sess->windowsize;
 		}
 		break;
 
@@ -713,18 +870,31 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 static void tftp_timeout_handler(void)
 {
-	if (++timeout_count > timeout_count_max) {
-		restart("Retry count exceeded");
-	} else {
+	int i;
+
+	tftp_send_queued();
+
+	for (i = 0; i < tftp_num_sessions; i++) {
+		struct tftp_session *sess = &tftp_sessions[i];
+
+		if (sess->state == STATE_DONE || sess->state == STATE_QUEUED ||
+		    get_timer(sess->time_active) < timeout_ms)
+			continue;
+
+		if (++sess->timeout_count > timeout_count_max) {
+			restart("Retry count exceeded");
+			return;
+		}
 		puts("T ");
-		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
-		if (tftp_state != STATE_RECV_WRQ)
-			tftp_send();
+		sess->time_active = get_timer(0);
+		if (sess->state != STATE_RECV_WRQ)
+			tftp_send(sess);
 	}
+	tftp_set_timeout();
 }
 
-/* Initialize tftp_load_addr and tftp_load_size from image_load_addr and lmb */
-static int tftp_init_load_addr(void)
+/* Initialize the load size of @sess from lmb and set up where it is stored */
+static int tftp_init_load_addr(struct tftp_session *sess)
 {
 #ifdef CONFIG_LMB
 	struct lmb lmb;
@@ -732,18 +902,41 @@ static int tftp_init_load_addr(void)
 
 	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
 
-	max_size = lmb_get_free_size(&lmb, image_load_addr);
+	max_size = lmb_get_free_size(&lmb, sess->load_addr);
 	if (!max_size)
 		return -1;
 
-	tftp_load_size = max_size;
+	sess->load_size = max_size;
 #endif
-	tftp_load_addr = image_load_addr;
+	tftp_init_store(sess);
 	return 0;
 }
 
+int tftp_add_file(ulong addr, const char *name)
+{
+	struct tftp_session *sess;
+
+	if (1 + tftp_extra_files >= CONFIG_TFTP_MAX_FILES)
+		return -ENOSPC;
+
+	sess = &tftp_sessions[1 + tftp_extra_files++];
+	sess->load_addr = addr;
+	strlcpy(sess->filename, name, MAX_LEN);
+
+	return 0;
+}
+
+void tftp_clear_files(void)
+{
+	tftp_extra_files = 0;
+}
+
 void tftp_start(enum proto_t protocol)
 {
+	struct tftp_session *sess = &tftp_sessions[0];
+	int remote_port;
+	int our_port;
+	int i;
 #if CONFIG_NET_TFTP_VARS
 	char *ep;             /* Environment pointer */
 
@@ -784,19 +977,19 @@ void tftp_start(enum proto_t protocol)
 	debug("TFTP blocksize = %i, TFTP windowsize = %d timeout = %ld ms\n",
 	      tftp_block_size_option, tftp_window_size_option, timeout_ms);
 
-	tftp_remote_ip = net_server_ip;
-	if (!net_parse_bootfile(&tftp_remote_ip, tftp_filename, MAX_LEN)) {
+	sess->remote_ip = net_server_ip;
+	if (!net_parse_bootfile(&sess->remote_ip, sess->filename, MAX_LEN)) {
 		sprintf(default_filename, "%02X%02X%02X%02X.img",
 			net_ip.s_addr & 0xFF,
 			(net_ip.s_addr >>  8) & 0xFF,
 			(net_ip.s_addr >> 16) & 0xFF,
 			(net_ip.s_addr >> 24) & 0xFF);
 
-		strncpy(tftp_filename, default_filename, DEFAULT_NAME_LEN);
-		tftp_filename[DEFAULT_NAME_LEN - 1] = 0;
+		strncpy(sess->filename, default_filename, DEFAULT_NAME_LEN);
+		sess->filename[DEFAULT_NAME_LEN - 1] = 0;
 
 		printf("*** Warning: no boot file name; using '%s'\n",
-		       tftp_filename);
+		       sess->filename);
 	}
 
 	printf("Using %s device\n", eth_get_name());
@@ -806,7 +999,7 @@ void tftp_start(enum proto_t protocol)
 #else
 	       "from",
 #endif
-	       &tftp_remote_ip, &net_ip);
+	       &sess->remote_ip, &net_ip);
 
 	/* Check if we need to send across this subnet */
 	if (net_gateway.s_addr && net_netmask.s_addr) {
@@ -814,13 +1007,13 @@ void tftp_start(enum proto_t protocol)
 		struct in_addr remote_net;
 
 		our_net.s_addr = net_ip.s_addr & net_netmask.s_addr;
-		remote_net.s_addr = tftp_remote_ip.s_addr & net_netmask.s_addr;
+		remote_net.s_addr = sess->remote_ip.s_addr & net_netmask.s_addr;
 		if (our_net.s_addr != remote_net.s_addr)
 			printf("; sending through gateway %pI4", &net_gateway);
 	}
 	putc('\n');
 
-	printf("Filename '%s'.", tftp_filename);
+	printf("Filename '%s'.", sess->filename);
 
 	if (net_boot_file_expected_size_in_blocks) {
 		printf(" Size is 0x%x Bytes = ",
@@ -829,6 +1022,7 @@ void tftp_start(enum proto_t protocol)
 	}
 
 	putc('\n');
+	tftp_num_sessions = 1;
 #ifdef CONFIG_CMD_TFTPPUT
 	tftp_put_active = (protocol == TFTPPUT);
 	if (tftp_put_active) {
@@ -836,65 +1030,89 @@ void tftp_start(enum proto_t protocol)
 		printf("Save size:    0x%lx\n", image_save_size);
 		net_boot_file_size = image_save_size;
 		puts("Saving: *\b");
-		tftp_state = STATE_SEND_WRQ;
-		new_transfer();
+		sess->state = STATE_SEND_WRQ;
+		new_transfer(sess);
 	} else
 #endif
 	{
-		if (tftp_init_load_addr()) {
-			eth_halt();
-			net_set_state(NETLOOP_FAIL);
-			puts("\nTFTP error: ");
-			puts("trying to overwrite reserved memory...\n");
-			return;
+		/* Any files added by tftp_add_file() come along */
+		tftp_num_sessions += tftp_extra_files;
+		sess->load_addr = image_load_addr;
+		for (i = 0; i < tftp_num_sessions; i++) {
+			sess = &tftp_sessions[i];
+			if (i)
+				printf("Filename '%s'.\n", sess->filename);
+			if (tftp_init_load_addr(sess)) {
+				eth_halt();
+				net_set_state(NETLOOP_FAIL);
+				puts("\nTFTP error: trying to overwrite ");
+				puts("reserved memory...\n");
+				return;
+			}
+			printf("Load address: 0x%lx\n", sess->load_addr);
+			sess->state = STATE_QUEUED;
 		}
-		printf("Load address: 0x%lx\n", tftp_load_addr);
 		puts("Loading: *\b");
-		tftp_state = STATE_SEND_RRQ;
 	}
 
 	time_start = get_timer(0);
 	timeout_count_max = tftp_timeout_count_max;
 
-	net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 	net_set_udp_handler(tftp_handler);
 #ifdef CONFIG_CMD_TFTPPUT
 	net_set_icmp_handler(icmp_handler);
 #endif
-	tftp_remote_port = WELL_KNOWN_PORT;
-	timeout_count = 0;
+	remote_port = WELL_KNOWN_PORT;
 	/* Use a pseudo-random port unless a specific port is set */
-	tftp_our_port = 1024 + (get_timer(0) % 3072);
+	our_port = 1024 + (get_timer(0) % 3072);
 
 #ifdef CONFIG_TFTP_PORT
 	ep = env_get("tftpdstp");
 	if (ep != NULL)
-		tftp_remote_port = simple_strtol(ep, NULL, 10);
+		remote_port = simple_strtol(ep, NULL, 10);
 	ep = env_get("tftpsrcp");
 	if (ep != NULL)
-		tftp_our_port = simple_strtol(ep, NULL, 10);
+		our_port = simple_strtol(ep, NULL, 10);
 #endif
-	tftp_cur_block = 0;
-	tftp_windowsize = 1;
-	tftp_last_nack = 0;
-	/* zero out server ether in case the server ip has changed */
-	memset(net_server_ethaddr, 0, 6);
-	/* Revert tftp_block_size to dflt */
-	tftp_block_size = TFTP_BLOCK_SIZE;
+	for (i = 0; i < tftp_num_sessions; i++) {
+		sess = &tftp_sessions[i];
+		sess->remote_ip = tftp_sessions[0].remote_ip;
+		sess->remote_port = remote_port;
+		/* Each file is fetched from the next port at our end */
+		sess->our_port = our_port + i;
+		sess->timeout_count = 0;
+		sess->time_active = time_start;
+		sess->cur_block = 0;
+		sess->windowsize = 1;
+		sess->last_nack = 0;
+		sess->file_size = 0;
+		/* Revert the block size to dflt */
+		sess->block_size = TFTP_BLOCK_SIZE;
 #ifdef CONFIG_TFTP_TSIZE
-	tftp_tsize = 0;
-	tftp_tsize_num_hash = 0;
+		sess->tsize = 0;
+		sess->tsize_num_hash = 0;
 #endif
+	}
+	/* zero out server ether in case the server ip has changed */
+	memset(net_server_ethaddr, 0, 6);
 
-	tftp_send();
+	tftp_set_timeout();
+	if (tftp_put_active)
+		tftp_send(&tftp_sessions[0]);
+	else
+		tftp_send_queued();
 }
 
 #ifdef CONFIG_CMD_TFTPSRV
 void tftp_start_server(void)
 {
-	tftp_filename[0] = 0;
+	struct tftp_session *sess = &tftp_sessions[0];
 
-	if (tftp_init_load_addr()) {
+	sess->filename[0] = 0;
+	sess->load_addr = image_load_addr;
+	tftp_num_sessions = 1;
+
+	if (tftp_init_load_addr(sess)) {
 		eth_halt();
 		net_set_state(NETLOOP_FAIL);
 		puts("\nTFTP error: trying to overwrite reserved memory...\n");
@@ -902,30 +1120,31 @@ void tftp_start_server(void)
 	}
 	printf("Using %s device\n", eth_get_name());
 	printf("Listening for TFTP transfer on %pI4\n", &net_ip);
-	printf("Load address: 0x%lx\n", tftp_load_addr);
+	printf("Load address: 0x%lx\n", sess->load_addr);
 
 	puts("Loading: *\b");
 
 	timeout_count_max = tftp_timeout_count_max;
-	timeout_count = 0;
+	sess->timeout_count = 0;
+	sess->time_active = get_timer(0);
+	sess->file_size = 0;
 	timeout_ms = TIMEOUT;
-	net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 
-	/* Revert tftp_block_size to dflt */
-	tftp_block_size = TFTP_BLOCK_SIZE;
-	tftp_cur_block = 0;
-	tftp_our_port = WELL_KNOWN_PORT;
+	/* Revert the block size to dflt */
+	sess->block_size = TFTP_BLOCK_SIZE;
+	sess->cur_block = 0;
+	sess->our_port = WELL_KNOWN_PORT;
 
 #ifdef CONFIG_TFTP_TSIZE
-	tftp_tsize = 0;
-	tftp_tsize_num_hash = 0;
+	sess->tsize = 0;
+	sess->tsize_num_hash = 0;
 #endif
 
-	tftp_state = STATE_RECV_WRQ;
+	sess->state = STATE_RECV_WRQ;
 	net_set_udp_handler(tftp_handler);
+	tftp_set_timeout();
 
 	/* zero out server ether in case the server ip has changed */
 	memset(net_server_ethaddr, 0, 6);
 }
 #endif /* CONFIG_CMD_TFTPSRV */
-
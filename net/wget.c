@@ -0,0 +1,326 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * HTTP client for downloading files
+ *
+ * The file is fetched with a single HTTP/1.0 GET over TCP, so that the server
+ * does not send the body in chunks, which would end up in the file. Once the
+ * response header has been read, each segment of the body is copied straight
+ * to its place at the load address, so data received out of order does not
+ * have to wait for the gap before it to be filled.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <env.h>
+#include <image.h>
+#include <lmb.h>
+#include <log.h>
+#include <mapmem.h>
+#include <net.h>
+#include <asm/global_data.h>
+#include <net/tcp.h>
+#include <net/wget.h>
+#include <linux/sizes.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Largest response header accepted */
+#define WGET_HDR_SIZE	2048
+/* Number of "loading" hashes per line */
+#define HASHES_PER_LINE	65
+/* Bytes per hash when the size of the file is not known */
+#define WGET_HASH_SIZE	SZ_64K
+
+static char wget_filename[1024];
+static struct in_addr wget_server_ip;
+static int wget_server_port;
+static ulong wget_load_addr;
+static ulong wget_load_size;
+static ulong wget_time_start;
+
+/* Response header, until its end is found */
+static char wget_hdr[WGET_HDR_SIZE + 1];
+static uint wget_hdr_len;
+static bool wget_hdr_done;
+/* Offset of the body in the stream received */
+static u32 wget_body_start;
+/* Size of the body from Content-Length, or 0 if not given */
+static ulong wget_content_len;
+static bool wget_done;
+static int wget_num_hash;
+
+static void wget_fail(const char *msg)
+{
+	printf("\nHTTP error: %s\n", msg);
+	wget_done = true;
+	tcp_abort();
+	net_set_state(NETLOOP_FAIL);
+}
+
+static ulong wget_body_len(void)
+{
+	return wget_hdr_done ? tcp_rx_len() - wget_body_start : 0;
+}
+
+static void wget_show_progress(void)
+{
+	ulong len = wget_body_len();
+	int hashes;
+
+	if (wget_content_len)
+		hashes = min(len, wget_content_len) /
+			DIV_ROUND_UP(wget_content_len, 50);
+	else
+		hashes = len / WGET_HASH_SIZE;
+	while (wget_num_hash < hashes) {
+		putc('#');
+		if (!(++wget_num_hash % HASHES_PER_LINE) && !wget_content_len)
+			puts("\n\t ");
+	}
+}
+
+static void wget_complete(ulong len)
+{
+	ulong time;
+
+	wget_done = true;
+	wget_show_progress();
+	if (wget_content_len) {
+		puts("  ");
+		print_size(wget_content_len, "");
+	}
+	time = get_timer(wget_time_start);
+	if (time > 0) {
+		puts("\n\t ");	/* Line up with "Loading: " */
+		print_size(len / time * 1000, "/s");
+	}
+	puts("\ndone\n");
+
+	net_boot_file_size = len;
+	tcp_close();
+	net_set_state(NETLOOP_SUCCESS);
+}
+
+/* Check the status line and find the size of the body */
+static int wget_parse_header(void)
+{
+	char *line, *next, *end;
+
+	line = wget_hdr;
+	end = strstr(line, "\r\n");
+	*end = '\0';
+	if (strncmp(line, "HTTP/1.", 7) || strlen(line) < 12 ||
+	    strncmp(line + 8, " 200", 4)) {
+		wget_fail(line);
+		return -EPROTO;
+	}
+
+	for (line = end + 2; *line; line = next) {
+		end = strstr(line, "\r\n");
+		*end = '\0';
+		next = end + 2;
+		if (!strncasecmp(line, "Content-Length:", 15)) {
+			wget_content_len = simple_strtoul(skip_spaces(line + 15),
+							  NULL, 10);
+		} else if (!strncasecmp(line, "Transfer-Encoding:", 18) &&
+			   !strstr(line + 18, "identity")) {
+			wget_fail("transfer encoding not supported");
+			return -EPROTO;
+		}
+	}
+
+	if (wget_load_size && wget_content_len > wget_load_size) {
+		wget_fail("trying to overwrite reserved memory...");
+		return -E2BIG;
+	}
+	debug("HTTP body at %x, %lx bytes\n", wget_body_start,
+	      wget_content_len);
+
+	return 0;
+}
+
+static void wget_store(ulong offset, const uchar *data, uint len)
+{
+	void *ptr;
+
+	if (wget_load_size && (offset > wget_load_size ||
+			       len > wget_load_size - offset)) {
+		wget_fail("trying to overwrite reserved memory...");
+		return;
+	}
+	if (wget_content_len && offset + len > wget_content_len)
+		len = offset < wget_content_len ? wget_content_len - offset : 0;
+
+	ptr = map_sysmem(wget_load_addr + offset, len);
+	memcpy(ptr, data, len);
+	unmap_sysmem(ptr);
+}
+
+static int wget_rx(u32 offset, const uchar *data, uint len)
+{
+	char *end;
+	uint n;
+
+	if (wget_done)
+		return 0;
+
+	if (!wget_hdr_done) {
+		/* The header must be read in order to find the body */
+		if (offset != wget_hdr_len)
+			return -EAGAIN;
+		n = min(len, WGET_HDR_SIZE - wget_hdr_len);
+		memcpy(wget_hdr + wget_hdr_len, data, n);
+		wget_hdr_len += n;
+		wget_hdr[wget_hdr_len] = '\0';
+
+		end = strstr(wget_hdr, "\r\n\r\n");
+		if (!end) {
+			if (wget_hdr_len == WGET_HDR_SIZE)
+				wget_fail("response header too long");
+			return 0;
+		}
+		wget_body_start = end + 4 - wget_hdr;
+		end[2] = '\0';
+		wget_hdr_done = true;
+		if (wget_parse_header())
+			return 0;
+	}
+
+	/* Skip any part of the header in this segment */
+	if (offset < wget_body_start) {
+		n = wget_body_start - offset;
+		if (n >= len)
+			return 0;
+		data += n;
+		len -= n;
+		offset = wget_body_start;
+	}
+
+	wget_store(offset - wget_body_start, data, len);
+
+	return 0;
+}
+
+static void wget_send_request(void)
+{
+	char req[sizeof(wget_filename) + 128];
+	int len;
+
+	len = snprintf(req, sizeof(req),
+		       "GET %s HTTP/1.0\r\n"
+		       "Host: %pI4\r\n"
+		       "User-Agent: U-Boot\r\n"
+		       "Connection: close\r\n\r\n",
+		       wget_filename, &wget_server_ip);
+	if (tcp_send(req, len))
+		wget_fail("cannot send request");
+}
+
+static void wget_event(enum tcp_event event)
+{
+	if (wget_done)
+		return;
+
+	switch (event) {
+	case TCP_EV_CONNECTED:
+		wget_send_request();
+		break;
+	case TCP_EV_DATA:
+		wget_show_progress();
+		if (wget_hdr_done && wget_content_len &&
+		    wget_body_len() >= wget_content_len)
+			wget_complete(wget_content_len);
+		break;
+	case TCP_EV_CLOSED:
+		/* Without a Content-Length the body ends with the connection */
+		if (wget_hdr_done && !wget_content_len)
+			wget_complete(wget_body_len());
+		else
+			wget_fail("connection closed");
+		break;
+	case TCP_EV_RESET:
+		wget_fail("connection reset");
+		break;
+	case TCP_EV_TIMEOUT:
+		wget_fail("timeout");
+		break;
+	}
+}
+
+static const struct tcp_ops wget_tcp_ops = {
+	.rx	= wget_rx,
+	.event	= wget_event,
+};
+
+/* Initialize wget_load_addr and wget_load_size from image_load_addr and lmb */
+static int wget_init_load_addr(void)
+{
+#ifdef CONFIG_LMB
+	struct lmb lmb;
+	phys_size_t max_size;
+
+	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
+
+	max_size = lmb_get_free_size(&lmb, image_load_addr);
+	if (!max_size)
+		return -1;
+
+	wget_load_size = max_size;
+#endif
+	wget_load_addr = image_load_addr;
+	return 0;
+}
+
+void wget_start(void)
+{
+	u32 rx_limit;
+	char *ep;
+
+	wget_server_ip = net_server_ip;
+	if (!net_parse_bootfile(&wget_server_ip, wget_filename + 1,
+				sizeof(wget_filename) - 1)) {
+		puts("*** ERROR: no file name given\n");
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+	/* Paths are always absolute */
+	wget_filename[0] = '/';
+	if (wget_filename[1] == '/')
+		memmove(wget_filename, wget_filename + 1,
+			strlen(wget_filename));
+
+	wget_server_port = WGET_PORT;
+	ep = env_get("httpdstp");
+	if (ep)
+		wget_server_port = simple_strtol(ep, NULL, 10);
+
+	printf("Using %s device\n", eth_get_name());
+	printf("HTTP from server %pI4; our IP address is %pI4\n",
+	       &wget_server_ip, &net_ip);
+	printf("Filename '%s'.\n", wget_filename);
+
+	wget_load_size = 0;
+	if (wget_init_load_addr()) {
+		eth_halt();
+		net_set_state(NETLOOP_FAIL);
+		puts("\nHTTP error: ");
+		puts("trying to overwrite reserved memory...\n");
+		return;
+	}
+	printf("Load address: 0x%lx\n", wget_load_addr);
+	puts("Loading: *\b");
+
+	wget_hdr_len = 0;
+	wget_hdr_done = false;
+	wget_body_start = 0;
+	wget_content_len = 0;
+	wget_done = false;
+	wget_num_hash = 0;
+	wget_time_start = get_timer(0);
+
+	/* The receive window is bounded by the space at the load address */
+	rx_limit = U32_MAX;
+	if (wget_load_size && wget_load_size < U32_MAX - WGET_HDR_SIZE)
+		rx_limit = wget_load_size + WGET_HDR_SIZE;
+	tcp_connect(wget_server_ip, wget_server_port, &wget_tcp_ops, rx_limit);
+}
@@ -0,0 +1,363 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test for wget command
+ *
+ * A small HTTP server is run in the tx handler of the sandbox Ethernet
+ * driver, answering each packet sent by U-Boot with the segments which then
+ * fit in the receive queue.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <dm.h>
+#include <env.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <net.h>
+#include <asm/eth.h>
+#include <asm/unaligned.h>
+#include <dm/test.h>
+#include <net/tcp.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define WGET_TEST_ADDR		0x1000000
+#define WGET_TEST_SIZE		100000
+#define WGET_TEST_PORT		80
+#define WGET_TEST_ISS		0x7ffffff0
+
+/**
+ * struct wget_test_srv - state of the fake HTTP server
+ *
+ * @stream:	response to send, header then body
+ * @len:	size of @stream
+ * @client_port: port of U-Boot
+ * @client_wscale: window scale of U-Boot
+ * @snd_una:	oldest sequence number not acknowledged by U-Boot
+ * @snd_nxt:	next sequence number to send
+ * @rcv_nxt:	next sequence number expected from U-Boot
+ * @got_request: the GET request was received
+ * @close:	close the connection after the body instead of giving its size
+ * @fin_sent:	our FIN was sent
+ * @drop_seg:	sequence number of a segment to drop the first time, or 0
+ * @rtx_seq:	sequence number of the last segment sent again
+ * @rtx_count:	number of segments sent again
+ */
+struct wget_test_srv {
+	uchar *stream;
+	uint len;
+	int client_port;
+	uint client_wscale;
+	u32 snd_una;
+	u32 snd_nxt;
+	u32 rcv_nxt;
+	bool got_request;
+	bool close;
+	bool fin_sent;
+	u32 drop_seg;
+	u32 rtx_seq;
+	int rtx_count;
+};
+
+static struct wget_test_srv srv;
+
+static uint sb_tcp_checksum(struct ip_tcp_hdr *ip, uint len)
+{
+	struct {
+		struct in_addr src;
+		struct in_addr dst;
+		u8 rsvd;
+		u8 p;
+		u16 len;
+	} __attribute__((packed)) ph;
+
+	net_copy_ip(&ph.src, &ip->ip_src);
+	net_copy_ip(&ph.dst, &ip->ip_dst);
+	ph.rsvd = 0;
+	ph.p = IPPROTO_TCP;
+	ph.len = htons(len);
+
+	return add_ip_checksums(sizeof(ph),
+				compute_ip_checksum(&ph, sizeof(ph)),
+				compute_ip_checksum((uchar *)ip + IP_HDR_SIZE,
+						    len));
+}
+
+static int sb_tcp_send(struct udevice *dev, u8 flags, u32 seq,
+		       const uchar *data, uint len)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+	struct ethernet_hdr *eth;
+	struct ip_tcp_hdr *ip;
+	uint hlen = TCP_HDR_SIZE;
+	uchar *opt;
+
+	if (priv->recv_packets >= PKTBUFSRX)
+		return -EOVERFLOW;
+
+	eth = (void *)priv->recv_packet_buffer[priv->recv_packets];
+	memcpy(eth->et_dest, net_ethaddr, ARP_HLEN);
+	memcpy(eth->et_src, priv->fake_host_hwaddr, ARP_HLEN);
+	eth->et_protlen = htons(PROT_IP);
+
+	ip = (void *)eth + ETHER_HDR_SIZE;
+	opt = (uchar *)ip + IP_TCP_HDR_SIZE;
+	if (flags & TCP_SYN) {
+		opt[0] = TCP_O_MSS;
+		opt[1] = 4;
+		put_unaligned_be16(TCP_MSS, opt + 2);
+		opt[4] = TCP_O_NOP;
+		opt[5] = TCP_O_WS;
+		opt[6] = 3;
+		opt[7] = 0;
+		hlen += TCP_SYN_OPT_SIZE;
+	}
+	memcpy((uchar *)ip + IP_HDR_SIZE + hlen, data, len);
+
+	ip->ip_hl_v = 0x45;
+	ip->ip_tos = 0;
+	ip->ip_len = htons(IP_HDR_SIZE + hlen + len);
+	ip->ip_id = 0;
+	ip->ip_off = htons(IP_FLAGS_DFRAG);
+	ip->ip_ttl = 64;
+	ip->ip_p = IPPROTO_TCP;
+	ip->ip_sum = 0;
+	net_write_ip(&ip->ip_src, priv->fake_host_ipaddr);
+	net_write_ip(&ip->ip_dst, net_ip);
+	ip->ip_sum = compute_ip_checksum(ip, IP_HDR_SIZE);
+
+	ip->tcp_src = htons(WGET_TEST_PORT);
+	ip->tcp_dst = htons(srv.client_port);
+	ip->tcp_seq = htonl(seq);
+	ip->tcp_ack = htonl(srv.rcv_nxt);
+	ip->tcp_hlen = (hlen / 4) << 4;
+	ip->tcp_flags = flags | TCP_ACK;
+	ip->tcp_win = htons(0xffff);
+	ip->tcp_xsum = 0;
+	ip->tcp_ugr = 0;
+	if (len & 1)
+		((uchar *)ip)[IP_HDR_SIZE + hlen + len] = 0;
+	ip->tcp_xsum = sb_tcp_checksum(ip, hlen + len);
+
+	priv->recv_packet_length[priv->recv_packets] =
+		ETHER_HDR_SIZE + IP_HDR_SIZE + hlen + len;
+	++priv->recv_packets;
+
+	return 0;
+}
+
+/* Send the segment of the stream starting at @seq */
+static int sb_wget_send_seg(struct udevice *dev, u32 seq, u32 end, u8 flags)
+{
+	uint off = seq - WGET_TEST_ISS - 1;
+	uint len = min_t(uint, TCP_MSS, end - seq);
+
+	return sb_tcp_send(dev, flags, seq, srv.stream + off, len);
+}
+
+static int sb_wget_handler(struct udevice *dev, void *packet,
+			   unsigned int len)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+	struct ethernet_hdr *eth = packet;
+	/* Used by all of the ut_assert macros */
+	struct unit_test_state *uts = priv->priv;
+	struct ip_tcp_hdr *ip;
+	u32 ack, wnd, end, seq;
+	uint hlen, plen;
+	const char *req;
+	u8 flags;
+
+	if (!sandbox_eth_arp_req_to_reply(dev, packet, len))
+		return 0;
+	if (ntohs(eth->et_protlen) != PROT_IP)
+		return 0;
+	ip = packet + ETHER_HDR_SIZE;
+	if (ip->ip_p != IPPROTO_TCP)
+		return 0;
+
+	hlen = (ip->tcp_hlen >> 4) * 4;
+	plen = ntohs(ip->ip_len) - IP_HDR_SIZE - hlen;
+	ut_asserteq(WGET_TEST_PORT, ntohs(ip->tcp_dst));
+	ut_assert(ip_checksum_ok(ip, IP_HDR_SIZE));
+	ut_asserteq(0, sb_tcp_checksum(ip, hlen + plen));
+	flags = ip->tcp_flags;
+	if (flags & TCP_RST)
+		return 0;
+
+	if (flags & TCP_SYN) {
+		const uchar *opt = (uchar *)ip + IP_TCP_HDR_SIZE;
+
+		ut_asserteq(TCP_HDR_SIZE + TCP_SYN_OPT_SIZE, hlen);
+		ut_asserteq(TCP_O_WS, opt[5]);
+		srv.client_port = ntohs(ip->tcp_src);
+		srv.client_wscale = opt[7];
+		srv.rcv_nxt = ntohl(ip->tcp_seq) + 1;
+		srv.snd_una = WGET_TEST_ISS;
+		srv.snd_nxt = WGET_TEST_ISS + 1;
+		srv.got_request = false;
+		srv.fin_sent = false;
+		return sb_tcp_send(dev, TCP_SYN, WGET_TEST_ISS, NULL, 0);
+	}
+
+	ut_assert(flags & TCP_ACK);
+	if (plen && ntohl(ip->tcp_seq) == srv.rcv_nxt) {
+		req = (char *)ip + IP_HDR_SIZE + hlen;
+		ut_asserteq_mem("GET /test.bin HTTP/1.0\r\n", req, 24);
+		srv.rcv_nxt += plen;
+		srv.got_request = true;
+	}
+	if (!srv.got_request)
+		return 0;
+
+	/* Send the oldest segment again on the first duplicate ACK */
+	ack = ntohl(ip->tcp_ack);
+	end = WGET_TEST_ISS + 1 + srv.len;
+	if (ack == srv.snd_una && (s32)(end - ack) > 0 &&
+	    srv.snd_una != srv.snd_nxt && !plen) {
+		if (ack == srv.rtx_seq)
+			return 0;
+		srv.rtx_seq = ack;
+		srv.rtx_count++;
+		return sb_wget_send_seg(dev, ack, end, TCP_PUSH);
+	}
+	if ((s32)(ack - srv.snd_una) > 0)
+		srv.snd_una = ack;
+
+	wnd = ntohs(ip->tcp_win) << srv.client_wscale;
+	while (priv->recv_packets < PKTBUFSRX && (s32)(end - srv.snd_nxt) > 0 &&
+	       srv.snd_nxt - srv.snd_una < wnd) {
+		seq = srv.snd_nxt;
+		srv.snd_nxt += min_t(uint, TCP_MSS, end - seq);
+		if (seq == srv.drop_seg) {
+			srv.drop_seg = 0;
+			continue;
+		}
+		/* Push the last segment which fits, so that it is ACKed */
+		sb_wget_send_seg(dev, seq, end,
+				 priv->recv_packets == PKTBUFSRX - 1 ?
+				 TCP_PUSH : 0);
+	}
+	if (srv.close && srv.snd_nxt == end && !srv.fin_sent &&
+	    priv->recv_packets < PKTBUFSRX) {
+		srv.fin_sent = true;
+		srv.snd_nxt++;
+		return sb_tcp_send(dev, TCP_FIN, end, NULL, 0);
+	}
+
+	return 0;
+}
+
+/* Set up the server to send @hdr followed by the test data */
+static int wget_test_setup(struct unit_test_state *uts, const char *hdr,
+			   bool close, uint drop_seg)
+{
+	uchar *body;
+	uint hlen;
+	int i;
+
+	hlen = strlen(hdr);
+	memset(&srv, '\0', sizeof(srv));
+	srv.close = close;
+	srv.len = hlen + WGET_TEST_SIZE;
+	srv.stream = malloc(srv.len);
+	ut_assertnonnull(srv.stream);
+	memcpy(srv.stream, hdr, hlen);
+	body = srv.stream + hlen;
+	for (i = 0; i < WGET_TEST_SIZE; i++)
+		body[i] = i * 7 + (i >> 8);
+	if (drop_seg)
+		srv.drop_seg = WGET_TEST_ISS + 1 + drop_seg * TCP_MSS;
+
+	sandbox_eth_set_tx_handler(0, sb_wget_handler);
+	/* Used by all of the ut_assert macros in the tx_handler */
+	sandbox_eth_set_priv(0, uts);
+	env_set("ethact", "eth@10002000");
+
+	memset(map_sysmem(WGET_TEST_ADDR, WGET_TEST_SIZE), '\0',
+	       WGET_TEST_SIZE);
+
+	return 0;
+}
+
+static void wget_test_cleanup(void)
+{
+	sandbox_eth_set_tx_handler(0, NULL);
+	free(srv.stream);
+}
+
+static int wget_test_run(struct unit_test_state *uts, bool close,
+			 uint drop_seg)
+{
+	const char *hdr;
+
+	if (close)
+		hdr = "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n";
+	else
+		hdr = "HTTP/1.1 200 OK\r\nContent-Length: 100000\r\n\r\n";
+	ut_assertok(wget_test_setup(uts, hdr, close, drop_seg));
+
+	ut_assertok(run_command("wget 1000000 1.1.2.2:/test.bin", 0));
+	ut_asserteq(WGET_TEST_SIZE, env_get_hex("filesize", 0));
+	ut_asserteq_mem(srv.stream + strlen(hdr),
+			map_sysmem(WGET_TEST_ADDR, WGET_TEST_SIZE),
+			WGET_TEST_SIZE);
+
+	wget_test_cleanup();
+
+	return 0;
+}
+
+/* Test downloading a file with a Content-Length */
+static int dm_test_cmd_wget(struct unit_test_state *uts)
+{
+	ut_assertok(wget_test_run(uts, false, 0));
+	ut_asserteq(0, srv.rtx_count);
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_wget, UT_TESTF_SCAN_FDT);
+
+/* Test downloading a file whose end is given by closing the connection */
+static int dm_test_cmd_wget_close(struct unit_test_state *uts)
+{
+	ut_assertok(wget_test_run(uts, true, 0));
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_wget_close, UT_TESTF_SCAN_FDT);
+
+/*
+ * Test recovering from a lost segment: the segments after it are kept, and
+ * once it is sent again the ACK moves past all of them
+ */
+static int dm_test_cmd_wget_lost(struct unit_test_state *uts)
+{
+	ut_assertok(wget_test_run(uts, false, 10));
+	ut_asserteq(1, srv.rtx_count);
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_wget_lost, UT_TESTF_SCAN_FDT);
+
+/*
+ * Test that a chunked response is rejected rather than having the chunk
+ * sizes written into the file
+ */
+static int dm_test_cmd_wget_chunked(struct unit_test_state *uts)
+{
+	u8 zero[TCP_MSS];
+
+	ut_assertok(wget_test_setup(uts, "HTTP/1.1 200 OK\r\n"
+				    "Transfer-Encoding: chunked\r\n\r\n",
+				    true, 0));
+	ut_asserteq(CMD_RET_FAILURE,
+		    run_command("wget 1000000 1.1.2.2:/test.bin", 0));
+	memset(zero, '\0', sizeof(zero));
+	ut_asserteq_mem(zero, map_sysmem(WGET_TEST_ADDR, sizeof(zero)),
+			sizeof(zero));
+	wget_test_cleanup();
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_wget_chunked, UT_TESTF_SCAN_FDT);
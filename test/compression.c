@@ -6,6 +6,7 @@
 #include <common.h>
 #include <bootm.h>
 #include <command.h>
+#include <decomp_frames.h>
 #include <gzip.h>
 #include <image.h>
 #include <log.h>
@@ -13,6 +14,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 
 #include <u-boot/zlib.h>
 #include <bzlib.h>
@@ -157,6 +159,50 @@ static int uncompress_using_gzip(struct unit_test_state *uts,
 	return ret;
 }
 
+#if CONFIG_IS_ENABLED(DECOMP_FRAMES)
+/*
+ * Compress in two gzip members which give their size in their header, as
+ * 'mkimage -Z' does, so that gunzip() inflates them in parallel
+ */
+static int compress_using_gzip_frames(struct unit_test_state *uts,
+				      void *in, unsigned long in_size,
+				      void *out, unsigned long out_max,
+				      unsigned long *out_size)
+{
+	const int extra = 2 + 4 + GZIP_SUBFIELD_UB_LEN;
+	unsigned long pos = 0, size, part;
+	u8 *dst = out;
+	u8 member[TEST_BUFFER_SIZE];
+	int i, ret;
+
+	for (i = 0; i < 2; i++) {
+		part = i ? in_size - in_size / 2 : in_size / 2;
+		size = sizeof(member);
+		ret = gzip(member, &size, in, part);
+		if (ret)
+			return ret;
+		if (pos + size + extra > out_max)
+			return -1;
+
+		/* add an extra field to the header, holding the member size */
+		memcpy(dst + pos, member, 10);
+		dst[pos + 3] |= 4;
+		put_unaligned_le16(extra - 2, dst + pos + 10);
+		dst[pos + 12] = GZIP_SUBFIELD_UB1;
+		dst[pos + 13] = GZIP_SUBFIELD_UB2;
+		put_unaligned_le16(GZIP_SUBFIELD_UB_LEN, dst + pos + 14);
+		put_unaligned_le32(size + extra, dst + pos + 16);
+		memcpy(dst + pos + 10 + extra, member + 10, size - 10);
+		pos += size + extra;
+		in += part;
+	}
+	if (out_size)
+		*out_size = pos;
+
+	return 0;
+}
+#endif
+
 static int compress_using_bzip2(struct unit_test_state *uts,
 				void *in, unsigned long in_size,
 				void *out, unsigned long out_max,
@@ -414,6 +460,132 @@ static int compression_test_gzip(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_gzip, 0);
 
+#if CONFIG_IS_ENABLED(DECOMP_FRAMES)
+static int compression_test_gzip_frames(struct unit_test_state *uts)
+{
+	return run_test(uts, "gzip_frames", compress_using_gzip_frames,
+			uncompress_using_gzip);
+}
+COMPRESSION_TEST(compression_test_gzip_frames, 0);
+
+/*
+ * The size of a member is known from its header, so that a reader which has
+ * only seen the first chunk of a member larger than the chunk can tell
+ */
+static int compression_test_gzip_frame_size(struct unit_test_state *uts)
+{
+	const int hdr_size = 10 + 2 + 4 + GZIP_SUBFIELD_UB_LEN;
+	u8 out[TEST_BUFFER_SIZE];
+	u8 buf[TEST_BUFFER_SIZE * 2];
+	ulong size, first, len;
+
+	ut_assertok(compress_using_gzip_frames(uts, (void *)plain,
+					       strlen(plain), buf, sizeof(buf),
+					       &size));
+	first = gzip_frame_size(buf, size);
+	ut_assert(first > hdr_size);
+	ut_assert(first < size);
+
+	/* a chunk holding just the header is enough */
+	ut_asserteq(first, gzip_frame_size(buf, hdr_size));
+	ut_asserteq(0, gzip_frame_size(buf, hdr_size - 1));
+	ut_asserteq(size - first, gzip_frame_size(buf + first, hdr_size));
+
+	/* both members are inflated, not just the first */
+	len = size;
+	ut_assertok(gunzip(out, sizeof(out), buf, &len));
+	ut_asserteq(strlen(plain), len);
+	ut_asserteq_mem(plain, out, len);
+
+	/* a truncated member is not inflated in parallel */
+	len = size - 1;
+	ut_assert(gunzip(out, sizeof(out), buf, &len) ||
+		  len != strlen(plain));
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_frame_size, 0);
+
+#if CONFIG_IS_ENABLED(ZSTD)
+/*
+ * split -b 175 /tmp/plain.txt /tmp/plain.
+ * zstd --no-check -c /tmp/plain.aa /tmp/plain.ab > /tmp/plain.zst
+ */
+static const char zstd_frames_compressed[] =
+	"\x28\xb5\x2f\xfd\x20\xaf\xa5\x02\x00\xf2\xc5\x12\x17\x90\xa7\xe9"
+	"\x58\x71\x1b\xb0\xd1\x7e\xd8\xf6\xc9\xfc\x16\xd3\xfc\x2f\x76\x83"
+	"\xeb\x55\x11\x07\x55\x3d\x4c\x3e\x48\x61\x14\x1d\xbe\xee\xa2\xf4"
+	"\x3a\x93\xa7\xa1\x0c\x28\x5e\xc2\x9d\x13\xc8\xf0\x2a\xbb\xaa\x26"
+	"\x50\x18\x89\x68\x7e\xa4\xf3\xca\x3d\xc5\xd6\xaa\x2a\x60\x12\x9c"
+	"\x38\x66\x70\x66\x1b\x6d\x12\x01\x00\xe8\x85\xaa\x32\x28\xb5\x2f"
+	"\xfd\x20\xaf\xfd\x03\x00\x82\x89\x1b\x19\x80\xa5\xd5\x01\x8c\x1d"
+	"\xad\xa0\xa8\xec\x4c\x12\xfb\x13\x3b\x4d\xe8\x18\xdc\xd6\x38\x4b"
+	"\x7a\x05\x16\x64\xd0\x1b\xa7\x7a\x44\x56\xe0\xeb\x22\xfd\x72\xed"
+	"\xac\x4c\xe5\x07\x1c\x9e\x70\xae\x75\xdd\x95\x3a\x63\x31\xc8\x88"
+	"\xd0\x8e\xb5\x74\x16\x72\xe0\x18\xd7\x30\xaf\xde\x8f\x77\xe0\xe1"
+	"\xe5\x8e\xf2\xea\x32\x85\x91\x8d\x64\x54\xbf\x14\xca\x42\x92\xf1"
+	"\x35\x5d\x8d\xe5\x40\x3e\xe1\x15\x24\x80\x73\x24\xf3\xd7\x71\x2d"
+	"\xac\xef\x4a\x54\xb7\x74\x0e\x04\x00\x18\x1b\x75\x44\xa1\xac\xaa"
+	"\xb0\x5b\xc1\x84\x02";
+static const unsigned long zstd_frames_compressed_size = 229;
+static const unsigned long zstd_frame_size[] = { 93, 136 };
+static const unsigned long zstd_frame_len[] = { 175, 175 };
+
+/*
+ * Each frame gives its content size, so the frames are decompressed in
+ * parallel, whether or not they are followed by a seek table
+ */
+static int compression_test_zstd_frames(struct unit_test_state *uts)
+{
+	u8 buf[TEST_BUFFER_SIZE];
+	u8 out[TEST_BUFFER_SIZE];
+	ulong size, len;
+	u8 *table;
+	int i;
+
+	/* the frame headers are walked */
+	ut_assertok(zstd_decomp_frames(out, sizeof(out), zstd_frames_compressed,
+				       zstd_frames_compressed_size, &len));
+	ut_asserteq(strlen(plain), len);
+	ut_asserteq_mem(plain, out, len);
+
+	/* the output must have room for all the frames */
+	ut_asserteq(-ENOSPC, zstd_decomp_frames(out, strlen(plain) - 1,
+						zstd_frames_compressed,
+						zstd_frames_compressed_size,
+						&len));
+
+	/* a single frame is left to the usual decompressor */
+	ut_asserteq(-ENOENT, zstd_decomp_frames(out, sizeof(out),
+						zstd_frames_compressed,
+						zstd_frame_size[0], &len));
+
+	/* add a seek table, as 'mkimage -Z' does */
+	size = zstd_frames_compressed_size;
+	memcpy(buf, zstd_frames_compressed, size);
+	table = buf + size;
+	put_unaligned_le32(ZSTD_SEEKABLE_MAGIC, table);
+	put_unaligned_le32(2 * 8 + ZSTD_SEEKABLE_FOOTER_SIZE, table + 4);
+	for (i = 0; i < 2; i++) {
+		put_unaligned_le32(zstd_frame_size[i], table + 8 + i * 8);
+		put_unaligned_le32(zstd_frame_len[i], table + 12 + i * 8);
+	}
+	put_unaligned_le32(2, table + 24);
+	table[28] = 0;
+	put_unaligned_le32(ZSTD_SEEKABLE_FOOTER_MAGIC, table + 29);
+	size += 8 + 2 * 8 + ZSTD_SEEKABLE_FOOTER_SIZE;
+
+	memset(out, '\0', sizeof(out));
+	ut_assertok(zstd_decomp_frames(out, sizeof(out), buf, size, &len));
+	ut_asserteq(strlen(plain), len);
+	ut_asserteq_mem(plain, out, len);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_zstd_frames, 0);
+#endif
+#endif
+
 static int compression_test_bzip2(struct unit_test_state *uts)
 {
 	return run_test(uts, "bzip2", compress_using_bzip2,
@@ -5,6 +5,7 @@
 
 #include <common.h>
 #include <dm.h>
+#include <malloc.h>
 #include <part.h>
 #include <usb.h>
 #include <asm/global_data.h>
@@ -162,3 +163,153 @@ static int dm_test_blk_get_from_parent(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_blk_get_from_parent, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that the block cache serves sequential small reads from read-ahead */
+static int dm_test_blk_cache(struct unit_test_state *uts)
+{
+	struct block_cache_dev_stats stats;
+	struct blk_desc *desc;
+	struct udevice *dev;
+	char *write, *read;
+	int i;
+
+	ut_assertok(uclass_get_device(UCLASS_MMC, 0, &dev));
+	ut_assertok(blk_get_device_by_str("mmc", "0", &desc));
+	ut_asserteq(512, desc->blksz);
+
+	blkcache_configure(8, 32, 64);
+	blkcache_invalidate(IF_TYPE_MMC, 0);
+
+	write = malloc(64 * 512);
+	read = malloc(64 * 512);
+	ut_assertnonnull(write);
+	ut_assertnonnull(read);
+	for (i = 0; i < 64 * 512; i++)
+		write[i] = i / 512 + i;
+	ut_asserteq(64, blk_dwrite(desc, 0, 64, write));
+
+	/* Read one block at a time; the window should keep growing */
+	for (i = 0; i < 64; i++)
+		ut_asserteq(1, blk_dread(desc, i, 1, read + i * 512));
+	ut_asserteq_mem(write, read, 64 * 512);
+
+	for (i = 0; !blkcache_dev_stats(i, &stats); i++) {
+		if (stats.iftype == IF_TYPE_MMC && stats.devnum == 0)
+			break;
+	}
+	ut_asserteq(IF_TYPE_MMC, stats.iftype);
+	ut_asserteq(3, stats.misses);
+	ut_asserteq(61, stats.hits);
+	ut_asserteq(3, stats.readaheads);
+
+	/* A read spanning several cached entries is a hit */
+	memset(read, '\0', 64 * 512);
+	ut_asserteq(20, blk_dread(desc, 3, 20, read));
+	ut_asserteq_mem(write + 3 * 512, read, 20 * 512);
+	ut_assertok(blkcache_dev_stats(i, &stats));
+	ut_asserteq(62, stats.hits);
+
+	/* Writing must invalidate the cache */
+	memset(write, 0xaa, 512);
+	ut_asserteq(1, blk_dwrite(desc, 5, 1, write));
+	ut_asserteq(1, blk_dread(desc, 5, 1, read));
+	ut_asserteq_mem(write, read, 512);
+
+	free(write);
+	free(read);
+	blkcache_configure(8, 32, CONFIG_BLOCK_CACHE_READAHEAD);
+
+	return 0;
+}
+DM_TEST(dm_test_blk_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+struct blk_stream_state {
+	char *expect;
+	int chunks;
+	lbaint_t blocks;
+};
+
+static int blk_stream_check(void *priv, void *buf, lbaint_t blkcnt)
+{
+	struct blk_stream_state *state = priv;
+
+	if (memcmp(buf, state->expect + state->blocks * 512, blkcnt * 512))
+		return -EBADMSG;
+	state->chunks++;
+	state->blocks += blkcnt;
+
+	return 0;
+}
+
+/* Test asynchronous and streamed reads */
+static int dm_test_blk_async(struct unit_test_state *uts)
+{
+	struct blk_stream_state state;
+	struct blk_req req[2];
+	struct blk_desc *desc;
+	struct udevice *dev;
+	char *write, *read;
+	int i;
+
+	ut_assertok(uclass_get_device(UCLASS_MMC, 0, &dev));
+	ut_assertok(blk_get_device_by_str("mmc", "0", &desc));
+	blkcache_invalidate(IF_TYPE_MMC, 0);
+
+	write = malloc(100 * 512);
+	read = malloc(100 * 512);
+	ut_assertnonnull(write);
+	ut_assertnonnull(read);
+	for (i = 0; i < 100 * 512; i++)
+		write[i] = i / 512 + i;
+	ut_asserteq(100, blk_dwrite(desc, 0, 100, write));
+
+	/* A request does not complete until it is waited for */
+	memset(read, '\0', 100 * 512);
+	req[0].start = 10;
+	req[0].blkcnt = 20;
+	req[0].buffer = read;
+	ut_assertok(blk_dsubmit(desc, &req[0]));
+	ut_asserteq(false, req[0].done);
+	ut_asserteq(20, blk_dwait(desc, &req[0]));
+	ut_asserteq(true, req[0].done);
+	ut_asserteq_mem(write + 10 * 512, read, 20 * 512);
+
+	/* Submitting another request completes the one in flight */
+	req[0].start = 40;
+	req[0].blkcnt = 4;
+	req[0].buffer = read;
+	req[1].start = 50;
+	req[1].blkcnt = 4;
+	req[1].buffer = read + 4 * 512;
+	ut_assertok(blk_dsubmit(desc, &req[0]));
+	ut_assertok(blk_dsubmit(desc, &req[1]));
+	ut_asserteq(true, req[0].done);
+	ut_asserteq(4, blk_dwait(desc, &req[1]));
+	ut_asserteq(4, blk_dwait(desc, &req[0]));
+	ut_asserteq_mem(write + 40 * 512, read, 4 * 512);
+	ut_asserteq_mem(write + 50 * 512, read + 4 * 512, 4 * 512);
+
+	/* Stream the data through a callback, a chunk at a time */
+	memset(read, '\0', 100 * 512);
+	memset(&state, '\0', sizeof(state));
+	state.expect = write;
+	ut_asserteq(100, blk_dread_stream(desc, 0, 100, read, 16,
+					  blk_stream_check, &state));
+	ut_asserteq(7, state.chunks);
+	ut_asserteq(100, state.blocks);
+	ut_asserteq_mem(write, read, 100 * 512);
+
+	/* An error from the callback stops the stream */
+	memset(&state, '\0', sizeof(state));
+	write[20 * 512] ^= 0xff;
+	state.expect = write;
+	ut_asserteq(-EBADMSG, blk_dread_stream(desc, 0, 100, read, 16,
+					       blk_stream_check, &state));
+	ut_asserteq(1, state.chunks);
+
+	free(write);
+	free(read);
+
+	return 0;
+}
+DM_TEST(dm_test_blk_async, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -13,6 +13,7 @@
 #include <malloc.h>
 #include <asm/global_data.h>
 #include <dm/device-internal.h>
+#include <dm/lists.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/test.h>
@@ -1200,3 +1201,77 @@ static int dm_test_dma_offset(struct unit_test_state *uts)
        return 0;
 }
 DM_TEST(dm_test_dma_offset, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Check that each compatible string finds the first driver which has it */
+static int dm_test_lookup_compat(struct unit_test_state *uts)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *id, *found, *other;
+	struct driver *entry, *drv, *before;
+
+	ut_assertnonnull(gd_dm_compat_index());
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++) {
+			drv = lists_driver_lookup_compat(id->compatible,
+							 &found);
+			ut_assertnonnull(drv);
+			ut_assert(drv <= entry);
+			ut_asserteq_str(id->compatible, found->compatible);
+
+			/* No earlier driver, nor an earlier entry of drv, has it */
+			for (before = driver; before != drv; before++) {
+				for (other = before->of_match;
+				     other && other->compatible; other++)
+					ut_assert(strcmp(other->compatible,
+							 id->compatible));
+			}
+			for (other = drv->of_match; other != found; other++)
+				ut_assert(strcmp(other->compatible,
+						 id->compatible));
+		}
+	}
+	ut_assertnull(lists_driver_lookup_compat("denx,u-boot-no-such-device",
+						 &found));
+
+	return 0;
+}
+DM_TEST(dm_test_lookup_compat, 0);
+
+#if CONFIG_IS_ENABLED(DM_PROBE_TIMES)
+/* Check the probe times and their report in the devicetree */
+static int dm_test_probe_times(struct unit_test_state *uts)
+{
+	const int size = 0x10000;
+	struct udevice *bus;
+	int node, sub, cost;
+	int prev = INT_MAX;
+	void *fdt;
+
+	ut_assertok(uclass_get_device(UCLASS_TEST_BUS, 0, &bus));
+	ut_assert(dev_get_time(bus, DM_TIME_PROBE) <=
+		  dev_get_time(bus, DM_TIME_PROBE_TOTAL));
+	ut_assertnull(gd->dm_times.dev);
+	ut_asserteq(0, gd->dm_times.depth);
+
+	/* The devices are listed with the most costly first */
+	fdt = malloc(size);
+	ut_assertnonnull(fdt);
+	ut_assertok(fdt_create_empty_tree(fdt, size));
+	ut_assertok(dm_probe_times_add_fdt(fdt, 0));
+	node = fdt_subnode_offset(fdt, 0, "dm");
+	ut_assert(node >= 0);
+	fdt_for_each_subnode(sub, fdt, node) {
+		ut_assertnonnull(fdt_getprop(fdt, sub, "name", NULL));
+		cost = fdtdec_get_int(fdt, sub, "bind", -1) +
+			fdtdec_get_int(fdt, sub, "probe", -1);
+		ut_assert(cost > 0);
+		ut_assert(cost <= prev);
+		prev = cost;
+	}
+	free(fdt);
+
+	return 0;
+}
+DM_TEST(dm_test_probe_times, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
@@ -7,6 +7,7 @@
  */
 
 #include <common.h>
+#include <command.h>
 #include <dm.h>
 #include <env.h>
 #include <fdtdec.h>
@@ -42,6 +43,227 @@ static int dm_test_eth(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_eth, UT_TESTF_SCAN_FDT);
 
+/* Test that traffic is counted on the device which carried it */
+static int dm_test_eth_stats(struct unit_test_state *uts)
+{
+	struct eth_stats *stats;
+	struct udevice *dev;
+
+	net_ping_ip = string_to_ip("1.1.2.2");
+
+	env_set("ethact", "eth@10002000");
+	ut_assertok(net_loop(PING));
+
+	/* ARP request and ping request out, their replies back */
+	ut_assertok(uclass_get_device_by_name(UCLASS_ETH, "eth@10002000",
+					      &dev));
+	stats = eth_get_stats(dev);
+	ut_asserteq(2, stats->tx_packets);
+	ut_asserteq(2, stats->rx_packets);
+	ut_assert(stats->rx_bytes > 0);
+	ut_asserteq(0, stats->rx_errors);
+	ut_asserteq(0, stats->tx_errors);
+	ut_asserteq(0, stats->rx_full_polls);
+
+	ut_assertok(run_command("net stats", 0));
+
+	return 0;
+}
+DM_TEST(dm_test_eth_stats, UT_TESTF_SCAN_FDT);
+
+/* Test that a known neighbour is not asked for its MAC address again */
+static int dm_test_eth_arp_cache(struct unit_test_state *uts)
+{
+	struct eth_stats *stats;
+	struct udevice *dev;
+
+	net_ping_ip = string_to_ip("1.1.2.2");
+
+	env_set("ethact", "eth@10002000");
+	ut_assertok(net_loop(PING));
+	ut_assertok(uclass_get_device_by_name(UCLASS_ETH, "eth@10002000",
+					      &dev));
+	stats = eth_get_stats(dev);
+	ut_asserteq(2, stats->tx_packets);
+
+	/* Only the ping request is sent and only its reply comes back */
+	ut_assertok(net_loop(PING));
+	ut_asserteq(3, stats->tx_packets);
+	ut_asserteq(3, stats->rx_packets);
+
+	/* After a flush, ARP is needed again */
+	ut_assertok(run_command("arp flush", 0));
+	ut_assertok(net_loop(PING));
+	ut_asserteq(5, stats->tx_packets);
+
+	return 0;
+}
+DM_TEST(dm_test_eth_arp_cache, UT_TESTF_SCAN_FDT);
+
+/* Test the software side of checksum offload and scatter-gather send */
+static int dm_test_eth_offload(struct unit_test_state *uts)
+{
+	uchar pkt[ETHER_HDR_SIZE + IP_UDP_HDR_SIZE + 4];
+	struct ethernet_hdr *et = (struct ethernet_hdr *)pkt;
+	struct ip_udp_hdr *ip = (struct ip_udp_hdr *)(pkt + ETHER_HDR_SIZE);
+	struct eth_sg sg[2];
+	struct eth_stats *stats;
+	struct udevice *dev;
+	int offset;
+
+	env_set("ethact", "eth@10002000");
+	eth_set_current();
+	ut_assertok(uclass_get_device_by_name(UCLASS_ETH, "eth@10002000",
+					      &dev));
+
+	/* Sandbox does not offload, so UDP goes without a checksum */
+	memset(pkt, 0, sizeof(pkt));
+	et->et_protlen = htons(PROT_IP);
+	net_set_udp_header((uchar *)ip, string_to_ip("1.1.2.2"), 69, 1234, 4);
+	ut_asserteq(0, ip->udp_xsum);
+	ut_asserteq(-ENOENT, eth_get_tx_csum(pkt, sizeof(pkt), &offset));
+
+	/* A finished checksum the stack did not leave is never touched */
+	ip->udp_xsum = htons(0x1234);
+	ut_asserteq(-ENOENT, eth_get_tx_csum(pkt, sizeof(pkt), &offset));
+
+	/* Without ETH_FEAT_SG the pieces are sent as one packet */
+	ut_assertok(eth_init());
+	stats = eth_get_stats(dev);
+	sg[0].addr = pkt;
+	sg[0].length = ETHER_HDR_SIZE + IP_UDP_HDR_SIZE;
+	sg[1].addr = pkt + sg[0].length;
+	sg[1].length = sizeof(pkt) - sg[0].length;
+	ut_assertok(eth_send_sg(sg, 2));
+	ut_asserteq(1, stats->tx_packets);
+	ut_asserteq(sizeof(pkt), stats->tx_bytes);
+	ut_asserteq(-EINVAL, eth_send_sg(sg, 0));
+	eth_halt();
+
+	return 0;
+}
+DM_TEST(dm_test_eth_offload, UT_TESTF_SCAN_FDT);
+
+/* Act as a device which completes the checksums left to it */
+static int sb_csum_offload_handler(struct udevice *dev, void *packet,
+				   unsigned int len)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+	uchar *sent = priv->priv;
+	int start, offset;
+
+	memcpy(sent, packet, len);
+	start = eth_get_tx_csum(packet, len, &offset);
+	if (start >= 0)
+		ip_checksum_complete(sent + start, len - start, offset);
+
+	return 0;
+}
+
+/* Check the UDP checksum of a packet as it would go on the wire */
+static bool sb_udp_csum_ok(const uchar *pkt, int len)
+{
+	const struct ip_udp_hdr *ip = (void *)(pkt + ETHER_HDR_SIZE);
+	int udp_len = len - ETHER_HDR_SIZE - IP_HDR_SIZE;
+
+	return !add_ip_checksums(0, ip_pseudo_checksum(ip->ip_src, ip->ip_dst,
+						       IPPROTO_UDP, udp_len),
+				 compute_ip_checksum(pkt + ETHER_HDR_SIZE +
+						     IP_HDR_SIZE, udp_len));
+}
+
+/* Test sending through a device which completes checksums */
+static int dm_test_eth_offload_tx_csum(struct unit_test_state *uts)
+{
+	uchar pkt[ETHER_HDR_SIZE + IP_UDP_HDR_SIZE + 6];
+	struct ip_udp_hdr *ip = (struct ip_udp_hdr *)(pkt + ETHER_HDR_SIZE);
+	uchar sent[sizeof(pkt)], other[sizeof(pkt)];
+	struct in_addr dest = string_to_ip("1.1.2.2");
+	struct in_addr old_ip = net_ip;
+	struct eth_pdata *pdata;
+	struct udevice *dev;
+	uint features;
+	u16 partial;
+
+	env_set("ethact", "eth@10002000");
+	eth_set_current();
+	ut_assertok(uclass_get_device_by_name(UCLASS_ETH, "eth@10002000",
+					      &dev));
+	pdata = dev_get_plat(dev);
+	features = pdata->features;
+	pdata->features |= ETH_FEAT_TX_CSUM;
+	sandbox_eth_set_tx_handler(0, sb_csum_offload_handler);
+	sandbox_eth_set_priv(0, sent);
+	net_ip = string_to_ip("1.1.2.3");
+	ut_assertok(eth_init());
+
+	/* The stack leaves the sum to the device, which finishes it */
+	net_set_ether(pkt, net_bcast_ethaddr, PROT_IP);
+	memcpy(pkt + ETHER_HDR_SIZE + IP_UDP_HDR_SIZE, "offload", 6);
+	net_set_udp_header((uchar *)ip, dest, 69, 1234, 6);
+	partial = ip->udp_xsum;
+	ut_asserteq_ptr(ip, net_tx_csum_marked());
+	ut_assert(!sb_udp_csum_ok(pkt, sizeof(pkt)));
+	ut_assertok(eth_send(pkt, sizeof(pkt)));
+	ut_assert(sb_udp_csum_ok(sent, sizeof(sent)));
+
+	/*
+	 * A packet with a finished checksum from elsewhere, as sent by an EFI
+	 * application, goes out unchanged
+	 */
+	memcpy(other, sent, sizeof(other));
+	ut_assertok(eth_send(other, sizeof(other)));
+	ut_asserteq_mem(other, sent, sizeof(sent));
+	ut_assert(sb_udp_csum_ok(sent, sizeof(sent)));
+
+	/* So does a packet once the next IP header is built */
+	net_set_ip_header(other + ETHER_HDR_SIZE, dest, net_ip,
+			  IP_UDP_HDR_SIZE + 6, IPPROTO_UDP);
+	ut_assertnull(net_tx_csum_marked());
+	ut_assertok(eth_send(pkt, sizeof(pkt)));
+	ut_asserteq(partial, ((struct ip_udp_hdr *)(sent +
+					ETHER_HDR_SIZE))->udp_xsum);
+
+	/* A partial checksum is finished as the device would do */
+	ip_checksum_complete(pkt + ETHER_HDR_SIZE + IP_HDR_SIZE,
+			     sizeof(pkt) - ETHER_HDR_SIZE - IP_HDR_SIZE,
+			     offsetof(struct ip_udp_hdr, udp_xsum) -
+			     IP_HDR_SIZE);
+	ut_assert(sb_udp_csum_ok(pkt, sizeof(pkt)));
+
+	eth_halt();
+	sandbox_eth_set_tx_handler(0, NULL);
+	sandbox_eth_set_priv(0, NULL);
+	pdata->features = features;
+	net_ip = old_ip;
+
+	return 0;
+}
+DM_TEST(dm_test_eth_offload_tx_csum, UT_TESTF_SCAN_FDT);
+
+/* Test that netperf keeps the device sending for the time asked */
+static int dm_test_eth_netperf(struct unit_test_state *uts)
+{
+	struct eth_stats *stats;
+	struct udevice *dev;
+
+	env_set("ethact", "eth@10002000");
+	ut_assertok(run_command("netperf source 1.1.2.2 1", 0));
+
+	/* One ARP request, then a stream of packets */
+	ut_assertok(uclass_get_device_by_name(UCLASS_ETH, "eth@10002000",
+					      &dev));
+	stats = eth_get_stats(dev);
+	ut_assert(stats->tx_packets > 2);
+	ut_asserteq(0, stats->tx_errors);
+
+	/* Too small for the header */
+	ut_assert(run_command("netperf source 1.1.2.2 1 8", 0));
+
+	return 0;
+}
+DM_TEST(dm_test_eth_netperf, UT_TESTF_SCAN_FDT);
+
 static int dm_test_eth_alias(struct unit_test_state *uts)
 {
 	net_ping_ip = string_to_ip("1.1.2.2");
@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for loading FIT images from storage a chunk at a time
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <dm.h>
+#include <fit_stream.h>
+#include <gzip.h>
+#include <hash.h>
+#include <image.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <part.h>
+#include <dm/test.h>
+#include <linux/libfdt.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+
+enum {
+	KERNEL_SIZE	= 0x10000,
+	FDT_SIZE	= 20000,
+	FIT_START	= 16,		/* first block of the FIT on mmc0 */
+	FIT_BUF_SIZE	= 0x40000,
+	CHUNK_SIZE	= 0x1000,
+};
+
+/* Data for the FIT, along with a buffer holding it */
+struct fit_test_data {
+	char *kernel;
+	char *kernel_gz;
+	ulong kernel_gz_size;
+	char *fdt;
+	char *buf;
+	int size;
+};
+
+static int fit_test_hash(struct unit_test_state *uts, void *fit,
+			 const char *name, const char *algo, const void *data,
+			 int size)
+{
+	u8 value[HASH_MAX_DIGEST_SIZE];
+	int len = sizeof(value);
+
+	ut_assertok(hash_block(algo, data, size, value, &len));
+	ut_assertok(fdt_begin_node(fit, name));
+	ut_assertok(fdt_property_string(fit, FIT_ALGO_PROP, algo));
+	ut_assertok(fdt_property(fit, FIT_VALUE_PROP, value, len));
+	ut_assertok(fdt_end_node(fit));
+
+	return 0;
+}
+
+/*
+ * Build a FIT with external data: a gzipped kernel whose data is not
+ * block-aligned and an uncompressed FDT whose data starts on a block
+ */
+static int fit_test_build(struct unit_test_state *uts,
+			  struct fit_test_data *td)
+{
+	void *fit = td->buf;
+	int fdt_offset, totalsize;
+	int i;
+
+	td->kernel = malloc(KERNEL_SIZE);
+	td->kernel_gz_size = KERNEL_SIZE;
+	td->kernel_gz = malloc(td->kernel_gz_size);
+	td->fdt = malloc(FDT_SIZE);
+	ut_assertnonnull(td->kernel);
+	ut_assertnonnull(td->kernel_gz);
+	ut_assertnonnull(td->fdt);
+	for (i = 0; i < KERNEL_SIZE; i++)
+		td->kernel[i] = "sandbox kernel "[i % 15] + i / 1000;
+	for (i = 0; i < FDT_SIZE; i++)
+		td->fdt[i] = i * 7 + i / 512;
+	ut_assertok(gzip(td->kernel_gz, &td->kernel_gz_size, (uchar *)td->kernel,
+			 KERNEL_SIZE));
+
+	/* The FDT goes on the first block boundary after the kernel */
+	fdt_offset = ALIGN(0x1000 + td->kernel_gz_size, 512);
+
+	ut_assertok(fdt_create(fit, FIT_BUF_SIZE));
+	ut_assertok(fdt_finish_reservemap(fit));
+	ut_assertok(fdt_begin_node(fit, ""));
+	ut_assertok(fdt_property_string(fit, FIT_DESC_PROP, "test"));
+	ut_assertok(fdt_property_u32(fit, FIT_TIMESTAMP_PROP, 0));
+
+	ut_assertok(fdt_begin_node(fit, "images"));
+	ut_assertok(fdt_begin_node(fit, "kernel"));
+	ut_assertok(fdt_property_string(fit, FIT_TYPE_PROP, "kernel"));
+	ut_assertok(fdt_property_string(fit, FIT_COMP_PROP, "gzip"));
+	ut_assertok(fdt_property_u32(fit, FIT_LOAD_PROP, 0));
+	ut_assertok(fdt_property_u32(fit, FIT_DATA_OFFSET_PROP, 0));
+	ut_assertok(fdt_property_u32(fit, FIT_DATA_SIZE_PROP,
+				     td->kernel_gz_size));
+	ut_assertok(fit_test_hash(uts, fit, "hash-1", "sha256",
+				  td->kernel_gz, td->kernel_gz_size));
+	ut_assertok(fit_test_hash(uts, fit, "hash-2", "crc32",
+				  td->kernel_gz, td->kernel_gz_size));
+	ut_assertok(fdt_end_node(fit));
+
+	ut_assertok(fdt_begin_node(fit, "fdt-1"));
+	ut_assertok(fdt_property_string(fit, FIT_TYPE_PROP, "flat_dt"));
+	ut_assertok(fdt_property_string(fit, FIT_COMP_PROP, "none"));
+	ut_assertok(fdt_property_u32(fit, FIT_DATA_POSITION_PROP,
+				     fdt_offset));
+	ut_assertok(fdt_property_u32(fit, FIT_DATA_SIZE_PROP, FDT_SIZE));
+	ut_assertok(fit_test_hash(uts, fit, "hash-1", "sha1", td->fdt,
+				  FDT_SIZE));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+
+	ut_assertok(fdt_begin_node(fit, "configurations"));
+	ut_assertok(fdt_property_string(fit, "default", "conf-1"));
+	ut_assertok(fdt_begin_node(fit, "conf-1"));
+	ut_assertok(fdt_property_string(fit, FIT_KERNEL_PROP, "kernel"));
+	ut_assertok(fdt_property_string(fit, FIT_FDT_PROP, "fdt-1"));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_finish(fit));
+
+	totalsize = ALIGN(fdt_totalsize(fit), 4);
+	ut_assert(totalsize < 0x1000);
+	memset(td->buf + fdt_totalsize(fit), '\0',
+	       FIT_BUF_SIZE - fdt_totalsize(fit));
+	/* Make the kernel start part-way through a block */
+	ut_assertok(fdt_setprop_inplace_u32(fit,
+			fdt_path_offset(fit, "/images/kernel"),
+			FIT_DATA_OFFSET_PROP, 0x1000 - totalsize));
+	memcpy(td->buf + 0x1000, td->kernel_gz, td->kernel_gz_size);
+	memcpy(td->buf + fdt_offset, td->fdt, FDT_SIZE);
+	td->size = fdt_offset + FDT_SIZE;
+
+	return 0;
+}
+
+static void fit_test_free(struct fit_test_data *td)
+{
+	free(td->kernel);
+	free(td->kernel_gz);
+	free(td->fdt);
+	free(td->buf);
+}
+
+static int fit_test_mem_read(struct fit_stream_src *src, ulong offset,
+			     ulong size, void *buf)
+{
+	struct fit_test_data *td = src->priv;
+
+	if (offset + size > td->size)
+		return -EIO;
+	memcpy(buf, td->buf + offset, size);
+
+	return 0;
+}
+
+/* Test loading images from a FIT on a block device */
+static int dm_test_fit_stream(struct unit_test_state *uts)
+{
+	struct fit_stream_src src = {};
+	struct fit_test_data td = {};
+	struct blk_desc *desc;
+	struct udevice *dev;
+	int kernel, fdt;
+	char *load;
+	void *fit, *enc;
+	ulong len;
+
+	td.buf = malloc(FIT_BUF_SIZE);
+	ut_assertnonnull(td.buf);
+	ut_assertok(fit_test_build(uts, &td));
+
+	ut_assertok(uclass_get_device(UCLASS_MMC, 0, &dev));
+	ut_assertok(blk_get_device_by_str("mmc", "0", &desc));
+	ut_asserteq(td.size / 512 + 1,
+		    blk_dwrite(desc, FIT_START, td.size / 512 + 1, td.buf));
+
+	src.desc = desc;
+	src.start = FIT_START;
+	src.chunk = CHUNK_SIZE;
+	ut_assertok(fit_stream_read_header(&src, &fit));
+	ut_asserteq_mem(td.buf, fit, fdt_totalsize(fit));
+	kernel = fit_image_get_node(fit, "kernel");
+	fdt = fit_image_get_node(fit, "fdt-1");
+	ut_assert(kernel >= 0);
+	ut_assert(fdt >= 0);
+
+	load = malloc(2 * KERNEL_SIZE);
+	ut_assertnonnull(load);
+
+	/* The kernel is decompressed as it is read */
+	ut_assertok(fit_stream_load_image(&src, fit, kernel,
+					  map_to_sysmem(load), 2 * KERNEL_SIZE,
+					  &len));
+	ut_asserteq(KERNEL_SIZE, len);
+	ut_asserteq_mem(td.kernel, load, KERNEL_SIZE);
+
+	/* The FDT is read straight to its destination */
+	memset(load, '\0', FDT_SIZE);
+	ut_assertok(fit_stream_load_image(&src, fit, fdt, map_to_sysmem(load),
+					  2 * KERNEL_SIZE, &len));
+	ut_asserteq(FDT_SIZE, len);
+	ut_asserteq_mem(td.fdt, load, FDT_SIZE);
+
+	/* Not enough space */
+	ut_asserteq(-ENOSPC, fit_stream_load_image(&src, fit, kernel,
+						   map_to_sysmem(load),
+						   KERNEL_SIZE / 2, &len));
+	ut_asserteq(-ENOSPC, fit_stream_load_image(&src, fit, fdt,
+						   map_to_sysmem(load),
+						   FDT_SIZE - 1, &len));
+
+	/* Corrupt data must be caught by the hash */
+	td.buf[0x1000 + td.kernel_gz_size - 1] ^= 0xff;
+	ut_asserteq(1, blk_dwrite(desc, FIT_START + (0x1000 +
+				  td.kernel_gz_size - 1) / 512, 1,
+				  td.buf + ALIGN_DOWN(0x1000 +
+				  td.kernel_gz_size - 1, 512)));
+	ut_asserteq(-EACCES, fit_stream_load_image(&src, fit, kernel,
+						   map_to_sysmem(load),
+						   2 * KERNEL_SIZE, &len));
+	td.buf[0x1000 + td.kernel_gz_size - 1] ^= 0xff;
+
+	/* Read the FIT through a function instead */
+	free(fit);
+	src.desc = NULL;
+	src.read = fit_test_mem_read;
+	src.priv = &td;
+	ut_assertok(fit_stream_read_header(&src, &fit));
+	ut_assertok(fit_stream_load_image(&src, fit, kernel,
+					  map_to_sysmem(load), 2 * KERNEL_SIZE,
+					  &len));
+	ut_asserteq(KERNEL_SIZE, len);
+	ut_asserteq_mem(td.kernel, load, KERNEL_SIZE);
+
+	/* Ciphertext which cannot be decrypted must not be loaded */
+	enc = malloc(fdt_totalsize(fit) + 0x100);
+	ut_assertnonnull(enc);
+	ut_assertok(fdt_open_into(fit, enc, fdt_totalsize(fit) + 0x100));
+	fdt = fit_image_get_node(enc, "fdt-1");
+	ut_assert(fdt_add_subnode(enc, fdt, FIT_CIPHER_NODENAME) >= 0);
+	fdt = fit_image_get_node(enc, "fdt-1");
+	ut_asserteq(-EACCES, fit_stream_load_image(&src, enc, fdt,
+						   map_to_sysmem(load),
+						   2 * KERNEL_SIZE, &len));
+	free(enc);
+
+	free(load);
+	free(fit);
+	fit_test_free(&td);
+
+	return 0;
+}
+DM_TEST(dm_test_fit_stream, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for binding devicetree nodes when their uclass is first used
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <dm.h>
+#include <dm/lists.h>
+#include <dm/uclass-internal.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/*
+ * A clock controller which is also a reset controller, as many SoCs have.
+ * These are built without DM_LAZY_BIND too, so the nodes in test.dts match.
+ */
+static int lazy_ccu_bind(struct udevice *dev)
+{
+	return device_bind_driver_to_node(dev, "lazy_reset", "lazy-reset",
+					  dev_ofnode(dev), NULL);
+}
+
+static const struct udevice_id lazy_ccu_ids[] = {
+	{ .compatible = "sandbox,lazy-ccu" },
+	{ }
+};
+
+U_BOOT_DRIVER(lazy_ccu) = {
+	.name	= "lazy_ccu",
+	.id	= UCLASS_NOP,
+	.of_match	= lazy_ccu_ids,
+	.bind	= lazy_ccu_bind,
+};
+
+U_BOOT_DRIVER(lazy_reset) = {
+	.name	= "lazy_reset",
+	.id	= UCLASS_RESET,
+};
+
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/* Check for a device bound to @node, without binding anything */
+static bool lazy_is_bound(struct udevice *parent, ofnode node)
+{
+	struct udevice *dev;
+
+	if (ofnode_equal(dev_ofnode(parent), node))
+		return true;
+	device_foreach_child(dev, parent) {
+		if (lazy_is_bound(dev, node))
+			return true;
+	}
+
+	return false;
+}
+
+static int dm_test_lazy_bind(struct unit_test_state *uts)
+{
+	struct udevice *dev, *bus, *ccu;
+	ofnode node, ccu0, ccu1;
+	int count;
+
+	/* Looking up a uclass binds its nodes */
+	node = ofnode_path("/d-test");
+	ut_assert(ofnode_valid(node));
+	ut_assert(!lazy_is_bound(uts->root, node));
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST_FDT, "d-test",
+					       &dev));
+	ut_assert(ofnode_equal(node, dev_ofnode(dev)));
+
+	/* The children of a bus are there once it is probed */
+	ut_assertok(uclass_get_device_by_name(UCLASS_TEST_BUS, "some-bus",
+					      &bus));
+	count = 0;
+	device_foreach_child(dev, bus)
+		count++;
+	ut_asserteq(3, count);
+
+	/* Devices bound by another driver are found by node and phandle */
+	ccu0 = ofnode_path("/lazy-ccu0");
+	ccu1 = ofnode_path("/lazy-ccu1");
+	ut_assert(!lazy_is_bound(uts->root, ccu0));
+	ut_assert(!lazy_is_bound(uts->root, ccu1));
+	ut_assertok(uclass_get_device_by_ofnode(UCLASS_RESET, ccu1, &dev));
+	ut_asserteq_str("lazy_reset", dev->driver->name);
+	ut_assert(ofnode_equal(ccu1, dev_ofnode(dev)));
+	ut_assert(!lazy_is_bound(uts->root, ccu0));
+
+	ccu = dev_get_parent(dev);
+	ut_asserteq_str("lazy_ccu", ccu->driver->name);
+	ut_assertok(uclass_get_device_by_phandle(UCLASS_RESET, ccu, "resets",
+						 &dev));
+	ut_asserteq_str("lazy_reset", dev->driver->name);
+	ut_assert(ofnode_equal(ccu0, dev_ofnode(dev)));
+
+	/* 'dm tree' shows everything */
+	node = ofnode_path("/misc-test");
+	ut_assert(ofnode_valid(node));
+	ut_assert(!lazy_is_bound(uts->root, node));
+	console_record_reset();
+	ut_assertok(run_command("dm tree", 0));
+	ut_assert(lazy_is_bound(uts->root, node));
+	console_record_reset();
+
+	return 0;
+}
+DM_TEST(dm_test_lazy_bind, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT |
+	UT_TESTF_CONSOLE_REC);
+#endif
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for writing a file to a block device while it is downloaded
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <dm.h>
+#include <image.h>
+#include <malloc.h>
+#include <part.h>
+#include <asm/global_data.h>
+#include <dm/test.h>
+#include <linux/sizes.h>
+#include <net/store.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define TEST_FILE_SIZE		200000
+#define TEST_PIECE		1024
+#define TEST_LOAD_ADDR		0x1000000
+
+static int net_store_test_start(struct unit_test_state *uts,
+				struct blk_desc **descp,
+				struct disk_partition *info)
+{
+	struct blk_desc *desc;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &desc));
+	memset(info, '\0', sizeof(*info));
+	info->start = 0;
+	info->size = desc->lba;
+	info->blksz = desc->blksz;
+	*descp = desc;
+
+	return 0;
+}
+
+/* Send the file to net_store_write() in @piece sized parts */
+static int net_store_test_piece(const u8 *file, int piece)
+{
+	ulong offset = piece * TEST_PIECE;
+
+	return net_store_write(offset, file + offset,
+			       min_t(ulong, TEST_PIECE,
+				     TEST_FILE_SIZE - offset));
+}
+
+/* Test writing a file whose pieces arrive out of order, as with nfs */
+static int dm_test_net_store_order(struct unit_test_state *uts)
+{
+	int npieces = DIV_ROUND_UP(TEST_FILE_SIZE, TEST_PIECE);
+	ulong old_addr = image_load_addr;
+	struct disk_partition info;
+	struct blk_desc *desc;
+	ulong blks;
+	u8 *file, *read;
+	int i;
+
+	ut_assertok(net_store_test_start(uts, &desc, &info));
+	blks = DIV_ROUND_UP(TEST_FILE_SIZE, desc->blksz);
+	ut_assert(blks <= desc->lba);
+
+	file = malloc(TEST_FILE_SIZE);
+	read = malloc(blks * desc->blksz);
+	ut_assertnonnull(file);
+	ut_assertnonnull(read);
+	for (i = 0; i < TEST_FILE_SIZE; i++)
+		file[i] = i * 7 + (i >> 11);
+
+	image_load_addr = TEST_LOAD_ADDR;
+	ut_assertok(net_store_start(desc, &info, "mmc 0"));
+	ut_assert(net_store_active());
+
+	/*
+	 * Swap each pair of pieces, send piece 10 again later and hold back
+	 * piece 20 until 16 more pieces have arrived
+	 */
+	for (i = 0; i < npieces; i += 2) {
+		if (i + 1 < npieces && i + 1 != 21)
+			ut_assertok(net_store_test_piece(file, i + 1));
+		if (i != 20)
+			ut_assertok(net_store_test_piece(file, i));
+		if (i == 30)
+			ut_assertok(net_store_test_piece(file, 10));
+		if (i == 36) {
+			ut_assertok(net_store_test_piece(file, 20));
+			ut_assertok(net_store_test_piece(file, 21));
+		}
+	}
+	ut_assertok(net_store_finish());
+	net_store_stop();
+	ut_assert(!net_store_active());
+
+	/* The last block is padded with zeros */
+	ut_asserteq(blks, blk_dread(desc, 0, blks, read));
+	ut_asserteq_mem(file, read, TEST_FILE_SIZE);
+	for (i = TEST_FILE_SIZE; i < blks * desc->blksz; i++)
+		ut_asserteq(0, read[i]);
+
+	/* A piece more than the buffer size ahead cannot be kept */
+	ut_assertok(net_store_start(desc, &info, "mmc 0"));
+	ut_asserteq(-ENOSPC, net_store_write(CONFIG_NET_STORE_BUF_SIZE, file,
+					     TEST_PIECE));
+	net_store_stop();
+
+	image_load_addr = old_addr;
+	free(read);
+	free(file);
+
+	return 0;
+}
+DM_TEST(dm_test_net_store_order, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that the buffer must not run past the end of memory */
+static int dm_test_net_store_lmb(struct unit_test_state *uts)
+{
+	ulong old_addr = image_load_addr;
+	struct disk_partition info;
+	struct blk_desc *desc;
+
+	ut_assertok(net_store_test_start(uts, &desc, &info));
+
+	image_load_addr = gd->ram_size - SZ_4K;
+	ut_asserteq(-EFAULT, net_store_start(desc, &info, "mmc 0"));
+	ut_assert(!net_store_active());
+
+	image_load_addr = TEST_LOAD_ADDR;
+	ut_assertok(net_store_start(desc, &info, "mmc 0"));
+	net_store_stop();
+
+	image_load_addr = old_addr;
+
+	return 0;
+}
+DM_TEST(dm_test_net_store_lmb, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -3,11 +3,19 @@
 #include <common.h>
 #include <dm.h>
 #include <log.h>
+#include <malloc.h>
+#include <of_live.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <dm/of_access.h>
 #include <dm/of_extra.h>
+#include <dm/of_index.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 static int dm_test_ofnode_compatible(struct unit_test_state *uts)
 {
 	ofnode root_node = ofnode_path("/");
@@ -292,3 +300,198 @@ static int dm_test_ofnode_get_reg(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_ofnode_get_reg, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(OF_INDEX)
+/* Check that the index gives the same nodes as libfdt */
+static int check_of_index(struct unit_test_state *uts, const void *blob)
+{
+	static const char *const paths[] = {
+		"/", "/chosen", "/aliases", "/translation-test@8000/dev@1,100",
+		"/translation-test@8000/dev", "/no-such-node", "testfdt0",
+	};
+	int node, i, pass;
+	u32 phandle;
+
+	for (node = fdt_next_node(blob, -1, NULL); node >= 0;
+	     node = fdt_next_node(blob, node, NULL)) {
+		phandle = fdt_get_phandle(blob, node);
+		if (phandle)
+			ut_asserteq(node, of_index_phandle(blob, phandle));
+	}
+
+	/* The second pass finds the remembered paths */
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < ARRAY_SIZE(paths); i++)
+			ut_asserteq(fdt_path_offset(blob, paths[i]),
+				    of_index_path(blob, paths[i]));
+	}
+
+	return 0;
+}
+
+static int dm_test_ofnode_index(struct unit_test_state *uts)
+{
+	const void *orig = gd->fdt_blob;
+	int size, ret;
+	void *blob;
+
+	ut_assertok(check_of_index(uts, orig));
+
+	/* Adding a node moves the others, which must be noticed */
+	size = fdt_totalsize(orig) + 0x100;
+	blob = malloc(size);
+	ut_assertnonnull(blob);
+	ut_assertok(fdt_open_into(orig, blob, size));
+	gd->fdt_blob = blob;
+	ret = check_of_index(uts, blob);
+	if (!ret)
+		ret = fdt_add_subnode(blob, 0, "of-index-test") < 0;
+	if (!ret)
+		ret = check_of_index(uts, blob);
+
+	/* An alias set to a path of the same length is followed */
+	if (!ret)
+		ret = of_index_path(blob, "testfdt3") !=
+		      fdt_path_offset(blob, "/b-test");
+	if (!ret)
+		ret = fdt_setprop_inplace(blob, fdt_path_offset(blob, "/aliases"),
+					  "testfdt3", "/a-test", 8);
+	if (!ret)
+		ret = of_index_path(blob, "testfdt3") !=
+		      fdt_path_offset(blob, "/a-test");
+	gd->fdt_blob = orig;
+	of_index_invalidate();
+	free(blob);
+	ut_assertok(ret);
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_index, UT_TESTF_SCAN_FDT);
+#endif
+
+#if CONFIG_IS_ENABLED(OF_LIVE)
+static int dm_test_ofnode_live_names(struct unit_test_state *uts)
+{
+	const struct of_live_names *names = gd_of_live_names();
+	struct device_node *b_test, *d_test;
+	struct property *b_prop, *d_prop, **pp;
+	const char *b_value, *d_value;
+	char name[] = "compatible";
+
+	ut_assertnonnull(names);
+	b_test = of_find_node_by_path("/b-test");
+	d_test = of_find_node_by_path("/d-test");
+	ut_assertnonnull(b_test);
+	ut_assertnonnull(d_test);
+
+	/* Both nodes use the same copy of the name */
+	b_prop = of_find_property(b_test, name, NULL);
+	d_prop = of_find_property(d_test, "compatible", NULL);
+	ut_assertnonnull(b_prop);
+	ut_assertnonnull(d_prop);
+	ut_asserteq_ptr(b_prop->name, d_prop->name);
+	ut_assert(of_live_name_shared(names, b_prop->name));
+	ut_asserteq_ptr(b_prop->name, of_live_find_name(names, name));
+	ut_assertnull(of_live_find_name(names, "no-such-property"));
+
+	/* The "name" property made up for each node is not shared */
+	ut_asserteq_str("b-test", of_get_property(b_test, "name", NULL));
+
+	/* A property added to the live tree is found by comparing strings */
+	ut_assertok(ofnode_write_string(np_to_ofnode(b_test), "live-names-test",
+					"yes"));
+	b_value = of_get_property(b_test, "live-names-test", NULL);
+	d_value = of_get_property(d_test, "live-names-test", NULL);
+
+	/* Remove it again, since the live tree is shared with other tests */
+	for (pp = &b_test->properties; *pp; pp = &(*pp)->next) {
+		if (!strcmp((*pp)->name, "live-names-test")) {
+			b_prop = *pp;
+			*pp = b_prop->next;
+			free(b_prop->name);
+			free(b_prop);
+			break;
+		}
+	}
+
+	ut_asserteq_str("yes", b_value);
+	ut_assertnull(d_value);
+	ut_assertnull(of_get_property(b_test, "live-names-test", NULL));
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_live_names, UT_TESTF_SCAN_FDT | UT_TESTF_LIVE_TREE);
+
+/* Number of times to look up each node in dm_test_ofnode_lookup_speed() */
+#define LOOKUP_SPEED_REPEAT	20
+
+/* Compare the time taken to look up nodes and properties in each tree */
+static int dm_test_ofnode_lookup_speed(struct unit_test_state *uts)
+{
+	const void *blob = gd->fdt_blob;
+	ulong flat_us, index_us, live_us, start;
+	int flat_found = 0, index_found = 0, live_found = 0;
+	int node, count, i, j;
+	struct device_node *np;
+	const char *value;
+	u32 *phandles;
+
+	count = 0;
+	for (node = fdt_next_node(blob, -1, NULL); node >= 0;
+	     node = fdt_next_node(blob, node, NULL)) {
+		if (fdt_get_phandle(blob, node))
+			count++;
+	}
+	ut_assert(count > 0);
+	phandles = malloc(count * sizeof(*phandles));
+	ut_assertnonnull(phandles);
+	i = 0;
+	for (node = fdt_next_node(blob, -1, NULL); node >= 0;
+	     node = fdt_next_node(blob, node, NULL)) {
+		if (fdt_get_phandle(blob, node))
+			phandles[i++] = fdt_get_phandle(blob, node);
+	}
+
+	start = timer_get_us();
+	for (j = 0; j < LOOKUP_SPEED_REPEAT; j++) {
+		for (i = 0; i < count; i++) {
+			node = fdt_node_offset_by_phandle(blob, phandles[i]);
+			value = fdt_getprop(blob, node, "compatible", NULL);
+			flat_found += node >= 0 && value;
+		}
+	}
+	flat_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (j = 0; j < LOOKUP_SPEED_REPEAT; j++) {
+		for (i = 0; i < count; i++) {
+			node = of_index_phandle(blob, phandles[i]);
+			value = fdt_getprop(blob, node, "compatible", NULL);
+			index_found += node >= 0 && value;
+		}
+	}
+	index_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (j = 0; j < LOOKUP_SPEED_REPEAT; j++) {
+		for (i = 0; i < count; i++) {
+			np = of_find_node_by_phandle(phandles[i]);
+			value = of_get_property(np, "compatible", NULL);
+			live_found += np && value;
+		}
+	}
+	live_us = timer_get_us() - start;
+	free(phandles);
+
+	/* All three find the same nodes */
+	ut_assert(flat_found > 0);
+	ut_asserteq(flat_found, index_found);
+	ut_asserteq(flat_found, live_found);
+
+	printf("%d lookups: flat %lu us, indexed %lu us, live %lu us\n",
+	       count * LOOKUP_SPEED_REPEAT, flat_us, index_us, live_us);
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_lookup_speed, UT_TESTF_SCAN_FDT | UT_TESTF_LIVE_TREE);
+#endif
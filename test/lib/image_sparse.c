@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for writing Android sparse images
+ *
+ * The same image is written in one go by write_sparse_image() and a piece at
+ * a time by sparse_stream_write(), with the pieces split at every kind of
+ * place: in the file header, in chunk headers, in the value of a FILL chunk
+ * and in the blocks of a RAW chunk.
+ */
+
+#include <common.h>
+#include <image-sparse.h>
+#include <malloc.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define TEST_BLKSZ		512	/* block size of the device */
+#define TEST_SPARSE_BLKSZ	1024	/* block size of the image */
+#define TEST_DEV_BLKS		32
+#define TEST_FILL_VAL		0x5a5aa5a5
+#define TEST_IMG_SIZE		0x4000
+
+static u8 test_dev[TEST_DEV_BLKS * TEST_BLKSZ];
+
+static lbaint_t test_sparse_write(struct sparse_storage *info, lbaint_t blk,
+				  lbaint_t blkcnt, const void *buffer)
+{
+	if (blk + blkcnt > TEST_DEV_BLKS)
+		return 0;
+	memcpy(test_dev + blk * TEST_BLKSZ, buffer, blkcnt * TEST_BLKSZ);
+
+	return blkcnt;
+}
+
+static lbaint_t test_sparse_reserve(struct sparse_storage *info,
+				    lbaint_t blk, lbaint_t blkcnt)
+{
+	return blkcnt;
+}
+
+static void test_sparse_init(struct sparse_storage *info)
+{
+	memset(info, '\0', sizeof(*info));
+	info->blksz = TEST_BLKSZ;
+	info->start = 2;
+	info->size = TEST_DEV_BLKS - info->start;
+	info->write = test_sparse_write;
+	info->reserve = test_sparse_reserve;
+	memset(test_dev, 0xee, sizeof(test_dev));
+}
+
+static u8 *test_add_chunk(u8 *p, u16 type, u32 blks, u32 data_len)
+{
+	chunk_header_t *chunk = (chunk_header_t *)p;
+
+	chunk->chunk_type = type;
+	chunk->reserved1 = 0;
+	chunk->chunk_sz = blks;
+	chunk->total_sz = sizeof(*chunk) + data_len;
+
+	return p + sizeof(*chunk);
+}
+
+/*
+ * Build an image with RAW, FILL, DONT_CARE and CRC32 chunks, and the device
+ * contents it should give. Return the size of the image.
+ */
+static ulong test_make_image(u8 *img, u8 *expect)
+{
+	sparse_header_t *hdr = (sparse_header_t *)img;
+	u8 *p = img + sizeof(*hdr), *out = expect;
+	u32 val = TEST_FILL_VAL;
+	int i;
+
+	memset(expect, 0xee, sizeof(test_dev));
+	out += 2 * TEST_BLKSZ;
+
+	hdr->magic = SPARSE_HEADER_MAGIC;
+	hdr->major_version = 1;
+	hdr->minor_version = 0;
+	hdr->file_hdr_sz = sizeof(*hdr);
+	hdr->chunk_hdr_sz = sizeof(chunk_header_t);
+	hdr->blk_sz = TEST_SPARSE_BLKSZ;
+	hdr->total_blks = 3 + 2 + 1 + 1 + 0;
+	hdr->total_chunks = 5;
+	hdr->image_checksum = 0;
+
+	p = test_add_chunk(p, CHUNK_TYPE_RAW, 3, 3 * TEST_SPARSE_BLKSZ);
+	for (i = 0; i < 3 * TEST_SPARSE_BLKSZ; i++)
+		*out++ = *p++ = i * 13 + (i >> 7);
+
+	p = test_add_chunk(p, CHUNK_TYPE_FILL, 2, sizeof(val));
+	memcpy(p, &val, sizeof(val));
+	p += sizeof(val);
+	for (i = 0; i < 2 * TEST_SPARSE_BLKSZ; i += sizeof(val))
+		memcpy(out + i, &val, sizeof(val));
+	out += 2 * TEST_SPARSE_BLKSZ;
+
+	p = test_add_chunk(p, CHUNK_TYPE_DONT_CARE, 1, 0);
+	out += TEST_SPARSE_BLKSZ;
+
+	p = test_add_chunk(p, CHUNK_TYPE_RAW, 1, TEST_SPARSE_BLKSZ);
+	for (i = 0; i < TEST_SPARSE_BLKSZ; i++)
+		*out++ = *p++ = ~i;
+
+	p = test_add_chunk(p, CHUNK_TYPE_CRC32, 0, 0);
+
+	return p - img;
+}
+
+/* Check that write_sparse_image() gives the expected device contents */
+static int lib_test_sparse_image(struct unit_test_state *uts)
+{
+	struct sparse_storage info;
+	u8 *img, *expect;
+
+	img = malloc(TEST_IMG_SIZE);
+	expect = malloc(sizeof(test_dev));
+	ut_assertnonnull(img);
+	ut_assertnonnull(expect);
+	test_make_image(img, expect);
+
+	test_sparse_init(&info);
+	ut_assertok(write_sparse_image(&info, "test", img, NULL));
+	ut_asserteq_mem(expect, test_dev, sizeof(test_dev));
+
+	free(expect);
+	free(img);
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_image, 0);
+
+/* Feed the image to sparse_stream_write() @step bytes at a time */
+static int test_sparse_stream(struct unit_test_state *uts, const u8 *img,
+			      ulong size, ulong step, const u8 *expect)
+{
+	struct sparse_storage info;
+	struct sparse_stream ss;
+	ulong used = 0, avail;
+	long ret;
+
+	test_sparse_init(&info);
+	ut_assertok(sparse_stream_init(&ss, &info, NULL));
+	for (avail = 0; avail < size;) {
+		avail = min(avail + step, size);
+		ret = sparse_stream_write(&ss, (void *)img + used,
+					  avail - used);
+		ut_assert(ret >= 0);
+		ut_assert(used + ret <= avail);
+		used += ret;
+	}
+	ut_asserteq(size, used);
+	ut_assertok(sparse_stream_finish(&ss, "test"));
+	ut_asserteq_mem(expect, test_dev, sizeof(test_dev));
+
+	return 0;
+}
+
+/* Check writing the image in pieces split at any point */
+static int lib_test_sparse_stream(struct unit_test_state *uts)
+{
+	static const ulong steps[] = {
+		1, 3, 4, 11, 12, 16, 27, 28, 100, 511, 512, 513, 1000, 1024,
+		TEST_IMG_SIZE,
+	};
+	struct sparse_storage info;
+	struct sparse_stream ss;
+	u8 *img, *expect;
+	ulong size;
+	int i;
+
+	img = malloc(TEST_IMG_SIZE);
+	expect = malloc(sizeof(test_dev));
+	ut_assertnonnull(img);
+	ut_assertnonnull(expect);
+	size = test_make_image(img, expect);
+
+	for (i = 0; i < ARRAY_SIZE(steps); i++)
+		ut_assertok(test_sparse_stream(uts, img, size, steps[i],
+					       expect));
+
+	/* A truncated image is reported */
+	test_sparse_init(&info);
+	ut_assertok(sparse_stream_init(&ss, &info, NULL));
+	ut_assert(sparse_stream_write(&ss, img, size - 1) >= 0);
+	ut_asserteq(-1, sparse_stream_finish(&ss, "test"));
+
+	free(expect);
+	free(img);
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_stream, 0);
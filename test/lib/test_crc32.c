@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests and benchmark for the CRC-32 and CRC-32C implementations
+ *
+ * The table-driven code may use slice-by-8 tables or, on ARMv8, the CRC32
+ * and PMULL instructions, so check it against a plain bitwise CRC at
+ * various lengths and alignments.
+ */
+
+#include <common.h>
+#include <div64.h>
+#include <malloc.h>
+#include <rand.h>
+#include <time.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+#include <linux/sizes.h>
+
+#define CRC32_POLY	0xedb88320
+#define CRC32C_POLY	0x82f63b78
+
+/* Enough for the PMULL folding to kick in, with an odd tail */
+#define TEST_CRC_SIZE	(4096 + 64 + 13)
+
+static const int test_crc_lens[] = {
+	0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100,
+	255, 1023, 1024, 1025, 2048 + 7, 4096 + 48,
+};
+
+static u32 crc_bitwise(u32 crc, u32 poly, const u8 *p, int len)
+{
+	int i;
+
+	while (len--) {
+		crc ^= *p++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (crc & 1 ? poly : 0);
+	}
+
+	return crc;
+}
+
+static void rand_buf(u8 *buf, int size)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		buf[i] = rand() & 0xff;
+}
+
+/* Check the standard "123456789" check values */
+static int lib_test_crc32_vectors(struct unit_test_state *uts)
+{
+	static const char msg[] = "123456789";
+
+	ut_asserteq(0xcbf43926, crc32(0, (const u8 *)msg, 9));
+	ut_asserteq(0, crc32(0, (const u8 *)msg, 0));
+	/* crc32() continues from a previous result */
+	ut_asserteq(0xcbf43926, crc32(crc32(0, (const u8 *)msg, 4),
+				      (const u8 *)msg + 4, 5));
+	ut_asserteq(0xcbf43926, ~crc32_no_comp(~0, (const u8 *)msg, 9));
+
+	if (IS_ENABLED(CONFIG_CRC32C)) {
+		u32 table[256];
+
+		crc32c_init(table, CRC32C_POLY);
+		ut_asserteq(0xe3069283, ~crc32c_cal(~0, msg, 9, table));
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_crc32_vectors, 0);
+
+/* Compare against a bitwise CRC at all alignments and many lengths */
+static int lib_test_crc32_bitwise(struct unit_test_state *uts)
+{
+	u32 table[256];
+	int i, align;
+	u8 *buf;
+
+	buf = malloc(TEST_CRC_SIZE + 8);
+	ut_assertnonnull(buf);
+	rand_buf(buf, TEST_CRC_SIZE + 8);
+	if (IS_ENABLED(CONFIG_CRC32C))
+		crc32c_init(table, CRC32C_POLY);
+
+	for (align = 0; align < 8; align++) {
+		const u8 *p = buf + align;
+
+		for (i = 0; i < ARRAY_SIZE(test_crc_lens); i++) {
+			int len = test_crc_lens[i];
+
+			ut_asserteq(crc_bitwise(0x12345678, CRC32_POLY, p, len),
+				    crc32_no_comp(0x12345678, p, len));
+			ut_asserteq(~crc_bitwise(~0, CRC32_POLY, p, len),
+				    crc32(0, p, len));
+			if (IS_ENABLED(CONFIG_CRC32C))
+				ut_asserteq(crc_bitwise(~0, CRC32C_POLY, p, len),
+					    crc32c_cal(~0, (const char *)p, len,
+						       table));
+		}
+	}
+	ut_asserteq(~crc_bitwise(~0, CRC32_POLY, buf, TEST_CRC_SIZE),
+		    crc32(0, buf, TEST_CRC_SIZE));
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_crc32_bitwise, 0);
+
+static void crc_bench_show(const char *name, ulong len, ulong us)
+{
+	us = max(us, 1UL);
+	printf("%-10s %lu bytes in %lu us, %llu KiB/s\n", name, len, us,
+	       lldiv((u64)len * 1000000 / 1024, us));
+}
+
+/* Show how long the CRCs take over 1MiB, compared to the bitwise version */
+static int lib_test_crc32_speed(struct unit_test_state *uts)
+{
+	const ulong len = SZ_1M;
+	u32 table[256], crc, expect;
+	ulong start;
+	u8 *buf;
+
+	buf = malloc(len);
+	ut_assertnonnull(buf);
+	rand_buf(buf, len);
+
+	start = timer_get_us();
+	expect = crc_bitwise(0, CRC32_POLY, buf, len);
+	crc_bench_show("bitwise", len, timer_get_us() - start);
+
+	start = timer_get_us();
+	crc = crc32_no_comp(0, buf, len);
+	crc_bench_show("crc32", len, timer_get_us() - start);
+	ut_asserteq(expect, crc);
+
+	if (IS_ENABLED(CONFIG_CRC32C)) {
+		crc32c_init(table, CRC32C_POLY);
+		expect = crc_bitwise(0, CRC32C_POLY, buf, len);
+		start = timer_get_us();
+		crc = crc32c_cal(0, (const char *)buf, len, table);
+		crc_bench_show("crc32c", len, timer_get_us() - start);
+		ut_asserteq(expect, crc);
+	}
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_crc32_speed, 0);
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for the SHA-1/SHA-2 implementations
+ *
+ * These check the block functions actually in use, which may be
+ * architecture-specific (e.g. the ARMv8 Crypto Extensions), against the
+ * FIPS 180 test vectors and against the portable block functions.
+ */
+
+#include <common.h>
+#include <hash.h>
+#include <hexdump.h>
+#include <malloc.h>
+#include <rand.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <u-boot/sha1.h>
+#include <u-boot/sha256.h>
+#include <u-boot/sha512.h>
+
+enum {
+	MSG_ABC,	/* "abc" */
+	MSG_448,	/* the 448-bit message from FIPS 180 */
+	MSG_MILLION,	/* one million 'a' characters */
+};
+
+struct test_sha_vec {
+	const char *algo;
+	int msg;
+	const char *digest;
+};
+
+static const struct test_sha_vec test_sha_vec[] = {
+	{ "sha1", MSG_ABC, "a9993e364706816aba3e25717850c26c9cd0d89d" },
+	{ "sha1", MSG_448, "84983e441c3bd26ebaae4aa1f95129e5e54670f1" },
+	{ "sha1", MSG_MILLION, "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+	{ "sha256", MSG_ABC, "ba7816bf8f01cfea414140de5dae2223"
+			     "b00361a396177a9cb410ff61f20015ad" },
+	{ "sha256", MSG_448, "248d6a61d20638b8e5c026930c3e6039"
+			     "a33ce45964ff2167f6ecedd419db06c1" },
+	{ "sha256", MSG_MILLION, "cdc76e5c9914fb9281a1c7e284d73e67"
+				 "f1809a48a497200e046d39ccc7112cd0" },
+	{ "sha384", MSG_ABC, "cb00753f45a35e8bb5a03d699ac65007"
+			     "272c32ab0eded1631a8b605a43ff5bed"
+			     "8086072ba1e7cc2358baeca134c825a7" },
+	{ "sha384", MSG_448, "3391fdddfc8dc7393707a65b1b470939"
+			     "7cf8b1d162af05abfe8f450de5f36bc6"
+			     "b0455a8520bc4e6f5fe95b1fe3c8452b" },
+	{ "sha384", MSG_MILLION, "9d0e1809716474cb086e834e310a4a1c"
+				 "ed149e9c00f248527972cec5704c2a5b"
+				 "07b8b3dc38ecc4ebae97ddd87f3d8985" },
+	{ "sha512", MSG_ABC, "ddaf35a193617abacc417349ae204131"
+			     "12e6fa4e89a97ea20a9eeee64b55d39a"
+			     "2192992a274fc1a836ba3c23a3feebbd"
+			     "454d4423643ce80e2a9ac94fa54ca49f" },
+	{ "sha512", MSG_448, "204a8fc6dda82f0a0ced7beb8e08a416"
+			     "57c16ef468b228a8279be331a703c335"
+			     "96fd15c13b1b07f9aa1d3bea57789ca0"
+			     "31ad85c7a71dd70354ec631238ca3445" },
+	{ "sha512", MSG_MILLION, "e718483d0ce769644e2e42c7bc15b463"
+				 "8e1f98b13b2044285632a803afa973eb"
+				 "de0ff244877ea60a4cb0432ce577c31b"
+				 "eb009c5c2c49aa2e4eadb217ad8cc09b" },
+};
+
+static const char test_sha_msg_448[] =
+	"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+static void rand_buf(u8 *buf, int size)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		buf[i] = rand() & 0xff;
+}
+
+/* Test each algorithm against the FIPS 180 test vectors */
+static int lib_test_sha_vectors(struct unit_test_state *uts)
+{
+	u8 expect[HASH_MAX_DIGEST_SIZE], digest[HASH_MAX_DIGEST_SIZE];
+	const struct test_sha_vec *vec;
+	struct hash_algo *algo;
+	int size, len;
+	u8 *buf;
+
+	buf = malloc(1000000);
+	ut_assertnonnull(buf);
+
+	for (vec = test_sha_vec; vec < test_sha_vec + ARRAY_SIZE(test_sha_vec);
+	     vec++) {
+		if (hash_lookup_algo(vec->algo, &algo))
+			continue;
+
+		switch (vec->msg) {
+		case MSG_ABC:
+			strcpy((char *)buf, "abc");
+			size = 3;
+			break;
+		case MSG_448:
+			strcpy((char *)buf, test_sha_msg_448);
+			size = strlen(test_sha_msg_448);
+			break;
+		default:
+			memset(buf, 'a', 1000000);
+			size = 1000000;
+			break;
+		}
+		len = strlen(vec->digest) / 2;
+		ut_asserteq(algo->digest_size, len);
+		ut_assertok(hex2bin(expect, vec->digest, len));
+
+		memset(digest, '\0', sizeof(digest));
+		algo->hash_func_ws(buf, size, digest, algo->chunk_size);
+		ut_asserteq_mem(expect, digest, len);
+	}
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_sha_vectors, 0);
+
+/*
+ * Test that hashing a buffer in pieces of awkward sizes gives the same
+ * result as hashing it in one go
+ */
+static int lib_test_sha_split(struct unit_test_state *uts)
+{
+	static const int piece[] = { 1, 3, 55, 63, 64, 65, 127, 128, 129, 300 };
+	static const char *const names[] = {
+		"sha1", "sha256", "sha384", "sha512"
+	};
+	u8 expect[HASH_MAX_DIGEST_SIZE], digest[HASH_MAX_DIGEST_SIZE];
+	const int size = 4000;
+	struct hash_algo *algo;
+	int i, j, pos, len;
+	void *ctx;
+	u8 *buf;
+
+	buf = malloc(size);
+	ut_assertnonnull(buf);
+	rand_buf(buf, size);
+
+	for (i = 0; i < ARRAY_SIZE(names); i++) {
+		if (hash_progressive_lookup_algo(names[i], &algo))
+			continue;
+		algo->hash_func_ws(buf, size, expect, algo->chunk_size);
+
+		for (j = 0; j < ARRAY_SIZE(piece); j++) {
+			ut_assertok(algo->hash_init(algo, &ctx));
+			for (pos = 0; pos < size; pos += len) {
+				len = min(piece[j], size - pos);
+				ut_assertok(algo->hash_update(algo, ctx,
+							      buf + pos, len,
+							      0));
+			}
+			ut_assertok(algo->hash_finish(algo, ctx, digest,
+						      algo->digest_size));
+			ut_asserteq_mem(expect, digest, algo->digest_size);
+		}
+	}
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_sha_split, 0);
+
+/*
+ * Test that the block functions in use, which may be accelerated, match the
+ * portable ones
+ */
+static int lib_test_sha_process(struct unit_test_state *uts)
+{
+	const int blocks = 37;
+	u8 *buf;
+
+	buf = malloc(blocks * SHA512_BLOCK_SIZE);
+	ut_assertnonnull(buf);
+	rand_buf(buf, blocks * SHA512_BLOCK_SIZE);
+
+	if (IS_ENABLED(CONFIG_SHA1)) {
+		sha1_context ctx, base;
+
+		sha1_starts(&ctx);
+		sha1_starts(&base);
+		sha1_process(&ctx, buf, blocks);
+		sha1_base_process(&base, buf, blocks);
+		ut_asserteq_mem(base.state, ctx.state, sizeof(ctx.state));
+	}
+	if (IS_ENABLED(CONFIG_SHA256)) {
+		sha256_context ctx, base;
+
+		sha256_starts(&ctx);
+		sha256_starts(&base);
+		sha256_process(&ctx, buf, blocks);
+		sha256_base_process(&base, buf, blocks);
+		ut_asserteq_mem(base.state, ctx.state, sizeof(ctx.state));
+
+		/* no blocks must leave the state alone */
+		sha256_process(&ctx, buf, 0);
+		ut_asserteq_mem(base.state, ctx.state, sizeof(ctx.state));
+	}
+	if (IS_ENABLED(CONFIG_SHA512)) {
+		sha512_context ctx, base;
+
+		sha512_starts(&ctx);
+		sha512_starts(&base);
+		sha512_process(&ctx, buf, blocks);
+		sha512_base_process(&base, buf, blocks);
+		ut_asserteq_mem(base.state, ctx.state, sizeof(ctx.state));
+	}
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_sha_process, 0);
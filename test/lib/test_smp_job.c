@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for running jobs on secondary CPUs
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <smp_job.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+
+#define TEST_JOBS	(CONFIG_SMP_JOB_CPUS + 2)
+#define TEST_JOB_SIZE	0x10000
+#define TEST_JOB_ROUNDS	64
+
+struct test_job {
+	struct smp_job job;
+	uint seed;
+	u32 crc;
+};
+
+/*
+ * Allocate, fill and checksum buffers of varying sizes, so that the jobs and
+ * the boot CPU all use malloc() at the same time
+ */
+static int test_job_func(void *arg)
+{
+	struct test_job *tj = arg;
+	uint seed = tj->seed;
+	u32 crc = 0;
+	int i, j;
+
+	for (i = 0; i < TEST_JOB_ROUNDS; i++) {
+		int size = TEST_JOB_SIZE / TEST_JOB_ROUNDS * (i + 1);
+		u8 *buf;
+
+		buf = malloc(size);
+		if (!buf)
+			return -ENOMEM;
+		for (j = 0; j < size; j++) {
+			seed = seed * 1103515245 + 12345;
+			buf[j] = seed >> 16;
+		}
+		crc = crc32(crc, buf, size);
+		free(buf);
+	}
+	tj->crc = crc;
+
+	return 0;
+}
+
+static int lib_test_smp_job(struct unit_test_state *uts)
+{
+	struct test_job jobs[TEST_JOBS], ref;
+	int i;
+
+	for (i = 0; i < TEST_JOBS; i++) {
+		jobs[i].seed = i + 1;
+		smp_job_start(&jobs[i].job, test_job_func, &jobs[i]);
+	}
+
+	/* Keep the boot CPU busy with the same work meanwhile */
+	for (i = 0; i < TEST_JOBS; i++) {
+		ref.seed = i + 1;
+		ut_assertok(test_job_func(&ref));
+		ut_assertok(smp_job_wait(&jobs[i].job));
+		ut_asserteq(ref.crc, jobs[i].crc);
+	}
+
+	/* There are enough secondary CPUs for the first jobs */
+	for (i = 0; i < CONFIG_SMP_JOB_CPUS; i++) {
+		ut_assert(jobs[i].job.cpu >= 1);
+		ut_assert(jobs[i].job.cpu <= CONFIG_SMP_JOB_CPUS);
+	}
+	ut_asserteq(0, smp_job_cpu());
+
+	/* Stopping is idempotent and the CPUs start again for the next job */
+	smp_job_stop();
+	smp_job_stop();
+	ref.seed = 1;
+	smp_job_start(&ref.job, test_job_func, &ref);
+	ut_assertok(smp_job_wait(&ref.job));
+	ut_asserteq(jobs[0].crc, ref.crc);
+	ut_assert(ref.job.cpu >= 1);
+	smp_job_stop();
+
+	return 0;
+}
+LIB_TEST(lib_test_smp_job, 0);
+
+/* Split the work into jobs of its own, as decompressing frames does */
+static int test_job_nested(void *arg)
+{
+	struct test_job *tj = arg, sub[TEST_JOBS];
+	int i, ret;
+
+	for (i = 0; i < TEST_JOBS; i++) {
+		sub[i].seed = tj->seed + i;
+		smp_job_start(&sub[i].job, test_job_func, &sub[i]);
+	}
+	tj->crc = 0;
+	for (i = 0; i < TEST_JOBS; i++) {
+		ret = smp_job_wait(&sub[i].job);
+		if (ret)
+			return ret;
+		tj->crc ^= sub[i].crc;
+	}
+
+	return 0;
+}
+
+static int lib_test_smp_job_nested(struct unit_test_state *uts)
+{
+	struct test_job outer[2], ref;
+	u32 crc;
+	int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(outer); i++) {
+		outer[i].seed = i * TEST_JOBS + 1;
+		smp_job_start(&outer[i].job, test_job_nested, &outer[i]);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(outer); i++) {
+		ut_assertok(smp_job_wait(&outer[i].job));
+		crc = 0;
+		for (j = 0; j < TEST_JOBS; j++) {
+			ref.seed = outer[i].seed + j;
+			ut_assertok(test_job_func(&ref));
+			crc ^= ref.crc;
+		}
+		ut_asserteq(crc, outer[i].crc);
+	}
+	smp_job_stop();
+
+	return 0;
+}
+LIB_TEST(lib_test_smp_job_nested, 0);
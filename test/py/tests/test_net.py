@@ -167,6 +167,49 @@ def test_net_tftpboot(u_boot_console):
     output = u_boot_console.run_command('crc32 $fileaddr $filesize')
     assert expected_crc in output
 
+@pytest.mark.buildconfigspec('cmd_net')
+def test_net_tftpboot_multi(u_boot_console):
+    """Test fetching several files with one tftpboot command.
+
+    The readable file is downloaded twice at once, to two addresses, and the
+    CRC32 of the second copy is validated as well as the size of the first.
+
+    The details of the file to download are provided by the boardenv_* file;
+    see the comment at the beginning of this file.
+    """
+
+    if not net_set_up:
+        pytest.skip('Network not initialized')
+
+    if int(u_boot_console.config.buildconfig.get('config_tftp_max_files',
+                                                 '1')) < 2:
+        pytest.skip('tftpboot fetches a single file')
+
+    f = u_boot_console.config.env.get('env__net_tftp_readable_file', None)
+    if not f:
+        pytest.skip('No TFTP readable file to read')
+
+    addr = f.get('addr', None)
+    sz = f.get('size', None)
+    if not addr or not sz:
+        pytest.skip('No TFTP file address and size to load at')
+
+    fn = f['fn']
+    addr2 = addr + ((sz + 0xfffff) & ~0xfffff)
+    output = u_boot_console.run_command('tftpboot %x %s %x %s' %
+                                        (addr, fn, addr2, fn))
+    assert 'Bytes transferred = %d' % sz in output
+
+    expected_crc = f.get('crc32', None)
+    if not expected_crc:
+        return
+
+    if u_boot_console.config.buildconfig.get('config_cmd_crc32', 'n') != 'y':
+        return
+
+    output = u_boot_console.run_command('crc32 %x $filesize' % addr2)
+    assert expected_crc in output
+
 @pytest.mark.buildconfigspec('cmd_nfs')
 def test_net_nfs(u_boot_console):
     """Test the nfs command.
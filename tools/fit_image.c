@@ -24,6 +24,11 @@
 
 static image_header_t header;
 
+/* See include/decomp_frames.h */
+#define GZIP_SUBFIELD_UB	"UB"
+#define ZSTD_SEEKABLE_MAGIC		0x184d2a5e
+#define ZSTD_SEEKABLE_FOOTER_MAGIC	0x8f92eab1
+
 static int fit_add_file_data(struct image_tool_params *params, size_t size_inc,
 			     const char *tmpfile)
 {
@@ -205,6 +210,226 @@ static void add_crc_node(void *fdt)
 	fdt_end_node(fdt);
 }
 
+static void put_le16(uint8_t *buf, uint16_t val)
+{
+	buf[0] = val;
+	buf[1] = val >> 8;
+}
+
+static void put_le32(uint8_t *buf, uint32_t val)
+{
+	put_le16(buf, val);
+	put_le16(buf + 2, val >> 16);
+}
+
+/**
+ * fit_compress_frame() - Compress one frame with the gzip or zstd program
+ *
+ * @params: Parameters, giving the compression type
+ * @fname: Name of the file to compress, which is replaced by the compressed
+ *	frame
+ * @bufp: Returns the compressed frame, which must be freed by the caller
+ * @return size of the compressed frame, or -1 on error
+ */
+static int fit_compress_frame(struct image_tool_params *params,
+			      const char *fname, uint8_t **bufp)
+{
+	char cmd[MKIMAGE_MAX_DTC_CMDLINE_LEN];
+	struct stat sbuf;
+	uint8_t *buf;
+	int ret;
+	int fd;
+
+	/* -n leaves out the file name, so the gzip header is 10 bytes */
+	snprintf(cmd, sizeof(cmd), "%s \"%s\"",
+		 params->comp == IH_COMP_GZIP ? "gzip -9 -n -f" :
+		 "zstd -q -19 -f --rm", fname);
+	debug("Trying to execute \"%s\"\n", cmd);
+	ret = system(cmd);
+	if (ret) {
+		fprintf(stderr, "%s: '%s' failed (%d)\n", params->cmdname, cmd,
+			ret);
+		return -1;
+	}
+
+	snprintf(cmd, sizeof(cmd), "%s%s", fname,
+		 params->comp == IH_COMP_GZIP ? ".gz" : ".zst");
+	fd = open(cmd, O_RDONLY | O_BINARY);
+	if (fd < 0 || fstat(fd, &sbuf) < 0) {
+		fprintf(stderr, "%s: Can't open %s: %s\n", params->cmdname,
+			cmd, strerror(errno));
+		goto err;
+	}
+	buf = malloc(sbuf.st_size);
+	if (!buf) {
+		fprintf(stderr, "%s: Out of memory\n", params->cmdname);
+		goto err;
+	}
+	if (read(fd, buf, sbuf.st_size) != sbuf.st_size) {
+		fprintf(stderr, "%s: Can't read %s: %s\n", params->cmdname,
+			cmd, strerror(errno));
+		free(buf);
+		goto err;
+	}
+	close(fd);
+	unlink(cmd);
+	*bufp = buf;
+
+	return sbuf.st_size;
+err:
+	if (fd >= 0)
+		close(fd);
+	unlink(cmd);
+	return -1;
+}
+
+/* Write @len bytes of @data to @f, returning 0 if OK, -1 on error */
+static int fit_write_all(FILE *f, const void *data, size_t len)
+{
+	return fwrite(data, 1, len, f) == len ? 0 : -1;
+}
+
+/**
+ * fit_compress_frames() - Compress the data file in independent frames
+ *
+ * The data file is split into frames of params->frame_size bytes, which are
+ * compressed separately so that U-Boot can decompress them in parallel. Each
+ * gzip member gives its size in a 'UB' subfield of the extra field in its
+ * header. The zstd frames are followed by a seek table, as in the zstd
+ * seekable format.
+ *
+ * @params: Parameters, where datafile is updated to the compressed file
+ * @fname: Name of the file to write
+ * @return 0 if OK, -1 on error
+ */
+static int fit_compress_frames(struct image_tool_params *params,
+			       const char *fname)
+{
+	char chunkfile[MKIMAGE_MAX_TMPFILE_LEN + 16];
+	uint32_t *sizes = NULL, *new_sizes;
+	uint8_t *buf = NULL;
+	uint8_t *frame;
+	FILE *in, *out;
+	uint8_t hdr[12];
+	size_t len;
+	int count = 0;
+	int size;
+	int i;
+
+	snprintf(chunkfile, sizeof(chunkfile), "%s.chunk", fname);
+	in = fopen(params->datafile, "rb");
+	out = fopen(fname, "wb");
+	if (!in || !out) {
+		fprintf(stderr, "%s: Can't open %s or %s: %s\n",
+			params->cmdname, params->datafile, fname,
+			strerror(errno));
+		goto err;
+	}
+	buf = malloc(params->frame_size);
+	if (!buf) {
+		fprintf(stderr, "%s: Out of memory\n", params->cmdname);
+		goto err;
+	}
+
+	while ((len = fread(buf, 1, params->frame_size, in))) {
+		FILE *chunk;
+
+		chunk = fopen(chunkfile, "wb");
+		if (!chunk || fwrite(buf, 1, len, chunk) != len) {
+			fprintf(stderr, "%s: Can't write %s\n",
+				params->cmdname, chunkfile);
+			if (chunk)
+				fclose(chunk);
+			goto err;
+		}
+		fclose(chunk);
+		size = fit_compress_frame(params, chunkfile, &frame);
+		if (size < 0)
+			goto err;
+
+		if (params->comp == IH_COMP_GZIP) {
+			if (size < 18 || frame[3]) {
+				fprintf(stderr, "%s: Unexpected gzip header\n",
+					params->cmdname);
+				free(frame);
+				goto err;
+			}
+			/* Add an extra field holding the size of the member */
+			frame[3] = 4;
+			put_le16(hdr, 8);
+			memcpy(hdr + 2, GZIP_SUBFIELD_UB, 2);
+			put_le16(hdr + 4, 4);
+			put_le32(hdr + 6, size + 10);
+			if (fit_write_all(out, frame, 10) ||
+			    fit_write_all(out, hdr, 10) ||
+			    fit_write_all(out, frame + 10, size - 10)) {
+				free(frame);
+				goto err_write;
+			}
+		} else if (fit_write_all(out, frame, size)) {
+			free(frame);
+			goto err_write;
+		}
+		free(frame);
+
+		new_sizes = realloc(sizes, (count + 1) * 2 * sizeof(*sizes));
+		if (!new_sizes) {
+			fprintf(stderr, "%s: Out of memory\n", params->cmdname);
+			goto err;
+		}
+		sizes = new_sizes;
+		sizes[count * 2] = size;
+		sizes[count * 2 + 1] = len;
+		count++;
+	}
+
+	if (params->comp == IH_COMP_ZSTD) {
+		put_le32(hdr, ZSTD_SEEKABLE_MAGIC);
+		put_le32(hdr + 4, count * 8 + 9);
+		if (fit_write_all(out, hdr, 8))
+			goto err_write;
+		for (i = 0; i < count; i++) {
+			put_le32(hdr, sizes[i * 2]);
+			put_le32(hdr + 4, sizes[i * 2 + 1]);
+			if (fit_write_all(out, hdr, 8))
+				goto err_write;
+		}
+		put_le32(hdr, count);
+		hdr[4] = 0;
+		put_le32(hdr + 5, ZSTD_SEEKABLE_FOOTER_MAGIC);
+		if (fit_write_all(out, hdr, 9))
+			goto err_write;
+	}
+	if (ferror(in)) {
+		fprintf(stderr, "%s: Can't read %s\n", params->cmdname,
+			params->datafile);
+		goto err;
+	}
+	fclose(in);
+	in = NULL;
+	if (fclose(out)) {
+		out = NULL;
+		goto err_write;
+	}
+	free(sizes);
+	free(buf);
+	params->datafile = (char *)fname;
+
+	return 0;
+err_write:
+	fprintf(stderr, "%s: Can't write %s\n", params->cmdname, fname);
+err:
+	if (in)
+		fclose(in);
+	if (out)
+		fclose(out);
+	unlink(chunkfile);
+	unlink(fname);
+	free(sizes);
+	free(buf);
+	return -1;
+}
+
 /**
  * fit_write_images() - Write out a list of images to the FIT
  *
@@ -745,7 +970,21 @@ static int fit_handle_file(struct image_tool_params *params)
 
 	/* We either compile the source file, or use the existing FIT image */
 	if (params->auto_its) {
-		if (fit_build(params, tmpfile)) {
+		char framefile[MKIMAGE_MAX_TMPFILE_LEN + 8];
+
+		/* Compress the data first, if requested */
+		if (params->frame_size) {
+			sprintf(framefile, "%s.frames", tmpfile);
+			if (fit_compress_frames(params, framefile)) {
+				fprintf(stderr, "%s: failed to compress %s\n",
+					params->cmdname, params->datafile);
+				return EXIT_FAILURE;
+			}
+		}
+		ret = fit_build(params, tmpfile);
+		if (params->frame_size)
+			unlink(framefile);
+		if (ret) {
 			fprintf(stderr, "%s: failed to build FIT\n",
 				params->cmdname);
 			return EXIT_FAILURE;
@@ -933,6 +1172,13 @@ static int fit_extract_contents(void *ptr, struct image_tool_params *params)
 
 static int fit_check_params(struct image_tool_params *params)
 {
+	if (params->frame_size &&
+	    (!params->auto_its || (params->comp != IH_COMP_GZIP &&
+				   params->comp != IH_COMP_ZSTD))) {
+		fprintf(stderr, "%s: -Z needs -f auto and -C gzip or zstd\n",
+			params->cmdname);
+		return -1;
+	}
 	if (params->auto_its)
 		return 0;
 	return	((params->dflag && params->fflag) ||
@@ -83,6 +83,7 @@ struct image_tool_params {
 	int bl_len;		/* Block length in byte for external data */
 	const char *engine_id;	/* Engine to use for signing */
 	bool reset_timestamp;	/* Reset the timestamp on an existing image */
+	unsigned int frame_size;	/* Compress data in frames of this size */
 };
 
 /*
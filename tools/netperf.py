@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+"""Host side of the U-Boot netperf command
+
+Run 'netperf.py source <board IP>' against 'netperf sink' on the board, or
+'netperf.py sink' against 'netperf source <host IP>'.
+"""
+
+import argparse
+import socket
+import struct
+import time
+
+MAGIC = 0x4e505246
+HDR = struct.Struct('!III')
+PORT = 5001
+
+
+def source(args):
+    """Send packets to the board as fast as the socket takes them"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    filler = bytes(args.size - HDR.size)
+    gap = 1 / args.rate if args.rate else 0
+    start = time.monotonic()
+    seq = 0
+    while time.monotonic() - start < args.time:
+        usec = int(time.monotonic() * 1e6) & 0xffffffff
+        sock.sendto(HDR.pack(MAGIC, seq, usec) + filler, (args.host, args.port))
+        seq += 1
+        if gap:
+            time.sleep(max(0, start + seq * gap - time.monotonic()))
+    elapsed = time.monotonic() - start
+    print(f'{seq} packets in {elapsed:.3f} s, {seq / elapsed:.0f} packets/s, '
+          f'{seq * args.size / elapsed / 1e6:.2f} MB/s')
+
+
+def sink(args):
+    """Count the packets the board sends until none come for 3 seconds"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(('', args.port))
+    sock.settimeout(3)
+    packets = nbytes = drops = late = 0
+    next_seq = None
+    start = last = None
+    try:
+        while True:
+            data = sock.recv(65536)
+            magic, seq, _ = HDR.unpack_from(data)
+            if magic != MAGIC:
+                continue
+            last = time.monotonic()
+            if next_seq is None:
+                start, next_seq = last, seq
+            packets += 1
+            nbytes += len(data)
+            if seq >= next_seq:
+                drops += seq - next_seq
+                next_seq = seq + 1
+            else:
+                late += 1
+                drops = max(0, drops - 1)
+    except socket.timeout:
+        pass
+    if not packets:
+        print('No packets received')
+        return
+    elapsed = (last - start) or 1e-6
+    print(f'{packets} packets in {elapsed:.3f} s, '
+          f'{packets / elapsed:.0f} packets/s, {nbytes / elapsed / 1e6:.2f} '
+          f'MB/s, {drops} dropped, {late} out of order')
+
+
+def main():
+    """Parse the arguments and run the test"""
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest='mode', required=True)
+    src = sub.add_parser('source', help='send packets to the board')
+    src.add_argument('host', help='IP address of the board')
+    src.add_argument('-t', '--time', type=float, default=10,
+                     help='seconds to send for')
+    src.add_argument('-s', '--size', type=int, default=1472,
+                     help='UDP payload size')
+    src.add_argument('-r', '--rate', type=float, default=0,
+                     help='packets per second, 0 for as fast as possible')
+    snk = sub.add_parser('sink', help='receive packets from the board')
+    for cmd in src, snk:
+        cmd.add_argument('-p', '--port', type=int, default=PORT,
+                         help='UDP port')
+    args = parser.parse_args()
+    if args.mode == 'source':
+        source(args)
+    else:
+        sink(args)
+
+
+if __name__ == '__main__':
+    main()